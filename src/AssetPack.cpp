@@ -0,0 +1,117 @@
+#include "AssetPack.h"
+#include <cstring>
+#include <iostream>
+
+MappedFile AssetPack::m_file;
+const AssetPackFormat::Entry* AssetPack::m_entries = nullptr;
+std::uint32_t AssetPack::m_entryCount = 0;
+std::uint64_t AssetPack::m_namesBase = 0;
+
+namespace {
+    // [offset, offset + length) cabe em size; sem somar antes, que num pacote forjado dá a volta em u64
+    bool fits(std::uint64_t offset, std::uint64_t length, std::uint64_t size) {
+        return offset <= size && length <= size - offset;
+    }
+}
+
+bool AssetPack::mount(const std::string& path) {
+    using namespace AssetPackFormat;
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    Header header;
+    bool valid = m_file.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                header.entriesOffset % alignof(Entry) == 0 &&
+                fits(header.entriesOffset, static_cast<std::uint64_t>(header.entryCount) * sizeof(Entry),
+                     m_file.size()) &&
+                header.namesOffset <= m_file.size();
+    }
+
+    const Entry* entries = reinterpret_cast<const Entry*>(m_file.data() + (valid ? header.entriesOffset : 0));
+    for (std::uint32_t i = 0; valid && i < header.entryCount; ++i) {
+        const Entry& entry = entries[i];
+        valid = fits(entry.dataOffset, entry.dataSize, m_file.size()) &&
+                fits(header.namesOffset, entry.nameOffset, m_file.size()) &&
+                fits(header.namesOffset + entry.nameOffset, entry.nameLength, m_file.size()) &&
+                // largura * altura cabe em u64, o * 4 não: compara com dataSize / 4
+                (entry.encoding != Rgba8 ||
+                 (entry.dataSize % 4 == 0 &&
+                  entry.dataSize / 4 == static_cast<std::uint64_t>(entry.width) * entry.height));
+    }
+
+    if (!valid) {
+        std::cerr << "[ERRO] Pacote de assets inválido: " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    m_entries = entries;
+    m_entryCount = header.entryCount;
+    m_namesBase = header.namesOffset;
+    return true;
+}
+
+std::string_view AssetPack::entryName(const AssetPackFormat::Entry& entry) {
+    return std::string_view(reinterpret_cast<const char*>(m_file.data() + m_namesBase + entry.nameOffset),
+                            entry.nameLength);
+}
+
+const AssetPackFormat::Entry* AssetPack::find(std::string_view name) {
+    if (!m_file.isOpen()) return nullptr;
+
+    // entradas ordenadas por nome: busca binária sem copiar strings
+    std::uint32_t low = 0;
+    std::uint32_t high = m_entryCount;
+    while (low < high) {
+        const std::uint32_t mid = low + (high - low) / 2;
+        const int order = entryName(m_entries[mid]).compare(name);
+        if (order == 0) return &m_entries[mid];
+        if (order < 0) low = mid + 1;
+        else high = mid;
+    }
+    return nullptr;
+}
+
+bool AssetPack::loadImage(std::string_view name, sf::Image& image) {
+    const AssetPackFormat::Entry* entry = find(name);
+    if (!entry) {
+        return image.loadFromFile(std::string(LOOSE_DIRECTORY) + std::string(name));
+    }
+
+    const unsigned char* data = m_file.data() + entry->dataOffset;
+    if (entry->encoding == AssetPackFormat::Rgba8) {
+        image.create(entry->width, entry->height, data);
+        return true;
+    }
+    return image.loadFromMemory(data, static_cast<std::size_t>(entry->dataSize));
+}
+
+bool AssetPack::loadTexture(std::string_view name, sf::Texture& texture) {
+    const AssetPackFormat::Entry* entry = find(name);
+    if (!entry) {
+        return texture.loadFromFile(std::string(LOOSE_DIRECTORY) + std::string(name));
+    }
+
+    const unsigned char* data = m_file.data() + entry->dataOffset;
+    if (entry->encoding == AssetPackFormat::Rgba8) {
+        // upload direto da memória mapeada, sem decodificar nem copiar
+        if (!texture.create(entry->width, entry->height)) return false;
+        texture.update(data);
+        return true;
+    }
+    return texture.loadFromMemory(data, static_cast<std::size_t>(entry->dataSize));
+}
+
+bool AssetPack::loadFont(std::string_view name, sf::Font& font) {
+    const AssetPackFormat::Entry* entry = find(name);
+    if (!entry) {
+        return font.loadFromFile(std::string(LOOSE_DIRECTORY) + std::string(name));
+    }
+    if (entry->encoding != AssetPackFormat::Raw) return false;
+    return font.loadFromMemory(m_file.data() + entry->dataOffset, static_cast<std::size_t>(entry->dataSize));
+}
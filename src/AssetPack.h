@@ -0,0 +1,75 @@
+#pragma once
+#include "MappedFile.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Arquivo único com todos os assets, gerado por tools/pack_assets.cpp.
+//
+//   Header | Entry[entryCount] (ordenadas por nome) | nomes | dados
+//
+// Os dados de cada entrada ficam alinhados a DATA_ALIGNMENT. Imagens podem vir
+// já decodificadas em RGBA8, e aí o upload sai direto do arquivo mapeado.
+namespace AssetPackFormat {
+    constexpr char MAGIC[4] = {'C', 'H', 'P', 'K'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint64_t DATA_ALIGNMENT = 16;
+
+    enum Encoding : std::uint32_t {
+        Raw = 0,    // bytes do arquivo original (PNG, TTF...)
+        Rgba8 = 1,  // pixels decodificados, width * height * 4
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t reserved;
+        std::uint64_t entriesOffset;
+        std::uint64_t namesOffset;
+    };
+
+    struct Entry {
+        std::uint64_t dataOffset;
+        std::uint64_t dataSize;
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t encoding;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t reserved;
+    };
+}
+
+// Acesso aos assets por nome relativo à pasta assets/ (ex.: "fonts/PressStart2P-Regular.ttf").
+// Com o pacote montado, nada é lido do disco; o que não estiver nele cai para assets/<nome>.
+class AssetPack {
+private:
+    static MappedFile m_file;
+    static const AssetPackFormat::Entry* m_entries;
+    static std::uint32_t m_entryCount;
+    static std::uint64_t m_namesBase;
+
+    AssetPack() = delete;
+    ~AssetPack() = delete;
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    static const AssetPackFormat::Entry* find(std::string_view name);
+    static std::string_view entryName(const AssetPackFormat::Entry& entry);
+
+public:
+    static constexpr const char* DEFAULT_PATH = "assets.pak";
+    static constexpr const char* LOOSE_DIRECTORY = "assets/";
+
+    static bool mount(const std::string& path);
+    static bool isMounted() { return m_file.isOpen(); }
+    static bool contains(std::string_view name) { return find(name) != nullptr; }
+
+    // Seguros para chamar de qualquer thread depois de mount()
+    static bool loadImage(std::string_view name, sf::Image& image);
+    static bool loadTexture(std::string_view name, sf::Texture& texture);
+    // A fonte lê direto da memória mapeada, que vive até o fim do programa
+    static bool loadFont(std::string_view name, sf::Font& font);
+};
@@ -0,0 +1,821 @@
+#include "Benchmark.h"
+#include "CommandQueue.h"
+#include "ParticleSystem.h"
+#include "SoftwareRenderer.h"
+#include "SpatialGrid.h"
+#include "TileGrid.h"
+#include "WorldBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr float WORLD_WIDTH = 800.0f;
+    constexpr float WORLD_HEIGHT = 600.0f;
+    constexpr float STEP_DT = 1.0f / 120.0f;
+    constexpr std::uint32_t SEED = 12345;
+    constexpr int WARMUP_STEPS = 60;
+    constexpr float VERLET_SKIN = 8.0f;
+    // célula fixa de antes do ajuste automático
+    constexpr float FIXED_CELL_SIZE = 60.0f;
+    constexpr float PILE_HEIGHT = 250.0f;
+    constexpr int SOLVER_ITERATIONS = 4;
+    // passo pedido na variante adaptativa, em múltiplos de STEP_DT
+    constexpr int ADAPTIVE_STEP_SCALE = 4;
+    // Varredura do fluido: represa que desaba, com o mundo crescendo junto com N
+    constexpr const char* FLUID_SWEEP_NAME = "fluid-dam";
+    constexpr int FLUID_COUNTS[] = {5000, 20000, 50000, 100000};
+    constexpr int FLUID_STEPS = 120;
+    constexpr int FLUID_WARMUP_STEPS = 20;
+    constexpr float FLUID_MASS = 2.0f;  // raio 7
+    constexpr float FLUID_SPACING = 14.0f;
+
+    // Malha de molas (arestas e diagonais: ~4 restrições por partícula), sem colisões
+    constexpr const char* CLOTH_SWEEP_NAME = "constraints-cloth";
+    constexpr int CLOTH_SIDES[] = {50, 160, 500};
+    constexpr int CLOTH_STEPS = 30;
+    constexpr int CLOTH_WARMUP_STEPS = 5;
+    constexpr float CLOTH_SPACING = 4.0f;
+
+    // Custo de montar a imagem: cabeças e trilhas x mapa de densidade, só gravidade
+    constexpr const char* RENDER_SWEEP_NAME = "render-splat";
+    constexpr int RENDER_COUNTS[] = {50000, 200000, 1000000};
+    // acima disto as cabeças passam de 7 milhões de vértices; só o mapa é medido
+    constexpr int RENDER_PARTICLES_LIMIT = 200000;
+    constexpr int RENDER_STEPS = 5;
+
+    // Quadro offscreen do SoftwareRenderer em 1080p, o mundo esticado sobre ele
+    constexpr const char* SOFTWARE_SWEEP_NAME = "render-software";
+    constexpr int SOFTWARE_COUNTS[] = {10000, 100000};
+    constexpr size_t SOFTWARE_WIDTH = 1920;
+    constexpr size_t SOFTWARE_HEIGHT = 1080;
+    constexpr int SOFTWARE_FRAMES = 3;
+
+    // Mundo aberto: as mesmas nuvens de partículas cada vez mais afastadas; a grade
+    // densa cobre a caixa envolvente, os tiles só a área ocupada
+    constexpr const char* OPEN_SWEEP_NAME = "open-world";
+    constexpr float OPEN_SPREADS[] = {1e3f, 1e4f, 1e5f, 1e6f};
+    constexpr int OPEN_PARTICLES = 20000;
+    constexpr int OPEN_CLUSTERS = 8;
+    constexpr float OPEN_CLUSTER_SIGMA = 300.0f;
+    constexpr int OPEN_BUILDS = 20;
+
+    // Fim do update (volta ao AoS, trilhas, cabeças) pelo grafo de tarefas, numa
+    // thread e no pool; só gravidade, trilhas cheias
+    constexpr const char* FRAME_SWEEP_NAME = "frame-graph";
+    constexpr int FRAME_COUNTS[] = {20000, 100000};
+    constexpr int FRAME_STEPS = 20;
+
+    // Fila de comandos: produtores empurrando spawns contra um consumidor que drena
+    // e aplica em lote, e o lote comparado com o spawn de uma em uma
+    constexpr const char* QUEUE_SWEEP_NAME = "command-queue";
+    constexpr int QUEUE_PRODUCERS[] = {1, 2, 4};
+    constexpr int QUEUE_COMMANDS = 400000;  // por medição, divididos entre os produtores
+    constexpr int QUEUE_SPAWNS = 9000;  // abaixo do limite de expansão automática do pool
+
+    // Varredura de restituição em muitos mundos pequenos: um por vez, como na
+    // janela (pool e geometria do quadro dentro do mundo), contra o WorldBatch
+    constexpr const char* BATCH_SWEEP_NAME = "world-batch";
+    constexpr int BATCH_COUNTS[] = {100, 500, 2000};
+    constexpr int BATCH_RESTITUTIONS = 8;
+    constexpr int BATCH_SEEDS = 4;
+    constexpr int BATCH_STEPS = 120;
+
+    // Como as partículas iniciais se espalham pelo mundo
+    enum class Layout {
+        Uniform,    // generateRandomParticles: posição uniforme, massa 1..5
+        Piled,      // faixa encostada no chão
+        Clustered,  // alguns aglomerados gaussianos
+    };
+
+    struct Scenario {
+        const char* name;
+        int particles;
+        int steps;
+        std::function<void(ParticleSystem&, ParticleSystem::PhysicsInputState&)> configure;
+        Layout layout = Layout::Uniform;
+    };
+
+    using Inputs = ParticleSystem::PhysicsInputState;
+
+    // Aplicada antes do spawn e da configuração do cenário. stepScale multiplica o
+    // passo pedido ao sistema; o número de passos cai na mesma proporção, então o
+    // tempo simulado é o mesmo das outras variantes.
+    struct Variant {
+        const char* name;
+        std::function<void(ParticleSystem&, Inputs&)> apply;
+        int stepScale = 1;
+    };
+
+    struct Result {
+        double kernelPerStep;   // forças + integração
+        double pairsPerStep;    // vizinhos + colisões
+        double totalPerStep;
+        double stepsPerSecond;
+        double rebuildShare;
+        size_t listBytes;
+        double candidatesPerPair;
+        double penetration;     // sobreposição média dos contatos, em px
+        double visitsPerStep;   // contatos x iterações do solver
+    };
+
+    ParticleSystem::PhysicsInputState defaultInputs() {
+        ParticleSystem::PhysicsInputState inputs{};
+        inputs.gravityEnabled = true;
+        inputs.gravitationalAcceleration = 250.0f;
+        inputs.repulsionStrength = 5.0f;
+        inputs.collisionsEnabled = true;
+        inputs.collisionRestitution = 0.7f;
+        inputs.mousePosition = {WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f};
+        inputs.mouseForceStrength = 3750.0f;
+        inputs.mouseForceAttractMode = true;
+        return inputs;
+    }
+
+    std::vector<Scenario> scenarios() {
+        return {
+            {"gravity-collision", 2000, 600, [](ParticleSystem&, ParticleSystem::PhysicsInputState&) {}},
+            {"mouse-vortex", 2000, 600, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                in.mouseForceEnabled = true;
+                in.forceMode = 1; // redemoinho
+            }},
+            {"repulsion-gas", 2000, 600, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                // sem gravidade as partículas se espalham e andam pouco por passo
+                in.gravityEnabled = false;
+                in.repulsionEnabled = true;
+            }},
+            {"big-mix", 2000, 600, [](ParticleSystem& system, ParticleSystem::PhysicsInputState&) {
+                // 1% de partículas pesadas: o raio (5 + massa) passa de 40 px
+                std::mt19937 rng(SEED);
+                std::uniform_real_distribution<float> x(50.0f, WORLD_WIDTH - 50.0f), y(50.0f, WORLD_HEIGHT - 50.0f);
+                for (int i = 0; i < 20; ++i) {
+                    system.addParticle(40.0f, {x(rng), y(rng)}, {0.0f, 0.0f}, sf::Color::White);
+                }
+            }},
+            // mesma busca de pares sobre três distribuições; só colisões
+            {"pairs-uniform", 3000, 300, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                in.gravityEnabled = false;
+            }, Layout::Uniform},
+            {"pairs-piled", 3000, 300, [](ParticleSystem&, ParticleSystem::PhysicsInputState&) {}, Layout::Piled},
+            {"pairs-clustered", 3000, 300, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                in.gravityEnabled = false;
+            }, Layout::Clustered},
+            // pilha assentando sob gravidade: penetração x visitas de pares por solver
+            {"pile-settle", 1500, 1200, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                in.collisionRestitution = 0.2f;
+            }, Layout::Piled},
+            // três espécies sem gravidade: pares separados por par de espécies antes das contas
+            {"species-clusters", 3000, 300, [](ParticleSystem& system, ParticleSystem::PhysicsInputState& in) {
+                in.gravityEnabled = false;
+                in.repulsionEnabled = true;
+                system.loadSpeciesPreset(SpeciesPreset::Clusters);
+            }},
+            // tabuleiro de pinos: custo da amostra do campo de distância por partícula
+            {"obstacle-pegs", 3000, 600, [](ParticleSystem& system, ParticleSystem::PhysicsInputState&) {
+                system.getObstacles().loadScene(ObstacleScene::Pegs, WORLD_WIDTH, WORLD_HEIGHT);
+            }},
+            {"mouse-pulse", 2000, 600, [](ParticleSystem&, ParticleSystem::PhysicsInputState& in) {
+                in.gravityEnabled = false;
+                in.collisionsEnabled = false;
+                in.mouseForceEnabled = true;
+                in.forceMode = 2; // onda de pulso
+            }},
+            {"force-fields", 10000, 300, [](ParticleSystem& system, ParticleSystem::PhysicsInputState& in) {
+                // 16 atratores em grade, 4 vórtices, uma onda e ruído ambiente
+                in.collisionsEnabled = false;
+                ForceFieldSet& fields = system.getForceFields();
+                for (int i = 0; i < 16; ++i) {
+                    const float x = WORLD_WIDTH * (0.125f + 0.25f * (i % 4));
+                    const float y = WORLD_HEIGHT * (0.125f + 0.25f * (i / 4));
+                    fields.add(ForceField::pointAttractor(x, y, (i % 2) ? 2000.0f : -1500.0f, 150.0f));
+                }
+                for (int i = 0; i < 4; ++i) {
+                    fields.add(ForceField::vortex(WORLD_WIDTH * (0.25f + 0.5f * (i % 2)),
+                                                  WORLD_HEIGHT * (0.25f + 0.5f * (i / 2)), 3000.0f, 250.0f, 40.0f));
+                }
+                fields.add(ForceField::wave(WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f, 2500.0f, 600.0f, 0.05f, 3.0f));
+                fields.add(ForceField::noise(400.0f, 80.0f, 0.5f));
+            }},
+        };
+    }
+
+    std::vector<Variant> variants() {
+        return {
+            {"especializado", [](ParticleSystem& s, Inputs&) { s.setSpecializedKernels(true); }},
+            {"genérico", [](ParticleSystem& s, Inputs&) { s.setSpecializedKernels(false); }},
+            {"verlet", [](ParticleSystem& s, Inputs&) { s.setNeighborSkin(VERLET_SKIN); }},
+            {"célula-60", [](ParticleSystem& s, Inputs&) { s.setGridCellSize(FIXED_CELL_SIZE); }},
+            {"sap", [](ParticleSystem& s, Inputs&) { s.setBroadphase(BroadphaseType::SweepAndPrune); }},
+            {"pbd-4", [](ParticleSystem&, Inputs& in) { in.solverIterations = SOLVER_ITERATIONS; }},
+            {"pbd-4 sem warm", [](ParticleSystem& s, Inputs& in) {
+                in.solverIterations = SOLVER_ITERATIONS;
+                s.setWarmStarting(false);
+            }},
+            {"pbd-8 sem warm", [](ParticleSystem& s, Inputs& in) {
+                in.solverIterations = 2 * SOLVER_ITERATIONS;
+                s.setWarmStarting(false);
+            }},
+            {"euler", [](ParticleSystem&, Inputs& in) { in.integrator = StepKernels::IntegratorType::SymplecticEuler; }},
+            {"vel-verlet", [](ParticleSystem&, Inputs& in) { in.integrator = StepKernels::IntegratorType::VelocityVerlet; }},
+            {"adaptativo", [](ParticleSystem&, Inputs& in) { in.adaptiveSubsteps = true; }, ADAPTIVE_STEP_SCALE},
+        };
+    }
+
+    void spawn(ParticleSystem& system, Layout layout, int count) {
+        if (layout == Layout::Uniform) {
+            system.generateRandomParticles(count, 1.0f, 5.0f);
+            return;
+        }
+
+        std::mt19937 rng(SEED);
+        std::uniform_real_distribution<float> mass(1.0f, 2.0f), velocity(-20.0f, 20.0f);
+        std::uniform_real_distribution<float> x(0.0f, WORLD_WIDTH), unit(0.0f, 1.0f);
+        constexpr int CLUSTERS = 6;
+        sf::Vector2f centers[CLUSTERS];
+        for (sf::Vector2f& center : centers) {
+            center = {WORLD_WIDTH * (0.1f + 0.8f * unit(rng)), WORLD_HEIGHT * (0.1f + 0.8f * unit(rng))};
+        }
+        std::normal_distribution<float> spread(0.0f, 30.0f);
+
+        for (int i = 0; i < count; ++i) {
+            sf::Vector2f position;
+            if (layout == Layout::Piled) {
+                position = {x(rng), WORLD_HEIGHT - PILE_HEIGHT * unit(rng)};
+            } else {
+                const sf::Vector2f& center = centers[i % CLUSTERS];
+                position = {center.x + spread(rng), center.y + spread(rng)};
+            }
+            system.addParticle(mass(rng), position, {velocity(rng), velocity(rng)}, sf::Color::White);
+        }
+    }
+
+    Result runScenario(const Scenario& scenario, const Variant& variant) {
+        ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+        system.setRandomSeed(SEED);
+        ParticleSystem::PhysicsInputState inputs = defaultInputs();
+        variant.apply(system, inputs);
+        spawn(system, scenario.layout, scenario.particles);
+        scenario.configure(system, inputs);
+
+        // os tempos são sempre por STEP_DT simulado, para comparar com stepScale > 1
+        const float dt = STEP_DT * static_cast<float>(variant.stepScale);
+        const int updates = scenario.steps / variant.stepScale;
+        for (int i = 0; i < WARMUP_STEPS / variant.stepScale; ++i) {
+            system.update(dt, inputs);
+        }
+        system.resetStepTimings();
+
+        double penetration = 0.0;
+        double visits = 0.0;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < updates; ++i) {
+            system.update(dt, inputs);
+            const ContactSolver::Stats& c = system.getContactStats();
+            penetration += c.meanPenetration;
+            visits += static_cast<double>(c.pairVisits) * system.getLastSubsteps();
+        }
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        const ParticleSystem::StepTimings& t = system.getStepTimings();
+        Result result;
+        result.kernelPerStep = (t.forces + t.integrate) * 1e6 / scenario.steps;
+        result.pairsPerStep = (t.neighbors + t.collisions) * 1e6 / scenario.steps;
+        result.totalPerStep = wall * 1e6 / scenario.steps;
+        result.stepsPerSecond = scenario.steps / wall;
+        const NeighborList::Stats& n = system.getNeighborStats();
+        result.rebuildShare = n.updates > 0 ? n.rebuilds * 100.0 / n.updates : 0.0;
+        result.listBytes = n.memoryBytes;
+        const Broadphase::Stats& b = system.getBroadphase().getStats();
+        result.candidatesPerPair = b.pairs > 0 ? static_cast<double>(b.candidates) / b.pairs : 0.0;
+        result.penetration = penetration / updates;
+        result.visitsPerStep = visits / scenario.steps;
+        return result;
+    }
+
+    struct FluidResult {
+        double stepsPerSecond;
+        double forcesPerStep;  // densidade + pressão/viscosidade, us
+        float maxDensityRatio;
+        size_t threads;
+    };
+
+    // Coluna de líquido no terço esquerdo de um mundo de proporção 4:3
+    FluidResult runFluid(int particles, bool parallel) {
+        const int columns = static_cast<int>(std::sqrt(static_cast<float>(particles) / 2.0f));
+        const int rows = (particles + columns - 1) / columns;
+        const float width = 3.0f * FLUID_SPACING * static_cast<float>(columns);
+        const float height = std::max(0.75f * width, FLUID_SPACING * static_cast<float>(rows + 2));
+
+        ParticleSystem system(width, height);
+        system.setRandomSeed(SEED);
+        system.reserveParticles(static_cast<size_t>(particles));
+        FluidSolver::Params params = system.getFluidParams();
+        params.parallel = parallel;
+        system.setFluidParams(params);
+        for (int i = 0; i < particles; ++i) {
+            const float x = FLUID_SPACING * (0.5f + static_cast<float>(i % columns));
+            const float y = height - FLUID_SPACING * (0.5f + static_cast<float>(i / columns));
+            system.addParticle(FLUID_MASS, {x, y}, {0.0f, 0.0f}, sf::Color::White);
+        }
+
+        ParticleSystem::PhysicsInputState inputs = defaultInputs();
+        inputs.fluidEnabled = true;
+        for (int i = 0; i < FLUID_WARMUP_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+        system.resetStepTimings();
+
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < FLUID_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        FluidResult result;
+        result.stepsPerSecond = FLUID_STEPS / wall;
+        result.forcesPerStep = system.getStepTimings().forces * 1e6 / FLUID_STEPS;
+        result.maxDensityRatio = system.getFluidStats().maxDensityRatio;
+        result.threads = system.getFluidStats().threads;
+        return result;
+    }
+
+    struct ClothResult {
+        size_t constraints;
+        double constraintsPerStep;  // us
+        double millionsPerSecond;   // restrições x iterações por segundo
+        float maxStretch;
+        size_t colors;
+        size_t threads;
+    };
+
+    ClothResult runCloth(int side, bool parallel) {
+        const float extent = CLOTH_SPACING * static_cast<float>(side);
+        ParticleSystem system(extent * 2.0f, extent * 2.0f);
+        system.setRandomSeed(SEED);
+        system.reserveParticles(static_cast<size_t>(side) * side);
+        ConstraintSolver::Params params;
+        params.parallel = parallel;
+        system.setConstraintParams(params);
+        for (int row = 0; row < side; ++row) {
+            for (int column = 0; column < side; ++column) {
+                system.addParticle(1.0f, {0.5f * extent + CLOTH_SPACING * column, 0.5f * extent + CLOTH_SPACING * row},
+                                   {0.0f, 0.0f}, sf::Color::White);
+            }
+        }
+        ConstraintStore& store = system.getConstraints();
+        const float diagonal = CLOTH_SPACING * std::sqrt(2.0f);
+        for (int row = 0; row < side; ++row) {
+            for (int column = 0; column < side; ++column) {
+                const std::uint32_t i = static_cast<std::uint32_t>(row * side + column);
+                const std::uint32_t s = static_cast<std::uint32_t>(side);
+                const float compliance = ConstraintStore::DEFAULT_SPRING_COMPLIANCE;
+                if (column + 1 < side) store.add(i, i + 1, CLOTH_SPACING, ConstraintType::Spring, compliance);
+                if (row + 1 < side) store.add(i, i + s, CLOTH_SPACING, ConstraintType::Spring, compliance);
+                if (column + 1 < side && row + 1 < side) {
+                    store.add(i, i + s + 1, diagonal, ConstraintType::Spring, compliance);
+                    store.add(i + 1, i + s, diagonal, ConstraintType::Spring, compliance);
+                }
+            }
+        }
+
+        ParticleSystem::PhysicsInputState inputs = defaultInputs();
+        inputs.collisionsEnabled = false;
+        for (int i = 0; i < CLOTH_WARMUP_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+        system.resetStepTimings();
+        for (int i = 0; i < CLOTH_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+
+        const ConstraintSolver::Stats& stats = system.getConstraintStats();
+        const double seconds = system.getStepTimings().constraints;
+        ClothResult result;
+        result.constraints = stats.constraints;
+        result.constraintsPerStep = seconds * 1e6 / CLOTH_STEPS;
+        result.millionsPerSecond = seconds > 0.0 ? static_cast<double>(stats.constraints) * params.iterations *
+                                                       CLOTH_STEPS / seconds / 1e6 : 0.0;
+        result.maxStretch = stats.maxStretch;
+        result.colors = stats.colors;
+        result.threads = stats.threads;
+        return result;
+    }
+
+    void runClothSweep() {
+        std::printf("\n%-18s %8s %13s %9s %13s %9s %8s %6s %9s\n", "cenário", "restr.", "restr. us/p", "M/s",
+                    "restr. us/p", "M/s", "threads", "cores", "estic.");
+        std::printf("%-18s %8s %23s %32s\n", "", "", "(1 thread)", "(pool)");
+        for (const int side : CLOTH_SIDES) {
+            const ClothResult serial = runCloth(side, false);
+            const ClothResult parallel = runCloth(side, true);
+            std::printf("%-18s %8zu %13.0f %9.1f %13.0f %9.1f %8zu %6zu %8.1f%%   (restrições x%.2f)\n",
+                        CLOTH_SWEEP_NAME, parallel.constraints, serial.constraintsPerStep, serial.millionsPerSecond,
+                        parallel.constraintsPerStep, parallel.millionsPerSecond, parallel.threads, parallel.colors,
+                        parallel.maxStretch * 100.0f,
+                        parallel.constraintsPerStep > 0.0 ? serial.constraintsPerStep / parallel.constraintsPerStep
+                                                          : 0.0);
+        }
+    }
+
+    // us por passo da montagem da imagem no modo pedido, ou -1 se não foi medido
+    double runRender(int particles, RenderMode mode) {
+        if (mode == RenderMode::Particles && particles > RENDER_PARTICLES_LIMIT) return -1.0;
+        ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+        system.setRandomSeed(SEED);
+        system.reserveParticles(static_cast<size_t>(particles));
+        system.setRenderMode(mode);
+        system.generateRandomParticles(particles, 1.0f, 5.0f);
+
+        ParticleSystem::PhysicsInputState inputs = defaultInputs();
+        inputs.collisionsEnabled = false;
+        system.update(STEP_DT, inputs);
+        system.resetStepTimings();
+        for (int i = 0; i < RENDER_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+        const ParticleSystem::StepTimings& t = system.getStepTimings();
+        return (t.trails + t.heads + t.splat) * 1e6 / RENDER_STEPS;
+    }
+
+    void runRenderSweep() {
+        std::printf("\n%-18s %8s %16s %16s\n", "cenário", "N", "partículas us/p", "densidade us/p");
+        for (const int particles : RENDER_COUNTS) {
+            const double heads = runRender(particles, RenderMode::Particles);
+            const double splat = runRender(particles, RenderMode::Density);
+            if (heads < 0.0) {
+                std::printf("%-18s %8d %16s %16.0f\n", RENDER_SWEEP_NAME, particles, "-", splat);
+            } else {
+                std::printf("%-18s %8d %16.0f %16.0f   (imagem x%.2f)\n", RENDER_SWEEP_NAME, particles, heads, splat,
+                            splat > 0.0 ? heads / splat : 0.0);
+            }
+        }
+    }
+
+    struct SoftwareResult {
+        double msPerFrame;
+        SoftwareRenderer::Stats stats;
+    };
+
+    SoftwareResult runSoftware(ParticleSystem& system, bool parallel) {
+        SoftwareRenderer renderer;
+        SoftwareRenderer::Params params;
+        params.parallel = parallel;
+        renderer.setParams(params);
+        renderer.resize(SOFTWARE_WIDTH, SOFTWARE_HEIGHT, WORLD_WIDTH, WORLD_HEIGHT);
+        renderer.render(system, ThreadPool::shared());
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SOFTWARE_FRAMES; ++i) {
+            renderer.render(system, ThreadPool::shared());
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {seconds * 1e3 / SOFTWARE_FRAMES, renderer.getStats()};
+    }
+
+    void runSoftwareSweep() {
+        std::printf("\n%-18s %8s %11s %11s %8s %11s %11s\n", "cenário", "N", "ms/quadro", "ms/quadro", "threads",
+                    "triângulos", "entradas");
+        std::printf("%-18s %8s %11s %11s\n", "", "", "(1 thread)", "(pool)");
+        for (const int particles : SOFTWARE_COUNTS) {
+            // o mesmo quadro para as duas medições: trilhas já cheias, só gravidade
+            ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+            system.setRandomSeed(SEED);
+            system.reserveParticles(static_cast<size_t>(particles));
+            system.setRenderMode(RenderMode::Particles);
+            system.generateRandomParticles(particles, 1.0f, 5.0f);
+            ParticleSystem::PhysicsInputState inputs = defaultInputs();
+            inputs.collisionsEnabled = false;
+            for (int i = 0; i < WARMUP_STEPS; ++i) {
+                system.update(STEP_DT, inputs);
+            }
+
+            const SoftwareResult serial = runSoftware(system, false);
+            const SoftwareResult parallel = runSoftware(system, true);
+            std::printf("%-18s %8d %11.1f %11.1f %8zu %11zu %11zu   (quadro x%.2f)\n", SOFTWARE_SWEEP_NAME, particles,
+                        serial.msPerFrame, parallel.msPerFrame, parallel.stats.threads, parallel.stats.triangles,
+                        parallel.stats.tileEntries,
+                        parallel.msPerFrame > 0.0 ? serial.msPerFrame / parallel.msPerFrame : 0.0);
+        }
+    }
+
+    struct OpenResult {
+        double usPerBuild;
+        double candidatesPerPair;
+        size_t pairs;
+    };
+
+    OpenResult runOpen(Broadphase& broadphase, const std::vector<float>& positions, const std::vector<float>& radii) {
+        std::vector<ParticlePair> pairs;
+        const size_t count = radii.size();
+        broadphase.findPairs(positions.data(), radii.data(), count, 0.0f, pairs);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < OPEN_BUILDS; ++i) {
+            broadphase.findPairs(positions.data(), radii.data(), count, 0.0f, pairs);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const Broadphase::Stats& stats = broadphase.getStats();
+        return {seconds * 1e6 / OPEN_BUILDS,
+                stats.pairs > 0 ? static_cast<double>(stats.candidates) / stats.pairs : 0.0, stats.pairs};
+    }
+
+    void runOpenSweep() {
+        std::printf("\n%-18s %9s %8s %11s %9s %11s %11s %9s %8s %10s\n", "cenário", "espalhado", "pares",
+                    "grade us", "cand/par", "célula px", "tiles us", "cand/par", "tiles", "tiles KB");
+        for (const float spread : OPEN_SPREADS) {
+            // nuvens gaussianas com centros espalhados por um quadrado de lado spread
+            std::mt19937 rng(SEED);
+            std::uniform_real_distribution<float> center(0.0f, spread);
+            std::normal_distribution<float> offset(0.0f, OPEN_CLUSTER_SIGMA);
+            std::uniform_real_distribution<float> mass(1.0f, 5.0f);
+            std::vector<float> centers;
+            for (int c = 0; c < OPEN_CLUSTERS; ++c) {
+                centers.push_back(center(rng));
+                centers.push_back(center(rng));
+            }
+            std::vector<float> positions;
+            std::vector<float> radii;
+            for (int i = 0; i < OPEN_PARTICLES; ++i) {
+                const int c = i % OPEN_CLUSTERS;
+                positions.push_back(centers[c * 2] + offset(rng));
+                positions.push_back(centers[c * 2 + 1] + offset(rng));
+                radii.push_back(5.0f + mass(rng));
+            }
+
+            SpatialGrid grid;
+            TileGrid tiles;
+            const OpenResult g = runOpen(grid, positions, radii);
+            const OpenResult t = runOpen(tiles, positions, radii);
+            const TileGrid::TileStats& ts = tiles.getTileStats();
+            std::printf("%-18s %9.0f %8zu %11.0f %9.2f %11.1f %11.0f %9.2f %8zu %10.1f   (pares x%.2f)\n",
+                        OPEN_SWEEP_NAME, spread, t.pairs, g.usPerBuild, g.candidatesPerPair,
+                        grid.getGridStats().cellSize, t.usPerBuild, t.candidatesPerPair, ts.activeTiles,
+                        ts.memoryBytes / 1024.0, t.usPerBuild > 0.0 ? g.usPerBuild / t.usPerBuild : 0.0);
+        }
+    }
+
+    struct FrameResult {
+        double wallPerStep;     // update inteiro, relógio
+        double framePerStep;    // volta ao AoS + trilhas + cabeças, somado entre as threads
+        TaskGraph::Stats graph;
+    };
+
+    FrameResult runFrame(int particles, bool parallel) {
+        ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+        system.setRandomSeed(SEED);
+        system.reserveParticles(static_cast<size_t>(particles));
+        system.setRenderMode(RenderMode::Particles);
+        TaskGraph::Params params;
+        params.parallel = parallel;
+        system.setFrameGraphParams(params);
+        system.generateRandomParticles(particles, 1.0f, 5.0f);
+        ParticleSystem::PhysicsInputState inputs = defaultInputs();
+        inputs.collisionsEnabled = false;
+        for (int i = 0; i < WARMUP_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+
+        system.resetStepTimings();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAME_STEPS; ++i) {
+            system.update(STEP_DT, inputs);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const ParticleSystem::StepTimings& t = system.getStepTimings();
+        return {seconds * 1e6 / FRAME_STEPS, (t.syncFromSoA + t.trails + t.heads) * 1e6 / FRAME_STEPS,
+                system.getFrameGraphStats()};
+    }
+
+    void runFrameSweep() {
+        std::printf("\n%-18s %8s %12s %12s %12s %12s %8s %8s %8s\n", "cenário", "N", "passo us", "quadro us",
+                    "passo us", "quadro us", "threads", "nós", "roubos");
+        std::printf("%-18s %8s %25s %25s\n", "", "", "(1 thread)", "(pool)");
+        for (const int particles : FRAME_COUNTS) {
+            const FrameResult serial = runFrame(particles, false);
+            const FrameResult parallel = runFrame(particles, true);
+            std::printf("%-18s %8d %12.0f %12.0f %12.0f %12.0f %8zu %8zu %8zu   (passo x%.2f)\n", FRAME_SWEEP_NAME,
+                        particles, serial.wallPerStep, serial.framePerStep, parallel.wallPerStep,
+                        parallel.framePerStep, parallel.graph.threads, parallel.graph.nodes, parallel.graph.steals,
+                        parallel.wallPerStep > 0.0 ? serial.wallPerStep / parallel.wallPerStep : 0.0);
+        }
+    }
+
+    struct QueueResult {
+        double millionsPerSecond;
+        std::uint64_t dropped;  // pushes que acharam o anel cheio (e tentaram de novo)
+        size_t largestDrain;
+    };
+
+    QueueResult runQueue(int producers) {
+        CommandQueue queue;
+        std::atomic<int> finished{0};
+        const int perProducer = QUEUE_COMMANDS / producers;
+        const SimCommand command = SimCommand::spawn(2.0f, {1.0f, 1.0f}, {0.0f, 0.0f}, sf::Color::White,
+                                                     ParticleType::Original);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < perProducer; ++i) {
+                    while (!queue.push(command)) std::this_thread::yield();
+                }
+                finished.fetch_add(1);
+            });
+        }
+        std::vector<SimCommand> drained;
+        size_t total = 0;
+        const size_t expected = static_cast<size_t>(perProducer) * producers;
+        while (total < expected) {
+            drained.clear();
+            const size_t count = queue.drain(drained);
+            total += count;
+            if (count == 0) std::this_thread::yield();
+        }
+        for (std::thread& thread : threads) thread.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const CommandQueue::Stats stats = queue.getStats();
+        return {expected / seconds / 1e6, stats.dropped, stats.largestDrain};
+    }
+
+    double runSpawns(bool batched) {
+        ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+        std::vector<ParticleSystem::ParticleSpawn> spawns;
+        std::mt19937 rng(SEED);
+        std::uniform_real_distribution<float> x(0.0f, WORLD_WIDTH), y(0.0f, WORLD_HEIGHT);
+        for (int i = 0; i < QUEUE_SPAWNS; ++i) {
+            spawns.push_back({2.0f, {x(rng), y(rng)}, {0.0f, 0.0f}, sf::Color::White, ParticleType::Original});
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (batched) {
+            system.addParticles(spawns.data(), spawns.size());
+        } else {
+            for (const ParticleSystem::ParticleSpawn& spawn : spawns) {
+                if (Particle* p = system.addParticle(spawn.mass, spawn.position, spawn.velocity, spawn.color)) {
+                    p->setParticleType(spawn.type);
+                }
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+    }
+
+    void runQueueSweep() {
+        std::printf("\n%-18s %10s %12s %12s %12s\n", "cenário", "produtores", "Mcmd/s", "fila cheia", "maior lote");
+        for (const int producers : QUEUE_PRODUCERS) {
+            const QueueResult r = runQueue(producers);
+            std::printf("%-18s %10d %12.2f %12llu %12zu\n", QUEUE_SWEEP_NAME, producers, r.millionsPerSecond,
+                        static_cast<unsigned long long>(r.dropped), r.largestDrain);
+        }
+        const double single = runSpawns(false);
+        const double batch = runSpawns(true);
+        std::printf("%-18s %d spawns: %.2f ms um a um, %.2f ms em lote   (spawn x%.2f)\n", QUEUE_SWEEP_NAME,
+                    QUEUE_SPAWNS, single, batch, batch > 0.0 ? single / batch : 0.0);
+    }
+
+    void fillBatch(WorldBatch& batch, int particles, bool parallel) {
+        WorldBatch::Params params;
+        params.particles = particles;
+        params.steps = BATCH_STEPS;
+        params.dt = STEP_DT;
+        params.worldWidth = WORLD_WIDTH;
+        params.worldHeight = WORLD_HEIGHT;
+        params.parallel = parallel;
+        batch.setParams(params);
+        const Inputs inputs = defaultInputs();
+        batch.addGrid({0.1f, 0.9f, BATCH_RESTITUTIONS}, {inputs.gravitationalAcceleration,
+                      inputs.gravitationalAcceleration, 1}, {0.0f, 0.0f, 1}, BATCH_SEEDS, SEED);
+    }
+
+    // Os mesmos mundos do lote, um atrás do outro, cada um como o da janela
+    double runWorldsOneByOne(int particles) {
+        const WorldBatch::Range restitutions{0.1f, 0.9f, BATCH_RESTITUTIONS};
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < BATCH_RESTITUTIONS; ++r) {
+            for (int s = 0; s < BATCH_SEEDS; ++s) {
+                ParticleSystem system(WORLD_WIDTH, WORLD_HEIGHT);
+                system.setRandomSeed(SEED + static_cast<std::uint32_t>(s));
+                system.generateRandomParticles(particles);
+                Inputs inputs = defaultInputs();
+                inputs.collisionRestitution = restitutions.at(r);
+                for (int step = 0; step < BATCH_STEPS; ++step) {
+                    system.update(STEP_DT, inputs);
+                }
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(BATCH_RESTITUTIONS) * BATCH_SEEDS * BATCH_STEPS / seconds;
+    }
+
+    void runBatchSweep() {
+        std::printf("\n%-18s %8s %8s %14s %14s %14s %8s\n", "cenário", "N", "mundos", "um a um",
+                    "lote 1 thread", "lote pool", "threads");
+        std::printf("%-18s %8s %8s %44s\n", "", "", "", "(passos de mundo/s)");
+        for (const int particles : BATCH_COUNTS) {
+            WorldBatch serial, parallel;
+            fillBatch(serial, particles, false);
+            fillBatch(parallel, particles, true);
+            const double oneByOne = runWorldsOneByOne(particles);
+            serial.run(ThreadPool::shared());
+            parallel.run(ThreadPool::shared());
+            const WorldBatch::Stats& s = serial.getStats();
+            const WorldBatch::Stats& p = parallel.getStats();
+            std::printf("%-18s %8d %8zu %14.0f %14.0f %14.0f %8zu   (x%.2f)\n", BATCH_SWEEP_NAME, particles,
+                        p.worlds, oneByOne, s.worldStepsPerSecond, p.worldStepsPerSecond, p.threads,
+                        oneByOne > 0.0 ? p.worldStepsPerSecond / oneByOne : 0.0);
+        }
+    }
+
+    void runFluidSweep() {
+        std::printf("\n%-18s %7s %9s %12s %9s %12s %8s %9s\n", "cenário", "N", "passos/s", "fluido us/p",
+                    "passos/s", "fluido us/p", "threads", "rho máx");
+        std::printf("%-18s %7s %22s %31s\n", "", "", "(1 thread)", "(pool)");
+        for (const int particles : FLUID_COUNTS) {
+            const FluidResult serial = runFluid(particles, false);
+            const FluidResult parallel = runFluid(particles, true);
+            std::printf("%-18s %7d %9.1f %12.0f %9.1f %12.0f %8zu %9.2f   (fluido x%.2f)\n", FLUID_SWEEP_NAME,
+                        particles, serial.stepsPerSecond, serial.forcesPerStep, parallel.stepsPerSecond,
+                        parallel.forcesPerStep, parallel.threads, parallel.maxDensityRatio,
+                        parallel.forcesPerStep > 0.0 ? serial.forcesPerStep / parallel.forcesPerStep : 0.0);
+        }
+    }
+}
+
+int Benchmark::run(const std::string& filter) {
+    const std::vector<Variant> allVariants = variants();
+    int executed = 0;
+
+    std::printf("%-18s %-14s %6s %11s %11s %11s %9s %9s %9s %9s %9s %9s\n", "cenário", "variante", "N",
+                "física us/p", "pares us/p", "total us/p", "passos/s", "reconstr.", "pares KB", "cand/par",
+                "sobrep px", "visitas/p");
+    for (const Scenario& scenario : scenarios()) {
+        if (!filter.empty() && std::string(scenario.name).find(filter) == std::string::npos) {
+            continue;
+        }
+        ++executed;
+
+        Result baseline{};
+        for (size_t v = 0; v < allVariants.size(); ++v) {
+            const Result r = runScenario(scenario, allVariants[v]);
+            std::printf("%-18s %-14s %6d %11.2f %11.2f %11.2f %9.1f %8.1f%% %9.1f %9.2f %9.3f %9.0f", scenario.name,
+                        allVariants[v].name, scenario.particles, r.kernelPerStep, r.pairsPerStep, r.totalPerStep,
+                        r.stepsPerSecond, r.rebuildShare, r.listBytes / 1024.0, r.candidatesPerPair,
+                        r.penetration, r.visitsPerStep);
+            if (v == 0) {
+                baseline = r;
+                std::printf("\n");
+            } else {
+                // quanto a primeira variante (a padrão) ganha sobre esta
+                std::printf("   (física x%.2f, pares x%.2f)\n",
+                            baseline.kernelPerStep > 0.0 ? r.kernelPerStep / baseline.kernelPerStep : 0.0,
+                            baseline.pairsPerStep > 0.0 ? r.pairsPerStep / baseline.pairsPerStep : 0.0);
+            }
+        }
+    }
+
+    if (filter.empty() || std::string(FLUID_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runFluidSweep();
+    }
+    if (filter.empty() || std::string(CLOTH_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runClothSweep();
+    }
+    if (filter.empty() || std::string(RENDER_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runRenderSweep();
+    }
+    if (filter.empty() || std::string(SOFTWARE_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runSoftwareSweep();
+    }
+    if (filter.empty() || std::string(OPEN_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runOpenSweep();
+    }
+    if (filter.empty() || std::string(FRAME_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runFrameSweep();
+    }
+    if (filter.empty() || std::string(QUEUE_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runQueueSweep();
+    }
+    if (filter.empty() || std::string(BATCH_SWEEP_NAME).find(filter) != std::string::npos) {
+        ++executed;
+        runBatchSweep();
+    }
+
+    if (executed == 0) {
+        std::fprintf(stderr, "Nenhum cenário corresponde a '%s'\n", filter.c_str());
+        return 1;
+    }
+    return 0;
+}
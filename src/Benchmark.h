@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+// Cenários fixos de carga (semente, número de partículas e entradas constantes),
+// rodados headless em cada variante do passo de física para comparar builds e
+// caminhos de código. Uso: Chaos --bench [filtro]
+namespace Benchmark {
+    // Roda os cenários cujo nome contém o filtro (vazio = todos). Devolve o código de saída.
+    int run(const std::string& filter);
+}
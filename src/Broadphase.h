@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Par de índices do SoA, sempre com a < b
+struct ParticlePair {
+    std::uint32_t a;
+    std::uint32_t b;
+};
+
+enum class BroadphaseType : std::uint8_t {
+    Grid,           // grade uniforme em dois níveis (SpatialGrid)
+    SweepAndPrune,  // ordenação incremental no eixo x (SweepAndPrune)
+    Tiles,          // tiles esparsos alocados sob demanda, para o mundo aberto (TileGrid)
+};
+
+// Fase ampla da busca de pares. Uma chamada por construção da lista, então a
+// chamada virtual não pesa; o laço interno fica todo dentro de cada implementação.
+class Broadphase {
+public:
+    struct Stats {
+        size_t candidates = 0;  // testes de distância na última construção
+        size_t pairs = 0;
+    };
+
+    virtual ~Broadphase() = default;
+
+    // Todos os pares com distância < ra + rb + margin, cada um uma única vez
+    virtual void findPairs(const float* positions, const float* radii, size_t count, float margin,
+                           std::vector<ParticlePair>& pairs) = 0;
+    virtual const char* getName() const = 0;
+
+    const Stats& getStats() const { return m_stats; }
+
+protected:
+    Stats m_stats;
+};
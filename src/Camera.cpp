@@ -0,0 +1,69 @@
+#include "Camera.h"
+#include <algorithm>
+
+Camera::Camera(float worldWidth, float worldHeight, float viewportWidth, float viewportHeight)
+    : m_world(worldWidth, worldHeight), m_viewport(viewportWidth, viewportHeight) {
+    fitWorld();
+}
+
+void Camera::setWorldSize(float width, float height) {
+    m_world = sf::Vector2f(width, height);
+    clamp();
+}
+
+void Camera::setUnbounded(bool unbounded) {
+    m_unbounded = unbounded;
+    clamp();
+}
+
+void Camera::setViewport(float width, float height) {
+    m_viewport = sf::Vector2f(std::max(width, 1.0f), std::max(height, 1.0f));
+    clamp();
+}
+
+float Camera::fitZoom() const {
+    const float zoomX = m_world.x > 0.0f ? m_viewport.x / m_world.x : 1.0f;
+    const float zoomY = m_world.y > 0.0f ? m_viewport.y / m_world.y : 1.0f;
+    return std::min(zoomX, zoomY);
+}
+
+void Camera::fitWorld() {
+    m_zoom = fitZoom();
+    m_center = m_world * 0.5f;
+    clamp();
+}
+
+void Camera::pan(const sf::Vector2f& pixels) {
+    m_center -= pixels / m_zoom;
+    clamp();
+}
+
+void Camera::zoomAt(const sf::Vector2f& pixel, float factor) {
+    const sf::Vector2f anchor = pixelToWorld(pixel);
+    m_zoom *= factor;
+    clamp();
+    // o ponto do mundo que estava embaixo do cursor continua embaixo dele
+    m_center += anchor - pixelToWorld(pixel);
+    clamp();
+}
+
+void Camera::clamp() {
+    const float minZoom = fitZoom() * (m_unbounded ? MIN_ZOOM_OPEN : MIN_ZOOM_FIT);
+    m_zoom = std::min(std::max(m_zoom, minZoom), std::max(MAX_ZOOM, fitZoom()));
+    if (m_unbounded) return;
+    m_center.x = std::min(std::max(m_center.x, 0.0f), m_world.x);
+    m_center.y = std::min(std::max(m_center.y, 0.0f), m_world.y);
+}
+
+sf::View Camera::getView() const {
+    return sf::View(m_center, m_viewport / m_zoom);
+}
+
+sf::FloatRect Camera::getVisibleArea() const {
+    const sf::Vector2f size = m_viewport / m_zoom;
+    return sf::FloatRect(m_center - size * 0.5f, size);
+}
+
+sf::Vector2f Camera::pixelToWorld(const sf::Vector2f& pixel) const {
+    return m_center + (pixel - m_viewport * 0.5f) / m_zoom;
+}
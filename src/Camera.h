@@ -0,0 +1,49 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Câmera 2D sobre o mundo: um centro e um zoom (pixels da janela por unidade do
+// mundo). O mundo tem tamanho próprio e não sabe da janela; redimensionar só
+// muda quanto do mundo cabe na tela, sem tocar na simulação.
+class Camera {
+public:
+    // o zoom mínimo é relativo ao que enquadra o mundo inteiro
+    static constexpr float MIN_ZOOM_FIT = 0.5f;
+    // no mundo aberto dá para afastar bem mais, para seguir quem se espalhou
+    static constexpr float MIN_ZOOM_OPEN = 1.0f / 64.0f;
+    static constexpr float MAX_ZOOM = 16.0f;
+
+    Camera(float worldWidth, float worldHeight, float viewportWidth, float viewportHeight);
+
+    void setWorldSize(float width, float height);
+    // No mundo aberto o centro pode ir para fora do retângulo do mundo
+    void setUnbounded(bool unbounded);
+    // Tamanho da janela em pixels; centro e zoom ficam onde estavam
+    void setViewport(float width, float height);
+
+    // Enquadra o mundo inteiro no centro da tela
+    void fitWorld();
+    // Desloca a câmera em pixels da tela (arrastar o mundo junto com o mouse)
+    void pan(const sf::Vector2f& pixels);
+    // Multiplica o zoom mantendo parado o ponto do mundo embaixo de pixel
+    void zoomAt(const sf::Vector2f& pixel, float factor);
+
+    sf::View getView() const;
+    // Região do mundo que aparece na tela
+    sf::FloatRect getVisibleArea() const;
+    sf::Vector2f pixelToWorld(const sf::Vector2f& pixel) const;
+
+    float getZoom() const { return m_zoom; }
+    const sf::Vector2f& getCenter() const { return m_center; }
+    const sf::Vector2f& getViewport() const { return m_viewport; }
+
+private:
+    float fitZoom() const;
+    // Mantém o zoom no intervalo e o centro dentro do mundo (se ele tiver bordas)
+    void clamp();
+
+    sf::Vector2f m_world;
+    sf::Vector2f m_viewport;
+    sf::Vector2f m_center;
+    float m_zoom = 1.0f;
+    bool m_unbounded = false;
+};
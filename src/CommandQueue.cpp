@@ -0,0 +1,106 @@
+#include "CommandQueue.h"
+#include <algorithm>
+
+SimCommand SimCommand::spawn(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity,
+                             const sf::Color& color, ParticleType particleType) {
+    SimCommand command;
+    command.type = Type::Spawn;
+    command.mass = mass;
+    command.position = position;
+    command.velocity = velocity;
+    command.color = color;
+    command.particleType = particleType;
+    return command;
+}
+
+SimCommand SimCommand::spawnRandom(std::uint32_t count, float minMass, float maxMass, ParticleType particleType) {
+    SimCommand command;
+    command.type = Type::SpawnRandom;
+    command.count = count;
+    command.mass = minMass;
+    command.maxMass = maxMass;
+    command.particleType = particleType;
+    return command;
+}
+
+SimCommand SimCommand::despawn(const sf::Vector2f& position, float radius) {
+    SimCommand command;
+    command.type = Type::Despawn;
+    command.position = position;
+    command.value = radius;
+    return command;
+}
+
+SimCommand SimCommand::withOption(Type type, std::uint8_t option) {
+    SimCommand command;
+    command.type = type;
+    command.option = option;
+    return command;
+}
+
+SimCommand SimCommand::simple(Type type) {
+    SimCommand command;
+    command.type = type;
+    return command;
+}
+
+CommandQueue::CommandQueue(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) rounded <<= 1;
+    m_mask = rounded - 1;
+    m_slots.reset(new Slot[rounded]);
+    // o slot i está livre para a posição i; publicado, passa a i + 1
+    for (size_t i = 0; i < rounded; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool CommandQueue::push(const SimCommand& command) {
+    size_t position = m_writePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &m_slots[position & m_mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (diff == 0) {
+            // slot livre para esta posição; quem ganhar a troca fica com ele
+            if (m_writePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // o consumidor ainda não liberou a volta anterior: cheio
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            // outro produtor levou esta posição
+            position = m_writePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->command = command;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+size_t CommandQueue::drain(std::vector<SimCommand>& out) {
+    size_t count = 0;
+    for (;;) {
+        Slot& slot = m_slots[m_readPos & m_mask];
+        // para no primeiro slot ainda não publicado, mesmo que outros adiante já
+        // estejam: a ordem de saída é a de reserva
+        if (slot.sequence.load(std::memory_order_acquire) != m_readPos + 1) break;
+        out.push_back(slot.command);
+        slot.sequence.store(m_readPos + m_mask + 1, std::memory_order_release);
+        ++m_readPos;
+        ++count;
+    }
+    m_drained += count;
+    m_largestDrain = std::max(m_largestDrain, count);
+    return count;
+}
+
+CommandQueue::Stats CommandQueue::getStats() const {
+    Stats stats;
+    stats.pushed = m_writePos.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.drained = m_drained;
+    stats.largestDrain = m_largestDrain;
+    return stats;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "Particle.h"
+#include "ForceField.h"
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Um pedido de mudança no mundo feito fora do passo (entrada do usuário, gerador
+// de carga). Tamanho fixo para caber direto no anel; o significado de cada campo
+// depende do tipo.
+struct SimCommand {
+    enum class Type : std::uint8_t {
+        Spawn,             // mass, position, velocity, color, particleType
+        SpawnRandom,       // count, mass (mín), maxMass, particleType
+        Despawn,           // quem estiver a menos de value de position
+        Clear,
+        SetNeighborSkin,   // value
+        SetBroadphase,     // option: BroadphaseType
+        SetRenderMode,     // option: RenderMode
+        SetSpeciesPreset,  // option: SpeciesPreset
+        LoadObstacleScene, // option: ObstacleScene
+        AddBody,           // option: BodyShape, position
+        AddForceField,     // field
+        ClearForceFields,
+        SaveSnapshot,
+        LoadSnapshot,
+    };
+
+    Type type = Type::Clear;
+    ParticleType particleType = ParticleType::Original;
+    std::uint8_t option = 0;
+    std::uint32_t count = 0;
+    float mass = 0.0f;
+    float maxMass = 0.0f;
+    float value = 0.0f;
+    sf::Vector2f position;
+    sf::Vector2f velocity;
+    sf::Color color;
+    ForceField field;
+
+    static SimCommand spawn(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity,
+                            const sf::Color& color, ParticleType particleType);
+    static SimCommand spawnRandom(std::uint32_t count, float minMass, float maxMass, ParticleType particleType);
+    static SimCommand despawn(const sf::Vector2f& position, float radius);
+    static SimCommand withOption(Type type, std::uint8_t option);
+    static SimCommand simple(Type type);
+};
+
+// Fila de comandos entre quem produz entrada e o passo de física: várias threads
+// empurram, uma só (a da simulação) drena, uma vez por passo. É um anel de
+// tamanho fixo sem trava: cada produtor reserva uma posição com um
+// compare-and-swap no contador de escrita e publica o comando pelo número de
+// sequência do slot, então produtores só disputam aquele contador e o consumidor
+// nunca toma trava nenhuma. Cheio, o push falha na hora em vez de bloquear: a
+// simulação pode estar na mesma thread e nunca drenaria.
+class CommandQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    struct Stats {
+        std::uint64_t pushed = 0;
+        std::uint64_t dropped = 0;   // push com o anel cheio
+        std::uint64_t drained = 0;
+        size_t largestDrain = 0;     // maior lote de um drain só
+    };
+
+    // capacity é arredondada para a próxima potência de dois
+    explicit CommandQueue(size_t capacity = DEFAULT_CAPACITY);
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    // Qualquer thread. false com a fila cheia (o comando é descartado e contado)
+    bool push(const SimCommand& command);
+    // Só o consumidor: copia para o fim de out tudo o que já foi publicado, em ordem
+    // de reserva, e devolve quantos vieram
+    size_t drain(std::vector<SimCommand>& out);
+
+    size_t getCapacity() const { return m_mask + 1; }
+    // Da thread consumidora
+    Stats getStats() const;
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        SimCommand command;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask = 0;
+
+    // cada contador na sua linha de cache: produtores batem num, o consumidor no outro
+    alignas(64) std::atomic<size_t> m_writePos{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    alignas(64) size_t m_readPos = 0;
+    std::uint64_t m_drained = 0;
+    size_t m_largestDrain = 0;
+};
@@ -0,0 +1,274 @@
+#include "Constraints.h"
+#include <algorithm>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    constexpr float MIN_VALID_MASS = 0.0001f;
+    constexpr float MIN_DISTANCE = 0.0001f;
+
+    unsigned lowestSetBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    struct Lanes {
+        alignas(64) float dx[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float dy[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float m1[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float m2[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float invM1[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float invM2[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float correctionX[ConstraintSolver::BATCH_SIZE];
+        alignas(64) float correctionY[ConstraintSolver::BATCH_SIZE];
+    };
+
+    // Um passo de XPBD por restrição: lambda acumula a força (vezes dt²) ao longo
+    // das iterações e a folga alpha = compliance / dt² amolece a mola. Corda
+    // frouxa vira máscara, como os contatos sem sobreposição.
+    void distanceCorrections(float invDtSq, const float* __restrict dx, const float* __restrict dy,
+                             const float* __restrict m1, const float* __restrict m2,
+                             const float* __restrict restLength, const float* __restrict compliance,
+                             const float* __restrict unilateral, float* __restrict lambda,
+                             float* __restrict correctionX, float* __restrict correctionY,
+                             float* __restrict invM1, float* __restrict invM2, size_t n) {
+        for (size_t l = 0; l < n; ++l) {
+            const float i1 = 1.0f / m1[l];
+            const float i2 = 1.0f / m2[l];
+            const float inv1 = (m1[l] > MIN_VALID_MASS) ? i1 : 0.0f;
+            const float inv2 = (m2[l] > MIN_VALID_MASS) ? i2 : 0.0f;
+            invM1[l] = inv1;
+            invM2[l] = inv2;
+
+            const float distance = std::sqrt(std::max(dx[l] * dx[l] + dy[l] * dy[l], MIN_DISTANCE * MIN_DISTANCE));
+            const float stretch = distance - restLength[l];
+            const float active = (unilateral[l] > 0.0f && stretch <= 0.0f) ? 0.0f : 1.0f;
+            const float alpha = compliance[l] * invDtSq;
+            const float denominator = std::max(inv1 + inv2 + alpha, 1e-12f);
+            const float delta = (-stretch - alpha * lambda[l]) / denominator * active;
+            lambda[l] += delta;
+            correctionX[l] = dx[l] / distance * delta;
+            correctionY[l] = dy[l] / distance * delta;
+        }
+    }
+}
+
+void ConstraintStore::add(std::uint32_t a, std::uint32_t b, float restLength, ConstraintType type,
+                          float compliance) {
+    flush();
+    m_a.push_back(a);
+    m_b.push_back(b);
+    m_restLength.push_back(restLength);
+    m_compliance.push_back(type == ConstraintType::Spring ? compliance : 0.0f);
+    m_type.push_back(type);
+    ++m_version;
+}
+
+void ConstraintStore::clear() {
+    m_a.clear();
+    m_b.clear();
+    m_restLength.clear();
+    m_compliance.clear();
+    m_type.clear();
+    m_pending = false;
+    ++m_version;
+}
+
+void ConstraintStore::onParticleReleased(size_t index, size_t last) {
+    if (m_a.empty()) return;
+    if (!m_pending) {
+        m_slotOf.clear();
+        m_originalAt.clear();
+        m_pending = true;
+    }
+    // antes desta saída havia last + 1 partículas; quem entrou depois da primeira
+    // saída pendente ganha um índice novo, que nenhuma restrição usa ainda
+    while (m_originalAt.size() <= last) {
+        const std::uint32_t slot = static_cast<std::uint32_t>(m_originalAt.size());
+        m_originalAt.push_back(static_cast<std::uint32_t>(m_slotOf.size()));
+        m_slotOf.push_back(slot);
+    }
+    const std::uint32_t released = m_originalAt[index];
+    const std::uint32_t moved = m_originalAt[last];
+    m_slotOf[released] = RELEASED;
+    if (index != last) {
+        m_slotOf[moved] = static_cast<std::uint32_t>(index);
+        m_originalAt[index] = moved;
+    }
+    m_originalAt.pop_back();
+}
+
+void ConstraintStore::onPoolCleared() {
+    clear();
+}
+
+void ConstraintStore::flush() const {
+    if (!m_pending) return;
+    m_pending = false;
+
+    // compactação estável: quem sobra mantém a ordem
+    size_t kept = 0;
+    for (size_t c = 0; c < m_a.size(); ++c) {
+        const std::uint32_t a = m_a[c] < m_slotOf.size() ? m_slotOf[m_a[c]] : m_a[c];
+        const std::uint32_t b = m_b[c] < m_slotOf.size() ? m_slotOf[m_b[c]] : m_b[c];
+        if (a == RELEASED || b == RELEASED) continue;
+        m_a[kept] = a;
+        m_b[kept] = b;
+        m_restLength[kept] = m_restLength[c];
+        m_compliance[kept] = m_compliance[c];
+        m_type[kept] = m_type[c];
+        ++kept;
+    }
+    m_a.resize(kept);
+    m_b.resize(kept);
+    m_restLength.resize(kept);
+    m_compliance.resize(kept);
+    m_type.resize(kept);
+    ++m_version;
+}
+
+void ConstraintSolver::color(const ConstraintStore& store, size_t particleCount) {
+    // a mesma coloração gulosa dos contatos
+    const size_t count = store.size();
+    const std::uint32_t* a = store.a();
+    const std::uint32_t* b = store.b();
+    m_colorMask.assign(particleCount, 0);
+    m_colorOf.resize(count);
+    size_t counts[COLOR_COUNT + 1] = {};
+    for (size_t c = 0; c < count; ++c) {
+        const std::uint64_t freeColors = ~(m_colorMask[a[c]] | m_colorMask[b[c]]);
+        std::uint8_t color = OVERFLOW_COLOR;
+        if (freeColors != 0) {
+            color = static_cast<std::uint8_t>(lowestSetBit(freeColors));
+            m_colorMask[a[c]] |= std::uint64_t(1) << color;
+            m_colorMask[b[c]] |= std::uint64_t(1) << color;
+        }
+        m_colorOf[c] = color;
+        ++counts[color];
+    }
+
+    m_colorStart[0] = 0;
+    size_t colors = 0;
+    for (size_t color = 0; color <= COLOR_COUNT; ++color) {
+        m_colorStart[color + 1] = m_colorStart[color] + counts[color];
+        colors += (counts[color] > 0 && color != OVERFLOW_COLOR) ? 1 : 0;
+    }
+    size_t cursor[COLOR_COUNT + 1];
+    std::copy(m_colorStart, m_colorStart + COLOR_COUNT + 1, cursor);
+    m_a.resize(count);
+    m_b.resize(count);
+    m_restLength.resize(count);
+    m_compliance.resize(count);
+    m_unilateral.resize(count);
+    m_lambda.resize(count);
+    const float* restLengths = store.restLengths();
+    const float* compliances = store.compliances();
+    const ConstraintType* types = store.types();
+    for (size_t c = 0; c < count; ++c) {
+        const size_t slot = cursor[m_colorOf[c]]++;
+        m_a[slot] = a[c];
+        m_b[slot] = b[c];
+        m_restLength[slot] = restLengths[c];
+        m_compliance[slot] = compliances[c];
+        m_unilateral[slot] = (types[c] == ConstraintType::Rope) ? 1.0f : 0.0f;
+    }
+
+    m_stats.colors = colors;
+    m_stats.overflow = counts[OVERFLOW_COLOR];
+    ++m_stats.recolors;
+}
+
+void ConstraintSolver::projectRange(size_t begin, size_t end, float invDtSq, const Arrays& arrays) {
+    float* positions = arrays.positions;
+    Lanes lanes;
+    for (size_t batch = begin; batch < end; batch += BATCH_SIZE) {
+        const size_t n = std::min(BATCH_SIZE, end - batch);
+        const std::uint32_t* a = &m_a[batch];
+        const std::uint32_t* b = &m_b[batch];
+        for (size_t l = 0; l < n; ++l) {
+            lanes.dx[l] = positions[a[l] * 2] - positions[b[l] * 2];
+            lanes.dy[l] = positions[a[l] * 2 + 1] - positions[b[l] * 2 + 1];
+            lanes.m1[l] = arrays.masses[a[l]];
+            lanes.m2[l] = arrays.masses[b[l]];
+        }
+
+        distanceCorrections(invDtSq, lanes.dx, lanes.dy, lanes.m1, lanes.m2, &m_restLength[batch],
+                            &m_compliance[batch], &m_unilateral[batch], &m_lambda[batch], lanes.correctionX,
+                            lanes.correctionY, lanes.invM1, lanes.invM2, n);
+
+        for (size_t l = 0; l < n; ++l) {
+            positions[a[l] * 2]     += lanes.correctionX[l] * lanes.invM1[l];
+            positions[a[l] * 2 + 1] += lanes.correctionY[l] * lanes.invM1[l];
+            positions[b[l] * 2]     -= lanes.correctionX[l] * lanes.invM2[l];
+            positions[b[l] * 2 + 1] -= lanes.correctionY[l] * lanes.invM2[l];
+        }
+    }
+}
+
+void ConstraintSolver::solve(const ConstraintStore& store, float deltaTime, const Arrays& arrays,
+                             ThreadPool& pool) {
+    m_stats.constraints = store.size();
+    m_stats.threads = m_params.parallel ? pool.getThreadCount() : 1;
+    m_stats.maxStretch = 0.0f;
+    if (m_stats.constraints == 0) return;
+
+    if (store.getVersion() != m_coloredVersion || arrays.count != m_coloredCount) {
+        color(store, arrays.count);
+        m_coloredVersion = store.getVersion();
+        m_coloredCount = arrays.count;
+    }
+
+    const float* positions = arrays.positions;
+    float maxStretch = 0.0f;
+    for (size_t c = 0; c < m_a.size(); ++c) {
+        const float dx = positions[m_a[c] * 2] - positions[m_b[c] * 2];
+        const float dy = positions[m_a[c] * 2 + 1] - positions[m_b[c] * 2 + 1];
+        const float ratio = std::sqrt(dx * dx + dy * dy) / std::max(m_restLength[c], MIN_DISTANCE);
+        maxStretch = std::max(maxStretch, std::abs(ratio - 1.0f));
+        m_lambda[c] = 0.0f;
+    }
+    m_stats.maxStretch = maxStretch;
+
+    m_startPositions.assign(arrays.positions, arrays.positions + arrays.count * 2);
+
+    const float invDtSq = 1.0f / (deltaTime * deltaTime);
+    const int iterations = std::max(m_params.iterations, 1);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (size_t color = 0; color < COLOR_COUNT; ++color) {
+            const size_t begin = m_colorStart[color];
+            const size_t count = m_colorStart[color + 1] - begin;
+            if (count == 0) continue;
+            if (m_params.parallel) {
+                pool.parallelFor(count, BATCH_SIZE, [&](size_t first, size_t last) {
+                    projectRange(begin + first, begin + last, invDtSq, arrays);
+                });
+            } else {
+                projectRange(begin, begin + count, invDtSq, arrays);
+            }
+        }
+        // o transbordo divide partículas entre si, então vai uma restrição por vez
+        for (size_t c = m_colorStart[OVERFLOW_COLOR]; c < m_colorStart[OVERFLOW_COLOR + 1]; ++c) {
+            projectRange(c, c + 1, invDtSq, arrays);
+        }
+    }
+
+    // PBD: o que as posições andaram vira velocidade, e a posição anterior acompanha;
+    // quem não está em nenhuma restrição fica como o integrador deixou
+    const float invDt = 1.0f / deltaTime;
+    float* __restrict velocities = arrays.velocities;
+    float* __restrict previous = arrays.previousPositions;
+    const float* __restrict start = m_startPositions.data();
+    const float* __restrict current = arrays.positions;
+    for (size_t i = 0; i < arrays.count * 2; ++i) {
+        const float moved = current[i] - start[i];
+        velocities[i] += moved * invDt;
+        previous[i] = (moved != 0.0f) ? current[i] - velocities[i] * deltaTime : previous[i];
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "ParticlePool.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class ConstraintType : std::uint8_t {
+    Spring = 0,  // puxa e empurra para o comprimento de repouso, com folga (compliance)
+    Rod,         // distância fixa
+    Rope,        // só puxa: encurtar é livre
+    Count
+};
+
+// Corpos prontos feitos de partículas e restrições
+enum class BodyShape : std::uint8_t {
+    SoftBox = 0,  // malha quadrada com molas nas arestas e nas diagonais
+    Chain,        // corrente de partículas ligadas por cordas
+    Count
+};
+
+// Restrições de distância entre pares de partículas, guardadas como SoA de
+// índices (os mesmos do SoA do passo) e comprimentos de repouso.
+//
+// O pool tira partículas trocando a que sai pela última, então os índices
+// mudam. A loja observa o pool: cada saída só anota o remapeamento (O(1)), e a
+// próxima leitura aplica tudo de uma vez numa passada pelas restrições, levando
+// as que apontam para a nova posição da partícula movida e descartando as que
+// tocavam a que saiu. Limpar o pool limpa as restrições.
+class ConstraintStore : public ParticlePool::Observer {
+public:
+    // Folga padrão das molas (px por unidade de força): um corpo mole que não desmonta
+    static constexpr float DEFAULT_SPRING_COMPLIANCE = 1e-5f;
+
+    void add(std::uint32_t a, std::uint32_t b, float restLength, ConstraintType type,
+             float compliance = 0.0f);
+    void clear();
+
+    size_t size() const { flush(); return m_a.size(); }
+    bool empty() const { return size() == 0; }
+    // Muda a cada alteração do conjunto (inclusive pelos remapeamentos)
+    std::uint64_t getVersion() const { flush(); return m_version; }
+
+    const std::uint32_t* a() const { flush(); return m_a.data(); }
+    const std::uint32_t* b() const { flush(); return m_b.data(); }
+    const float* restLengths() const { flush(); return m_restLength.data(); }
+    const float* compliances() const { flush(); return m_compliance.data(); }
+    const ConstraintType* types() const { flush(); return m_type.data(); }
+
+    void onParticleReleased(size_t index, size_t last) override;
+    void onPoolCleared() override;
+
+private:
+    static constexpr std::uint32_t RELEASED = ~std::uint32_t(0);
+
+    // Aplica os remapeamentos anotados desde a última leitura
+    void flush() const;
+
+    // mutable: quem lê aplica as saídas pendentes antes
+    mutable std::vector<std::uint32_t> m_a;
+    mutable std::vector<std::uint32_t> m_b;
+    mutable std::vector<float> m_restLength;
+    mutable std::vector<float> m_compliance;
+    mutable std::vector<ConstraintType> m_type;
+    mutable std::uint64_t m_version = 0;
+
+    // índice do começo das saídas pendentes -> índice atual (ou RELEASED), e o inverso
+    mutable std::vector<std::uint32_t> m_slotOf;
+    mutable std::vector<std::uint32_t> m_originalAt;
+    mutable bool m_pending = false;
+};
+
+// Solver por posição (XPBD) das restrições da loja. As restrições são
+// coloridas como os contatos (nenhuma partícula duas vezes na mesma cor), mas
+// como o conjunto muda pouco a coloração só é refeita quando a versão da loja
+// muda. Cada cor é dividida entre as threads em lotes de BATCH_SIZE: coleta,
+// contas sem desvios e devolução, sem disputa porque a cor não repete
+// partícula. Como nos contatos, a velocidade sai do quanto as posições andaram.
+class ConstraintSolver {
+public:
+    static constexpr size_t BATCH_SIZE = 256;
+    static constexpr size_t COLOR_COUNT = 64;
+
+    struct Params {
+        int iterations = 4;
+        bool parallel = true;
+    };
+
+    struct Arrays {
+        float* positions;
+        float* velocities;
+        float* previousPositions;
+        const float* masses;
+        size_t count;
+    };
+
+    struct Stats {
+        size_t constraints = 0;
+        size_t colors = 0;
+        size_t overflow = 0;    // restrições sem cor, resolvidas uma a uma
+        size_t recolors = 0;    // colorações refeitas desde o início
+        size_t threads = 1;
+        float maxStretch = 0.0f;  // maior |comprimento / repouso - 1| antes de resolver
+    };
+
+    void solve(const ConstraintStore& store, float deltaTime, const Arrays& arrays, ThreadPool& pool);
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void color(const ConstraintStore& store, size_t particleCount);
+    void projectRange(size_t begin, size_t end, float invDtSq, const Arrays& arrays);
+
+    static constexpr std::uint8_t OVERFLOW_COLOR = COLOR_COUNT;
+
+    Params m_params;
+    Stats m_stats;
+    std::uint64_t m_coloredVersion = ~std::uint64_t(0);
+    size_t m_coloredCount = 0;
+
+    // restrições agrupadas por cor
+    std::vector<std::uint32_t> m_a;
+    std::vector<std::uint32_t> m_b;
+    std::vector<float> m_restLength;
+    std::vector<float> m_compliance;
+    std::vector<float> m_unilateral;  // 1 nas cordas
+    std::vector<float> m_lambda;
+    size_t m_colorStart[COLOR_COUNT + 2] = {};
+
+    std::vector<std::uint8_t> m_colorOf;
+    std::vector<std::uint64_t> m_colorMask;
+    std::vector<float> m_startPositions;
+};
@@ -0,0 +1,556 @@
+#include "ContactSolver.h"
+#include <algorithm>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    constexpr float CORRECTION_PERCENT = 0.5f;
+    constexpr float CORRECTION_SLOP = 0.01f;
+    constexpr float MIN_VALID_MASS = 0.0001f;
+    constexpr float MIN_NORMAL_DISTANCE = 0.0001f;
+
+    // Modo por posição
+    constexpr float WARM_START_FACTOR = 0.7f;  // fração do lambda anterior usada como partida
+    constexpr float BOUNCE_THRESHOLD = 10.0f;  // px/s; abaixo disso o contato não quica
+    constexpr std::uint64_t EMPTY_KEY = ~std::uint64_t(0);
+
+    std::uint64_t pairKey(const ParticlePair& pair) {
+        return (std::uint64_t(pair.a) << 32) | pair.b;
+    }
+
+    size_t hashSlot(std::uint64_t key, size_t mask) {
+        std::uint64_t h = key * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 32;
+        return static_cast<size_t>(h) & mask;
+    }
+
+    unsigned lowestSetBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    // Mesmas contas do laço escalar de antes, com os "continue" virando máscara
+    // (active 0 ou 1). Sem desvios e com restrict, o laço vetoriza.
+    void contactImpulses(const float* __restrict restitution, const float* __restrict friction,
+                         const float* __restrict dx, const float* __restrict dy,
+                         const float* __restrict rvx, const float* __restrict rvy,
+                         const float* __restrict radiusSum, const float* __restrict m1,
+                         const float* __restrict m2, float* __restrict impulseX, float* __restrict impulseY,
+                         float* __restrict correctionX, float* __restrict correctionY,
+                         float* __restrict invM1, float* __restrict invM2, float* __restrict active, size_t n) {
+        for (size_t l = 0; l < n; ++l) {
+            const float i1 = 1.0f / m1[l];
+            const float i2 = 1.0f / m2[l];
+            const float inv1 = (m1[l] > MIN_VALID_MASS) ? i1 : 0.0f;
+            const float inv2 = (m2[l] > MIN_VALID_MASS) ? i2 : 0.0f;
+            const float invMassSum = inv1 + inv2;
+            const float effectiveMass = 1.0f / std::max(invMassSum, 1e-12f);
+
+            const float distSq = dx[l] * dx[l] + dy[l] * dy[l];
+            const float distance = std::sqrt(distSq);
+            const float safeDistance = std::max(distance, MIN_NORMAL_DISTANCE);
+            const float scaledX = dx[l] / safeDistance;
+            const float scaledY = dy[l] / safeDistance;
+            const bool separated = distance > MIN_NORMAL_DISTANCE;
+            const float normalX = separated ? scaledX : 1.0f;
+            const float normalY = separated ? scaledY : 0.0f;
+
+            const float velAlongNormal = rvx[l] * normalX + rvy[l] * normalY;
+            const float touching = (distSq < radiusSum[l] * radiusSum[l]) ? 1.0f : 0.0f;
+            const float approaching = (velAlongNormal <= 0.0f) ? 1.0f : 0.0f;
+            const float massive = (invMassSum > 0.0f) ? 1.0f : 0.0f;
+            const float mask = touching * approaching * massive;
+
+            const float j = -(1.0f + restitution[l]) * velAlongNormal * effectiveMass;
+            const float tangentX = -normalY;
+            const float tangentY = normalX;
+            const float vt = rvx[l] * tangentX + rvy[l] * tangentY;
+            const float jt = vt * friction[l] * effectiveMass;
+
+            const float penetration = std::max(radiusSum[l] - distance - CORRECTION_SLOP, 0.0f);
+            const float correction = penetration * effectiveMass * CORRECTION_PERCENT * mask;
+
+            impulseX[l] = (j * normalX - jt * tangentX) * mask;
+            impulseY[l] = (j * normalY - jt * tangentY) * mask;
+            correctionX[l] = normalX * correction;
+            correctionY[l] = normalY * correction;
+            invM1[l] = inv1;
+            invM2[l] = inv2;
+            active[l] = mask;
+        }
+    }
+
+    // Uma iteração de projeção: cada contato leva a distância até ra + rb - slop.
+    // lambda acumula o deslocamento total do contato e nunca fica negativo.
+    void positionCorrections(const float* __restrict dx, const float* __restrict dy,
+                             const float* __restrict radiusSum, const float* __restrict m1,
+                             const float* __restrict m2, float* __restrict lambda,
+                             float* __restrict displacementX, float* __restrict displacementY,
+                             float* __restrict invM1, float* __restrict invM2, size_t n) {
+        for (size_t l = 0; l < n; ++l) {
+            const float i1 = 1.0f / m1[l];
+            const float i2 = 1.0f / m2[l];
+            const float inv1 = (m1[l] > MIN_VALID_MASS) ? i1 : 0.0f;
+            const float inv2 = (m2[l] > MIN_VALID_MASS) ? i2 : 0.0f;
+            const float invMassSum = inv1 + inv2;
+            const float effectiveMass = 1.0f / std::max(invMassSum, 1e-12f);
+            const float massive = (invMassSum > 0.0f) ? 1.0f : 0.0f;
+
+            const float distance = std::sqrt(dx[l] * dx[l] + dy[l] * dy[l]);
+            const float safeDistance = std::max(distance, MIN_NORMAL_DISTANCE);
+            const float scaledX = dx[l] / safeDistance;
+            const float scaledY = dy[l] / safeDistance;
+            const bool separated = distance > MIN_NORMAL_DISTANCE;
+            const float normalX = separated ? scaledX : 1.0f;
+            const float normalY = separated ? scaledY : 0.0f;
+
+            const float constraint = distance - radiusSum[l] + CORRECTION_SLOP;
+            const float accumulated = std::max(lambda[l] - constraint * effectiveMass, 0.0f) * massive;
+            const float applied = accumulated - lambda[l];
+            lambda[l] = accumulated;
+
+            displacementX[l] = normalX * applied;
+            displacementY[l] = normalY * applied;
+            invM1[l] = inv1;
+            invM2[l] = inv2;
+        }
+    }
+
+    // Passada de velocidade depois da projeção: restituição sobre a velocidade
+    // normal de antes do passo e atrito limitado pelo empurrão normal (Coulomb).
+    void velocityCorrections(const float* __restrict restitution, const float* __restrict friction, float invDt,
+                             const float* __restrict dx,
+                             const float* __restrict dy, const float* __restrict rvx,
+                             const float* __restrict rvy, const float* __restrict m1,
+                             const float* __restrict m2, const float* __restrict lambda,
+                             const float* __restrict normalVelocityBefore, float* __restrict impulseX,
+                             float* __restrict impulseY, float* __restrict invM1, float* __restrict invM2,
+                             size_t n) {
+        for (size_t l = 0; l < n; ++l) {
+            const float i1 = 1.0f / m1[l];
+            const float i2 = 1.0f / m2[l];
+            const float inv1 = (m1[l] > MIN_VALID_MASS) ? i1 : 0.0f;
+            const float inv2 = (m2[l] > MIN_VALID_MASS) ? i2 : 0.0f;
+            const float effectiveMass = 1.0f / std::max(inv1 + inv2, 1e-12f);
+
+            const float distance = std::sqrt(dx[l] * dx[l] + dy[l] * dy[l]);
+            const float safeDistance = std::max(distance, MIN_NORMAL_DISTANCE);
+            const float scaledX = dx[l] / safeDistance;
+            const float scaledY = dy[l] / safeDistance;
+            const bool separated = distance > MIN_NORMAL_DISTANCE;
+            const float normalX = separated ? scaledX : 1.0f;
+            const float normalY = separated ? scaledY : 0.0f;
+            const float tangentX = -normalY;
+            const float tangentY = normalX;
+
+            const float active = (lambda[l] > 0.0f) ? 1.0f : 0.0f;
+            const float before = normalVelocityBefore[l];
+            const float bounce = (before < -BOUNCE_THRESHOLD) ? -restitution[l] * before : 0.0f;
+            const float vn = rvx[l] * normalX + rvy[l] * normalY;
+            const float deltaNormal = (bounce - vn) * active;
+
+            const float vt = rvx[l] * tangentX + rvy[l] * tangentY;
+            // lambda é deslocamento x massa efetiva; o limite fica em velocidade relativa
+            const float maxFriction = friction[l] * lambda[l] * invDt / effectiveMass;
+            const float deltaTangent = -std::min(std::max(vt, -maxFriction), maxFriction) * active;
+
+            impulseX[l] = (normalX * deltaNormal + tangentX * deltaTangent) * effectiveMass;
+            impulseY[l] = (normalY * deltaNormal + tangentY * deltaTangent) * effectiveMass;
+            invM1[l] = inv1;
+            invM2[l] = inv2;
+        }
+    }
+}
+
+void ContactSolver::contactMaterial(const Arrays& arrays, std::uint32_t a, std::uint32_t b, float restitution,
+                                    float& contactRestitution, float& contactFriction) {
+    const std::uint8_t speciesA = arrays.species[a];
+    const std::uint8_t speciesB = arrays.species[b];
+    const float scale = std::max(arrays.restitutionScales[speciesA], arrays.restitutionScales[speciesB]);
+    contactRestitution = std::min(restitution * scale, 1.0f);
+    contactFriction = std::sqrt(arrays.frictions[speciesA] * arrays.frictions[speciesB]);
+}
+
+void ContactSolver::collectContacts(const std::vector<ParticlePair>& pairs, const Arrays& arrays) {
+    // a lista de pares pode ter folga (margem, skin); aqui só fica quem se toca agora
+    const float* positions = arrays.positions;
+    const float* radii = arrays.radii;
+    m_contacts.clear();
+    float deepest = 0.0f;
+    double overlapSum = 0.0;
+    for (const ParticlePair& pair : pairs) {
+        const float dx = positions[pair.a * 2] - positions[pair.b * 2];
+        const float dy = positions[pair.a * 2 + 1] - positions[pair.b * 2 + 1];
+        const float radiusSum = radii[pair.a] + radii[pair.b];
+        const float distanceSq = dx * dx + dy * dy;
+        if (distanceSq < radiusSum * radiusSum) {
+            m_contacts.push_back(pair);
+            const float overlap = radiusSum - std::sqrt(distanceSq);
+            deepest = std::max(deepest, overlap);
+            overlapSum += overlap;
+        }
+    }
+    m_stats.contacts = m_contacts.size();
+    m_stats.maxPenetration = deepest;
+    m_stats.meanPenetration = m_contacts.empty() ? 0.0f : static_cast<float>(overlapSum / m_contacts.size());
+}
+
+void ContactSolver::colorContacts(size_t particleCount) {
+    // coloração gulosa numa passada: cada partícula guarda em bits as cores em que
+    // já aparece, e o contato fica com a menor cor livre nas duas. Contatos sem cor
+    // livre vão para OVERFLOW_COLOR e são resolvidos um a um no fim.
+    m_colorMask.assign(particleCount, 0);
+    m_colorOf.resize(m_contacts.size());
+    size_t counts[COLOR_COUNT + 1] = {};
+
+    for (size_t c = 0; c < m_contacts.size(); ++c) {
+        const ParticlePair& contact = m_contacts[c];
+        const std::uint64_t freeColors = ~(m_colorMask[contact.a] | m_colorMask[contact.b]);
+        std::uint8_t color = OVERFLOW_COLOR;
+        if (freeColors != 0) {
+            color = static_cast<std::uint8_t>(lowestSetBit(freeColors));
+            m_colorMask[contact.a] |= std::uint64_t(1) << color;
+            m_colorMask[contact.b] |= std::uint64_t(1) << color;
+        }
+        m_colorOf[c] = color;
+        ++counts[color];
+    }
+
+    // counting sort estável por cor: dentro de cada cor fica a ordem da busca de pares
+    m_colorStart[0] = 0;
+    size_t colors = 0;
+    for (size_t color = 0; color <= COLOR_COUNT; ++color) {
+        m_colorStart[color + 1] = m_colorStart[color] + counts[color];
+        colors += (counts[color] > 0 && color != OVERFLOW_COLOR) ? 1 : 0;
+    }
+    size_t cursor[COLOR_COUNT + 1];
+    std::copy(m_colorStart, m_colorStart + COLOR_COUNT + 1, cursor);
+    m_sorted.resize(m_contacts.size());
+    for (size_t c = 0; c < m_contacts.size(); ++c) {
+        m_sorted[cursor[m_colorOf[c]]++] = m_contacts[c];
+    }
+
+    m_stats.colors = colors;
+    m_stats.overflow = counts[OVERFLOW_COLOR];
+}
+
+void ContactSolver::solveBatch(const ParticlePair* contacts, size_t count, float restitution, float deltaTime,
+                               const Arrays& arrays) {
+    float* positions = arrays.positions;
+    float* velocities = arrays.velocities;
+    float* previous = arrays.previousPositions;
+
+    Lanes& lanes = m_lanes;
+    for (size_t l = 0; l < count; ++l) {
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+        lanes.dx[l] = positions[a * 2] - positions[b * 2];
+        lanes.dy[l] = positions[a * 2 + 1] - positions[b * 2 + 1];
+        lanes.rvx[l] = velocities[a * 2] - velocities[b * 2];
+        lanes.rvy[l] = velocities[a * 2 + 1] - velocities[b * 2 + 1];
+        lanes.radiusSum[l] = arrays.radii[a] + arrays.radii[b];
+        lanes.m1[l] = arrays.masses[a];
+        lanes.m2[l] = arrays.masses[b];
+        contactMaterial(arrays, a, b, restitution, lanes.restitution[l], lanes.friction[l]);
+    }
+
+    contactImpulses(lanes.restitution, lanes.friction, lanes.dx, lanes.dy, lanes.rvx, lanes.rvy, lanes.radiusSum, lanes.m1, lanes.m2,
+                    lanes.impulseX, lanes.impulseY, lanes.correctionX, lanes.correctionY, lanes.invM1, lanes.invM2,
+                    lanes.active, count);
+
+    // nenhuma partícula se repete no lote, então a ordem da devolução não importa
+    for (size_t l = 0; l < count; ++l) {
+        // contato que o laço escalar pularia: nem a posição anterior é tocada
+        if (lanes.active[l] == 0.0f) continue;
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+
+        velocities[a * 2]     += lanes.impulseX[l] * lanes.invM1[l];
+        velocities[a * 2 + 1] += lanes.impulseY[l] * lanes.invM1[l];
+        velocities[b * 2]     -= lanes.impulseX[l] * lanes.invM2[l];
+        velocities[b * 2 + 1] -= lanes.impulseY[l] * lanes.invM2[l];
+
+        positions[a * 2]     += lanes.correctionX[l] * lanes.invM1[l];
+        positions[a * 2 + 1] += lanes.correctionY[l] * lanes.invM1[l];
+        positions[b * 2]     -= lanes.correctionX[l] * lanes.invM2[l];
+        positions[b * 2 + 1] -= lanes.correctionY[l] * lanes.invM2[l];
+
+        previous[a * 2]     = positions[a * 2] - velocities[a * 2] * deltaTime;
+        previous[a * 2 + 1] = positions[a * 2 + 1] - velocities[a * 2 + 1] * deltaTime;
+        previous[b * 2]     = positions[b * 2] - velocities[b * 2] * deltaTime;
+        previous[b * 2 + 1] = positions[b * 2 + 1] - velocities[b * 2 + 1] * deltaTime;
+    }
+}
+
+void ContactSolver::solve(const std::vector<ParticlePair>& pairs, float restitution, float deltaTime,
+                          const Arrays& arrays) {
+    collectContacts(pairs, arrays);
+    m_stats.batches = 0;
+    m_stats.iterations = 1;
+    m_stats.pairVisits = m_contacts.size();
+    m_stats.warmStarted = 0;
+    if (m_contacts.empty()) {
+        m_stats.colors = 0;
+        m_stats.overflow = 0;
+        return;
+    }
+    colorContacts(arrays.count);
+
+    for (size_t color = 0; color < COLOR_COUNT; ++color) {
+        const size_t end = m_colorStart[color + 1];
+        for (size_t begin = m_colorStart[color]; begin < end; begin += BATCH_SIZE) {
+            solveBatch(&m_sorted[begin], std::min(BATCH_SIZE, end - begin), restitution, deltaTime, arrays);
+            ++m_stats.batches;
+        }
+    }
+    // o transbordo divide partículas entre si, então vai um contato por vez
+    for (size_t c = m_colorStart[OVERFLOW_COLOR]; c < m_colorStart[OVERFLOW_COLOR + 1]; ++c) {
+        solveBatch(&m_sorted[c], 1, restitution, deltaTime, arrays);
+        ++m_stats.batches;
+    }
+    // a correção de sobreposição pode empurrar para dentro de um obstáculo; o
+    // integrador rebate a velocidade no passo seguinte
+    projectObstacles(arrays, true);
+}
+
+template <typename BatchFn>
+void ContactSolver::forEachBatch(BatchFn&& fn) {
+    for (size_t color = 0; color < COLOR_COUNT; ++color) {
+        const size_t end = m_colorStart[color + 1];
+        for (size_t begin = m_colorStart[color]; begin < end; begin += BATCH_SIZE) {
+            fn(begin, std::min(BATCH_SIZE, end - begin));
+        }
+    }
+    for (size_t c = m_colorStart[OVERFLOW_COLOR]; c < m_colorStart[OVERFLOW_COLOR + 1]; ++c) {
+        fn(c, size_t(1));
+    }
+}
+
+float ContactSolver::findCachedLambda(std::uint64_t key) const {
+    if (m_cacheKeys.empty()) return 0.0f;
+    const size_t mask = m_cacheKeys.size() - 1;
+    for (size_t slot = hashSlot(key, mask);; slot = (slot + 1) & mask) {
+        if (m_cacheKeys[slot] == key) return m_cacheLambdas[slot];
+        if (m_cacheKeys[slot] == EMPTY_KEY) return 0.0f;
+    }
+}
+
+void ContactSolver::storeLambdas() {
+    size_t capacity = 16;
+    while (capacity < m_sorted.size() * 2) capacity *= 2;
+    m_nextKeys.assign(capacity, EMPTY_KEY);
+    m_nextLambdas.resize(capacity);
+    const size_t mask = capacity - 1;
+    for (size_t c = 0; c < m_sorted.size(); ++c) {
+        if (m_lambda[c] <= 0.0f) continue;
+        const std::uint64_t key = pairKey(m_sorted[c]);
+        size_t slot = hashSlot(key, mask);
+        while (m_nextKeys[slot] != EMPTY_KEY) slot = (slot + 1) & mask;
+        m_nextKeys[slot] = key;
+        m_nextLambdas[slot] = m_lambda[c];
+    }
+    m_cacheKeys.swap(m_nextKeys);
+    m_cacheLambdas.swap(m_nextLambdas);
+}
+
+void ContactSolver::warmStartBatch(size_t begin, size_t count, const Arrays& arrays) {
+    // reaplica o empurrão do passo anterior na direção atual do contato
+    float* positions = arrays.positions;
+    for (size_t l = 0; l < count; ++l) {
+        const float lambda = m_lambda[begin + l];
+        if (lambda <= 0.0f) continue;
+        const std::uint32_t a = m_sorted[begin + l].a;
+        const std::uint32_t b = m_sorted[begin + l].b;
+        const float m1 = arrays.masses[a];
+        const float m2 = arrays.masses[b];
+        const float inv1 = (m1 > MIN_VALID_MASS) ? 1.0f / m1 : 0.0f;
+        const float inv2 = (m2 > MIN_VALID_MASS) ? 1.0f / m2 : 0.0f;
+        const float dx = positions[a * 2] - positions[b * 2];
+        const float dy = positions[a * 2 + 1] - positions[b * 2 + 1];
+        const float distance = std::sqrt(dx * dx + dy * dy);
+        if (distance <= MIN_NORMAL_DISTANCE) continue;
+        const float nx = dx / distance * lambda;
+        const float ny = dy / distance * lambda;
+        positions[a * 2]     += nx * inv1;
+        positions[a * 2 + 1] += ny * inv1;
+        positions[b * 2]     -= nx * inv2;
+        positions[b * 2 + 1] -= ny * inv2;
+    }
+}
+
+void ContactSolver::projectBatch(size_t begin, size_t count, const Arrays& arrays) {
+    float* positions = arrays.positions;
+    const ParticlePair* contacts = &m_sorted[begin];
+    Lanes& lanes = m_lanes;
+    for (size_t l = 0; l < count; ++l) {
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+        lanes.dx[l] = positions[a * 2] - positions[b * 2];
+        lanes.dy[l] = positions[a * 2 + 1] - positions[b * 2 + 1];
+        lanes.radiusSum[l] = arrays.radii[a] + arrays.radii[b];
+        lanes.m1[l] = arrays.masses[a];
+        lanes.m2[l] = arrays.masses[b];
+    }
+
+    // impulseX/Y guardam o deslocamento da iteração
+    positionCorrections(lanes.dx, lanes.dy, lanes.radiusSum, lanes.m1, lanes.m2, &m_lambda[begin],
+                        lanes.impulseX, lanes.impulseY, lanes.invM1, lanes.invM2, count);
+
+    for (size_t l = 0; l < count; ++l) {
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+        positions[a * 2]     += lanes.impulseX[l] * lanes.invM1[l];
+        positions[a * 2 + 1] += lanes.impulseY[l] * lanes.invM1[l];
+        positions[b * 2]     -= lanes.impulseX[l] * lanes.invM2[l];
+        positions[b * 2 + 1] -= lanes.impulseY[l] * lanes.invM2[l];
+    }
+}
+
+void ContactSolver::projectBounds(const Arrays& arrays) {
+    // mesmas bordas e obstáculos do integrador, como restrição de posição
+    float* __restrict positions = arrays.positions;
+    const float* __restrict radii = arrays.radii;
+    for (size_t i = 0; i < arrays.count; ++i) {
+        const float radius = radii[i];
+        positions[i * 2] = std::max(std::min(positions[i * 2], arrays.maxX - radius), arrays.minX + radius);
+        positions[i * 2 + 1] = std::max(std::min(positions[i * 2 + 1], arrays.maxY - radius), arrays.minY + radius);
+    }
+    projectObstacles(arrays, false);
+}
+
+void ContactSolver::projectObstacles(const Arrays& arrays, bool keepVelocity) {
+    if (!arrays.obstacles) return;
+    const DistanceGrid grid = *arrays.obstacles;
+    float* __restrict positions = arrays.positions;
+    float* __restrict previous = arrays.previousPositions;
+    const float* __restrict radii = arrays.radii;
+    const float shiftPrevious = keepVelocity ? 1.0f : 0.0f;
+    for (size_t i = 0; i < arrays.count; ++i) {
+        float distance, gradX, gradY;
+        grid.sample(positions[i * 2], positions[i * 2 + 1], distance, gradX, gradY);
+        const float invLength = 1.0f / std::max(std::sqrt(gradX * gradX + gradY * gradY), 1e-6f);
+        const float penetration = std::max(radii[i] - distance, 0.0f) * invLength;
+        positions[i * 2] += gradX * penetration;
+        positions[i * 2 + 1] += gradY * penetration;
+        previous[i * 2] += gradX * penetration * shiftPrevious;
+        previous[i * 2 + 1] += gradY * penetration * shiftPrevious;
+    }
+}
+
+void ContactSolver::velocityBatch(size_t begin, size_t count, float restitution, float deltaTime,
+                                  const Arrays& arrays) {
+    const float* positions = arrays.positions;
+    float* velocities = arrays.velocities;
+    const ParticlePair* contacts = &m_sorted[begin];
+    Lanes& lanes = m_lanes;
+    for (size_t l = 0; l < count; ++l) {
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+        lanes.dx[l] = positions[a * 2] - positions[b * 2];
+        lanes.dy[l] = positions[a * 2 + 1] - positions[b * 2 + 1];
+        lanes.rvx[l] = velocities[a * 2] - velocities[b * 2];
+        lanes.rvy[l] = velocities[a * 2 + 1] - velocities[b * 2 + 1];
+        lanes.m1[l] = arrays.masses[a];
+        lanes.m2[l] = arrays.masses[b];
+        contactMaterial(arrays, a, b, restitution, lanes.restitution[l], lanes.friction[l]);
+    }
+
+    velocityCorrections(lanes.restitution, lanes.friction, 1.0f / deltaTime, lanes.dx, lanes.dy, lanes.rvx, lanes.rvy, lanes.m1, lanes.m2,
+                        &m_lambda[begin], &m_normalVelocity[begin], lanes.impulseX, lanes.impulseY, lanes.invM1,
+                        lanes.invM2, count);
+
+    for (size_t l = 0; l < count; ++l) {
+        const std::uint32_t a = contacts[l].a;
+        const std::uint32_t b = contacts[l].b;
+        velocities[a * 2]     += lanes.impulseX[l] * lanes.invM1[l];
+        velocities[a * 2 + 1] += lanes.impulseY[l] * lanes.invM1[l];
+        velocities[b * 2]     -= lanes.impulseX[l] * lanes.invM2[l];
+        velocities[b * 2 + 1] -= lanes.impulseY[l] * lanes.invM2[l];
+    }
+}
+
+void ContactSolver::solvePositions(const std::vector<ParticlePair>& pairs, int iterations, float restitution,
+                                   float deltaTime, std::uint64_t generation, const Arrays& arrays) {
+    iterations = std::max(iterations, 1);
+    if (generation != m_cacheGeneration) {
+        // índices remapeados: o que estava no cache pode ser de outro par
+        m_cacheKeys.clear();
+        m_cacheGeneration = generation;
+    }
+
+    collectContacts(pairs, arrays);
+    m_stats.iterations = iterations;
+    // cada iteração passa pelos contatos duas vezes: posição e velocidade
+    m_stats.pairVisits = m_contacts.size() * static_cast<size_t>(2 * iterations);
+    m_stats.warmStarted = 0;
+    m_stats.batches = 0;
+    if (m_contacts.empty()) {
+        m_stats.colors = 0;
+        m_stats.overflow = 0;
+        m_cacheKeys.clear();
+        return;
+    }
+    colorContacts(arrays.count);
+
+    const float* velocities = arrays.velocities;
+    const float* positions = arrays.positions;
+    m_lambda.resize(m_sorted.size());
+    m_normalVelocity.resize(m_sorted.size());
+    for (size_t c = 0; c < m_sorted.size(); ++c) {
+        const std::uint32_t a = m_sorted[c].a;
+        const std::uint32_t b = m_sorted[c].b;
+        const float dx = positions[a * 2] - positions[b * 2];
+        const float dy = positions[a * 2 + 1] - positions[b * 2 + 1];
+        const float distance = std::max(std::sqrt(dx * dx + dy * dy), MIN_NORMAL_DISTANCE);
+        m_normalVelocity[c] = ((velocities[a * 2] - velocities[b * 2]) * dx +
+                               (velocities[a * 2 + 1] - velocities[b * 2 + 1]) * dy) / distance;
+
+        const float cached = m_warmStarting ? findCachedLambda(pairKey(m_sorted[c])) : 0.0f;
+        m_lambda[c] = cached * WARM_START_FACTOR;
+        m_stats.warmStarted += (cached > 0.0f) ? 1 : 0;
+    }
+
+    m_startPositions.assign(arrays.positions, arrays.positions + arrays.count * 2);
+
+    if (m_stats.warmStarted > 0) {
+        forEachBatch([&](size_t begin, size_t count) { warmStartBatch(begin, count, arrays); });
+    }
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        forEachBatch([&](size_t begin, size_t count) {
+            projectBatch(begin, count, arrays);
+            ++m_stats.batches;
+        });
+        projectBounds(arrays);
+    }
+
+    // PBD: o que as posições andaram por causa dos contatos vira velocidade
+    const float invDt = 1.0f / deltaTime;
+    float* __restrict velocityOut = arrays.velocities;
+    const float* __restrict start = m_startPositions.data();
+    const float* __restrict current = arrays.positions;
+    for (size_t i = 0; i < arrays.count * 2; ++i) {
+        velocityOut[i] += (current[i] - start[i]) * invDt;
+    }
+
+    // uma passada só deixa velocidade normal sobrando numa pilha alta, e ela vira tremor;
+    // com a mesma contagem de iterações a velocidade converge junto com as posições
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        forEachBatch([&](size_t begin, size_t count) {
+            velocityBatch(begin, count, restitution, deltaTime, arrays);
+        });
+    }
+
+    float* __restrict previous = arrays.previousPositions;
+    for (size_t i = 0; i < arrays.count * 2; ++i) {
+        previous[i] = current[i] - velocityOut[i] * deltaTime;
+    }
+
+    storeLambdas();
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "Broadphase.h"
+#include "Obstacle.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Resolução de colisões em lotes sobre o SoA. Os pares que de fato se tocam
+// viram contatos, e os contatos são coloridos de modo que nenhuma partícula
+// apareça duas vezes na mesma cor. Cada cor é resolvida em lotes de até
+// BATCH_SIZE contatos: os valores são coletados do SoA para arrays contíguos,
+// as contas (impulso normal, atrito e correção de posição) rodam num laço sem
+// desvios que o compilador vetoriza, e os resultados voltam ao SoA. Como os
+// contatos de uma cor são independentes, o resultado é o mesmo de resolvê-los
+// um a um na ordem das cores.
+//
+// Há dois modos. solve() é o de impulso em passada única (o comportamento
+// original). solvePositions() é um solver por posição (PBD): em cada iteração
+// cada contato empurra as posições até desfazer a sobreposição, acumulando o
+// deslocamento total (lambda) e sem nunca puxar além de zero, e as bordas do
+// mundo e os obstáculos entram como restrição no fim de cada iteração (sem elas a base da pilha
+// afunda no chão e nenhuma iteração a mais resolve). A velocidade sai do quanto
+// as posições andaram, e passadas de velocidade (tantas quanto as de posição)
+// aplicam restituição e atrito.
+// Os lambdas de cada par ficam guardados para o passo seguinte e servem de ponto
+// de partida (warm start): numa pilha parada o empurrão de que cada contato
+// precisa quase não muda entre passos, então poucas iterações bastam.
+class ContactSolver {
+public:
+    // Lote que cabe no L1 com folga: 16 arrays de BATCH_SIZE floats
+    static constexpr size_t BATCH_SIZE = 256;
+    // Cores possíveis: uma por bit da máscara de cada partícula
+    static constexpr size_t COLOR_COUNT = 64;
+
+    struct Arrays {
+        float* positions;
+        float* velocities;
+        float* previousPositions;
+        const float* masses;
+        const float* radii;
+        size_t count;
+        // bordas do mundo e obstáculos (nullptr sem obstáculos); só o modo por posição os usa
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        const DistanceGrid* obstacles;
+        // espécie de cada partícula e, por espécie, escala da restituição e atrito
+        const std::uint8_t* species;
+        const float* restitutionScales;
+        const float* frictions;
+    };
+
+    struct Stats {
+        size_t contacts = 0;
+        size_t colors = 0;
+        size_t overflow = 0;  // contatos que não couberam em nenhuma cor
+        size_t batches = 0;
+        int iterations = 0;          // 1 no modo de impulso
+        size_t pairVisits = 0;       // contatos visitados somando todas as passadas
+        size_t warmStarted = 0;      // contatos que partiram do lambda do passo anterior
+        float maxPenetration = 0.0f; // maior sobreposição ao coletar os contatos
+        float meanPenetration = 0.0f;
+    };
+
+    // restitution e deltaTime como em ParticleSystem::handleCollisions; restitution
+    // é a global, que cada contato escala pela maior escala das duas espécies
+    void solve(const std::vector<ParticlePair>& pairs, float restitution, float deltaTime, const Arrays& arrays);
+
+    // iterations >= 1. generation identifica o conjunto de partículas: se mudou,
+    // os índices do passo anterior não valem e o cache de lambdas é descartado.
+    void solvePositions(const std::vector<ParticlePair>& pairs, int iterations, float restitution,
+                        float deltaTime, std::uint64_t generation, const Arrays& arrays);
+
+    void setWarmStarting(bool enabled) { m_warmStarting = enabled; }
+    bool isWarmStarting() const { return m_warmStarting; }
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void collectContacts(const std::vector<ParticlePair>& pairs, const Arrays& arrays);
+    void colorContacts(size_t particleCount);
+    void solveBatch(const ParticlePair* contacts, size_t count, float restitution, float deltaTime,
+                    const Arrays& arrays);
+    // Passadas do modo por posição, sobre [begin, begin + count) de m_sorted
+    void warmStartBatch(size_t begin, size_t count, const Arrays& arrays);
+    void projectBatch(size_t begin, size_t count, const Arrays& arrays);
+    void velocityBatch(size_t begin, size_t count, float restitution, float deltaTime, const Arrays& arrays);
+    void projectBounds(const Arrays& arrays);
+    // Tira as partículas de dentro dos obstáculos; com keepVelocity a posição
+    // anterior anda junto e a velocidade implícita não muda
+    void projectObstacles(const Arrays& arrays, bool keepVelocity);
+    // Restituição e atrito do contato entre a e b, coletados para o lote
+    static void contactMaterial(const Arrays& arrays, std::uint32_t a, std::uint32_t b, float restitution,
+                                float& contactRestitution, float& contactFriction);
+    template <typename BatchFn>
+    void forEachBatch(BatchFn&& fn);
+
+    // Cache de lambdas por par (a, b), endereçamento aberto
+    float findCachedLambda(std::uint64_t key) const;
+    void storeLambdas();
+
+    static constexpr std::uint8_t OVERFLOW_COLOR = COLOR_COUNT;
+
+    // valores coletados de um lote e os resultados das contas, um por contato
+    struct Lanes {
+        alignas(64) float dx[BATCH_SIZE];
+        alignas(64) float dy[BATCH_SIZE];
+        alignas(64) float rvx[BATCH_SIZE];
+        alignas(64) float rvy[BATCH_SIZE];
+        alignas(64) float radiusSum[BATCH_SIZE];
+        alignas(64) float m1[BATCH_SIZE];
+        alignas(64) float m2[BATCH_SIZE];
+        alignas(64) float impulseX[BATCH_SIZE];
+        alignas(64) float impulseY[BATCH_SIZE];
+        alignas(64) float correctionX[BATCH_SIZE];
+        alignas(64) float correctionY[BATCH_SIZE];
+        alignas(64) float invM1[BATCH_SIZE];
+        alignas(64) float invM2[BATCH_SIZE];
+        alignas(64) float active[BATCH_SIZE];
+        alignas(64) float restitution[BATCH_SIZE];
+        alignas(64) float friction[BATCH_SIZE];
+    };
+
+    std::vector<ParticlePair> m_contacts;
+    std::vector<std::uint8_t> m_colorOf;
+    std::vector<std::uint64_t> m_colorMask;  // cores em que cada partícula já aparece
+    std::vector<ParticlePair> m_sorted;      // contatos agrupados por cor
+    size_t m_colorStart[COLOR_COUNT + 2] = {};
+    Lanes m_lanes;
+
+    // por contato, na ordem de m_sorted (modo por posição)
+    std::vector<float> m_lambda;
+    std::vector<float> m_normalVelocity;  // velocidade normal relativa antes de resolver
+    std::vector<float> m_startPositions;
+
+    std::vector<std::uint64_t> m_cacheKeys;
+    std::vector<float> m_cacheLambdas;
+    std::vector<std::uint64_t> m_nextKeys;
+    std::vector<float> m_nextLambdas;
+    std::uint64_t m_cacheGeneration = 0;
+    bool m_warmStarting = true;
+
+    Stats m_stats;
+};
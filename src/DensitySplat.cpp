@@ -0,0 +1,206 @@
+#include "DensitySplat.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // partículas por bloco do counting sort
+    constexpr size_t BLOCK_SIZE = 16384;
+    // faixas por thread: sobra para equilibrar faixas cheias e vazias
+    constexpr size_t BANDS_PER_THREAD = 8;
+    constexpr size_t ROW_GRAIN = 16;
+}
+
+const char* DensitySplat::modeName(RenderMode mode) {
+    switch (mode) {
+        case RenderMode::Particles: return "partículas";
+        case RenderMode::Density:   return "densidade";
+        case RenderMode::Auto:
+        case RenderMode::Count:     break;
+    }
+    return "auto";
+}
+
+void DensitySplat::resize(size_t width, size_t height, float areaLeft, float areaTop, float areaWidth,
+                          float areaHeight) {
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_accum.assign(width * height * 4, 0.0f);
+        m_scratch.assign(width * height * 4, 0.0f);
+        m_pixels.assign(width * height * 4, 0);
+        m_rowMax.assign(height, 0.0f);
+    }
+    m_areaLeft = areaLeft;
+    m_areaTop = areaTop;
+    m_areaWidth = areaWidth;
+    m_areaHeight = areaHeight;
+    m_scaleX = areaWidth > 0.0f ? static_cast<float>(width) / areaWidth : 1.0f;
+    m_scaleY = areaHeight > 0.0f ? static_cast<float>(height) / areaHeight : 1.0f;
+}
+
+void DensitySplat::render(const Arrays& arrays, ThreadPool& pool) {
+    const size_t count = arrays.count;
+    const size_t threadCount = m_params.parallel ? pool.getThreadCount() : 1;
+    m_stats = Stats();
+    m_stats.width = m_width;
+    m_stats.height = m_height;
+    m_stats.areaLeft = m_areaLeft;
+    m_stats.areaTop = m_areaTop;
+    m_stats.areaWidth = m_areaWidth;
+    m_stats.areaHeight = m_areaHeight;
+    m_stats.threads = threadCount;
+    if (m_width == 0 || m_height == 0) return;
+
+    auto forRange = [&](size_t total, size_t grain, const ThreadPool::Body& body) {
+        if (m_params.parallel) {
+            pool.parallelFor(total, grain, body);
+        } else {
+            body(0, total);
+        }
+    };
+
+    m_bandRows = std::max<size_t>(1, m_height / (threadCount * BANDS_PER_THREAD));
+    m_bandCount = (m_height + m_bandRows - 1) / m_bandRows;
+    // a última "faixa" recebe quem caiu fora da imagem e não é acumulada
+    const size_t slots = m_bandCount + 1;
+    const size_t blockCount = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    m_pixelOf.resize(count);
+    m_blockOffsets.assign(blockCount * slots, 0);
+    const float* positions = arrays.positions;
+    forRange(blockCount, 1, [&](size_t blockBegin, size_t blockEnd) {
+        for (size_t block = blockBegin; block < blockEnd; ++block) {
+            size_t* histogram = &m_blockOffsets[block * slots];
+            const size_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+            for (size_t i = block * BLOCK_SIZE; i < end; ++i) {
+                const float x = (positions[i * 2] - m_areaLeft) * m_scaleX;
+                const float y = (positions[i * 2 + 1] - m_areaTop) * m_scaleY;
+                const bool inside = x >= 0.0f && y >= 0.0f && x < static_cast<float>(m_width) &&
+                                    y < static_cast<float>(m_height);
+                const size_t px = inside ? static_cast<size_t>(x) : 0;
+                const size_t py = inside ? static_cast<size_t>(y) : 0;
+                m_pixelOf[i] = inside ? static_cast<std::uint32_t>(py * m_width + px) : OUTSIDE;
+                ++histogram[inside ? py / m_bandRows : m_bandCount];
+            }
+        }
+    });
+
+    // soma de prefixos faixa a faixa, bloco a bloco: dentro de uma faixa fica a ordem das partículas
+    m_bandStart.assign(slots + 1, 0);
+    size_t running = 0;
+    for (size_t band = 0; band < slots; ++band) {
+        m_bandStart[band] = running;
+        for (size_t block = 0; block < blockCount; ++block) {
+            const size_t inBlock = m_blockOffsets[block * slots + band];
+            m_blockOffsets[block * slots + band] = running;
+            running += inBlock;
+        }
+    }
+    m_bandStart[slots] = running;
+    m_stats.splatted = m_bandStart[m_bandCount];
+
+    m_sortedPixel.resize(count);
+    m_sortedColor.resize(count);
+    const std::uint32_t* colors = arrays.colors;
+    forRange(blockCount, 1, [&](size_t blockBegin, size_t blockEnd) {
+        for (size_t block = blockBegin; block < blockEnd; ++block) {
+            size_t* cursor = &m_blockOffsets[block * slots];
+            const size_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+            for (size_t i = block * BLOCK_SIZE; i < end; ++i) {
+                const std::uint32_t pixel = m_pixelOf[i];
+                const size_t band = pixel == OUTSIDE ? m_bandCount : (pixel / m_width) / m_bandRows;
+                const size_t slot = cursor[band]++;
+                m_sortedPixel[slot] = pixel;
+                m_sortedColor[slot] = colors[i];
+            }
+        }
+    });
+
+    forRange(m_bandCount, 1, [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; ++band) {
+            accumulateBand(band);
+        }
+    });
+
+    for (int pass = 0; pass < m_params.blurPasses; ++pass) {
+        forRange(m_height, ROW_GRAIN, [&](size_t begin, size_t end) {
+            blurRows(m_accum, m_scratch, begin, end, false);
+        });
+        forRange(m_height, ROW_GRAIN, [&](size_t begin, size_t end) {
+            blurRows(m_scratch, m_accum, begin, end, true);
+        });
+    }
+
+    forRange(m_height, ROW_GRAIN, [&](size_t begin, size_t end) {
+        toneRows(begin, end);
+    });
+
+    m_stats.maxDensity = *std::max_element(m_rowMax.begin(), m_rowMax.end());
+    ++m_version;
+}
+
+void DensitySplat::accumulateBand(size_t band) {
+    const size_t rowBegin = band * m_bandRows;
+    const size_t rowEnd = std::min(m_height, rowBegin + m_bandRows);
+    float* accum = m_accum.data();
+    std::fill(accum + rowBegin * m_width * 4, accum + rowEnd * m_width * 4, 0.0f);
+    for (size_t s = m_bandStart[band]; s < m_bandStart[band + 1]; ++s) {
+        float* texel = accum + static_cast<size_t>(m_sortedPixel[s]) * 4;
+        const std::uint32_t color = m_sortedColor[s];
+        texel[0] += 1.0f;
+        texel[1] += static_cast<float>((color >> 24) & 0xFF);
+        texel[2] += static_cast<float>((color >> 16) & 0xFF);
+        texel[3] += static_cast<float>((color >> 8) & 0xFF);
+    }
+}
+
+void DensitySplat::blurRows(const std::vector<float>& source, std::vector<float>& target, size_t rowBegin,
+                            size_t rowEnd, bool vertical) {
+    // binômio 1 2 1 numa direção, borda repetida; densidade e cores juntas, então
+    // o vizinho está a 4 floats (horizontal) ou a uma linha (vertical)
+    const size_t rowFloats = m_width * 4;
+    for (size_t y = rowBegin; y < rowEnd; ++y) {
+        const float* __restrict center = source.data() + y * rowFloats;
+        float* __restrict out = target.data() + y * rowFloats;
+        if (vertical) {
+            const float* __restrict above = y > 0 ? center - rowFloats : center;
+            const float* __restrict below = y + 1 < m_height ? center + rowFloats : center;
+            for (size_t i = 0; i < rowFloats; ++i) {
+                out[i] = 0.25f * above[i] + 0.5f * center[i] + 0.25f * below[i];
+            }
+        } else if (m_width > 1) {
+            for (size_t k = 0; k < 4; ++k) {
+                out[k] = 0.75f * center[k] + 0.25f * center[4 + k];
+                out[rowFloats - 4 + k] = 0.75f * center[rowFloats - 4 + k] + 0.25f * center[rowFloats - 8 + k];
+            }
+            for (size_t i = 4; i + 4 < rowFloats; ++i) {
+                out[i] = 0.25f * center[i - 4] + 0.5f * center[i] + 0.25f * center[i + 4];
+            }
+        } else {
+            std::copy(center, center + rowFloats, out);
+        }
+    }
+}
+
+void DensitySplat::toneRows(size_t rowBegin, size_t rowEnd) {
+    const float exposure = m_params.exposure;
+    const float* __restrict accum = m_accum.data();
+    std::uint8_t* __restrict pixels = m_pixels.data();
+    for (size_t y = rowBegin; y < rowEnd; ++y) {
+        float rowMax = 0.0f;
+        for (size_t p = y * m_width; p < (y + 1) * m_width; ++p) {
+            const float density = accum[p * 4];
+            rowMax = std::max(rowMax, density);
+            // Reinhard: x / (1 + x), sem exp, e satura devagar como ele
+            const float exposed = exposure * density;
+            const float brightness = exposed / (1.0f + exposed);
+            // cor média do pixel; sem partículas a soma é zero e o pixel fica transparente
+            const float invDensity = 1.0f / std::max(density, 1e-6f);
+            pixels[p * 4]     = static_cast<std::uint8_t>(std::min(accum[p * 4 + 1] * invDensity, 255.0f));
+            pixels[p * 4 + 1] = static_cast<std::uint8_t>(std::min(accum[p * 4 + 2] * invDensity, 255.0f));
+            pixels[p * 4 + 2] = static_cast<std::uint8_t>(std::min(accum[p * 4 + 3] * invDensity, 255.0f));
+            pixels[p * 4 + 3] = static_cast<std::uint8_t>(brightness * 255.0f);
+        }
+        m_rowMax[y] = rowMax;
+    }
+}
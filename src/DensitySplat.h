@@ -0,0 +1,103 @@
+#pragma once
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Como as partículas aparecem na tela
+enum class RenderMode : std::uint8_t {
+    Auto = 0,   // partículas até o limite de contagem, densidade acima dele
+    Particles,  // cabeças e trilhas de cada partícula
+    Density,    // mapa de densidade em uma textura
+    Count
+};
+
+// Mapa de densidade para contagens em que cada partícula é menor que um pixel.
+// Cada partícula soma 1 (e a sua cor) no pixel em que cai. O tom é a curva de
+// Reinhard x / (1 + x), com x = exposição * densidade, na cor média do pixel, e
+// o resultado é uma imagem RGBA do tamanho da tela, enviada como uma textura
+// só. O custo depois da contagem depende da resolução, não de N.
+//
+// Em paralelo sem disputa nem atomics: as partículas são distribuídas por faixas
+// de linhas com um counting sort em blocos (histograma por bloco, soma de
+// prefixos, espalhamento), e cada faixa é acumulada por uma thread só. Blur e
+// tom rodam por linhas. O resultado não depende do número de threads.
+class DensitySplat {
+public:
+    struct Params {
+        float exposure = 0.6f;  // quanto uma partícula sozinha acende o pixel
+        int blurPasses = 1;     // passadas do blur binomial 3x3; 0 desliga
+        bool parallel = true;
+    };
+
+    struct Arrays {
+        const float* positions;     // x, y em coordenadas do mundo
+        const std::uint32_t* colors; // RGBA empacotado como em sf::Color::toInteger
+        size_t count;
+    };
+
+    struct Stats {
+        size_t width = 0;
+        size_t height = 0;
+        // região do mundo coberta pela imagem
+        float areaLeft = 0.0f;
+        float areaTop = 0.0f;
+        float areaWidth = 0.0f;
+        float areaHeight = 0.0f;
+        size_t splatted = 0;  // partículas que caíram dentro da imagem
+        float maxDensity = 0.0f;
+        size_t threads = 1;
+    };
+
+    static const char* modeName(RenderMode mode);
+
+    // Resolução da imagem e a região do mundo esticada sobre ela (o mundo todo ou
+    // só o que a câmera mostra)
+    void resize(size_t width, size_t height, float areaLeft, float areaTop, float areaWidth, float areaHeight);
+
+    void render(const Arrays& arrays, ThreadPool& pool);
+
+    // RGBA, width * height * 4 bytes, pronto para sf::Texture::update
+    const std::uint8_t* pixels() const { return m_pixels.data(); }
+    std::uint64_t getVersion() const { return m_version; }
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void accumulateBand(size_t band);
+    void blurRows(const std::vector<float>& source, std::vector<float>& target, size_t rowBegin, size_t rowEnd,
+                  bool vertical);
+    void toneRows(size_t rowBegin, size_t rowEnd);
+
+    static constexpr std::uint32_t OUTSIDE = ~std::uint32_t(0);
+
+    Params m_params;
+    Stats m_stats;
+    size_t m_width = 0;
+    size_t m_height = 0;
+    float m_areaLeft = 0.0f;
+    float m_areaTop = 0.0f;
+    float m_areaWidth = 0.0f;
+    float m_areaHeight = 0.0f;
+    float m_scaleX = 1.0f;
+    float m_scaleY = 1.0f;
+    size_t m_bandRows = 1;
+    size_t m_bandCount = 0;
+    std::uint64_t m_version = 0;
+
+    // por partícula: pixel (ou OUTSIDE) e faixa; depois, ordenados por faixa
+    std::vector<std::uint32_t> m_pixelOf;
+    std::vector<std::uint32_t> m_sortedPixel;
+    std::vector<std::uint32_t> m_sortedColor;
+    // histograma de faixas por bloco de partículas, virando deslocamentos
+    std::vector<size_t> m_blockOffsets;
+    std::vector<size_t> m_bandStart;
+
+    // acumuladores por pixel: densidade e soma das cores (4 floats por pixel)
+    std::vector<float> m_accum;
+    std::vector<float> m_scratch;
+    std::vector<std::uint8_t> m_pixels;
+    std::vector<float> m_rowMax;
+};
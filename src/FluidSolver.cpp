@@ -0,0 +1,262 @@
+#include "FluidSolver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float PI = 3.14159265358979f;
+    // somas em lanes independentes: a ordem é fixa e o compilador vetoriza
+    constexpr size_t LANES = 8;
+    // blocos de partículas na cópia para a ordem das células
+    constexpr size_t GATHER_GRAIN = 4096;
+    // abaixo disto a distância entra como este valor (só divide; o termo já é zero)
+    constexpr float MIN_DISTANCE_SQ = 1e-8f;
+
+    // Densidade de uma malha hexagonal de espaçamento spacing somada pelo próprio
+    // kernel: é o repouso de um líquido em que os discos se encostam
+    float latticeDensity(float h, float spacing, float mass, float poly6) {
+        const float h2 = h * h;
+        const int reach = static_cast<int>(std::ceil(h / spacing)) + 1;
+        const float rowHeight = spacing * 0.8660254f;
+        float density = 0.0f;
+        for (int j = -2 * reach; j <= 2 * reach; ++j) {
+            const float y = static_cast<float>(j) * rowHeight;
+            const float offset = (j & 1) ? 0.5f * spacing : 0.0f;
+            for (int i = -reach - 1; i <= reach + 1; ++i) {
+                const float x = static_cast<float>(i) * spacing + offset;
+                const float t = std::max(h2 - (x * x + y * y), 0.0f);
+                density += mass * poly6 * t * t * t;
+            }
+        }
+        return density;
+    }
+
+    // Soma do poly6 (sem a constante) de todos em [begin, end) em volta de (xi, yi)
+    float densitySum(float xi, float yi, float h2, const float* __restrict x, const float* __restrict y,
+                     const float* __restrict mass, size_t begin, size_t end) {
+        float lanes[LANES] = {};
+        size_t j = begin;
+        for (; j + LANES <= end; j += LANES) {
+            for (size_t k = 0; k < LANES; ++k) {
+                const float dx = xi - x[j + k];
+                const float dy = yi - y[j + k];
+                const float t = std::max(h2 - (dx * dx + dy * dy), 0.0f);
+                lanes[k] += mass[j + k] * t * t * t;
+            }
+        }
+        float sum = 0.0f;
+        for (; j < end; ++j) {
+            const float dx = xi - x[j];
+            const float dy = yi - y[j];
+            const float t = std::max(h2 - (dx * dx + dy * dy), 0.0f);
+            sum += mass[j] * t * t * t;
+        }
+        for (size_t k = 0; k < LANES; ++k) {
+            sum += lanes[k];
+        }
+        return sum;
+    }
+
+    struct ForceInputs {
+        const float* __restrict x;
+        const float* __restrict y;
+        const float* __restrict vx;
+        const float* __restrict vy;
+        const float* __restrict mass;
+        const float* __restrict pressure;
+        const float* __restrict invDensity;
+    };
+
+    // Soma da pressão (sem a constante do gradiente) e da viscosidade (sem a do
+    // laplaciano) sobre [begin, end); pressureX/Y e viscX/Y recebem os totais
+    void forceSum(float xi, float yi, float vxi, float vyi, float pi, float h, const ForceInputs& in,
+                  size_t begin, size_t end, float& pressureX, float& pressureY, float& viscX, float& viscY) {
+        float px[LANES] = {}, py[LANES] = {}, qx[LANES] = {}, qy[LANES] = {};
+        auto term = [&](size_t j, float& outPX, float& outPY, float& outVX, float& outVY) {
+            const float dx = xi - in.x[j];
+            const float dy = yi - in.y[j];
+            const float r = std::sqrt(std::max(dx * dx + dy * dy, MIN_DISTANCE_SQ));
+            const float q = std::max(h - r, 0.0f);
+            const float push = in.mass[j] * (pi + in.pressure[j]) * q * q / r;
+            const float drag = in.mass[j] * in.invDensity[j] * q;
+            outPX += push * dx;
+            outPY += push * dy;
+            outVX += drag * (in.vx[j] - vxi);
+            outVY += drag * (in.vy[j] - vyi);
+        };
+        size_t j = begin;
+        for (; j + LANES <= end; j += LANES) {
+            for (size_t k = 0; k < LANES; ++k) {
+                term(j + k, px[k], py[k], qx[k], qy[k]);
+            }
+        }
+        float sumPX = 0.0f, sumPY = 0.0f, sumVX = 0.0f, sumVY = 0.0f;
+        for (; j < end; ++j) {
+            term(j, sumPX, sumPY, sumVX, sumVY);
+        }
+        for (size_t k = 0; k < LANES; ++k) {
+            sumPX += px[k];
+            sumPY += py[k];
+            sumVX += qx[k];
+            sumVY += qy[k];
+        }
+        pressureX += sumPX;
+        pressureY += sumPY;
+        viscX += sumVX;
+        viscY += sumVY;
+    }
+
+    // Faixa contínua de sorted com as células x0..x1 da linha row
+    inline void rowRange(const SpatialGrid::CellIndex& index, size_t row, size_t x0, size_t x1, size_t& begin,
+                         size_t& end) {
+        begin = index.cellStart[row * index.cellsX + x0];
+        end = index.cellStart[row * index.cellsX + x1 + 1];
+    }
+}
+
+void FluidSolver::computeAccelerations(const Arrays& arrays, SpatialGrid& grid, ThreadPool& pool) {
+    const size_t count = arrays.count;
+    m_stats = Stats();
+    if (count == 0) return;
+
+    float radiusSum = 0.0f;
+    float massSum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        radiusSum += arrays.radii[i];
+        massSum += arrays.masses[i];
+    }
+    const float meanRadius = radiusSum / static_cast<float>(count);
+    const float meanMass = massSum / static_cast<float>(count);
+
+    m_h = std::max(m_params.smoothingRatio * meanRadius, 1.0f);
+    m_h2 = m_h * m_h;
+    const float h5 = m_h2 * m_h2 * m_h;
+    m_poly6 = 4.0f / (PI * h5 * m_h2 * m_h);
+    m_spikyGrad = 30.0f / (PI * h5);
+    m_viscLaplacian = 40.0f / (PI * h5);
+    m_restDensity = latticeDensity(m_h, 2.0f * meanRadius, meanMass, m_poly6);
+    m_stiffness = m_params.soundSpeed * m_params.soundSpeed;
+
+    const SpatialGrid::CellIndex index = grid.indexCells(arrays.positions, count, m_h);
+    const size_t threadCount = m_params.parallel ? pool.getThreadCount() : 1;
+    auto forRange = [&](size_t total, size_t grain, const ThreadPool::Body& body) {
+        if (m_params.parallel) {
+            pool.parallelFor(total, grain, body);
+        } else {
+            body(0, total);
+        }
+    };
+    const size_t rows = index.cellsY;
+    const size_t rowGrain = std::max<size_t>(1, rows / (threadCount * 4));
+
+    m_x.resize(count);
+    m_y.resize(count);
+    m_vx.resize(count);
+    m_vy.resize(count);
+    m_mass.resize(count);
+    m_density.resize(count);
+    m_invDensity.resize(count);
+    m_pressure.resize(count);
+    m_ax.resize(count);
+    m_ay.resize(count);
+
+    forRange(count, GATHER_GRAIN, [&](size_t begin, size_t end) {
+        gather(arrays, index.sorted, begin, end);
+    });
+    forRange(rows, rowGrain, [&](size_t begin, size_t end) {
+        densityRows(index, begin, end);
+    });
+    forRange(rows, rowGrain, [&](size_t begin, size_t end) {
+        forceRows(index, begin, end);
+    });
+
+    float* __restrict accelerations = arrays.accelerations;
+    forRange(count, GATHER_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            const std::uint32_t i = index.sorted[s];
+            accelerations[i * 2] += m_ax[s];
+            accelerations[i * 2 + 1] += m_ay[s];
+        }
+    });
+
+    float maxDensity = 0.0f;
+    float totalDensity = 0.0f;
+    for (size_t s = 0; s < count; ++s) {
+        maxDensity = std::max(maxDensity, m_density[s]);
+        totalDensity += m_density[s];
+    }
+    m_stats.smoothingLength = m_h;
+    m_stats.restDensity = m_restDensity;
+    m_stats.maxDensityRatio = maxDensity / m_restDensity;
+    m_stats.meanDensityRatio = totalDensity / (static_cast<float>(count) * m_restDensity);
+    m_stats.cells = index.cellsX * index.cellsY;
+    m_stats.threads = threadCount;
+}
+
+int FluidSolver::requiredSubsteps(float deltaTime) const {
+    if (m_h <= 0.0f) return 1;
+    const float needed = std::ceil(deltaTime * m_params.soundSpeed / (ACOUSTIC_COURANT * m_h));
+    return static_cast<int>(std::max(needed, 1.0f));
+}
+
+void FluidSolver::gather(const Arrays& arrays, const std::uint32_t* sorted, size_t begin, size_t end) {
+    for (size_t s = begin; s < end; ++s) {
+        const std::uint32_t i = sorted[s];
+        m_x[s] = arrays.positions[i * 2];
+        m_y[s] = arrays.positions[i * 2 + 1];
+        m_vx[s] = arrays.velocities[i * 2];
+        m_vy[s] = arrays.velocities[i * 2 + 1];
+        m_mass[s] = arrays.masses[i];
+    }
+}
+
+void FluidSolver::densityRows(const SpatialGrid::CellIndex& index, size_t rowBegin, size_t rowEnd) {
+    for (size_t cy = rowBegin; cy < rowEnd; ++cy) {
+        const size_t y0 = cy > 0 ? cy - 1 : 0;
+        const size_t y1 = std::min(cy + 1, index.cellsY - 1);
+        for (size_t cx = 0; cx < index.cellsX; ++cx) {
+            const size_t cell = cy * index.cellsX + cx;
+            const size_t x0 = cx > 0 ? cx - 1 : 0;
+            const size_t x1 = std::min(cx + 1, index.cellsX - 1);
+            for (size_t s = index.cellStart[cell]; s < index.cellStart[cell + 1]; ++s) {
+                float sum = 0.0f;
+                for (size_t row = y0; row <= y1; ++row) {
+                    size_t begin, end;
+                    rowRange(index, row, x0, x1, begin, end);
+                    sum += densitySum(m_x[s], m_y[s], m_h2, m_x.data(), m_y.data(), m_mass.data(), begin, end);
+                }
+                const float density = m_poly6 * sum;
+                // sem pressão negativa: a superfície não puxa (evita os aglomerados da instabilidade de tração)
+                const float pressure = m_stiffness * std::max(density - m_restDensity, 0.0f);
+                m_density[s] = density;
+                m_invDensity[s] = 1.0f / density;
+                m_pressure[s] = pressure / (density * density);
+            }
+        }
+    }
+}
+
+void FluidSolver::forceRows(const SpatialGrid::CellIndex& index, size_t rowBegin, size_t rowEnd) {
+    const ForceInputs inputs{m_x.data(), m_y.data(), m_vx.data(), m_vy.data(), m_mass.data(), m_pressure.data(),
+                             m_invDensity.data()};
+    const float viscosity = m_params.viscosity * m_viscLaplacian;
+    for (size_t cy = rowBegin; cy < rowEnd; ++cy) {
+        const size_t y0 = cy > 0 ? cy - 1 : 0;
+        const size_t y1 = std::min(cy + 1, index.cellsY - 1);
+        for (size_t cx = 0; cx < index.cellsX; ++cx) {
+            const size_t cell = cy * index.cellsX + cx;
+            const size_t x0 = cx > 0 ? cx - 1 : 0;
+            const size_t x1 = std::min(cx + 1, index.cellsX - 1);
+            for (size_t s = index.cellStart[cell]; s < index.cellStart[cell + 1]; ++s) {
+                float pressureX = 0.0f, pressureY = 0.0f, viscX = 0.0f, viscY = 0.0f;
+                for (size_t row = y0; row <= y1; ++row) {
+                    size_t begin, end;
+                    rowRange(index, row, x0, x1, begin, end);
+                    forceSum(m_x[s], m_y[s], m_vx[s], m_vy[s], m_pressure[s], m_h, inputs, begin, end, pressureX,
+                             pressureY, viscX, viscY);
+                }
+                m_ax[s] = m_spikyGrad * pressureX + viscosity * viscX;
+                m_ay[s] = m_spikyGrad * pressureY + viscosity * viscY;
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <vector>
+
+// Modo fluido: hidrodinâmica de partículas suavizadas (SPH) sobre o SoA, no
+// lugar das colisões de disco. Cada passo calcula a densidade de cada partícula
+// (kernel poly6), a pressão que sai dela e, numa segunda passada, a aceleração de
+// pressão (gradiente do kernel spiky, na forma simétrica que conserva momento)
+// e de viscosidade (laplaciano do kernel de viscosidade).
+//
+// A vizinhança vem do índice por célula da SpatialGrid com célula do tamanho do
+// raio de suavização h. As partículas são copiadas na ordem das células, então
+// as 3x3 células em volta de uma célula são três faixas contínuas dos arrays, e
+// o laço interno é uma soma sem desvios sobre essas faixas, em lanes fixas que o
+// compilador vetoriza. Cada partícula só escreve a própria densidade e a própria
+// aceleração, então as linhas de células rodam em paralelo no ThreadPool e o
+// resultado não depende do número de threads.
+class FluidSolver {
+public:
+    struct Params {
+        float smoothingRatio = 4.0f;  // h em raios médios
+        float soundSpeed = 800.0f;    // px/s; a rigidez da pressão é c²
+        float viscosity = 600.0f;     // viscosidade cinemática, px²/s
+        bool parallel = true;
+    };
+
+    struct Arrays {
+        const float* positions;
+        const float* velocities;
+        const float* masses;
+        const float* radii;
+        float* accelerations;  // recebe a soma; quem chama zera antes se precisar
+        size_t count;
+    };
+
+    struct Stats {
+        float smoothingLength = 0.0f;
+        float restDensity = 0.0f;
+        float maxDensityRatio = 0.0f;   // maior densidade / densidade de repouso
+        float meanDensityRatio = 0.0f;
+        size_t cells = 0;
+        size_t threads = 1;
+    };
+
+    // Fração de h que o som pode andar por passo (CFL acústico)
+    static constexpr float ACOUSTIC_COURANT = 0.4f;
+
+    void computeAccelerations(const Arrays& arrays, SpatialGrid& grid, ThreadPool& pool);
+
+    // Subpassos para que o som não ande mais que ACOUSTIC_COURANT * h em cada um.
+    // Usa o h do último passo; antes do primeiro, 1.
+    int requiredSubsteps(float deltaTime) const;
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void gather(const Arrays& arrays, const std::uint32_t* sorted, size_t begin, size_t end);
+    void densityRows(const SpatialGrid::CellIndex& index, size_t rowBegin, size_t rowEnd);
+    void forceRows(const SpatialGrid::CellIndex& index, size_t rowBegin, size_t rowEnd);
+
+    Params m_params;
+    Stats m_stats;
+
+    // constantes dos kernels 2D para o h do passo
+    float m_h = 0.0f;
+    float m_h2 = 0.0f;
+    float m_poly6 = 0.0f;
+    float m_spikyGrad = 0.0f;
+    float m_viscLaplacian = 0.0f;
+    float m_restDensity = 0.0f;
+    float m_stiffness = 0.0f;
+
+    // na ordem das células
+    std::vector<float> m_x, m_y, m_vx, m_vy, m_mass;
+    std::vector<float> m_density;
+    std::vector<float> m_invDensity;
+    std::vector<float> m_pressure;  // p / rho²
+    std::vector<float> m_ax, m_ay;
+};
@@ -0,0 +1,258 @@
+#include "ForceField.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float MIN_MASS = 1.0f;
+    constexpr float MIN_DISTANCE = 0.01f;
+    constexpr float TWO_PI = 6.28318531f;
+    constexpr float PI = 3.14159265f;
+    constexpr float HALF_PI = 1.57079633f;
+
+    // Seno polinomial (erro < 2e-4) que vetoriza, ao contrário de std::sin
+    inline float fastSin(float x) {
+        const float turns = x * (1.0f / TWO_PI);
+        const float rounded = static_cast<float>(static_cast<int>(turns + ((turns >= 0.0f) ? 0.5f : -0.5f)));
+        float r = x - rounded * TWO_PI; // [-pi, pi]
+        const float upper = PI - r;
+        const float lower = -PI - r;
+        r = (r > HALF_PI) ? upper : ((r < -HALF_PI) ? lower : r); // [-pi/2, pi/2]
+        const float r2 = r * r;
+        return r * (1.0f + r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f + r2 * (-1.0f / 5040.0f))));
+    }
+
+    inline float latticeValue(std::int32_t ix, std::int32_t iy, std::uint32_t seed) {
+        std::uint32_t h = static_cast<std::uint32_t>(ix) * 0x8da6b343u ^ static_cast<std::uint32_t>(iy) * 0xd8163841u ^ seed;
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        return static_cast<float>(h & 0xFFFFu) * (2.0f / 65535.0f) - 1.0f;
+    }
+
+    // Ruído de valor suavizado em [-1, 1]
+    inline float valueNoise(float u, float v, std::uint32_t seed) {
+        std::int32_t ix = static_cast<std::int32_t>(u);
+        std::int32_t iy = static_cast<std::int32_t>(v);
+        ix -= (u < static_cast<float>(ix)) ? 1 : 0;
+        iy -= (v < static_cast<float>(iy)) ? 1 : 0;
+        const float fx = u - static_cast<float>(ix);
+        const float fy = v - static_cast<float>(iy);
+        const float sx = fx * fx * (3.0f - 2.0f * fx);
+        const float sy = fy * fy * (3.0f - 2.0f * fy);
+
+        const float a = latticeValue(ix, iy, seed);
+        const float b = latticeValue(ix + 1, iy, seed);
+        const float c = latticeValue(ix, iy + 1, seed);
+        const float d = latticeValue(ix + 1, iy + 1, seed);
+        const float top = a + (b - a) * sx;
+        const float bottom = c + (d - c) * sx;
+        return top + (bottom - top) * sy;
+    }
+
+    // Parte radial comum: direção normalizada até o centro, queda (1 - d/R)^2 e máscara de alcance
+    struct Radial {
+        float nx, ny, distance, falloff, mask;
+    };
+
+    inline Radial radial(const ForceField& field, float px, float py) {
+        Radial r;
+        const float dx = field.x - px;
+        const float dy = field.y - py;
+        r.distance = std::sqrt(dx * dx + dy * dy);
+        const float invDistance = 1.0f / std::max(r.distance, MIN_DISTANCE);
+        r.nx = dx * invDistance;
+        r.ny = dy * invDistance;
+        const float normalized = std::min(1.0f, r.distance / field.radius);
+        r.falloff = (1.0f - normalized) * (1.0f - normalized);
+        r.mask = (r.distance < field.radius && r.distance > MIN_DISTANCE) ? 1.0f : 0.0f;
+        return r;
+    }
+
+    void applyPointAttractors(const std::vector<ForceField>& fields, const float* __restrict positions,
+                              const float* __restrict masses, size_t count,
+                              float* __restrict ax, float* __restrict ay) {
+        for (const ForceField& field : fields) {
+            for (size_t i = 0; i < count; ++i) {
+                const Radial r = radial(field, positions[i * 2], positions[i * 2 + 1]);
+                const float magnitude = field.strength * r.falloff * r.mask / std::max(masses[i], MIN_MASS);
+                ax[i] += r.nx * magnitude;
+                ay[i] += r.ny * magnitude;
+            }
+        }
+    }
+
+    void applyVortices(const std::vector<ForceField>& fields, const float* __restrict positions,
+                       const float* __restrict masses, size_t count,
+                       float* __restrict ax, float* __restrict ay) {
+        for (const ForceField& field : fields) {
+            const float invOrbit = 1.0f / field.innerRadius;
+            for (size_t i = 0; i < count; ++i) {
+                const Radial r = radial(field, positions[i * 2], positions[i * 2 + 1]);
+                const float magnitude = field.strength * r.falloff * r.mask / std::max(masses[i], MIN_MASS);
+
+                // fora da órbita puxa para dentro; dentro empurra para fora e o giro é máximo
+                const bool outside = r.distance > field.innerRadius;
+                const float pull = magnitude * 2.0f;
+                const float push = -magnitude * (1.0f - r.distance * invOrbit) * 0.5f;
+                const float spin = magnitude * 0.5f;
+                const float radialPart = outside ? pull : push;
+                const float tangentialPart = outside ? spin : pull;
+
+                // tangente = (-ny, nx)
+                ax[i] += r.nx * radialPart - r.ny * tangentialPart;
+                ay[i] += r.ny * radialPart + r.nx * tangentialPart;
+            }
+        }
+    }
+
+    void applyWaves(const std::vector<ForceField>& fields, const float* __restrict positions,
+                    const float* __restrict masses, size_t count, double time,
+                    float* __restrict ax, float* __restrict ay) {
+        for (const ForceField& field : fields) {
+            // fase reduzida em double: o float não perde precisão com o tempo de execução
+            const float phase = static_cast<float>(std::fmod(field.speed * time, static_cast<double>(TWO_PI)));
+            for (size_t i = 0; i < count; ++i) {
+                const Radial r = radial(field, positions[i * 2], positions[i * 2 + 1]);
+                const float pulse = fastSin(phase - r.distance * field.frequency);
+                const float magnitude = field.strength * r.falloff * r.mask * pulse / std::max(masses[i], MIN_MASS);
+                ax[i] += r.nx * magnitude;
+                ay[i] += r.ny * magnitude;
+            }
+        }
+    }
+
+    void applyLines(const std::vector<ForceField>& fields, const float* __restrict positions,
+                    const float* __restrict masses, size_t count,
+                    float* __restrict ax, float* __restrict ay) {
+        for (const ForceField& field : fields) {
+            const float invRange = 1.0f / field.radius;
+            for (size_t i = 0; i < count; ++i) {
+                // distância com sinal até a linha, ao longo da normal
+                const float offset = (positions[i * 2] - field.x) * field.dirX + (positions[i * 2 + 1] - field.y) * field.dirY;
+                const float falloff = std::max(0.0f, 1.0f - std::abs(offset) * invRange);
+                const float toward = (offset > 0.0f) ? -1.0f : 1.0f;
+                // a linha é um segmento: só age até radius do ponto (x, y), como o modo linha do mouse
+                const float mask = radial(field, positions[i * 2], positions[i * 2 + 1]).mask;
+                const float magnitude = toward * field.strength * falloff * mask / std::max(masses[i], MIN_MASS);
+                ax[i] += field.dirX * magnitude;
+                ay[i] += field.dirY * magnitude;
+            }
+        }
+    }
+
+    void applyUniforms(const std::vector<ForceField>& fields, const float* __restrict masses, size_t count,
+                       float* __restrict ax, float* __restrict ay) {
+        for (const ForceField& field : fields) {
+            const float fx = field.dirX * field.strength;
+            const float fy = field.dirY * field.strength;
+            for (size_t i = 0; i < count; ++i) {
+                const float invMass = 1.0f / std::max(masses[i], MIN_MASS);
+                ax[i] += fx * invMass;
+                ay[i] += fy * invMass;
+            }
+        }
+    }
+
+    void applyNoise(const std::vector<ForceField>& fields, const float* __restrict positions,
+                    const float* __restrict masses, size_t count, double time,
+                    float* __restrict ax, float* __restrict ay) {
+        const std::uint32_t SEED_X = 0x9e3779b9u;
+        const std::uint32_t SEED_Y = 0x7f4a7c15u;
+        for (const ForceField& field : fields) {
+            // rolagem limitada para não perder precisão nas coordenadas da rede
+            const float scroll = static_cast<float>(std::fmod(field.speed * time, 4096.0));
+            for (size_t i = 0; i < count; ++i) {
+                const float u = positions[i * 2] * field.frequency + scroll;
+                const float v = positions[i * 2 + 1] * field.frequency + scroll * 0.7f;
+                const float magnitude = field.strength / std::max(masses[i], MIN_MASS);
+                ax[i] += valueNoise(u, v, SEED_X) * magnitude;
+                ay[i] += valueNoise(u, v, SEED_Y) * magnitude;
+            }
+        }
+    }
+}
+
+ForceField ForceField::pointAttractor(float x, float y, float strength, float radius) {
+    ForceField field;
+    field.type = ForceFieldType::PointAttractor;
+    field.x = x;
+    field.y = y;
+    field.strength = strength;
+    field.radius = radius;
+    return field;
+}
+
+ForceField ForceField::vortex(float x, float y, float strength, float radius, float orbitRadius) {
+    ForceField field = pointAttractor(x, y, strength, radius);
+    field.type = ForceFieldType::Vortex;
+    field.innerRadius = orbitRadius;
+    return field;
+}
+
+ForceField ForceField::wave(float x, float y, float strength, float radius, float wavenumber, float angularSpeed) {
+    ForceField field = pointAttractor(x, y, strength, radius);
+    field.type = ForceFieldType::Wave;
+    field.frequency = wavenumber;
+    field.speed = angularSpeed;
+    return field;
+}
+
+ForceField ForceField::line(float x, float y, float normalX, float normalY, float strength, float range) {
+    ForceField field = pointAttractor(x, y, strength, range);
+    field.type = ForceFieldType::Line;
+    const float length = std::sqrt(normalX * normalX + normalY * normalY);
+    field.dirX = (length > 0.0f) ? normalX / length : 1.0f;
+    field.dirY = (length > 0.0f) ? normalY / length : 0.0f;
+    return field;
+}
+
+ForceField ForceField::uniform(float dirX, float dirY, float strength) {
+    ForceField field;
+    field.type = ForceFieldType::Uniform;
+    field.dirX = dirX;
+    field.dirY = dirY;
+    field.strength = strength;
+    return field;
+}
+
+ForceField ForceField::noise(float strength, float cellSize, float cellsPerSecond) {
+    ForceField field;
+    field.type = ForceFieldType::Noise;
+    field.strength = strength;
+    field.frequency = 1.0f / std::max(cellSize, 1.0f);
+    field.speed = cellsPerSecond;
+    return field;
+}
+
+void ForceFieldSet::add(const ForceField& field) {
+    if (field.type >= ForceFieldType::Count) return;
+    m_byType[static_cast<size_t>(field.type)].push_back(field);
+    ++m_count;
+}
+
+void ForceFieldSet::clear() {
+    for (auto& fields : m_byType) {
+        fields.clear();
+    }
+    m_count = 0;
+}
+
+std::vector<ForceField> ForceFieldSet::list() const {
+    std::vector<ForceField> all;
+    all.reserve(m_count);
+    for (const auto& fields : m_byType) {
+        all.insert(all.end(), fields.begin(), fields.end());
+    }
+    return all;
+}
+
+void ForceFieldSet::accumulate(const float* positions, const float* masses, size_t count, double time,
+                               float* ax, float* ay) const {
+    using T = ForceFieldType;
+    applyPointAttractors(m_byType[size_t(T::PointAttractor)], positions, masses, count, ax, ay);
+    applyVortices(m_byType[size_t(T::Vortex)], positions, masses, count, ax, ay);
+    applyWaves(m_byType[size_t(T::Wave)], positions, masses, count, time, ax, ay);
+    applyLines(m_byType[size_t(T::Line)], positions, masses, count, ax, ay);
+    applyUniforms(m_byType[size_t(T::Uniform)], masses, count, ax, ay);
+    applyNoise(m_byType[size_t(T::Noise)], positions, masses, count, time, ax, ay);
+}
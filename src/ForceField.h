@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class ForceFieldType : std::uint8_t {
+    PointAttractor = 0,
+    Vortex,
+    Wave,
+    Line,
+    Uniform,
+    Noise,
+    Count
+};
+
+// Um campo de força da cena. Todos os tipos usam a mesma estrutura; cada um lê
+// só os parâmetros que fazem sentido para ele. A força é dividida pela massa
+// (mínimo 1), como a força do mouse sempre foi.
+struct ForceField {
+    ForceFieldType type = ForceFieldType::PointAttractor;
+    float x = 0.0f;             // centro (ou um ponto da linha)
+    float y = 0.0f;
+    float strength = 0.0f;      // positivo atrai (uniforme/ruído: intensidade)
+    float radius = 800.0f;      // alcance (linha: até o ponto e até a linha); uniforme e ruído valem no mundo todo
+    float innerRadius = 60.0f;  // vórtice: raio da órbita estável
+    float dirX = 1.0f;          // uniforme: direção; linha: normal
+    float dirY = 0.0f;
+    float frequency = 0.05f;    // onda: rad/px; ruído: 1 / tamanho da célula
+    float speed = 3.0f;         // onda: rad/s; ruído: células/s
+
+    static ForceField pointAttractor(float x, float y, float strength, float radius);
+    static ForceField vortex(float x, float y, float strength, float radius, float orbitRadius);
+    static ForceField wave(float x, float y, float strength, float radius, float wavenumber, float angularSpeed);
+    static ForceField line(float x, float y, float normalX, float normalY, float strength, float range);
+    static ForceField uniform(float dirX, float dirY, float strength);
+    static ForceField noise(float strength, float cellSize, float cellsPerSecond);
+};
+
+// Lista de campos agrupada por tipo. A avaliação roda um laço sem desvios por
+// campo sobre um bloco de partículas, então não há chamada virtual nem switch
+// por partícula e cada laço vetoriza.
+class ForceFieldSet {
+public:
+    // Tamanho do bloco que o passo fundido entrega a accumulate (cabe no L1)
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    void add(const ForceField& field);
+    void clear();
+    bool empty() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+
+    // Todos os campos, agrupados por tipo
+    std::vector<ForceField> list() const;
+
+    // Soma em ax/ay a aceleração de todos os campos sobre count partículas.
+    // time é o tempo simulado em segundos (fase das ondas, rolagem do ruído).
+    void accumulate(const float* positions, const float* masses, size_t count, double time,
+                    float* ax, float* ay) const;
+
+private:
+    std::vector<ForceField> m_byType[static_cast<size_t>(ForceFieldType::Count)];
+    size_t m_count = 0;
+};
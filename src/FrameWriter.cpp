@@ -0,0 +1,194 @@
+#include "FrameWriter.h"
+#include <SFML/Graphics.hpp>
+#include <cctype>
+#include <iostream>
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    bool endsWith(const std::string& text, const char* suffix) {
+        const std::string tail(suffix);
+        return text.size() >= tail.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+    }
+
+    // Posição e largura do único "%d" / "%05d" do padrão; false se não houver exatamente um
+    bool parsePattern(const std::string& pattern, size_t& at, size_t& length, int& width) {
+        at = pattern.find('%');
+        if (at == std::string::npos || pattern.find('%', at + 1) != std::string::npos) return false;
+        size_t cursor = at + 1;
+        width = 0;
+        while (cursor < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[cursor]))) {
+            width = width * 10 + (pattern[cursor] - '0');
+            ++cursor;
+        }
+        if (cursor >= pattern.size() || pattern[cursor] != 'd' || width > 20) return false;
+        length = cursor + 1 - at;
+        return true;
+    }
+
+    std::string frameName(const std::string& pattern, std::uint64_t frame) {
+        size_t at, length;
+        int width;
+        parsePattern(pattern, at, length, width);
+        std::string number = std::to_string(frame);
+        if (number.size() < static_cast<size_t>(width)) {
+            number.insert(0, static_cast<size_t>(width) - number.size(), '0');
+        }
+        return pattern.substr(0, at) + number + pattern.substr(at + length);
+    }
+
+    bool writePpm(std::FILE* file, const std::uint8_t* rgba, unsigned width, unsigned height,
+                  std::vector<std::uint8_t>& rgb) {
+        rgb.resize(static_cast<size_t>(width) * height * 3);
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+            rgb[i * 3] = rgba[i * 4];
+            rgb[i * 3 + 1] = rgba[i * 4 + 1];
+            rgb[i * 3 + 2] = rgba[i * 4 + 2];
+        }
+        return std::fprintf(file, "P6\n%u %u\n255\n", width, height) > 0 &&
+               std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    }
+}
+
+FrameWriter::~FrameWriter() {
+    close();
+}
+
+const char* FrameWriter::formatName(Format format) {
+    switch (format) {
+        case Format::PngSequence: return "sequência PNG";
+        case Format::PpmSequence: return "sequência PPM";
+        case Format::PpmStream:   return "fluxo PPM";
+        case Format::RawStream:   break;
+    }
+    return "RGBA cru";
+}
+
+bool FrameWriter::open(const std::string& target) {
+    close();
+
+    size_t at, length;
+    int width;
+    if (target.find('%') != std::string::npos) {
+        if (!parsePattern(target, at, length, width)) {
+            std::cerr << "[ERRO] Padrão de quadros inválido (use um só %d, p.ex. frames/%05d.png): " << target
+                      << std::endl;
+            return false;
+        }
+        if (endsWith(target, ".png")) {
+            m_format = Format::PngSequence;
+        } else if (endsWith(target, ".ppm")) {
+            m_format = Format::PpmSequence;
+        } else {
+            std::cerr << "[ERRO] Sequência de quadros precisa terminar em .png ou .ppm: " << target << std::endl;
+            return false;
+        }
+    } else {
+        m_format = endsWith(target, ".ppm") ? Format::PpmStream : Format::RawStream;
+        if (target == "-") {
+#if defined(_WIN32)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            m_stream = stdout;
+        } else {
+            m_stream = std::fopen(target.c_str(), "wb");
+            if (!m_stream) {
+                std::cerr << "[ERRO] Não foi possível abrir o destino dos quadros: " << target << std::endl;
+                return false;
+            }
+        }
+    }
+
+    m_target = target;
+    m_framesWritten = 0;
+    m_backFrame = 0;
+    m_failed = false;
+    m_backReady = false;
+    m_stopping = false;
+    m_thread = std::thread(&FrameWriter::ioLoop, this);
+    return true;
+}
+
+void FrameWriter::close() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    if (m_stream == stdout) {
+        std::fflush(stdout);
+    } else if (m_stream) {
+        std::fclose(m_stream);
+    }
+    m_stream = nullptr;
+}
+
+void FrameWriter::write(const std::uint8_t* rgba, unsigned width, unsigned height) {
+    if (!m_thread.joinable()) return;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_backReady; });
+    if (m_failed) return;
+    m_back.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+    m_backWidth = width;
+    m_backHeight = height;
+    m_backReady = true;
+    lock.unlock();
+    m_cv.notify_all();
+}
+
+void FrameWriter::ioLoop() {
+    std::vector<std::uint8_t> rgb;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_backReady || m_stopping; });
+            if (!m_backReady) return;
+        }
+
+        // m_back é exclusivo deste thread até m_backReady voltar a false
+        bool written = false;
+        switch (m_format) {
+            case Format::PngSequence: {
+                sf::Image image;
+                image.create(m_backWidth, m_backHeight, m_back.data());
+                written = image.saveToFile(frameName(m_target, m_backFrame));
+                break;
+            }
+            case Format::PpmSequence: {
+                const std::string name = frameName(m_target, m_backFrame);
+                std::FILE* file = std::fopen(name.c_str(), "wb");
+                written = file && writePpm(file, m_back.data(), m_backWidth, m_backHeight, rgb);
+                written = file && std::fclose(file) == 0 && written;
+                break;
+            }
+            case Format::PpmStream:
+                written = writePpm(m_stream, m_back.data(), m_backWidth, m_backHeight, rgb);
+                break;
+            case Format::RawStream:
+                written = std::fwrite(m_back.data(), 1, m_back.size(), m_stream) == m_back.size();
+                break;
+        }
+        if (!written) {
+            // pipe fechado ou disco cheio: para de gravar em vez de derrubar o replay
+            std::cerr << "[ERRO] Falha ao gravar o quadro " << m_backFrame << " em '" << m_target << "'"
+                      << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (written) {
+                ++m_framesWritten;
+                ++m_backFrame;
+            } else {
+                m_failed = true;
+            }
+            m_backReady = false;
+        }
+        m_cv.notify_all();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Grava os quadros RGBA do SoftwareRenderer. O destino escolhe o formato:
+//   "frames/%05d.png"  sequência de PNG (ou .ppm), numerada com printf
+//   "video.ppm"        PPMs concatenados num arquivo só (ffmpeg -f image2pipe)
+//   "-" ou outro nome  RGBA cru na saída padrão, num arquivo ou num FIFO
+//                      (ffmpeg -f rawvideo -pix_fmt rgba -s LxA)
+// A codificação e a escrita rodam num thread próprio sobre uma cópia do quadro;
+// quem desenha só espera se o quadro anterior ainda não saiu.
+class FrameWriter {
+public:
+    enum class Format : std::uint8_t {
+        PngSequence,
+        PpmSequence,
+        PpmStream,
+        RawStream,
+    };
+
+    FrameWriter() = default;
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    bool open(const std::string& target);
+    // Espera o último quadro e fecha o destino
+    void close();
+    bool isOpen() const { return m_thread.joinable(); }
+
+    void write(const std::uint8_t* rgba, unsigned width, unsigned height);
+
+    Format getFormat() const { return m_format; }
+    bool writesToStdout() const { return m_stream == stdout; }
+    std::uint64_t getFramesWritten() const { return m_framesWritten; }
+    bool hasFailed() const { return m_failed; }
+
+    static const char* formatName(Format format);
+
+private:
+    void ioLoop();
+
+    std::string m_target;
+    Format m_format = Format::RawStream;
+    std::FILE* m_stream = nullptr;
+    std::uint64_t m_framesWritten = 0;
+    bool m_failed = false;
+
+    // quadro de trás: pertence ao thread de I/O enquanto m_backReady for true
+    std::vector<std::uint8_t> m_back;
+    unsigned m_backWidth = 0;
+    unsigned m_backHeight = 0;
+    std::uint64_t m_backFrame = 0;
+    bool m_backReady = false;
+    bool m_stopping = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
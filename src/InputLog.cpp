@@ -0,0 +1,519 @@
+#include "InputLog.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    enum StepField : std::uint16_t {
+        FIELD_DT               = 1 << 0,
+        FIELD_FLAGS            = 1 << 1,
+        FIELD_GRAVITY          = 1 << 2,
+        FIELD_REPULSION        = 1 << 3,
+        FIELD_RESTITUTION      = 1 << 4,
+        FIELD_MOUSE_POSITION   = 1 << 5,
+        FIELD_MOUSE_STRENGTH   = 1 << 6,
+        FIELD_FORCE_MODE       = 1 << 7,
+        FIELD_SOLVER_ITERATIONS = 1 << 8,
+        FIELD_INTEGRATOR       = 1 << 9,
+        FIELD_ALL              = (1 << 10) - 1,
+    };
+
+    enum StepFlag : std::uint8_t {
+        FLAG_GRAVITY     = 1 << 0,
+        FLAG_REPULSION   = 1 << 1,
+        FLAG_COLLISIONS  = 1 << 2,
+        FLAG_MOUSE_FORCE = 1 << 3,
+        FLAG_ATTRACT     = 1 << 4,
+        FLAG_ADAPTIVE    = 1 << 5,
+        FLAG_FLUID       = 1 << 6,
+    };
+
+    std::uint8_t packFlags(const ParticleSystem::PhysicsInputState& in) {
+        std::uint8_t flags = 0;
+        if (in.gravityEnabled)        flags |= FLAG_GRAVITY;
+        if (in.repulsionEnabled)      flags |= FLAG_REPULSION;
+        if (in.collisionsEnabled)     flags |= FLAG_COLLISIONS;
+        if (in.mouseForceEnabled)     flags |= FLAG_MOUSE_FORCE;
+        if (in.mouseForceAttractMode) flags |= FLAG_ATTRACT;
+        if (in.adaptiveSubsteps)      flags |= FLAG_ADAPTIVE;
+        if (in.fluidEnabled)          flags |= FLAG_FLUID;
+        return flags;
+    }
+
+    void unpackFlags(std::uint8_t flags, ParticleSystem::PhysicsInputState& in) {
+        in.gravityEnabled        = (flags & FLAG_GRAVITY) != 0;
+        in.repulsionEnabled      = (flags & FLAG_REPULSION) != 0;
+        in.collisionsEnabled     = (flags & FLAG_COLLISIONS) != 0;
+        in.mouseForceEnabled     = (flags & FLAG_MOUSE_FORCE) != 0;
+        in.mouseForceAttractMode = (flags & FLAG_ATTRACT) != 0;
+        in.adaptiveSubsteps      = (flags & FLAG_ADAPTIVE) != 0;
+        in.fluidEnabled          = (flags & FLAG_FLUID) != 0;
+    }
+
+    template <typename T>
+    void writeValue(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+InputRecorder::~InputRecorder() {
+    close();
+}
+
+bool InputRecorder::open(const std::string& path, std::uint32_t seed, float width, float height,
+                         bool unbounded, BroadphaseType broadphase, float neighborSkin) {
+    close();
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        std::cerr << "[ERRO] Não foi possível criar o log de entrada: " << path << std::endl;
+        return false;
+    }
+
+    m_file.write(InputLog::MAGIC, sizeof(InputLog::MAGIC));
+    writeValue(m_file, InputLog::VERSION);
+    writeValue(m_file, seed);
+    writeValue(m_file, width);
+    writeValue(m_file, height);
+    const std::uint8_t worldFlags = unbounded ? InputLog::WORLD_UNBOUNDED : 0;
+    writeValue(m_file, worldFlags);
+    writeValue(m_file, static_cast<std::uint8_t>(broadphase));
+    writeValue(m_file, neighborSkin);
+
+    m_hasPrevious = false;
+    m_stepCount = 0;
+    return true;
+}
+
+void InputRecorder::close() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+void InputRecorder::recordStep(float dt, const ParticleSystem::PhysicsInputState& in) {
+    if (!m_file.is_open()) return;
+
+    const ParticleSystem::PhysicsInputState& prev = m_previous;
+    std::uint16_t mask = 0;
+    if (!m_hasPrevious) {
+        mask = FIELD_ALL;
+    } else {
+        if (dt != m_previousDt)                                        mask |= FIELD_DT;
+        if (packFlags(in) != packFlags(prev))                          mask |= FIELD_FLAGS;
+        if (in.gravitationalAcceleration != prev.gravitationalAcceleration) mask |= FIELD_GRAVITY;
+        if (in.repulsionStrength != prev.repulsionStrength)           mask |= FIELD_REPULSION;
+        if (in.collisionRestitution != prev.collisionRestitution)     mask |= FIELD_RESTITUTION;
+        if (in.mousePosition != prev.mousePosition)                   mask |= FIELD_MOUSE_POSITION;
+        if (in.mouseForceStrength != prev.mouseForceStrength)         mask |= FIELD_MOUSE_STRENGTH;
+        if (in.forceMode != prev.forceMode)                           mask |= FIELD_FORCE_MODE;
+        if (in.solverIterations != prev.solverIterations)             mask |= FIELD_SOLVER_ITERATIONS;
+        if (in.integrator != prev.integrator)                         mask |= FIELD_INTEGRATOR;
+    }
+
+    writeValue(m_file, InputLog::RecordType::Step);
+    writeValue(m_file, mask);
+    if (mask & FIELD_DT)             writeValue(m_file, dt);
+    if (mask & FIELD_FLAGS)          writeValue(m_file, packFlags(in));
+    if (mask & FIELD_GRAVITY)        writeValue(m_file, in.gravitationalAcceleration);
+    if (mask & FIELD_REPULSION)      writeValue(m_file, in.repulsionStrength);
+    if (mask & FIELD_RESTITUTION)    writeValue(m_file, in.collisionRestitution);
+    if (mask & FIELD_MOUSE_POSITION) {
+        writeValue(m_file, in.mousePosition.x);
+        writeValue(m_file, in.mousePosition.y);
+    }
+    if (mask & FIELD_MOUSE_STRENGTH) writeValue(m_file, in.mouseForceStrength);
+    if (mask & FIELD_FORCE_MODE)     writeValue(m_file, static_cast<std::uint8_t>(in.forceMode));
+    if (mask & FIELD_SOLVER_ITERATIONS) writeValue(m_file, static_cast<std::uint8_t>(in.solverIterations));
+    if (mask & FIELD_INTEGRATOR)     writeValue(m_file, in.integrator);
+
+    m_previous = in;
+    m_previousDt = dt;
+    m_hasPrevious = true;
+    ++m_stepCount;
+}
+
+void InputRecorder::recordSpawn(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity,
+                                const sf::Color& color, ParticleType type) {
+    if (!m_file.is_open()) return;
+
+    writeValue(m_file, InputLog::RecordType::Spawn);
+    writeValue(m_file, mass);
+    writeValue(m_file, position.x);
+    writeValue(m_file, position.y);
+    writeValue(m_file, velocity.x);
+    writeValue(m_file, velocity.y);
+    writeValue(m_file, color.r);
+    writeValue(m_file, color.g);
+    writeValue(m_file, color.b);
+    writeValue(m_file, color.a);
+    writeValue(m_file, static_cast<std::uint8_t>(type));
+}
+
+void InputRecorder::recordSpawnRandom(std::uint32_t count, float minMass, float maxMass, ParticleType type) {
+    if (!m_file.is_open()) return;
+
+    writeValue(m_file, InputLog::RecordType::SpawnRandom);
+    writeValue(m_file, count);
+    writeValue(m_file, minMass);
+    writeValue(m_file, maxMass);
+    writeValue(m_file, static_cast<std::uint8_t>(type));
+}
+
+void InputRecorder::recordClear() {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::Clear);
+}
+
+void InputRecorder::recordResize(float width, float height) {
+    if (!m_file.is_open()) return;
+
+    writeValue(m_file, InputLog::RecordType::Resize);
+    writeValue(m_file, width);
+    writeValue(m_file, height);
+}
+
+void InputRecorder::recordAddForceField(const ForceField& field) {
+    if (!m_file.is_open()) return;
+
+    writeValue(m_file, InputLog::RecordType::AddField);
+    writeValue(m_file, static_cast<std::uint8_t>(field.type));
+    for (float value : {field.x, field.y, field.strength, field.radius, field.innerRadius,
+                        field.dirX, field.dirY, field.frequency, field.speed}) {
+        writeValue(m_file, value);
+    }
+}
+
+void InputRecorder::recordClearForceFields() {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::ClearFields);
+}
+
+void InputRecorder::recordAddObstacle(const Obstacle& obstacle) {
+    if (!m_file.is_open()) return;
+
+    writeValue(m_file, InputLog::RecordType::AddObstacle);
+    writeValue(m_file, static_cast<std::uint8_t>(obstacle.type));
+    writeValue(m_file, obstacle.radius);
+    writeValue(m_file, static_cast<std::uint16_t>(obstacle.points.size() / 2));
+    for (float value : obstacle.points) {
+        writeValue(m_file, value);
+    }
+}
+
+void InputRecorder::recordClearObstacles() {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::ClearObstacles);
+}
+
+void InputRecorder::recordSpeciesPreset(SpeciesPreset preset) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::SetSpeciesPreset);
+    writeValue(m_file, static_cast<std::uint8_t>(preset));
+}
+
+void InputRecorder::recordAddBody(BodyShape shape, const sf::Vector2f& position) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::AddBody);
+    writeValue(m_file, static_cast<std::uint8_t>(shape));
+    writeValue(m_file, position.x);
+    writeValue(m_file, position.y);
+}
+
+void InputRecorder::recordDespawn(const sf::Vector2f& center, float radius) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::Despawn);
+    writeValue(m_file, center.x);
+    writeValue(m_file, center.y);
+    writeValue(m_file, radius);
+}
+
+void InputRecorder::recordBroadphase(BroadphaseType type) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::SetBroadphase);
+    writeValue(m_file, static_cast<std::uint8_t>(type));
+}
+
+void InputRecorder::recordNeighborSkin(float skin) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::SetNeighborSkin);
+    writeValue(m_file, skin);
+}
+
+void InputRecorder::recordLoadSnapshot(const Snapshot::View& view) {
+    if (!m_file.is_open()) return;
+    writeValue(m_file, InputLog::RecordType::LoadSnapshot);
+    writeValue(m_file, static_cast<std::uint64_t>(view.size()));
+    m_file.write(reinterpret_cast<const char*>(view.data()), static_cast<std::streamsize>(view.size()));
+}
+
+bool InputReplayer::open(const std::string& path) {
+    m_file.open(path, std::ios::binary | std::ios::ate);
+    if (!m_file) {
+        std::cerr << "[ERRO] Não foi possível abrir o log de entrada: " << path << std::endl;
+        return false;
+    }
+    m_fileSize = static_cast<std::uint64_t>(m_file.tellg());
+    m_file.seekg(0);
+
+    char magic[sizeof(InputLog::MAGIC)];
+    std::uint32_t version = 0;
+    if (!m_file.read(magic, sizeof(magic)) || std::memcmp(magic, InputLog::MAGIC, sizeof(magic)) != 0 ||
+        !readValue(m_file, version) || version < 1 || version > InputLog::VERSION) {
+        std::cerr << "[ERRO] Log de entrada inválido ou de versão incompatível: " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    // antes da versão 9 não havia flags do mundo: sempre fechado
+    std::uint8_t worldFlags = 0;
+    if (!readValue(m_file, m_seed) || !readValue(m_file, m_width) || !readValue(m_file, m_height) ||
+        (version >= InputLog::VERSION_WORLD_FLAGS && !readValue(m_file, worldFlags))) {
+        std::cerr << "[ERRO] Cabeçalho do log de entrada truncado: " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+    m_unbounded = (worldFlags & InputLog::WORLD_UNBOUNDED) != 0;
+
+    std::uint8_t broadphase = 0;
+    if (version >= InputLog::VERSION_PAIR_SETTINGS &&
+        (!readValue(m_file, broadphase) || !readValue(m_file, m_neighborSkin) ||
+         broadphase > static_cast<std::uint8_t>(BroadphaseType::Tiles))) {
+        std::cerr << "[ERRO] Cabeçalho do log de entrada truncado: " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+    m_broadphase = static_cast<BroadphaseType>(broadphase);
+    m_version = version;
+    return true;
+}
+
+bool InputReplayer::run(ParticleSystem& system, Stats& stats, const StepCallback& onStep) {
+    if (!m_file.is_open()) return false;
+
+    system.setRandomSeed(m_seed);
+    system.setUnbounded(m_unbounded);
+    if (hasPairSettings()) {
+        if (!m_overrides.broadphase) system.setBroadphase(m_broadphase);
+        if (!m_overrides.neighborSkin) system.setNeighborSkin(m_neighborSkin);
+    }
+    system.resetStepTimings();
+
+    ParticleSystem::PhysicsInputState inputs{};
+    float dt = 0.0f;
+    bool truncated = false;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    InputLog::RecordType type;
+    while (readValue(m_file, type)) {
+        switch (type) {
+            case InputLog::RecordType::Step: {
+                std::uint16_t mask = 0;
+                bool ok = readValue(m_file, mask);
+                if (ok && (mask & FIELD_DT))          ok = readValue(m_file, dt);
+                if (ok && (mask & FIELD_FLAGS)) {
+                    std::uint8_t flags = 0;
+                    ok = readValue(m_file, flags);
+                    unpackFlags(flags, inputs);
+                }
+                if (ok && (mask & FIELD_GRAVITY))     ok = readValue(m_file, inputs.gravitationalAcceleration);
+                if (ok && (mask & FIELD_REPULSION))   ok = readValue(m_file, inputs.repulsionStrength);
+                if (ok && (mask & FIELD_RESTITUTION)) ok = readValue(m_file, inputs.collisionRestitution);
+                if (ok && (mask & FIELD_MOUSE_POSITION)) {
+                    ok = readValue(m_file, inputs.mousePosition.x) && readValue(m_file, inputs.mousePosition.y);
+                }
+                if (ok && (mask & FIELD_MOUSE_STRENGTH)) ok = readValue(m_file, inputs.mouseForceStrength);
+                if (ok && (mask & FIELD_FORCE_MODE)) {
+                    std::uint8_t mode = 0;
+                    ok = readValue(m_file, mode);
+                    inputs.forceMode = mode;
+                }
+                if (ok && (mask & FIELD_SOLVER_ITERATIONS)) {
+                    std::uint8_t iterations = 0;
+                    ok = readValue(m_file, iterations);
+                    inputs.solverIterations = iterations;
+                }
+                if (ok && (mask & FIELD_INTEGRATOR)) {
+                    ok = readValue(m_file, inputs.integrator) &&
+                         static_cast<size_t>(inputs.integrator) < StepKernels::INTEGRATOR_COUNT;
+                }
+                if (!ok) { truncated = true; break; }
+
+                system.update(dt, inputs);
+                if (onStep) onStep(system);
+                ++stats.steps;
+                stats.peakParticles = std::max(stats.peakParticles, system.getParticleCount());
+                break;
+            }
+            case InputLog::RecordType::Spawn: {
+                float mass, x, y, vx, vy;
+                sf::Color color;
+                std::uint8_t particleType;
+                if (!readValue(m_file, mass) || !readValue(m_file, x) || !readValue(m_file, y) ||
+                    !readValue(m_file, vx) || !readValue(m_file, vy) ||
+                    !readValue(m_file, color.r) || !readValue(m_file, color.g) ||
+                    !readValue(m_file, color.b) || !readValue(m_file, color.a) ||
+                    !readValue(m_file, particleType)) {
+                    truncated = true;
+                    break;
+                }
+                Particle* p = system.addParticle(mass, {x, y}, {vx, vy}, color);
+                if (p) {
+                    p->setParticleType(static_cast<ParticleType>(particleType));
+                }
+                ++stats.spawns;
+                break;
+            }
+            case InputLog::RecordType::SpawnRandom: {
+                std::uint32_t count;
+                float minMass, maxMass;
+                std::uint8_t particleType;
+                if (!readValue(m_file, count) || !readValue(m_file, minMass) ||
+                    !readValue(m_file, maxMass) || !readValue(m_file, particleType)) {
+                    truncated = true;
+                    break;
+                }
+                system.generateRandomParticles(static_cast<int>(count), minMass, maxMass,
+                                               static_cast<ParticleType>(particleType));
+                stats.spawns += count;
+                break;
+            }
+            case InputLog::RecordType::Clear:
+                while (system.getParticleCount() > 0) system.removeParticle(size_t(0));
+                break;
+            case InputLog::RecordType::Resize: {
+                float width, height;
+                if (!readValue(m_file, width) || !readValue(m_file, height)) {
+                    truncated = true;
+                    break;
+                }
+                system.setWorldSize(width, height);
+                break;
+            }
+            case InputLog::RecordType::AddField: {
+                std::uint8_t fieldType;
+                ForceField field;
+                if (!readValue(m_file, fieldType) || !readValue(m_file, field.x) || !readValue(m_file, field.y) ||
+                    !readValue(m_file, field.strength) || !readValue(m_file, field.radius) ||
+                    !readValue(m_file, field.innerRadius) || !readValue(m_file, field.dirX) ||
+                    !readValue(m_file, field.dirY) || !readValue(m_file, field.frequency) ||
+                    !readValue(m_file, field.speed)) {
+                    truncated = true;
+                    break;
+                }
+                field.type = static_cast<ForceFieldType>(fieldType);
+                system.getForceFields().add(field);
+                break;
+            }
+            case InputLog::RecordType::ClearFields:
+                system.getForceFields().clear();
+                break;
+            case InputLog::RecordType::AddObstacle: {
+                std::uint8_t obstacleType;
+                std::uint16_t pointCount;
+                Obstacle obstacle;
+                bool ok = readValue(m_file, obstacleType) && readValue(m_file, obstacle.radius) &&
+                          readValue(m_file, pointCount) &&
+                          obstacleType < static_cast<std::uint8_t>(ObstacleType::Count);
+                obstacle.points.resize(ok ? pointCount * size_t(2) : 0);
+                for (float& value : obstacle.points) {
+                    if (!ok) break;
+                    ok = readValue(m_file, value);
+                }
+                if (!ok) {
+                    truncated = true;
+                    break;
+                }
+                obstacle.type = static_cast<ObstacleType>(obstacleType);
+                system.getObstacles().add(obstacle);
+                break;
+            }
+            case InputLog::RecordType::ClearObstacles:
+                system.getObstacles().clear();
+                break;
+            case InputLog::RecordType::SetSpeciesPreset: {
+                std::uint8_t preset;
+                if (!readValue(m_file, preset) || preset >= static_cast<std::uint8_t>(SpeciesPreset::Count)) {
+                    truncated = true;
+                    break;
+                }
+                system.loadSpeciesPreset(static_cast<SpeciesPreset>(preset));
+                break;
+            }
+            case InputLog::RecordType::AddBody: {
+                std::uint8_t shape;
+                sf::Vector2f position;
+                if (!readValue(m_file, shape) || !readValue(m_file, position.x) || !readValue(m_file, position.y) ||
+                    shape >= static_cast<std::uint8_t>(BodyShape::Count)) {
+                    truncated = true;
+                    break;
+                }
+                system.addBody(static_cast<BodyShape>(shape), position);
+                break;
+            }
+            case InputLog::RecordType::Despawn: {
+                sf::Vector2f center;
+                float radius;
+                if (!readValue(m_file, center.x) || !readValue(m_file, center.y) || !readValue(m_file, radius)) {
+                    truncated = true;
+                    break;
+                }
+                system.removeParticlesNear(center, radius);
+                break;
+            }
+            case InputLog::RecordType::SetBroadphase: {
+                std::uint8_t broadphase;
+                if (!readValue(m_file, broadphase) || broadphase > static_cast<std::uint8_t>(BroadphaseType::Tiles)) {
+                    truncated = true;
+                    break;
+                }
+                if (!m_overrides.broadphase) system.setBroadphase(static_cast<BroadphaseType>(broadphase));
+                break;
+            }
+            case InputLog::RecordType::SetNeighborSkin: {
+                float skin;
+                if (!readValue(m_file, skin)) {
+                    truncated = true;
+                    break;
+                }
+                if (!m_overrides.neighborSkin) system.setNeighborSkin(skin);
+                break;
+            }
+            case InputLog::RecordType::LoadSnapshot: {
+                std::uint64_t size;
+                // o tamanho vem do arquivo: nada de alocar mais do que ainda resta nele
+                if (!readValue(m_file, size) || size > m_fileSize - static_cast<std::uint64_t>(m_file.tellg())) {
+                    truncated = true;
+                    break;
+                }
+                std::vector<unsigned char> bytes(static_cast<size_t>(size));
+                Snapshot::View view;
+                if (!m_file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size)) ||
+                    !view.open(std::move(bytes)) || !system.loadSnapshot(view)) {
+                    truncated = true;
+                    break;
+                }
+                break;
+            }
+            default:
+                std::cerr << "[ERRO] Registro desconhecido no log de entrada: " << static_cast<int>(type) << std::endl;
+                truncated = true;
+                break;
+        }
+        if (truncated) break;
+    }
+
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (truncated) {
+        std::cerr << "[AVISO] Log de entrada truncado após " << stats.steps << " passos." << std::endl;
+    }
+    return !truncated;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "ParticleSystem.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+
+// Log binário de uma sessão: semente do RNG, dimensões do mundo e, em ordem,
+// cada passo de física (dt + PhysicsInputState) intercalado com os eventos de
+// spawn/limpeza/redimensionamento. Reproduzido headless, vira um teste de carga
+// repetível entre builds.
+//
+// Formato (little-endian):
+//   cabeçalho: "CHLG" | u32 versão | u32 semente | f32 largura | f32 altura | u8 flags do mundo
+//              | u8 busca de pares | f32 skin das listas de Verlet
+//     flags: bit 0 = mundo aberto (sem paredes); só a partir da versão 9
+//     busca de pares e skin: só a partir da versão 11
+//   Logs de qualquer versão de 1 a VERSION são lidos: cada versão só acrescentou
+//   registros e campos do passo, que os logs antigos simplesmente não têm.
+//   registros: u8 tipo + payload
+//     Step:        u16 máscara de campos alterados + apenas os campos alterados
+//     Spawn:       f32 massa, f32 x, f32 y, f32 vx, f32 vy, u8 r, g, b, a, u8 tipo
+//     SpawnRandom: u32 quantidade, f32 massa mín, f32 massa máx, u8 tipo
+//     Clear:       (vazio)
+//     Resize:      f32 largura, f32 altura do mundo (só logs antigos; a janela não muda mais o mundo)
+//     AddField:    u8 tipo do campo, f32 x, y, força, raio, raio interno, dirX, dirY, frequência, velocidade
+//     ClearFields: (vazio)
+//     AddObstacle: u8 tipo, f32 raio, u16 pontos, pontos x f32 x, y
+//     ClearObstacles: (vazio)
+//     SetSpeciesPreset: u8 conjunto de espécies
+//     AddBody:     u8 forma, f32 x, f32 y
+//     Despawn:     f32 x, f32 y, f32 raio
+//     SetBroadphase:   u8 BroadphaseType
+//     SetNeighborSkin: f32 skin
+//     LoadSnapshot:    u64 bytes + o arquivo de snapshot inteiro (o disco pode mudar depois)
+namespace InputLog {
+    constexpr char MAGIC[4] = {'C', 'H', 'L', 'G'};
+    constexpr std::uint32_t VERSION = 11;
+    constexpr std::uint32_t VERSION_WORLD_FLAGS = 9;
+    constexpr std::uint32_t VERSION_PAIR_SETTINGS = 11;
+    constexpr std::uint8_t WORLD_UNBOUNDED = 1;
+
+    enum class RecordType : std::uint8_t {
+        Step = 1,
+        Spawn = 2,
+        SpawnRandom = 3,
+        Clear = 4,
+        Resize = 5,
+        AddField = 6,
+        ClearFields = 7,
+        AddObstacle = 8,
+        ClearObstacles = 9,
+        SetSpeciesPreset = 10,
+        AddBody = 11,
+        Despawn = 12,
+        SetBroadphase = 13,
+        SetNeighborSkin = 14,
+        LoadSnapshot = 15,
+    };
+}
+
+class InputRecorder {
+public:
+    InputRecorder() = default;
+    ~InputRecorder();
+
+    // broadphase e neighborSkin são os do mundo no começo da gravação
+    bool open(const std::string& path, std::uint32_t seed, float width, float height, bool unbounded,
+              BroadphaseType broadphase, float neighborSkin);
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+
+    void recordStep(float dt, const ParticleSystem::PhysicsInputState& inputs);
+    void recordSpawn(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity,
+                     const sf::Color& color, ParticleType type);
+    void recordSpawnRandom(std::uint32_t count, float minMass, float maxMass, ParticleType type);
+    void recordClear();
+    void recordResize(float width, float height);
+    void recordAddForceField(const ForceField& field);
+    void recordClearForceFields();
+    void recordAddObstacle(const Obstacle& obstacle);
+    void recordClearObstacles();
+    void recordSpeciesPreset(SpeciesPreset preset);
+    void recordAddBody(BodyShape shape, const sf::Vector2f& position);
+    void recordDespawn(const sf::Vector2f& center, float radius);
+    void recordBroadphase(BroadphaseType type);
+    void recordNeighborSkin(float skin);
+    void recordLoadSnapshot(const Snapshot::View& view);
+
+    std::uint64_t getStepCount() const { return m_stepCount; }
+
+private:
+    std::ofstream m_file;
+    bool m_hasPrevious = false;
+    float m_previousDt = 0.0f;
+    ParticleSystem::PhysicsInputState m_previous{};
+    std::uint64_t m_stepCount = 0;
+};
+
+class InputReplayer {
+public:
+    struct Stats {
+        std::uint64_t steps = 0;
+        std::uint64_t spawns = 0;
+        double wallSeconds = 0.0;
+        size_t peakParticles = 0;
+    };
+
+    // Escolhas da linha de comando que valem por cima do que o log diz (para
+    // comparar buscas de pares no mesmo log); logs antes da versão 11 não dizem
+    struct Overrides {
+        bool broadphase = false;
+        bool neighborSkin = false;
+    };
+
+    bool open(const std::string& path);
+    void setOverrides(const Overrides& overrides) { m_overrides = overrides; }
+
+    std::uint32_t getSeed() const { return m_seed; }
+    float getWidth() const { return m_width; }
+    float getHeight() const { return m_height; }
+    bool isUnbounded() const { return m_unbounded; }
+    std::uint32_t getVersion() const { return m_version; }
+    bool hasPairSettings() const { return m_version >= InputLog::VERSION_PAIR_SETTINGS; }
+    BroadphaseType getBroadphase() const { return m_broadphase; }
+    float getNeighborSkin() const { return m_neighborSkin; }
+
+    using StepCallback = std::function<void(const ParticleSystem&)>;
+
+    // Executa o log inteiro o mais rápido possível, sem janela.
+    bool run(ParticleSystem& system, Stats& stats, const StepCallback& onStep = StepCallback());
+
+private:
+    std::ifstream m_file;
+    std::uint32_t m_seed = 0;
+    float m_width = 0.0f;
+    float m_height = 0.0f;
+    bool m_unbounded = false;
+    std::uint32_t m_version = 0;
+    BroadphaseType m_broadphase = BroadphaseType::Grid;
+    float m_neighborSkin = 0.0f;
+    std::uint64_t m_fileSize = 0;
+    Overrides m_overrides;
+};
@@ -1,4 +1,5 @@
 #include "Mousart.h"
+#include "AssetPack.h"
 #include <iostream>
 
 Mousart::Mousart() : m_isForceActive(false), m_currentType(CursorType::SKULL), m_hotspot(0, 0) {
@@ -16,22 +17,22 @@ Mousart::Mousart() : m_isForceActive(false), m_currentType(CursorType::SKULL), m
 }
 
 bool Mousart::initialize() {
-    if (!m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)].loadFromFile("assets/retromouse.png")) {
+    if (!AssetPack::loadTexture("retromouse.png", m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)])) {
         std::cerr << "Erro ao carregar assets/retromouse.png" << std::endl;
         
-        if (!m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)].loadFromFile("assets/retromouse_alt.png")) {
+        if (!AssetPack::loadTexture("retromouse_alt.png", m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)])) {
             std::cerr << "Erro ao carregar arquivo de cursor alternativo" << std::endl;
             return false;
         }
     }
     
-    if (!m_cursorTextures[static_cast<size_t>(CursorType::FORCE)].loadFromFile("assets/retromouse_force.png")) {
+    if (!AssetPack::loadTexture("retromouse_force.png", m_cursorTextures[static_cast<size_t>(CursorType::FORCE)])) {
         std::cerr << "Erro ao carregar assets/retromouse_force.png" << std::endl;
         m_cursorTextures[static_cast<size_t>(CursorType::FORCE)] = m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)];
     }
     
     // Carregar cursor esqueleto
-    if (!m_cursorTextures[static_cast<size_t>(CursorType::SKULL)].loadFromFile("assets/mouseskull.png")) {
+    if (!AssetPack::loadTexture("mouseskull.png", m_cursorTextures[static_cast<size_t>(CursorType::SKULL)])) {
         std::cerr << "Erro ao carregar assets/mouseskull.png" << std::endl;
         m_cursorTextures[static_cast<size_t>(CursorType::SKULL)] = m_cursorTextures[static_cast<size_t>(CursorType::DEFAULT)];
     }
@@ -0,0 +1,51 @@
+#include "NeighborList.h"
+#include <algorithm>
+
+bool NeighborList::needsRebuild(const float* positions, size_t count) const {
+    if (m_skin <= 0.0f) return true;
+
+    // nenhum par novo entra no alcance enquanto todos andaram menos que skin / 2
+    const float limit = 0.25f * m_skin * m_skin;
+    float maxDisplacementSq = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const float dx = positions[i * 2] - m_referencePositions[i * 2];
+        const float dy = positions[i * 2 + 1] - m_referencePositions[i * 2 + 1];
+        maxDisplacementSq = std::max(maxDisplacementSq, dx * dx + dy * dy);
+    }
+    return maxDisplacementSq > limit;
+}
+
+bool NeighborList::update(const float* positions, const float* radii, size_t count, float margin,
+                          std::uint64_t generation, Broadphase& broadphase) {
+    ++m_stats.updates;
+
+    // uma lista feita com margem maior também serve para uma menor; assim a
+    // repulsão (margem larga) e as colisões (margem 0) dividem a mesma lista
+    m_requestedMargin = std::max(m_requestedMargin, margin);
+    const bool rebuild = !m_valid || generation != m_generation || margin > m_margin ||
+                         m_referencePositions.size() != count * 2 || needsRebuild(positions, count);
+    if (rebuild) {
+        // sem skin a lista vale um passo só, então é feita com a margem exata pedida
+        const float buildMargin = m_skin > 0.0f ? m_requestedMargin : margin;
+        broadphase.findPairs(positions, radii, count, buildMargin + m_skin, m_pairs);
+        m_referencePositions.assign(positions, positions + count * 2);
+        m_generation = generation;
+        m_margin = buildMargin;
+        // a margem volta a encolher se ninguém mais pedir a larga até a próxima reconstrução
+        m_requestedMargin = margin;
+        m_valid = true;
+        ++m_stats.rebuilds;
+    }
+
+    m_stats.pairs = m_pairs.size();
+    m_stats.memoryBytes = m_pairs.capacity() * sizeof(ParticlePair) +
+                          m_referencePositions.capacity() * sizeof(float);
+    return rebuild;
+}
+
+void NeighborList::resetStats() {
+    m_stats = Stats();
+    m_stats.pairs = m_pairs.size();
+    m_stats.memoryBytes = m_pairs.capacity() * sizeof(ParticlePair) +
+                          m_referencePositions.capacity() * sizeof(float);
+}
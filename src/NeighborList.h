@@ -0,0 +1,49 @@
+#pragma once
+#include "Broadphase.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lista de Verlet: os pares a menos de ra + rb + margin + skin ficam guardados e
+// são reaproveitados entre passos. A lista só é refeita quando alguma partícula
+// andou mais que skin / 2 desde a última construção (aí um par novo poderia ter
+// entrado no alcance), ou quando as partículas ativas mudaram. Com skin 0 ela é
+// refeita a cada chamada, que é o modo de grade puro.
+class NeighborList {
+public:
+    struct Stats {
+        std::uint64_t updates = 0;
+        std::uint64_t rebuilds = 0;
+        size_t pairs = 0;
+        size_t memoryBytes = 0;
+    };
+
+    void setSkin(float skin) { m_skin = skin; invalidate(); }
+    float getSkin() const { return m_skin; }
+
+    // Garante que pairs() cobre tudo a menos de ra + rb + margin das posições atuais.
+    // generation identifica o conjunto de partículas (ParticlePool::getGeneration).
+    // Devolve true se a lista foi refeita.
+    bool update(const float* positions, const float* radii, size_t count, float margin,
+                std::uint64_t generation, Broadphase& broadphase);
+
+    void invalidate() { m_valid = false; m_requestedMargin = 0.0f; }
+
+    // Candidatos: quem usa ainda precisa testar a distância exata
+    const std::vector<ParticlePair>& pairs() const { return m_pairs; }
+
+    const Stats& getStats() const { return m_stats; }
+    void resetStats();
+
+private:
+    bool needsRebuild(const float* positions, size_t count) const;
+
+    std::vector<ParticlePair> m_pairs;
+    std::vector<float> m_referencePositions;
+    float m_skin = 0.0f;
+    float m_margin = 0.0f;           // margem da última construção
+    float m_requestedMargin = 0.0f;  // maior margem pedida desde então
+    std::uint64_t m_generation = 0;
+    bool m_valid = false;
+    Stats m_stats;
+};
@@ -0,0 +1,173 @@
+#include "Obstacle.h"
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+    float segmentDistance(float px, float py, float ax, float ay, float bx, float by) {
+        const float ex = bx - ax;
+        const float ey = by - ay;
+        const float wx = px - ax;
+        const float wy = py - ay;
+        const float lengthSq = ex * ex + ey * ey;
+        const float t = lengthSq > 0.0f ? std::min(std::max((wx * ex + wy * ey) / lengthSq, 0.0f), 1.0f) : 0.0f;
+        const float dx = wx - ex * t;
+        const float dy = wy - ey * t;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    float polygonDistance(const std::vector<float>& vertices, float px, float py) {
+        // menor distância às arestas; o sinal vem da paridade de cruzamentos
+        const size_t count = vertices.size() / 2;
+        float nearest = std::numeric_limits<float>::max();
+        bool inside = false;
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            const float ax = vertices[i * 2], ay = vertices[i * 2 + 1];
+            const float bx = vertices[j * 2], by = vertices[j * 2 + 1];
+            nearest = std::min(nearest, segmentDistance(px, py, ax, ay, bx, by));
+            if ((ay > py) != (by > py) && px < ax + (bx - ax) * (py - ay) / (by - ay)) {
+                inside = !inside;
+            }
+        }
+        return inside ? -nearest : nearest;
+    }
+}
+
+Obstacle Obstacle::circle(float x, float y, float radius) {
+    Obstacle obstacle;
+    obstacle.type = ObstacleType::Circle;
+    obstacle.points = {x, y};
+    obstacle.radius = radius;
+    return obstacle;
+}
+
+Obstacle Obstacle::capsule(float x1, float y1, float x2, float y2, float halfThickness) {
+    Obstacle obstacle;
+    obstacle.type = ObstacleType::Capsule;
+    obstacle.points = {x1, y1, x2, y2};
+    obstacle.radius = halfThickness;
+    return obstacle;
+}
+
+Obstacle Obstacle::polygon(std::vector<float> vertices, float rounding) {
+    Obstacle obstacle;
+    obstacle.type = ObstacleType::Polygon;
+    obstacle.points = std::move(vertices);
+    obstacle.radius = rounding;
+    return obstacle;
+}
+
+float Obstacle::distance(float x, float y) const {
+    switch (type) {
+        case ObstacleType::Circle:
+            if (points.size() < 2) break;
+            return std::hypot(x - points[0], y - points[1]) - radius;
+        case ObstacleType::Capsule:
+            if (points.size() < 4) break;
+            return segmentDistance(x, y, points[0], points[1], points[2], points[3]) - radius;
+        case ObstacleType::Polygon:
+            if (points.size() < 6) break;
+            return polygonDistance(points, x, y) - radius;
+        case ObstacleType::Count:
+            break;
+    }
+    return std::numeric_limits<float>::max();
+}
+
+void ObstacleSet::add(const Obstacle& obstacle) {
+    m_obstacles.push_back(obstacle);
+    m_dirty = true;
+}
+
+void ObstacleSet::clear() {
+    m_obstacles.clear();
+    m_dirty = true;
+}
+
+void ObstacleSet::loadScene(ObstacleScene scene, float w, float h) {
+    clear();
+    // meia espessura das paredes: com menos, o peso de uma pilha no modo de impulso
+    // empurra a fileira de baixo até a linha média, onde a normal se perde
+    constexpr float WALL = 10.0f;
+    switch (scene) {
+        case ObstacleScene::Funnel:
+            add(Obstacle::capsule(0.12f * w, 0.30f * h, 0.45f * w, 0.60f * h, WALL));
+            add(Obstacle::capsule(0.88f * w, 0.30f * h, 0.55f * w, 0.60f * h, WALL));
+            break;
+        case ObstacleScene::Pegs: {
+            constexpr float SPACING = 50.0f;
+            constexpr float PEG_RADIUS = 6.0f;
+            int row = 0;
+            for (float y = 0.30f * h; y < 0.85f * h; y += SPACING * 0.866f, ++row) {
+                const float offset = (row % 2) ? SPACING * 0.5f : 0.0f;
+                for (float x = SPACING * 0.5f + offset; x < w - SPACING * 0.25f; x += SPACING) {
+                    add(Obstacle::circle(x, y, PEG_RADIUS));
+                }
+            }
+            break;
+        }
+        case ObstacleScene::Container:
+            add(Obstacle::capsule(0.20f * w, 0.45f * h, 0.20f * w, 0.85f * h, WALL));
+            add(Obstacle::capsule(0.20f * w, 0.85f * h, 0.80f * w, 0.85f * h, WALL));
+            add(Obstacle::capsule(0.80f * w, 0.85f * h, 0.80f * w, 0.45f * h, WALL));
+            // rampa dentro do recipiente
+            add(Obstacle::polygon({0.20f * w, 0.85f * h, 0.42f * w, 0.85f * h, 0.20f * w, 0.68f * h}));
+            break;
+        case ObstacleScene::None:
+        case ObstacleScene::Count:
+            break;
+    }
+}
+
+const char* ObstacleSet::sceneName(ObstacleScene scene) {
+    switch (scene) {
+        case ObstacleScene::Funnel:    return "funil";
+        case ObstacleScene::Pegs:      return "pinos";
+        case ObstacleScene::Container: return "recipiente";
+        case ObstacleScene::None:
+        case ObstacleScene::Count:     break;
+    }
+    return "nenhum";
+}
+
+void ObstacleSet::bake(float worldWidth, float worldHeight, float cellSize) {
+    if (!m_dirty && worldWidth == m_bakedWidth && worldHeight == m_bakedHeight && cellSize == m_cellSize) {
+        return;
+    }
+    m_dirty = false;
+    m_bakedWidth = worldWidth;
+    m_bakedHeight = worldHeight;
+    m_cellSize = cellSize;
+    ++m_version;
+    if (m_obstacles.empty()) {
+        m_distances.clear();
+        m_grid = DistanceGrid();
+        return;
+    }
+
+    // nós de 0 até além da borda, para a amostra na borda ainda ter vizinho
+    m_nodesX = static_cast<size_t>(std::ceil(worldWidth / cellSize)) + 2;
+    m_nodesY = static_cast<size_t>(std::ceil(worldHeight / cellSize)) + 2;
+    // teto finito: a interpolação de dois valores enormes não pode virar inf - inf
+    const float ceiling = worldWidth + worldHeight;
+    m_distances.assign(m_nodesX * m_nodesY, ceiling);
+    for (size_t iy = 0; iy < m_nodesY; ++iy) {
+        const float y = static_cast<float>(iy) * cellSize;
+        for (size_t ix = 0; ix < m_nodesX; ++ix) {
+            const float x = static_cast<float>(ix) * cellSize;
+            float nearest = m_distances[iy * m_nodesX + ix];
+            for (const Obstacle& obstacle : m_obstacles) {
+                nearest = std::min(nearest, obstacle.distance(x, y));
+            }
+            m_distances[iy * m_nodesX + ix] = nearest;
+        }
+    }
+
+    m_grid.values = m_distances.data();
+    m_grid.nodesX = m_nodesX;
+    m_grid.invCell = 1.0f / cellSize;
+    m_grid.limitX = static_cast<float>(m_nodesX - 1) - 0.001f;
+    m_grid.limitY = static_cast<float>(m_nodesY - 1) - 0.001f;
+    // as cenas ficam dentro do mundo: além da grade não há obstáculo
+    m_grid.outside = ceiling;
+}
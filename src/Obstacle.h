@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class ObstacleType : std::uint8_t {
+    Circle = 0,
+    Capsule,
+    Polygon,
+    Count
+};
+
+// Cenas prontas de obstáculos, montadas para o tamanho do mundo
+enum class ObstacleScene : std::uint8_t {
+    None = 0,
+    Funnel,     // funil central com saída estreita
+    Pegs,       // tabuleiro de pinos (Galton)
+    Container,  // recipiente em U com um degrau
+    Count
+};
+
+// Um obstáculo estático. points guarda (x, y) em sequência: o centro do círculo,
+// as duas pontas da cápsula ou os vértices do polígono (em qualquer sentido; o
+// polígono pode ser côncavo). radius é o raio do círculo, a meia espessura da
+// cápsula ou o arredondamento das bordas do polígono.
+struct Obstacle {
+    ObstacleType type = ObstacleType::Circle;
+    std::vector<float> points;
+    float radius = 0.0f;
+
+    static Obstacle circle(float x, float y, float radius);
+    static Obstacle capsule(float x1, float y1, float x2, float y2, float halfThickness);
+    static Obstacle polygon(std::vector<float> vertices, float rounding = 0.0f);
+
+    // Distância com sinal até a borda: negativa dentro; sem pontos suficientes, infinita
+    float distance(float x, float y) const;
+};
+
+// Distância com sinal amostrada nos nós de uma grade regular sobre o mundo.
+// A amostragem é bilinear e o gradiente é o da própria interpolação, então a
+// normal é contínua dentro de cada célula; sem desvios, para rodar dentro do
+// laço vetorizado do passo. Fora da grade (mundo sem bordas, posição não
+// finita) não há contato: a distância é outside e o gradiente é nulo.
+struct DistanceGrid {
+    const float* values = nullptr;
+    size_t nodesX = 0;
+    float invCell = 1.0f;
+    float limitX = 0.0f;  // maior coordenada (em células) que ainda tem vizinho à direita
+    float limitY = 0.0f;
+    float outside = 0.0f; // maior que qualquer raio de partícula
+
+    inline void sample(float x, float y, float& distance, float& gradX, float& gradY) const {
+        const float cx = x * invCell;
+        const float cy = y * invCell;
+        // max(0, NaN) é 0: o índice nunca sai de um NaN
+        const float fx = std::min(limitX, std::max(0.0f, cx));
+        const float fy = std::min(limitY, std::max(0.0f, cy));
+        const float inside = (fx == cx && fy == cy) ? 1.0f : 0.0f;
+        const size_t ix = static_cast<size_t>(fx);
+        const size_t iy = static_cast<size_t>(fy);
+        const float tx = fx - static_cast<float>(ix);
+        const float ty = fy - static_cast<float>(iy);
+
+        const float* row = values + iy * nodesX + ix;
+        const float d00 = row[0];
+        const float d10 = row[1];
+        const float d01 = row[nodesX];
+        const float d11 = row[nodesX + 1];
+
+        const float top = d00 + (d10 - d00) * tx;
+        const float bottom = d01 + (d11 - d01) * tx;
+        const float sampled = top + (bottom - top) * ty;
+        distance = (inside > 0.0f) ? sampled : outside;
+        gradX = ((d10 - d00) + ((d11 - d01) - (d10 - d00)) * ty) * invCell * inside;
+        gradY = (bottom - top) * invCell * inside;
+    }
+};
+
+// Lista de obstáculos e o campo de distância gerado a partir dela. O campo só é
+// refeito quando a lista ou o tamanho do mundo mudam; no passo cada partícula
+// faz uma amostra, não importa quantos obstáculos existam.
+class ObstacleSet {
+public:
+    // Espaçamento dos nós da grade; bem menor que o menor raio de partícula (6 px)
+    static constexpr float DEFAULT_CELL_SIZE = 4.0f;
+
+    void add(const Obstacle& obstacle);
+    void clear();
+    bool empty() const { return m_obstacles.empty(); }
+    size_t size() const { return m_obstacles.size(); }
+    const std::vector<Obstacle>& list() const { return m_obstacles; }
+
+    // Troca a lista pela cena pronta
+    void loadScene(ObstacleScene scene, float worldWidth, float worldHeight);
+    static const char* sceneName(ObstacleScene scene);
+
+    // Refaz o campo se a lista ou o mundo mudaram desde a última vez
+    void bake(float worldWidth, float worldHeight, float cellSize = DEFAULT_CELL_SIZE);
+    // Válido depois de bake() com a lista não vazia
+    const DistanceGrid& grid() const { return m_grid; }
+    size_t getNodesX() const { return m_nodesX; }
+    size_t getNodesY() const { return m_nodesY; }
+    float getCellSize() const { return m_cellSize; }
+    // Muda a cada novo campo (para quem desenha saber quando refazer a textura)
+    std::uint64_t getVersion() const { return m_version; }
+
+private:
+    std::vector<Obstacle> m_obstacles;
+    std::vector<float> m_distances;
+    DistanceGrid m_grid;
+    size_t m_nodesX = 0;
+    size_t m_nodesY = 0;
+    float m_cellSize = 0.0f;
+    float m_bakedWidth = 0.0f;
+    float m_bakedHeight = 0.0f;
+    bool m_dirty = true;
+    std::uint64_t m_version = 0;
+};
@@ -0,0 +1,113 @@
+#include "PairForces.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float MAX_FORCE = 5000.0f;
+    constexpr float MIN_DISTANCE = 5.0f;
+    constexpr float MIN_VALID_MASS = 0.0001f;
+    constexpr float MIN_DISTANCE_SQ = 0.0001f;
+
+    // Mesmas contas do laço escalar de antes (força ~ massa1 * massa2 / d², limitada
+    // a MAX_FORCE), com o alcance e o par degenerado virando máscara
+    void pairForces(float strength, float range, const float* __restrict dx, const float* __restrict dy,
+                    const float* __restrict radiusSum, const float* __restrict m1, const float* __restrict m2,
+                    float* __restrict forceX, float* __restrict forceY, size_t n) {
+        for (size_t l = 0; l < n; ++l) {
+            const float distSq = dx[l] * dx[l] + dy[l] * dy[l];
+            const float reach = radiusSum[l] + range;
+            const float inRange = (distSq > MIN_DISTANCE_SQ && distSq < reach * reach) ? 1.0f : 0.0f;
+            const float dist = std::sqrt(std::max(distSq, MIN_DISTANCE_SQ));
+            const float effectiveDist = std::max(dist, MIN_DISTANCE);
+            const float magnitude = strength * m1[l] * m2[l] / (effectiveDist * effectiveDist);
+            const float limited = std::min(std::max(magnitude, -MAX_FORCE), MAX_FORCE) * inRange;
+            forceX[l] = dx[l] / dist * limited;
+            forceY[l] = dy[l] / dist * limited;
+        }
+    }
+}
+
+void PairForces::apply(const std::vector<ParticlePair>& pairs, const SpeciesTable& table, float strength,
+                       const Arrays& arrays) {
+    m_stats = Stats();
+    m_stats.pairs = pairs.size();
+    if (pairs.empty()) return;
+
+    if (table.getCount() == 1) {
+        const SpeciesTable::Interaction& only = table.getInteraction(0, 0);
+        m_stats.groups = 1;
+        applyGroup(pairs.data(), pairs.size(), strength * only.strength, only.range, arrays);
+        return;
+    }
+
+    // counting sort estável pelo par de espécies
+    const size_t groupCount = table.pairCount();
+    m_groupStart.assign(groupCount + 1, 0);
+    m_groupOf.resize(pairs.size());
+    const size_t lastSpecies = table.getCount() - 1;
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        const size_t a = std::min<size_t>(arrays.species[pairs[p].a], lastSpecies);
+        const size_t b = std::min<size_t>(arrays.species[pairs[p].b], lastSpecies);
+        const std::uint32_t group = static_cast<std::uint32_t>(table.pairIndex(a, b));
+        m_groupOf[p] = group;
+        ++m_groupStart[group + 1];
+    }
+    for (size_t g = 0; g < groupCount; ++g) {
+        m_groupStart[g + 1] += m_groupStart[g];
+    }
+    m_grouped.resize(pairs.size());
+    m_cursor.assign(m_groupStart.begin(), m_groupStart.end() - 1);
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        m_grouped[m_cursor[m_groupOf[p]]++] = pairs[p];
+    }
+
+    for (size_t a = 0; a <= lastSpecies; ++a) {
+        for (size_t b = a; b <= lastSpecies; ++b) {
+            const size_t group = table.pairIndex(a, b);
+            const size_t begin = m_groupStart[group];
+            const size_t end = m_groupStart[group + 1];
+            const SpeciesTable::Interaction& interaction = table.getInteraction(a, b);
+            if (begin == end || interaction.strength == 0.0f) continue;
+            ++m_stats.groups;
+            applyGroup(&m_grouped[begin], end - begin, strength * interaction.strength, interaction.range, arrays);
+        }
+    }
+}
+
+void PairForces::applyGroup(const ParticlePair* pairs, size_t count, float strength, float range,
+                            const Arrays& arrays) {
+    const float* positions = arrays.positions;
+    float* accelerations = arrays.accelerations;
+    Lanes& lanes = m_lanes;
+    for (size_t begin = 0; begin < count; begin += BATCH_SIZE) {
+        const size_t n = std::min(BATCH_SIZE, count - begin);
+        const ParticlePair* batch = pairs + begin;
+        for (size_t l = 0; l < n; ++l) {
+            const std::uint32_t a = batch[l].a;
+            const std::uint32_t b = batch[l].b;
+            lanes.dx[l] = positions[a * 2] - positions[b * 2];
+            lanes.dy[l] = positions[a * 2 + 1] - positions[b * 2 + 1];
+            lanes.radiusSum[l] = arrays.radii[a] + arrays.radii[b];
+            lanes.m1[l] = arrays.masses[a];
+            lanes.m2[l] = arrays.masses[b];
+        }
+
+        pairForces(strength, range, lanes.dx, lanes.dy, lanes.radiusSum, lanes.m1, lanes.m2, lanes.forceX,
+                   lanes.forceY, n);
+
+        // a mesma partícula pode aparecer em vários pares do lote: a soma é serial
+        for (size_t l = 0; l < n; ++l) {
+            const std::uint32_t a = batch[l].a;
+            const std::uint32_t b = batch[l].b;
+            if (lanes.m1[l] > MIN_VALID_MASS) {
+                accelerations[a * 2]     += lanes.forceX[l];
+                accelerations[a * 2 + 1] += lanes.forceY[l];
+            }
+            if (lanes.m2[l] > MIN_VALID_MASS) {
+                accelerations[b * 2]     -= lanes.forceX[l];
+                accelerations[b * 2 + 1] -= lanes.forceY[l];
+            }
+        }
+        ++m_stats.batches;
+    }
+}
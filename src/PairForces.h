@@ -0,0 +1,58 @@
+#pragma once
+#include "Broadphase.h"
+#include "Species.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forças entre pares (repulsão/atração por espécie) sobre o SoA. Os pares da
+// lista de vizinhos são separados por par de espécies com um counting sort
+// estável, então cada grupo tem uma força e um alcance só: o laço das contas não
+// consulta a matriz e roda em lotes sem desvios, como os do solver de contato.
+// Dentro de um grupo fica a ordem da busca de pares (célula a célula), que é a
+// que aproveita a cache. Com uma espécie só não há separação nenhuma.
+class PairForces {
+public:
+    static constexpr size_t BATCH_SIZE = 256;
+
+    struct Arrays {
+        const float* positions;
+        const float* masses;
+        const float* radii;
+        const std::uint8_t* species;
+        float* accelerations;  // recebe a soma
+        size_t count;
+    };
+
+    struct Stats {
+        size_t groups = 0;   // pares de espécies com algum par na lista
+        size_t batches = 0;
+        size_t pairs = 0;
+    };
+
+    // strength é a repulsão global; a matriz escala por par de espécies
+    void apply(const std::vector<ParticlePair>& pairs, const SpeciesTable& table, float strength,
+               const Arrays& arrays);
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void applyGroup(const ParticlePair* pairs, size_t count, float strength, float range, const Arrays& arrays);
+
+    struct Lanes {
+        alignas(64) float dx[BATCH_SIZE];
+        alignas(64) float dy[BATCH_SIZE];
+        alignas(64) float radiusSum[BATCH_SIZE];
+        alignas(64) float m1[BATCH_SIZE];
+        alignas(64) float m2[BATCH_SIZE];
+        alignas(64) float forceX[BATCH_SIZE];
+        alignas(64) float forceY[BATCH_SIZE];
+    };
+
+    std::vector<ParticlePair> m_grouped;
+    std::vector<std::uint32_t> m_groupOf;
+    std::vector<size_t> m_groupStart;
+    std::vector<size_t> m_cursor;
+    Lanes m_lanes;
+    Stats m_stats;
+};
@@ -5,16 +5,22 @@
 #include <cmath>
 #include <vector>
 #include <string>
-#include <random>
 #include <map>
 #include <memory>
 
+namespace {
+    // Nomes fixos: o TextureManager acha o handle sem alocar nem tocar no disco
+    const char* const TEXTURE_FILES[Particle::TEXTURE_VARIANTS] = {"1.png", "2.png", "3.png"};
+}
+
 void Particle::initialize(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity, const sf::Color& color) {
     this->vel = velocity;
     this->m_accel = {0.0f, 0.0f};
     this->mass = mass;
-    this->m_texture = nullptr;
+    this->m_soaIndex = NO_SOA_INDEX;
+    this->m_textureHandle = TextureManager::INVALID_HANDLE;
     this->m_type = ParticleType::Original;
+    this->m_species = 0;
     this->m_colorPulsePhase = 0.0f;
     this->m_useSpeedColor = true;
 
@@ -52,56 +58,27 @@ void Particle::initialize(float mass, const sf::Vector2f& position, const sf::Ve
     setParticleType(m_type);
 }
 
+void Particle::preloadTextures() {
+    for (const char* file : TEXTURE_FILES) {
+        TextureManager::preloadTexture(file);
+    }
+}
+
 void Particle::setParticleType(ParticleType type) {
     sf::Color currentColor = m_sprite.getColor();
     
     m_type = type;
     
     if (type == ParticleType::Original) {
-        m_texture = nullptr;
+        m_textureHandle = TextureManager::INVALID_HANDLE;
         updateTrailColor();
         return;
     }
-    std::string textureFile;
-    
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    
-    std::uniform_int_distribution<> distrib(0, 2);
-    int choice = distrib(gen);
-    textureFile = std::to_string(choice + 1) + ".png";
-    
-    m_texture = TextureManager::getTexture(textureFile);
-    
-    if (!m_texture || m_texture->getSize().x == 0) {
-        m_texture = TextureManager::getTexture("assets/" + textureFile);
-    }
     
-    if (m_texture && m_texture->getSize().x > 0) {
-        m_sprite.setTexture(*m_texture);
-        
-        sf::Vector2u textureSize = m_texture->getSize();
-        m_sprite.setOrigin(textureSize.x / 2.0f, textureSize.y / 2.0f);
-        
-        float scaleFactor = 5.0f;
-        
-        float scale = (radius * scaleFactor) / std::max(textureSize.x, textureSize.y);
-        m_sprite.setScale(scale, scale);
+    m_textureHandle = TextureManager::requestTexture(TEXTURE_FILES[m_textureVariant % TEXTURE_VARIANTS]);
     
-        currentColor.a = 255;
-        m_sprite.setColor(currentColor);
-    } else {
-        std::cerr << "Não foi possível carregar a textura: " << textureFile << std::endl;
-        m_type = ParticleType::Original;
-        m_texture = nullptr;
-        
-        sf::Color fallbackColor = m_baseColor;
-        fallbackColor.r = std::max(100u, (unsigned int)fallbackColor.r);
-        fallbackColor.g = std::max(100u, (unsigned int)fallbackColor.g);
-        fallbackColor.b = std::max(100u, (unsigned int)fallbackColor.b);
-        fallbackColor.a = 255;
-        m_sprite.setColor(fallbackColor);
-    }
+    currentColor.a = 255;
+    m_sprite.setColor(currentColor);
     
     // Atualizar a cor com base na velocidade
     updateTrailColor();
@@ -243,18 +220,29 @@ void Particle::updateTrailColor() {
 
 void Particle::draw(sf::RenderTarget& target, sf::RenderStates states) const {
     const sf::Vector2f particlePos = m_sprite.getPosition();
+    const sf::Texture* texture = TextureManager::getTexture(m_textureHandle);
     
+    const float scaleFactor = 5.0f;
     float radius = this->radius; 
-    if (m_texture) {
-        radius = m_sprite.getScale().x * m_texture->getSize().x * 0.5f;
+    if (texture) {
+        radius = this->radius * scaleFactor * 0.5f;
     }
 
     if (!Utility::isVisible(particlePos, radius, target.getView())) {
         return;
     }
         
-    if (m_type == ParticleType::Crystal && m_texture) {
-        target.draw(m_sprite, states);
+    if (m_type == ParticleType::Crystal && texture) {
+        // O tamanho da textura só é conhecido depois do upload, então a escala sai daqui
+        const sf::Vector2u textureSize = texture->getSize();
+        sf::Sprite sprite(*texture);
+        sprite.setOrigin(textureSize.x / 2.0f, textureSize.y / 2.0f);
+        const float scale = (this->radius * scaleFactor) / std::max(textureSize.x, textureSize.y);
+        sprite.setScale(scale, scale);
+        sprite.setPosition(particlePos);
+        sprite.setRotation(m_sprite.getRotation());
+        sprite.setColor(m_sprite.getColor());
+        target.draw(sprite, states);
     } else {
         if (m_type == ParticleType::Original) {
             sf::CircleShape circle(radius);
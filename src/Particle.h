@@ -4,6 +4,7 @@
 #include <deque>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include <memory>
 #include <iostream>
 
@@ -40,18 +41,38 @@ public:
         }
     }
     float getRadius() const { return radius; }
+    void setRadius(float r) { radius = r; }
     
     sf::Color getColor() const { return m_sprite.getColor(); }
     void setColor(const sf::Color& color) { m_sprite.setColor(color); }
+
+    // Cor original (após o realce de initialize), da qual sai a cor por velocidade
+    sf::Color getBaseColor() const { return m_baseColor; }
+    void setBaseColor(const sf::Color& color) { m_baseColor = color; updateTrailColor(); }
     
     void setParticleType(ParticleType type);
     ParticleType getParticleType() const { return m_type; }
+
+    // Qual das texturas do tipo usar; quem escolhe é o ParticleSystem, sem RNG
+    // próprio, para que gravação, replay e snapshots vejam a mesma textura
+    std::uint8_t getTextureVariant() const { return m_textureVariant; }
+    void setTextureVariant(std::uint8_t variant) { m_textureVariant = variant; }
+    static constexpr std::uint8_t TEXTURE_VARIANTS = 3;
+    // Carrega as texturas dos tipos de forma síncrona (quem não tem laço de janela
+    // para fazer os uploads pendentes)
+    static void preloadTextures();
+
+    // Espécie na SpeciesTable do sistema (0 na criação)
+    std::uint8_t getSpecies() const { return m_species; }
+    void setSpecies(std::uint8_t species) { m_species = species; }
     
-    std::shared_ptr<sf::Texture> getTexture() const { return m_texture; }
+    TextureHandle getTextureHandle() const { return m_textureHandle; }
 
     size_t getPoolIndex() const { return poolIndex; }
     void setPoolIndex(size_t index) { poolIndex = index; }
     
+    // NO_SOA_INDEX desde initialize até o primeiro syncToSoA
+    static constexpr size_t NO_SOA_INDEX = static_cast<size_t>(-1);
     size_t getSoAIndex() const { return m_soaIndex; }
     void setSoAIndex(size_t index) { m_soaIndex = index; }
     
@@ -87,8 +108,10 @@ private:
 
 private:
     sf::Sprite m_sprite;
-    std::shared_ptr<sf::Texture> m_texture;  
+    TextureHandle m_textureHandle = TextureManager::INVALID_HANDLE;
     ParticleType m_type;
+    std::uint8_t m_species = 0;
+    std::uint8_t m_textureVariant = 0;
     float radius;           
     sf::Vector2f vel;      
     sf::Vector2f m_accel;  
@@ -107,7 +130,7 @@ private:
     bool m_useSpeedColor;
 
     size_t poolIndex;
-    size_t m_soaIndex;
+    size_t m_soaIndex = NO_SOA_INDEX;
 
     std::vector<sf::Vertex> m_trailVertices;
 };
@@ -39,6 +39,7 @@ Particle* ParticlePool::acquireParticle(float mass, const sf::Vector2f& position
     
     m_activeParticles.push_back(particle);
     particle->setPoolIndex(m_activeParticles.size() - 1);
+    ++m_generation;
     
     return particle;
 }
@@ -62,6 +63,8 @@ void ParticlePool::releaseParticle(Particle* particle) {
     m_activeParticles.pop_back();
 
     m_inactiveParticles.push_back(particle);
+    ++m_generation;
+    if (m_observer) m_observer->onParticleReleased(indexToRemove, m_activeParticles.size());
 }
 
 void ParticlePool::clearAll() {
@@ -69,14 +72,28 @@ void ParticlePool::clearAll() {
                               m_activeParticles.begin(), 
                               m_activeParticles.end());
     m_activeParticles.clear();
+    ++m_generation;
+    if (m_observer) m_observer->onPoolCleared();
 }
 
 void ParticlePool::expandCapacity(size_t additionalCapacity) {
     if (m_capacity + additionalCapacity > MAX_AUTO_EXPAND_CAPACITY) {
+        // reserve() pode ter passado do limite
+        if (m_capacity >= MAX_AUTO_EXPAND_CAPACITY) return;
         additionalCapacity = MAX_AUTO_EXPAND_CAPACITY - m_capacity;
         if (additionalCapacity <= 0) return; 
     }
     
+    growStorage(additionalCapacity);
+}
+
+void ParticlePool::reserve(size_t capacity) {
+    if (capacity > m_capacity) {
+        growStorage(capacity - m_capacity);
+    }
+}
+
+void ParticlePool::growStorage(size_t additionalCapacity) {
     m_capacity += additionalCapacity;
     m_activeParticles.reserve(m_capacity);
     m_inactiveParticles.reserve(m_capacity);
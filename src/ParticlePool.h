@@ -3,17 +3,35 @@
 #include <vector>
 #include <memory>
 #include <deque>
+#include <cstdint>
 
 class ParticlePool {
+public:
+    // Para quem guarda índices do SoA e precisa segui-los, em vez de só os descartar
+    // quando a geração muda
+    class Observer {
+    public:
+        virtual ~Observer() = default;
+        // A partícula em index saiu e a que estava em last passou para index
+        // (index == last quando a que saiu era a última)
+        virtual void onParticleReleased(size_t index, size_t last) = 0;
+        virtual void onPoolCleared() = 0;
+    };
+
 private:
     std::vector<Particle*> m_activeParticles;
     std::vector<Particle*> m_inactiveParticles;
     size_t m_capacity;
+    // muda a cada acquire/release/clear: quem guarda índices do SoA sabe que eles mudaram
+    std::uint64_t m_generation = 0;
+    Observer* m_observer = nullptr;
     
     std::deque<Particle> m_particleStorage;
 
     static constexpr size_t MAX_AUTO_EXPAND_CAPACITY = 10000;
 
+    void growStorage(size_t additionalCapacity);
+
 public:
     ParticlePool(size_t initialCapacity = 1000);
     ~ParticlePool();
@@ -24,10 +42,15 @@ public:
     void releaseParticle(Particle* particle);
     void clearAll();
     void expandCapacity(size_t additionalCapacity);
+    // Ao contrário de expandCapacity, não respeita o limite de expansão automática
+    void reserve(size_t capacity);
+    // Um observador só; nullptr desliga
+    void setObserver(Observer* observer) { m_observer = observer; }
     
     size_t getActiveCount() const { return m_activeParticles.size(); }
     size_t getInactiveCount() const { return m_inactiveParticles.size(); }
     size_t getTotalCapacity() const { return m_capacity; }
+    std::uint64_t getGeneration() const { return m_generation; }
 
     const std::vector<Particle*>& getActiveParticles() const { return m_activeParticles; }
 };
@@ -2,21 +2,100 @@
 #include <iostream>
 #include <random>
 #include <cmath>
+#include <chrono>
+#include <iterator>
+#include <limits>
+
+namespace {
+    using StepClock = std::chrono::steady_clock;
+
+    double secondsSince(StepClock::time_point& mark) {
+        const StepClock::time_point now = StepClock::now();
+        const double elapsed = std::chrono::duration<double>(now - mark).count();
+        mark = now;
+        return elapsed;
+    }
+
+    // Lados do disco de uma cabeça pelo raio na tela: os 12 de sempre no tamanho
+    // normal, menos quando ela cabe em um ou dois pixels, mais com o zoom perto
+    constexpr int HEAD_SIDES[] = {4, 6, 12, 24, 48};
+
+    size_t headLevel(float screenRadius) {
+        if (screenRadius < 1.0f) return 0;
+        if (screenRadius < 2.0f) return 1;
+        if (screenRadius <= 24.0f) return 2;
+        if (screenRadius <= 64.0f) return 3;
+        return 4;
+    }
+
+    // Pontos do círculo unitário de cada nível, com o mesmo ângulo de sempre
+    struct HeadCircles {
+        std::vector<sf::Vector2f> points[std::size(HEAD_SIDES)];
+
+        HeadCircles() {
+            for (size_t level = 0; level < std::size(HEAD_SIDES); ++level) {
+                const int pointCount = HEAD_SIDES[level];
+                const float angleIncrement = (2.0f * 3.14159265f) / pointCount;
+                for (int i = 0; i <= pointCount; ++i) {
+                    const float angle = i * angleIncrement;
+                    points[level].emplace_back(std::cos(angle), std::sin(angle));
+                }
+            }
+        }
+    };
+}
 
 ParticleSystem::ParticleSystem(float width, float height)
-    : m_particlePool(INITIAL_POOL_CAPACITY), m_width(width), m_height(height) {
-    m_grid = std::make_unique<SpatialGrid>(width, height, GRID_CELL_SIZE);
+    : m_particlePool(INITIAL_POOL_CAPACITY), m_rng(std::random_device{}()),
+      m_width(width), m_height(height) {
     m_trailVertices.setPrimitiveType(sf::TriangleStrip);
     m_untexturedHeadVertices.setPrimitiveType(sf::Triangles);
+    m_constraintVertices.setPrimitiveType(sf::Lines);
+    m_particlePool.setObserver(&m_constraints);
 }
 
 ParticleSystem::~ParticleSystem() {
+    m_particlePool.setObserver(nullptr);
 }
 
-void ParticleSystem::setWindowSize(float width, float height) {
+void ParticleSystem::setWorldSize(float width, float height) {
     m_width = width;
     m_height = height;
-    m_grid = std::make_unique<SpatialGrid>(width, height, GRID_CELL_SIZE);
+}
+
+void ParticleSystem::setParallel(bool parallel) {
+    m_frameGraph.setParams({parallel});
+    m_tileGrid.setParams({parallel});
+
+    FluidSolver::Params fluid = m_fluidSolver.getParams();
+    fluid.parallel = parallel;
+    m_fluidSolver.setParams(fluid);
+
+    ConstraintSolver::Params constraints = m_constraintSolver.getParams();
+    constraints.parallel = parallel;
+    m_constraintSolver.setParams(constraints);
+
+    DensitySplat::Params splat = m_splat.getParams();
+    splat.parallel = parallel;
+    m_splat.setParams(splat);
+}
+
+void ParticleSystem::setFrameGeometry(bool enabled) {
+    m_frameGeometry = enabled;
+    if (!enabled) {
+        // o que foi montado antes não volta para a tela nem para o SoftwareRenderer
+        m_trailVertices.clear();
+        m_untexturedHeadVertices.clear();
+        m_texturedHeadBatches.clear();
+        m_constraintVertices.clear();
+        m_visibleCount = 0;
+    }
+}
+
+void ParticleSystem::setViewArea(const sf::FloatRect& area, float pixelsPerUnit) {
+    m_viewArea = area;
+    m_pixelsPerUnit = pixelsPerUnit;
+    m_hasViewArea = true;
 }
 
 Particle* ParticleSystem::addParticle(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity, const sf::Color& color) {
@@ -34,10 +113,72 @@ Particle* ParticleSystem::addParticle(float mass, const sf::Vector2f& position,
             particle = m_particlePool.acquireParticle(mass, position, velocity, color);
         }
     }
-    
+
+    if (particle) {
+        // mesma sequência ao vivo e no replay; o RNG da simulação não é tocado
+        const std::uint64_t spawnHash = (++m_spawnCount) * 0x9E3779B97F4A7C15ull;
+        particle->setTextureVariant(static_cast<std::uint8_t>((spawnHash >> 32) % Particle::TEXTURE_VARIANTS));
+    }
+
+    if (particle && m_species.getCount() > 1) {
+        assignSpecies(*particle, m_nextSpecies);
+        m_nextSpecies = (m_nextSpecies + 1) % m_species.getCount();
+    }
     return particle; 
 }
 
+size_t ParticleSystem::addParticles(const ParticleSpawn* spawns, size_t count) {
+    // sem isto o pool cresceria pela metade várias vezes no meio de um lote grande;
+    // nunca menos que essa metade, para lotes pequenos não realocarem a cada passo
+    const size_t inactive = m_particlePool.getInactiveCount();
+    if (count > inactive) {
+        m_particlePool.expandCapacity(std::max(count - inactive, m_particlePool.getTotalCapacity() / 2));
+    }
+
+    size_t added = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ParticleSpawn& spawn = spawns[i];
+        if (Particle* particle = addParticle(spawn.mass, spawn.position, spawn.velocity, spawn.color)) {
+            particle->setParticleType(spawn.type);
+            ++added;
+        }
+    }
+    return added;
+}
+
+size_t ParticleSystem::removeParticlesNear(const sf::Vector2f& center, float radius) {
+    const auto& activeParticles = m_particlePool.getActiveParticles();
+    const float radiusSq = radius * radius;
+    size_t removed = 0;
+    // de trás para a frente: quem vem do fim para o lugar da removida já foi testada
+    for (size_t i = activeParticles.size(); i-- > 0;) {
+        const sf::Vector2f offset = activeParticles[i]->getPosition() - center;
+        if (offset.x * offset.x + offset.y * offset.y < radiusSq) {
+            m_particlePool.releaseParticle(activeParticles[i]);
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+void ParticleSystem::assignSpecies(Particle& particle, size_t species) {
+    particle.setSpecies(static_cast<std::uint8_t>(species));
+    if (m_species.getCount() > 1) {
+        sf::Uint8 r, g, b;
+        SpeciesTable::color(species, r, g, b);
+        particle.setBaseColor(sf::Color(r, g, b, particle.getBaseColor().a));
+    }
+}
+
+void ParticleSystem::loadSpeciesPreset(SpeciesPreset preset) {
+    m_species.loadPreset(preset);
+    const auto& activeParticles = m_particlePool.getActiveParticles();
+    for (size_t i = 0; i < activeParticles.size(); ++i) {
+        assignSpecies(*activeParticles[i], i % m_species.getCount());
+    }
+    m_nextSpecies = activeParticles.size() % m_species.getCount();
+}
+
 void ParticleSystem::removeParticle(Particle* particle) {
     if (particle) {
         m_particlePool.releaseParticle(particle);
@@ -52,17 +193,180 @@ void ParticleSystem::removeParticle(size_t index) {
 }
 
 void ParticleSystem::update(float deltaTime, const PhysicsInputState& inputs) {
+    StepClock::time_point mark = StepClock::now();
+
     syncToSoA();
+    m_timings.syncToSoA += secondsSince(mark);
+
+    // trilhas, cabeças e a volta ao AoS são do quadro; só a física se repete por subpasso
+    int substeps = inputs.adaptiveSubsteps ? chooseSubsteps(deltaTime, inputs.integrator) : 1;
+    if (inputs.fluidEnabled) {
+        substeps = std::max(substeps, std::min(m_fluidSolver.requiredSubsteps(deltaTime), MAX_SUBSTEPS));
+    }
+    const float substepDt = deltaTime / static_cast<float>(substeps);
+    for (int s = 0; s < substeps; ++s) {
+        simulateStep(substepDt, inputs);
+    }
+    m_lastSubsteps = substeps;
+    m_timings.substeps += static_cast<std::uint64_t>(substeps);
+    mark = StepClock::now();
+
+    const size_t count = m_particlePool.getActiveCount();
+    m_splatting = m_frameGeometry && (m_renderMode == RenderMode::Density ||
+                                      (m_renderMode == RenderMode::Auto && count >= m_splatThreshold));
+    buildFrame(deltaTime);
+
+    if (m_splatting) {
+        // o mapa usa o pool com parallelFor, então fica fora do grafo
+        mark = StepClock::now();
+        renderSplat();
+        m_timings.splat += secondsSince(mark);
+    }
+
+    ++m_timings.steps;
+}
 
-    if (inputs.gravityEnabled) {
-        applyGravityEffect(inputs.gravitationalAcceleration);
+void ParticleSystem::buildFrame(float dt) {
+    const size_t count = m_particlePool.getActiveCount();
+    const size_t chunks = (count + FRAME_GRAIN - 1) / FRAME_GRAIN;
+    if (m_frameChunks.size() < chunks) m_frameChunks.resize(chunks);
+    if (m_splatting) m_soa_colors.resize(count);
+    if (m_frameGeometry) m_constraintVertices.resize(m_constraints.size() * 2);
+
+    // volta ao AoS -> (bloco a bloco) trilhas e cabeças -> junção de cada uma;
+    // as linhas das restrições ligam partículas de blocos quaisquer e esperam a volta inteira
+    TaskGraph& graph = m_frameGraph;
+    graph.clear();
+    const bool splatColors = m_splatting;
+    const TaskGraph::TaskId sync = graph.add(count, FRAME_GRAIN, [this, dt, splatColors](size_t begin, size_t end) {
+        syncFromSoA(begin, end, dt, splatColors);
+    });
+    if (m_frameGeometry) {
+        const TaskGraph::TaskId constraints = graph.add(m_constraints.size(), CONSTRAINT_VERTEX_GRAIN,
+                                                        [this](size_t begin, size_t end) {
+            buildConstraintVertices(begin, end);
+        });
+        graph.precede(sync, constraints);
     }
+
+    const bool buildsHeads = m_frameGeometry && !m_splatting;
+    // sem partículas não há bloco: a tarefa vazia rodaria o corpo com (0, 0) e
+    // indexaria m_frameChunks; as junções ainda rodam para esvaziar a geometria
+    const bool buildsChunks = buildsHeads && count > 0;
+    TaskGraph::TaskId trails = 0, trailJoin = 0, heads = 0, headJoin = 0;
+    if (buildsHeads) {
+        trailJoin = graph.add(0, 1, [this, chunks](size_t, size_t) {
+            gatherVertices(chunks, &FrameChunk::trails, m_trailVertices);
+        });
+        headJoin = graph.add(0, 1, [this, chunks](size_t, size_t) {
+            gatherVertices(chunks, &FrameChunk::heads, m_untexturedHeadVertices);
+        });
+    }
+    if (buildsChunks) {
+        trails = graph.add(count, FRAME_GRAIN, [this](size_t begin, size_t end) {
+            buildTrails(begin, end, m_frameChunks[begin / FRAME_GRAIN].trails);
+        });
+        heads = graph.add(count, FRAME_GRAIN, [this](size_t begin, size_t end) {
+            buildHeads(begin, end, m_frameChunks[begin / FRAME_GRAIN]);
+        });
+        graph.precedeChunks(sync, trails);
+        graph.precedeChunks(sync, heads);
+        graph.precede(trails, trailJoin);
+        graph.precede(heads, headJoin);
+    }
+    graph.run(ThreadPool::shared());
+
+    // tempo somado dos blocos: com as fases sobrepostas não há um intervalo de relógio para cada uma
+    m_timings.syncFromSoA += graph.getSeconds(sync);
+    if (buildsHeads) {
+        const double trailSeconds = buildsChunks ? graph.getSeconds(trails) : 0.0;
+        const double headSeconds = buildsChunks ? graph.getSeconds(heads) : 0.0;
+        m_timings.trails += trailSeconds + graph.getSeconds(trailJoin);
+        StepClock::time_point mark = StepClock::now();
+        // com chunks 0 só esvazia os lotes texturizados
+        gatherTexturedHeads(chunks);
+        m_timings.heads += headSeconds + graph.getSeconds(headJoin) + secondsSince(mark);
+    }
+}
+
+void ParticleSystem::gatherVertices(size_t chunks, std::vector<sf::Vertex> FrameChunk::*part, sf::VertexArray& out) {
+    size_t total = 0;
+    for (size_t c = 0; c < chunks; ++c) total += (m_frameChunks[c].*part).size();
+    out.resize(total);
+    size_t at = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        for (const sf::Vertex& vertex : m_frameChunks[c].*part) out[at++] = vertex;
+    }
+}
+
+void ParticleSystem::gatherTexturedHeads(size_t chunks) {
+    for (auto& pair : m_texturedHeadBatches) {
+        pair.second.clear();
+    }
+    // a textura é resolvida aqui, na thread do update: a provisória é criada na primeira chamada.
+    // Poucos handles distintos por quadro, então a busca linear basta
+    m_headTextures.clear();
+    m_visibleCount = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        m_visibleCount += m_frameChunks[c].visible;
+        for (const Particle* p : m_frameChunks[c].textured) {
+            const TextureHandle handle = p->getTextureHandle();
+            auto cached = std::find_if(m_headTextures.begin(), m_headTextures.end(),
+                                       [handle](const HeadTexture& entry) { return entry.handle == handle; });
+            if (cached == m_headTextures.end()) {
+                HeadTexture entry{handle, nullptr, {0.f, 0.f}};
+                if (const sf::Texture* texture = TextureManager::getTexture(handle)) {
+                    entry.batch = &m_texturedHeadBatches.try_emplace(texture, sf::Quads).first->second;
+                    entry.size = sf::Vector2f(texture->getSize());
+                }
+                cached = m_headTextures.insert(m_headTextures.end(), entry);
+            }
+            if (!cached->batch) continue;
+            const sf::Vector2f pos = p->getPosition();
+            const float radius = p->getRadius();
+            const sf::Color color = p->getColor();
+            const sf::Vector2f texSize = cached->size;
+            sf::VertexArray& batch = *cached->batch;
+            batch.append(sf::Vertex({pos.x - radius, pos.y - radius}, color, {0.f, 0.f}));
+            batch.append(sf::Vertex({pos.x + radius, pos.y - radius}, color, {texSize.x, 0.f}));
+            batch.append(sf::Vertex({pos.x + radius, pos.y + radius}, color, {texSize.x, texSize.y}));
+            batch.append(sf::Vertex({pos.x - radius, pos.y + radius}, color, {0.f, texSize.y}));
+        }
+    }
+}
+
+int ParticleSystem::chooseSubsteps(float deltaTime, StepKernels::IntegratorType integrator) const {
+    // maior |v| / r: quantos raios por segundo a partícula mais apressada anda
+    const float* __restrict velocities = m_soa_velocities.data();
+    const float* __restrict radii = m_soa_radii.data();
+    float maxRateSq = 0.0f;
+    for (size_t i = 0; i < m_particlePool.getActiveCount(); ++i) {
+        const float speedSq = velocities[i * 2] * velocities[i * 2] + velocities[i * 2 + 1] * velocities[i * 2 + 1];
+        const float radius = std::max(radii[i], MIN_SUBSTEP_RADIUS);
+        maxRateSq = std::max(maxRateSq, speedSq / (radius * radius));
+    }
+    const float needed = std::ceil(deltaTime * std::sqrt(maxRateSq) / StepKernels::courantLimit(integrator));
+    return static_cast<int>(std::min(std::max(needed, 1.0f), static_cast<float>(MAX_SUBSTEPS)));
+}
+
+void ParticleSystem::simulateStep(float deltaTime, const PhysicsInputState& inputs) {
+    StepClock::time_point mark = StepClock::now();
+
     if (inputs.repulsionEnabled) {
+        updateNeighbors(m_species.maxRange());
+        m_timings.neighbors += secondsSince(mark);
         applyInteractiveForces(inputs.repulsionStrength);
     }
-    if (inputs.mouseForceEnabled) {
-        applyMouseForce(inputs.mousePosition, inputs.mouseForceStrength, inputs.mouseForceAttractMode, inputs.forceMode);
+    if (inputs.fluidEnabled) {
+        if (!inputs.repulsionEnabled) {
+            m_soa_accelerations.assign(m_particlePool.getActiveCount() * 2, 0.0f);
+        }
+        const FluidSolver::Arrays fluid{m_soa_positions.data(), m_soa_velocities.data(), m_soa_masses.data(),
+                                        m_soa_radii.data(), m_soa_accelerations.data(),
+                                        m_particlePool.getActiveCount()};
+        m_fluidSolver.computeAccelerations(fluid, m_grid, ThreadPool::shared());
     }
+    m_timings.forces += secondsSince(mark);
 
     if (m_soa_previous_positions.size() != m_soa_positions.size()) {
         m_soa_previous_positions.resize(m_soa_positions.size());
@@ -70,42 +374,159 @@ void ParticleSystem::update(float deltaTime, const PhysicsInputState& inputs) {
             m_soa_previous_positions[i * 2]     = m_soa_positions[i * 2] - m_soa_velocities[i * 2] * deltaTime;
             m_soa_previous_positions[i * 2 + 1] = m_soa_positions[i * 2 + 1] - m_soa_velocities[i * 2 + 1] * deltaTime;
         }
+        m_previousDt = deltaTime;
+    }
+    // mudanças no conjunto de partículas já foram remapeadas em syncToSoA
+    if (inputs.integrator == StepKernels::IntegratorType::VelocityVerlet &&
+        m_soa_stored_accelerations.size() != m_soa_positions.size()) {
+        // sem a aceleração anterior a primeira correção fica em a * dt / 2
+        m_soa_stored_accelerations.assign(m_soa_positions.size(), 0.0f);
     }
 
-    // Chamar a função C otimizada
-    update_particles_c(
-        m_soa_positions.data(),
-        m_soa_previous_positions.data(),
-        m_soa_velocities.data(),
-        m_soa_accelerations.data(),
-        m_soa_masses.data(),
-        m_soa_radii.data(),
-        m_particlePool.getActiveCount(),
-        deltaTime,
-        m_width,
-        m_height,
-        inputs.collisionRestitution
-    );
+    integrate(deltaTime, inputs);
+    m_timings.integrate += secondsSince(mark);
 
-    syncFromSoA(deltaTime);
+    if (!m_constraints.empty()) {
+        const ConstraintSolver::Arrays arrays{m_soa_positions.data(), m_soa_velocities.data(),
+                                              m_soa_previous_positions.data(), m_soa_masses.data(),
+                                              m_particlePool.getActiveCount()};
+        m_constraintSolver.solve(m_constraints, deltaTime, arrays, ThreadPool::shared());
+    }
+    m_timings.constraints += secondsSince(mark);
 
-    if (inputs.collisionsEnabled) {
-        handleCollisions(inputs.collisionRestitution, deltaTime);
+    // no fluido a pressão é que mantém as partículas separadas
+    if (inputs.collisionsEnabled && !inputs.fluidEnabled) {
+        updateNeighbors(0.0f);
+        m_timings.neighbors += secondsSince(mark);
+        handleCollisions(inputs.collisionRestitution, deltaTime, inputs.solverIterations);
     }
-    
-    updateTrailVertices();
-    updateHeadVertices();
+    m_timings.collisions += secondsSince(mark);
+}
+
+void ParticleSystem::captureSnapshot(Snapshot::Data& out) const {
+    const auto& activeParticles = m_particlePool.getActiveParticles();
+    const size_t numParticles = activeParticles.size();
+    // posições anteriores só valem se o SoA ainda corresponde às partículas ativas
+    const bool hasPrevious = m_soa_previous_positions.size() == numParticles * 2 &&
+                             m_soaGeneration == m_particlePool.getGeneration();
+
+    out.worldWidth = m_width;
+    out.worldHeight = m_height;
+    out.positions.resize(numParticles * 2);
+    out.previousPositions.resize(numParticles * 2);
+    out.velocities.resize(numParticles * 2);
+    out.masses.resize(numParticles);
+    out.radii.resize(numParticles);
+    out.colors.resize(numParticles * 4);
+    out.types.resize(numParticles);
+    out.species.resize(numParticles);
+
+    for (size_t i = 0; i < numParticles; ++i) {
+        const Particle* p = activeParticles[i];
+        const sf::Vector2f pos = p->getPosition();
+        const sf::Vector2f vel = p->getVelocity();
+        const sf::Color color = p->getBaseColor();
+
+        out.positions[i * 2]     = pos.x;
+        out.positions[i * 2 + 1] = pos.y;
+        out.previousPositions[i * 2]     = hasPrevious ? m_soa_previous_positions[i * 2] : pos.x;
+        out.previousPositions[i * 2 + 1] = hasPrevious ? m_soa_previous_positions[i * 2 + 1] : pos.y;
+        out.velocities[i * 2]     = vel.x;
+        out.velocities[i * 2 + 1] = vel.y;
+        out.masses[i] = p->getMass();
+        out.radii[i] = p->getRadius();
+        out.colors[i * 4]     = color.r;
+        out.colors[i * 4 + 1] = color.g;
+        out.colors[i * 4 + 2] = color.b;
+        out.colors[i * 4 + 3] = color.a;
+        out.types[i] = static_cast<std::uint8_t>(p->getParticleType()) |
+                       static_cast<std::uint8_t>(p->getTextureVariant() << Snapshot::TYPE_BITS);
+        out.species[i] = p->getSpecies();
+    }
+}
+
+bool ParticleSystem::saveSnapshot(const std::string& path) {
+    if (m_snapshotWriter.isBusy()) {
+        std::cerr << "[AVISO] Snapshot anterior ainda sendo gravado, ignorando." << std::endl;
+        return false;
+    }
+    Snapshot::Data data;
+    captureSnapshot(data);
+    return m_snapshotWriter.saveAsync(path, std::move(data));
+}
+
+bool ParticleSystem::loadSnapshot(const std::string& path) {
+    Snapshot::View view;
+    return view.open(path) && loadSnapshot(view);
+}
+
+bool ParticleSystem::loadSnapshot(const Snapshot::View& view) {
+    // as posições só fazem sentido no mundo em que foram salvas
+    const float width = view.worldWidth();
+    const float height = view.worldHeight();
+    if (!(width > 0.0f && height > 0.0f && std::isfinite(width) && std::isfinite(height))) {
+        std::cerr << "[ERRO] Snapshot com tamanho de mundo inválido: " << width << "x" << height << std::endl;
+        return false;
+    }
+    setWorldSize(width, height);
+
+    const size_t count = view.count();
+    const float* positions = view.positions();
+    const float* velocities = view.velocities();
+    const float* masses = view.masses();
+    const float* radii = view.radii();
+    const std::uint8_t* colors = view.colors();
+    const std::uint8_t* types = view.types();
+    const std::uint8_t* species = view.species();
+
+    m_particlePool.clearAll();
+    m_particlePool.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const sf::Color color(colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]);
+        Particle* p = m_particlePool.acquireParticle(masses[i],
+                                                     {positions[i * 2], positions[i * 2 + 1]},
+                                                     {velocities[i * 2], velocities[i * 2 + 1]},
+                                                     color);
+        if (!p) break;
+        p->setRadius(radii[i]);
+        p->setBaseColor(color);
+        p->setSpecies(species ? species[i] : 0);
+        p->setSoAIndex(i);
+        p->setTextureVariant(static_cast<std::uint8_t>(types[i] >> Snapshot::TYPE_BITS));
+        const std::uint8_t type = types[i] & Snapshot::TYPE_MASK;
+        if (type != static_cast<std::uint8_t>(ParticleType::Original)) {
+            p->setParticleType(static_cast<ParticleType>(type));
+        }
+    }
+
+    // O SoA segue a ordem das partículas ativas, então as posições anteriores entram por cópia direta
+    const float* previous = view.previousPositions();
+    m_soa_previous_positions.assign(previous, previous + m_particlePool.getActiveCount() * 2);
+    m_soa_stored_accelerations.clear();
+    m_previousDt = 0.0f;
+    // o histórico acima já está na ordem das partículas carregadas
+    m_soaGeneration = m_particlePool.getGeneration();
+    return true;
 }
 
 void ParticleSystem::syncToSoA() {
     const auto& activeParticles = m_particlePool.getActiveParticles();
     const size_t numParticles = activeParticles.size();
+
+    // Partículas entraram ou saíram (a remoção põe a última no lugar da removida):
+    // o mesmo tamanho não quer dizer os mesmos índices
+    if (m_soaGeneration != m_particlePool.getGeneration()) {
+        remapStepHistory();
+        m_soaGeneration = m_particlePool.getGeneration();
+    }
     
     m_soa_positions.resize(numParticles * 2);
     m_soa_velocities.resize(numParticles * 2);
-    m_soa_accelerations.resize(numParticles * 2);
     m_soa_masses.resize(numParticles);
     m_soa_radii.resize(numParticles);
+    m_soa_species.resize(numParticles);
+    const std::uint8_t lastSpecies = static_cast<std::uint8_t>(m_species.getCount() - 1);
     
     for (size_t i = 0; i < numParticles; ++i) {
         Particle* p = activeParticles[i];
@@ -121,266 +542,343 @@ void ParticleSystem::syncToSoA() {
 
         m_soa_masses[i] = p->getMass();
         m_soa_radii[i] = p->getRadius();
+        // de um snapshot com mais espécies que a tabela atual, sobra a última
+        m_soa_species[i] = std::min(p->getSpecies(), lastSpecies);
     }
-
-    std::fill(m_soa_accelerations.begin(), m_soa_accelerations.end(), 0.0f);
 }
 
-void ParticleSystem::syncFromSoA(float dt) {
+void ParticleSystem::remapStepHistory() {
     const auto& activeParticles = m_particlePool.getActiveParticles();
     const size_t numParticles = activeParticles.size();
+    const size_t previousCount = m_soa_previous_positions.size() / 2;
+    const size_t storedCount = m_soa_stored_accelerations.size() / 2;
+
+    if (m_previousDt <= 0.0f) {
+        // sem passo conhecido não dá para estimar as das novas; update monta todas de novo
+        m_soa_previous_positions.clear();
+    } else if (previousCount > 0) {
+        m_soa_history_scratch.resize(numParticles * 2);
+        for (size_t i = 0; i < numParticles; ++i) {
+            const Particle* p = activeParticles[i];
+            const size_t old = p->getSoAIndex();
+            if (old < previousCount) {
+                m_soa_history_scratch[i * 2]     = m_soa_previous_positions[old * 2];
+                m_soa_history_scratch[i * 2 + 1] = m_soa_previous_positions[old * 2 + 1];
+            } else {
+                // nova: o deslocamento do último passo sai da velocidade inicial
+                const sf::Vector2f pos = p->getPosition();
+                const sf::Vector2f vel = p->getVelocity();
+                m_soa_history_scratch[i * 2]     = pos.x - vel.x * m_previousDt;
+                m_soa_history_scratch[i * 2 + 1] = pos.y - vel.y * m_previousDt;
+            }
+        }
+        m_soa_previous_positions.swap(m_soa_history_scratch);
+    }
 
+    if (storedCount > 0) {
+        m_soa_history_scratch.resize(numParticles * 2);
+        for (size_t i = 0; i < numParticles; ++i) {
+            const size_t old = activeParticles[i]->getSoAIndex();
+            // nova: sem aceleração anterior, como no primeiro passo
+            m_soa_history_scratch[i * 2]     = (old < storedCount) ? m_soa_stored_accelerations[old * 2] : 0.0f;
+            m_soa_history_scratch[i * 2 + 1] = (old < storedCount) ? m_soa_stored_accelerations[old * 2 + 1] : 0.0f;
+        }
+        m_soa_stored_accelerations.swap(m_soa_history_scratch);
+    }
+}
 
-    for (size_t i = 0; i < numParticles; ++i) {
+void ParticleSystem::syncFromSoA(size_t begin, size_t end, float dt, bool splatColors) {
+    const auto& activeParticles = m_particlePool.getActiveParticles();
+
+    for (size_t i = begin; i < end; ++i) {
         Particle* p = activeParticles[i];
         p->setPosition({m_soa_positions[i * 2], m_soa_positions[i * 2 + 1]});
         p->setVelocity({m_soa_velocities[i * 2], m_soa_velocities[i * 2 + 1]});
-        p->updateVisuals(dt);
+        if (m_frameGeometry) p->updateVisuals(dt);
+    }
+    if (splatColors) {
+        for (size_t i = begin; i < end; ++i) {
+            m_soa_colors[i] = activeParticles[i]->getColor().toInteger();
+        }
     }
 }
 
-void ParticleSystem::applyGravityEffect(float gravitationalAcceleration) {
-    const float MIN_VALID_MASS = 0.0001f;
-    const size_t numParticles = m_particlePool.getActiveCount();
-    
-    for (size_t i = 0; i < numParticles; ++i) {
-        const float mass = m_soa_masses[i];
-        if (mass > MIN_VALID_MASS) {
-            m_soa_accelerations[i * 2 + 1] += gravitationalAcceleration;
-        }
+void ParticleSystem::renderSplat() {
+    // cabeças e trilhas da última vez que foram montadas não voltam para a tela
+    m_trailVertices.clear();
+    m_untexturedHeadVertices.clear();
+    m_texturedHeadBatches.clear();
+
+    // sem câmera, o mundo todo a um pixel por unidade; com ela, só o que aparece,
+    // na resolução da tela (o custo não cresce com o tamanho do mundo)
+    sf::FloatRect area(0.0f, 0.0f, m_width, m_height);
+    float pixelsPerUnit = 1.0f;
+    if (m_hasViewArea) {
+        area = m_viewArea;
+        pixelsPerUnit = std::min(m_pixelsPerUnit, MAX_SPLAT_PIXELS / std::max(area.width, area.height));
+    }
+    const size_t width = static_cast<size_t>(std::max(area.width * pixelsPerUnit, 1.0f));
+    const size_t height = static_cast<size_t>(std::max(area.height * pixelsPerUnit, 1.0f));
+    m_splat.resize(width, height, area.left, area.top, area.width, area.height);
+    const DensitySplat::Arrays arrays{m_soa_positions.data(), m_soa_colors.data(),
+                                      m_particlePool.getActiveCount()};
+    m_splat.render(arrays, ThreadPool::shared());
+}
+
+ForceField ParticleSystem::makeMouseField(const PhysicsInputState& inputs) {
+    const float influenceRadius = 800.0f;
+    const float strength = inputs.mouseForceAttractMode ? inputs.mouseForceStrength : -inputs.mouseForceStrength;
+    const float x = inputs.mousePosition.x;
+    const float y = inputs.mousePosition.y;
+
+    switch (inputs.forceMode) {
+        case 1: // Redemoinho
+            return ForceField::vortex(x, y, strength, influenceRadius, 60.0f);
+        case 2: // Onda de Pulso
+            return ForceField::wave(x, y, strength, influenceRadius, 0.05f, 3.0f);
+        case 3: // Linha de Força
+            return ForceField::line(x, y, 1.0f, 0.0f, strength, influenceRadius);
+        default: // Padrão
+            return ForceField::pointAttractor(x, y, strength, influenceRadius);
+    }
+}
+
+void ParticleSystem::integrate(float deltaTime, const PhysicsInputState& inputs) {
+    // campos da cena + o do mouse, que muda a cada passo
+    m_stepFields = m_forceFields;
+    if (inputs.mouseForceEnabled) {
+        m_stepFields.add(makeMouseField(inputs));
+    }
+
+    m_obstacles.bake(m_width, m_height);
+    const StepKernels::DynamicStepFlags flags{inputs.gravityEnabled, !m_stepFields.empty(),
+                                              inputs.repulsionEnabled || inputs.fluidEnabled, !m_obstacles.empty(),
+                                              inputs.integrator};
+    const StepKernels::ExternalForceParams forces{inputs.gravitationalAcceleration, &m_stepFields, m_simulationTime};
+    const float previousDt = (m_previousDt > 0.0f) ? m_previousDt : deltaTime;
+    float minX, minY, maxX, maxY;
+    worldBounds(minX, minY, maxX, maxY);
+    const StepKernels::IntegrationParams integration{deltaTime, previousDt, minX, minY, maxX, maxY,
+                                                     inputs.collisionRestitution, m_obstacles.grid()};
+    const StepKernels::StepArrays arrays{
+        m_soa_positions.data(), m_soa_previous_positions.data(), m_soa_velocities.data(),
+        m_soa_masses.data(), m_soa_radii.data(), m_soa_accelerations.data(), m_soa_stored_accelerations.data(),
+        m_particlePool.getActiveCount()
+    };
+
+    // a variante é escolhida uma vez por passo; dentro do laço não há teste de flag
+    if (m_specializedKernels) {
+        StepKernels::selectStepKernel(flags)(forces, integration, arrays);
+    } else {
+        StepKernels::integrateParticlesGeneric(flags, forces, integration, arrays);
     }
+    m_simulationTime += deltaTime;
+    m_previousDt = deltaTime;
 }
 
 void ParticleSystem::draw(sf::RenderWindow& window) {
-    const sf::View& view = window.getView();
-    
-    // Calcular os limites da área visível com uma margem para partículas grandes
-    const float MARGIN = 50.0f; 
-    
-    const sf::FloatRect visibleArea(
-        view.getCenter().x - view.getSize().x / 2.0f - MARGIN,
-        view.getCenter().y - view.getSize().y / 2.0f - MARGIN,
-        view.getSize().x + MARGIN * 2.0f,
-        view.getSize().y + MARGIN * 2.0f
-    );
+    // o recorte pela câmera já aconteceu ao montar os vértices (setViewArea)
+    if (!m_obstacles.empty()) {
+        drawObstacles(window);
+    }
+    if (m_constraintVertices.getVertexCount() > 0) {
+        window.draw(m_constraintVertices);
+    }
     
+    if (m_splatting) {
+        const DensitySplat::Stats& stats = m_splat.getStats();
+        if (m_splatTextureVersion != m_splat.getVersion()) {
+            m_splatTextureVersion = m_splat.getVersion();
+            const sf::Vector2u size = m_splatTexture.getSize();
+            if (size.x != stats.width || size.y != stats.height) {
+                m_splatTexture.create(static_cast<unsigned>(stats.width), static_cast<unsigned>(stats.height));
+                m_splatSprite.setTexture(m_splatTexture, true);
+            }
+            m_splatTexture.update(m_splat.pixels());
+            m_splatSprite.setPosition(stats.areaLeft, stats.areaTop);
+            m_splatSprite.setScale(stats.areaWidth / static_cast<float>(stats.width),
+                                   stats.areaHeight / static_cast<float>(stats.height));
+        }
+        window.draw(m_splatSprite, sf::BlendAdd);
+        return;
+    }
+
     window.draw(m_trailVertices, sf::BlendAdd);
 
     window.draw(m_untexturedHeadVertices);
     for (const auto& pair : m_texturedHeadBatches) {
-        sf::RenderStates states(pair.first.get());
+        sf::RenderStates states(pair.first);
         window.draw(pair.second, states);
     }
 }
 
-void ParticleSystem::applyInteractiveForces(float strength) {
-    m_grid->clear();
-    const auto& activeParticles = m_particlePool.getActiveParticles();
-    for (Particle* p : activeParticles) {
-        m_grid->insert(p);
+void ParticleSystem::drawObstacles(sf::RenderWindow& window) {
+    // o que aparece na tela é o próprio campo de distância, então bate com o que a física vê
+    m_obstacles.bake(m_width, m_height);
+    if (m_obstacleTextureVersion != m_obstacles.getVersion()) {
+        m_obstacleTextureVersion = m_obstacles.getVersion();
+        const size_t nodesX = m_obstacles.getNodesX();
+        const size_t nodesY = m_obstacles.getNodesY();
+        const float* distances = m_obstacles.grid().values;
+        std::vector<sf::Uint8> pixels(nodesX * nodesY * 4);
+        for (size_t i = 0; i < nodesX * nodesY; ++i) {
+            // meia célula de borda suavizada
+            const float coverage = std::min(std::max(0.5f - distances[i] / m_obstacles.getCellSize(), 0.0f), 1.0f);
+            pixels[i * 4] = 70;
+            pixels[i * 4 + 1] = 80;
+            pixels[i * 4 + 2] = 110;
+            pixels[i * 4 + 3] = static_cast<sf::Uint8>(coverage * 255.0f);
+        }
+        m_obstacleTexture.create(static_cast<unsigned>(nodesX), static_cast<unsigned>(nodesY));
+        m_obstacleTexture.update(pixels.data());
+        m_obstacleTexture.setSmooth(true);
+        m_obstacleSprite.setTexture(m_obstacleTexture, true);
+        // o nó (i, j) fica em (i, j) * célula: o centro do texel cai em cima do nó
+        const float cell = m_obstacles.getCellSize();
+        m_obstacleSprite.setScale(cell, cell);
+        m_obstacleSprite.setPosition(-0.5f * cell, -0.5f * cell);
     }
+    window.draw(m_obstacleSprite);
+}
 
-    const float MAX_FORCE = 5000.0f;
-    const float MIN_DISTANCE = 5.0f;
-    
-    for (Particle* p1 : activeParticles) {
-        std::vector<Particle*> nearby = m_grid->getNearbyParticles(p1);
-        
-        for (Particle* p2 : nearby) {
-            if (p1->getSoAIndex() >= p2->getSoAIndex()) continue;
-
-            const float mass1 = p1->getMass();
-            const sf::Vector2f p1_pos = p1->getPosition();
-            
-            const float mass2 = p2->getMass();
-            const sf::Vector2f p2_pos = p2->getPosition();
-            
-            const float dx = p1_pos.x - p2_pos.x;
-            const float dy = p1_pos.y - p2_pos.y;
-            
-            const float distSq = dx * dx + dy * dy;
-
-            if (distSq > 0.0001f) {
-                const float dist = sqrt(distSq);
-                const float effectiveDist = (dist < MIN_DISTANCE) ? MIN_DISTANCE : dist;
-            const float massProduct = mass1 * mass2;
-            
-                float forceMagnitude = strength * massProduct / (effectiveDist * effectiveDist);
-            forceMagnitude = std::min(forceMagnitude, MAX_FORCE);
-            
-                const float fx = (dx / dist) * forceMagnitude;
-                const float fy = (dy / dist) * forceMagnitude;
-
-                size_t index1 = p1->getSoAIndex();
-                size_t index2 = p2->getSoAIndex();
+void ParticleSystem::buildConstraintVertices(size_t begin, size_t end) {
+    const auto& activeParticles = m_particlePool.getActiveParticles();
+    const std::uint32_t* a = m_constraints.a();
+    const std::uint32_t* b = m_constraints.b();
+    for (size_t c = begin; c < end; ++c) {
+        const Particle* first = activeParticles[a[c]];
+        const Particle* second = activeParticles[b[c]];
+        sf::Color color = first->getBaseColor();
+        color.a = 140;
+        m_constraintVertices[c * 2] = sf::Vertex(first->getPosition(), color);
+        m_constraintVertices[c * 2 + 1] = sf::Vertex(second->getPosition(), color);
+    }
+}
 
-                if (mass1 > 0.0001f) {
-                    m_soa_accelerations[index1 * 2]     += fx;
-                    m_soa_accelerations[index1 * 2 + 1] += fy;
+void ParticleSystem::addBody(BodyShape shape, const sf::Vector2f& position) {
+    // o pool pode reciclar as mais antigas no meio do caminho; aí os índices não
+    // seriam consecutivos, e o corpo fica sem restrições em vez de ligar outras
+    const size_t first = m_particlePool.getActiveCount();
+    auto index = [first](int i) { return static_cast<std::uint32_t>(first + static_cast<size_t>(i)); };
+    bool complete = true;
+    if (shape == BodyShape::SoftBox) {
+        const int side = SOFT_BOX_SIDE;
+        const float origin = -0.5f * BODY_SPACING * static_cast<float>(side - 1);
+        for (int row = 0; row < side && complete; ++row) {
+            for (int column = 0; column < side && complete; ++column) {
+                const sf::Vector2f at(position.x + origin + BODY_SPACING * static_cast<float>(column),
+                                      position.y + origin + BODY_SPACING * static_cast<float>(row));
+                complete = addParticle(BODY_MASS, at, {0.0f, 0.0f}, sf::Color(120, 220, 160)) != nullptr &&
+                           m_particlePool.getActiveCount() == first + static_cast<size_t>(row * side + column) + 1;
+            }
+        }
+        if (!complete) return;
+        const float diagonal = BODY_SPACING * std::sqrt(2.0f);
+        const float compliance = ConstraintStore::DEFAULT_SPRING_COMPLIANCE;
+        for (int row = 0; row < side; ++row) {
+            for (int column = 0; column < side; ++column) {
+                const int i = row * side + column;
+                if (column + 1 < side) {
+                    m_constraints.add(index(i), index(i + 1), BODY_SPACING, ConstraintType::Spring, compliance);
+                }
+                if (row + 1 < side) {
+                    m_constraints.add(index(i), index(i + side), BODY_SPACING, ConstraintType::Spring, compliance);
                 }
-                if (mass2 > 0.0001f) {
-                    m_soa_accelerations[index2 * 2]     -= fx;
-                    m_soa_accelerations[index2 * 2 + 1] -= fy;
+                if (column + 1 < side && row + 1 < side) {
+                    m_constraints.add(index(i), index(i + side + 1), diagonal, ConstraintType::Spring, compliance);
+                    m_constraints.add(index(i + 1), index(i + side), diagonal, ConstraintType::Spring, compliance);
                 }
             }
         }
+    } else if (shape == BodyShape::Chain) {
+        const float origin = -0.5f * BODY_SPACING * static_cast<float>(CHAIN_LINKS - 1);
+        for (int link = 0; link < CHAIN_LINKS && complete; ++link) {
+            const sf::Vector2f at(position.x + origin + BODY_SPACING * static_cast<float>(link), position.y);
+            complete = addParticle(BODY_MASS, at, {0.0f, 0.0f}, sf::Color(230, 190, 110)) != nullptr &&
+                       m_particlePool.getActiveCount() == first + static_cast<size_t>(link) + 1;
+        }
+        if (!complete) return;
+        for (int link = 0; link + 1 < CHAIN_LINKS; ++link) {
+            m_constraints.add(index(link), index(link + 1), BODY_SPACING, ConstraintType::Rope);
+        }
     }
 }
 
-void ParticleSystem::handleCollisions(float restitution, float deltaTime) {
-    m_grid->clear();
-    const auto& activeParticles = m_particlePool.getActiveParticles();
-    for (Particle* p : activeParticles) {
-        m_grid->insert(p);
+const Broadphase& ParticleSystem::getBroadphase() const {
+    switch (m_broadphaseType) {
+        case BroadphaseType::SweepAndPrune: return m_sweep;
+        case BroadphaseType::Tiles: return m_tileGrid;
+        default: return m_grid;
     }
-    
-    for (Particle* p1 : activeParticles) {
-        std::vector<Particle*> nearby = m_grid->getNearbyParticles(p1);
-        
-        for (Particle* p2 : nearby) {
-            if (p1->getSoAIndex() >= p2->getSoAIndex()) continue;
+}
 
-            const float r1 = p1->getRadius();
-            const float m1 = p1->getMass();
-            const float invM1 = (m1 > 0.0001f) ? 1.0f / m1 : 0.0f;
-            
-            const float r2 = p2->getRadius();
-            const float m2 = p2->getMass();
-            const float invM2 = (m2 > 0.0001f) ? 1.0f / m2 : 0.0f;
-            
-            const float radiusSum = r1 + r2;
-            const sf::Vector2f deltaPos = p1->getPosition() - p2->getPosition();
-            const float distSq = deltaPos.x * deltaPos.x + deltaPos.y * deltaPos.y;
-
-            if (distSq < radiusSum * radiusSum) {
-                const float distance = std::sqrt(distSq);
-                const sf::Vector2f normal = (distance > 0.0001f) ? deltaPos / distance : sf::Vector2f(1, 0);
-
-                const sf::Vector2f relativeVelocity = p1->getVelocity() - p2->getVelocity();
-                const float velAlongNormal = relativeVelocity.x * normal.x + relativeVelocity.y * normal.y;
-
-                if (velAlongNormal > 0) continue;
-
-                const float e = restitution;
-                float j = -(1.0f + e) * velAlongNormal;
-                j /= (invM1 + invM2);
-                const sf::Vector2f impulse = j * normal;
-                p1->setVelocity(p1->getVelocity() + impulse * invM1);
-                p2->setVelocity(p2->getVelocity() - impulse * invM2);
-
-                const sf::Vector2f tangent = {-normal.y, normal.x};
-                const float friction = 0.9f; 
-                const float vt = relativeVelocity.x * tangent.x + relativeVelocity.y * tangent.y;
-                sf::Vector2f tangent_impulse = tangent * (vt * friction);
-                tangent_impulse /= (invM1 + invM2);
-                p1->setVelocity(p1->getVelocity() - tangent_impulse * invM1);
-                p2->setVelocity(p2->getVelocity() + tangent_impulse * invM2);
-
-                const float percent = 0.5f; 
-                const float slop = 0.01f; 
-                const float penetration = std::max(radiusSum - distance - slop, 0.0f);
-                const sf::Vector2f correction = normal * (penetration / (invM1 + invM2)) * percent;
-                
-                p1->setPosition(p1->getPosition() + correction * invM1);
-                p2->setPosition(p2->getPosition() - correction * invM2);
-
-                size_t index1 = p1->getSoAIndex();
-                m_soa_previous_positions[index1 * 2] = p1->getPosition().x - p1->getVelocity().x * deltaTime;
-                m_soa_previous_positions[index1 * 2 + 1] = p1->getPosition().y - p1->getVelocity().y * deltaTime;
-                
-                size_t index2 = p2->getSoAIndex();
-                m_soa_previous_positions[index2 * 2] = p2->getPosition().x - p2->getVelocity().x * deltaTime;
-                m_soa_previous_positions[index2 * 2 + 1] = p2->getPosition().y - p2->getVelocity().y * deltaTime;
-            }
-        }
+Broadphase& ParticleSystem::activeBroadphase() {
+    switch (m_broadphaseType) {
+        case BroadphaseType::SweepAndPrune: return m_sweep;
+        case BroadphaseType::Tiles: return m_tileGrid;
+        default: return m_grid;
     }
 }
 
-void ParticleSystem::applyMouseForce(const sf::Vector2f& mousePosition, float strength, bool attractMode, int forceMode) {
-    const float influenceRadius = 800.0f; 
-    const float minMass = 1.0f; 
-
-    static float pulseTime = 0.0f;
-    pulseTime += 0.05f; 
-
-    for (size_t i = 0; i < m_particlePool.getActiveCount(); ++i) {
-        float px = m_soa_positions[i * 2];
-        float py = m_soa_positions[i * 2 + 1];
-        float mass = m_soa_masses[i];
-        
-        sf::Vector2f direction = mousePosition - sf::Vector2f(px, py);
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-        if (distance < influenceRadius && distance > 0.01f) {
-            
-            float normalizedDistance = std::min(1.0f, distance / influenceRadius);
-            float falloff = std::pow(1.0f - normalizedDistance, 2.0f);
-            
-            float forceMagnitude = strength * falloff / std::max(mass, minMass);
+void ParticleSystem::worldBounds(float& minX, float& minY, float& maxX, float& maxY) const {
+    if (m_unbounded) {
+        minX = minY = -std::numeric_limits<float>::infinity();
+        maxX = maxY = std::numeric_limits<float>::infinity();
+        return;
+    }
+    minX = 0.0f;
+    minY = 0.0f;
+    maxX = m_width;
+    maxY = m_height;
+}
 
-            if (!attractMode) {
-                forceMagnitude *= -1;
-            }
+void ParticleSystem::updateNeighbors(float margin) {
+    m_neighbors.update(m_soa_positions.data(), m_soa_radii.data(), m_particlePool.getActiveCount(), margin,
+                       m_particlePool.getGeneration(), activeBroadphase());
+}
 
-            sf::Vector2f force = {0.0f, 0.0f};
+void ParticleSystem::applyInteractiveForces(float strength) {
+    // só as forças entre pares passam por memória; o resto é somado no kernel fundido
+    m_soa_accelerations.assign(m_particlePool.getActiveCount() * 2, 0.0f);
+
+    // a lista pode trazer pares da margem extra (skin); o alcance exato é testado no lote
+    const PairForces::Arrays arrays{m_soa_positions.data(), m_soa_masses.data(), m_soa_radii.data(),
+                                    m_soa_species.data(), m_soa_accelerations.data(),
+                                    m_particlePool.getActiveCount()};
+    m_pairForces.apply(m_neighbors.pairs(), m_species, strength, arrays);
+}
 
-            switch (forceMode) {
-                case 0: { // Padrão
-                    force = (direction / distance) * forceMagnitude;
-                    break;
-                }
-                case 1: { // Redemoinho
-                    const float orbitRadius = 60.0f; // Raio da órbita estável
-
-                    sf::Vector2f radialForce;
-                    sf::Vector2f tangentForce;
-
-                    if (distance > orbitRadius) {
-                        radialForce = (direction / distance) * forceMagnitude * 2.0f;
-                        sf::Vector2f tangent = {-direction.y, direction.x};
-                        tangentForce = (tangent / distance) * forceMagnitude * 0.5f;
-                    } else {
-                        float pushStrength = forceMagnitude * (1.0f - distance / orbitRadius);
-                        radialForce = -(direction / distance) * pushStrength * 0.5f;
-
-                        // O giro é máximo para manter a órbita rápida e apertada.
-                        sf::Vector2f tangent = {-direction.y, direction.x};
-                        tangentForce = (tangent / distance) * forceMagnitude * 2.0f;
-                    }
-
-                    force = radialForce + tangentForce;
-                    break;
-                }
-                case 2: { // Onda de Pulso
-                    float pulse = sin(pulseTime - distance * 0.05f);
-                    force = (direction / distance) * forceMagnitude * pulse;
-                    break;
-                }
-                case 3: { // Linha de Força
-                    float dx = mousePosition.x - px;
-                    float lineFalloff = std::max(0.0f, 1.0f - std::abs(dx) / influenceRadius);
-                    float lineForce = strength * lineFalloff / std::max(mass, minMass);
-                    if (dx < 0) lineForce *= -1;
-                    if (!attractMode) lineForce *= -1;
-                    force = {lineForce, 0.0f};
-                    break;
-                }
-            }
-            m_soa_accelerations[i * 2]     += force.x;
-            m_soa_accelerations[i * 2 + 1] += force.y;
-        }
+void ParticleSystem::handleCollisions(float restitution, float deltaTime, int solverIterations) {
+    float minX, minY, maxX, maxY;
+    worldBounds(minX, minY, maxX, maxY);
+    const ContactSolver::Arrays arrays{m_soa_positions.data(), m_soa_velocities.data(),
+                                       m_soa_previous_positions.data(), m_soa_masses.data(), m_soa_radii.data(),
+                                       m_particlePool.getActiveCount(), minX, minY, maxX, maxY,
+                                       m_obstacles.empty() ? nullptr : &m_obstacles.grid(), m_soa_species.data(),
+                                       m_species.restitutionScales(), m_species.frictions()};
+    if (solverIterations > 0) {
+        m_contactSolver.solvePositions(m_neighbors.pairs(), solverIterations, restitution, deltaTime,
+                                       m_particlePool.getGeneration(), arrays);
+    } else {
+        m_contactSolver.solve(m_neighbors.pairs(), restitution, deltaTime, arrays);
     }
 }
 
-void ParticleSystem::generateRandomParticles(int count, float minMass, float maxMass) {
+size_t ParticleSystem::generateRandomParticles(int count, float minMass, float maxMass, ParticleType type) {
+    m_randomSpawns.clear();
     for (int i = 0; i < count; ++i) {
-        generateRandomParticle(minMass, maxMass);
+        m_randomSpawns.push_back(randomSpawn(minMass, maxMass, type));
     }
+    return addParticles(m_randomSpawns.data(), m_randomSpawns.size());
 }
 
 Particle* ParticleSystem::generateRandomParticle(float minMass, float maxMass) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    const ParticleSpawn spawn = randomSpawn(minMass, maxMass, ParticleType::Original);
+    return addParticle(spawn.mass, spawn.position, spawn.velocity, spawn.color);
+}
+
+ParticleSystem::ParticleSpawn ParticleSystem::randomSpawn(float minMass, float maxMass, ParticleType type) {
+    std::mt19937& gen = m_rng;
     float mass = std::uniform_real_distribution<float>(minMass, maxMass)(gen);
     
     const float r = std::uniform_real_distribution<float>(0.0f, 255.0f)(gen);
@@ -397,18 +895,37 @@ Particle* ParticleSystem::generateRandomParticle(float minMass, float maxMass) {
     float vx = std::uniform_real_distribution<float>(-50.0f, 50.0f)(gen);
     float vy = std::uniform_real_distribution<float>(-50.0f, 50.0f)(gen);
     
-    return addParticle(mass, sf::Vector2f(x, y), sf::Vector2f(vx, vy), color);
+    return {mass, sf::Vector2f(x, y), sf::Vector2f(vx, vy), color, type};
 }
 
-void ParticleSystem::updateTrailVertices() {
-    m_trailVertices.clear();
+void ParticleSystem::buildTrails(size_t begin, size_t end, std::vector<sf::Vertex>& out) const {
+    out.clear();
     const auto& activeParticles = m_particlePool.getActiveParticles();
 
-    for (const auto* particle : activeParticles) {
+    // fora da tela ou mais fina que meio pixel, a trilha não é montada
+    const bool cull = m_hasViewArea;
+    const float minTrailRadius = MIN_TRAIL_PIXELS / (1.4f * m_pixelsPerUnit);
+    for (size_t index = begin; index < end; ++index) {
+        const Particle* particle = activeParticles[index];
         auto trail = particle->getTrailData();
         if (trail.size < 2) {
             continue;
         }
+        if (cull) {
+            if (particle->getRadius() < minTrailRadius) {
+                continue;
+            }
+            // caixa entre a ponta mais nova e a mais velha, com folga para a curva e a espessura
+            const sf::Vector2f newest = trail.buffer[(trail.head - 1 + Particle::MAX_TRAIL_LENGTH) % Particle::MAX_TRAIL_LENGTH].position;
+            const sf::Vector2f oldest = trail.buffer[(trail.head - trail.size + Particle::MAX_TRAIL_LENGTH) % Particle::MAX_TRAIL_LENGTH].position;
+            const float margin = particle->getRadius() + std::abs(newest.x - oldest.x) + std::abs(newest.y - oldest.y);
+            if (std::max(newest.x, oldest.x) + margin < m_viewArea.left ||
+                std::min(newest.x, oldest.x) - margin > m_viewArea.left + m_viewArea.width ||
+                std::max(newest.y, oldest.y) + margin < m_viewArea.top ||
+                std::min(newest.y, oldest.y) - margin > m_viewArea.top + m_viewArea.height) {
+                continue;
+            }
+        }
 
         for (int i = 0; i < trail.size; ++i) {
             int current_idx = (trail.head - trail.size + i + Particle::MAX_TRAIL_LENGTH) % Particle::MAX_TRAIL_LENGTH;
@@ -437,58 +954,46 @@ void ParticleSystem::updateTrailVertices() {
             
             sf::Color color = trail.buffer[current_idx].color;
 
-            m_trailVertices.append(sf::Vertex(p - offset, color));
-            m_trailVertices.append(sf::Vertex(p + offset, color));
+            out.emplace_back(p - offset, color);
+            out.emplace_back(p + offset, color);
         }
 
-        if (m_trailVertices.getVertexCount() > 0) {
-            m_trailVertices.append(m_trailVertices[m_trailVertices.getVertexCount() - 1]);
-        }
+        // vértice repetido: a faixa da próxima trilha começa degenerada, sem ligar as duas
+        out.push_back(out.back());
     }
 }
 
-void ParticleSystem::updateHeadVertices() {
-    m_untexturedHeadVertices.clear();
-    for (auto& pair : m_texturedHeadBatches) {
-        pair.second.clear();
-    }
+void ParticleSystem::buildHeads(size_t begin, size_t end, FrameChunk& out) const {
+    out.heads.clear();
+    out.textured.clear();
+    out.visible = 0;
 
+    static const HeadCircles circles;
     const auto& activeParticles = m_particlePool.getActiveParticles();
-    for (const auto* p : activeParticles) {
+    for (size_t index = begin; index < end; ++index) {
+        const Particle* p = activeParticles[index];
         sf::Vector2f pos = p->getPosition();
         float radius = p->getRadius();
+        if (m_hasViewArea && (pos.x + radius < m_viewArea.left || pos.x - radius > m_viewArea.left + m_viewArea.width ||
+                              pos.y + radius < m_viewArea.top || pos.y - radius > m_viewArea.top + m_viewArea.height)) {
+            continue;
+        }
+        ++out.visible;
         sf::Color color = p->getColor();
 
-        sf::Vector2f topLeft(pos.x - radius, pos.y - radius);
-        sf::Vector2f topRight(pos.x + radius, pos.y - radius);
-        sf::Vector2f bottomRight(pos.x + radius, pos.y + radius);
-        sf::Vector2f bottomLeft(pos.x - radius, pos.y + radius);
-
-        auto texture = p->getTexture();
-        if (texture) {
-            if (m_texturedHeadBatches.find(texture) == m_texturedHeadBatches.end()) {
-                m_texturedHeadBatches[texture].setPrimitiveType(sf::Quads);
-            }
-            sf::VertexArray& batch = m_texturedHeadBatches[texture];
-            sf::Vector2u texSize = texture->getSize();
-            batch.append(sf::Vertex(topLeft, color, {0.f, 0.f}));
-            batch.append(sf::Vertex(topRight, color, {static_cast<float>(texSize.x), 0.f}));
-            batch.append(sf::Vertex(bottomRight, color, {static_cast<float>(texSize.x), static_cast<float>(texSize.y)}));
-            batch.append(sf::Vertex(bottomLeft, color, {0.f, static_cast<float>(texSize.y)}));
+        // com textura, o quad é montado depois do grafo (gatherTexturedHeads)
+        if (p->getTextureHandle() != TextureManager::INVALID_HANDLE) {
+            out.textured.push_back(p);
         } else {
-            const int pointCount = 12;
-            const float angleIncrement = (2.0f * 3.14159265f) / pointCount;
-
-            for (int i = 0; i < pointCount; ++i) {
-                float angle1 = i * angleIncrement;
-                float angle2 = (i + 1) * angleIncrement;
+            const std::vector<sf::Vector2f>& circle = circles.points[headLevel(radius * m_pixelsPerUnit)];
 
-                sf::Vector2f p1(pos.x + radius * std::cos(angle1), pos.y + radius * std::sin(angle1));
-                sf::Vector2f p2(pos.x + radius * std::cos(angle2), pos.y + radius * std::sin(angle2));
+            for (size_t i = 0; i + 1 < circle.size(); ++i) {
+                sf::Vector2f p1(pos.x + radius * circle[i].x, pos.y + radius * circle[i].y);
+                sf::Vector2f p2(pos.x + radius * circle[i + 1].x, pos.y + radius * circle[i + 1].y);
 
-                m_untexturedHeadVertices.append(sf::Vertex(pos, color));
-                m_untexturedHeadVertices.append(sf::Vertex(p1, color));
-                m_untexturedHeadVertices.append(sf::Vertex(p2, color));
+                out.heads.emplace_back(pos, color);
+                out.heads.emplace_back(p1, color);
+                out.heads.emplace_back(p2, color);
             }
         }
     }
@@ -2,10 +2,26 @@
 #include "Particle.h"
 #include "ParticlePool.h"
 #include "SpatialGrid.h"
+#include "SweepAndPrune.h"
+#include "TileGrid.h"
+#include "ContactSolver.h"
+#include "Constraints.h"
+#include "DensitySplat.h"
+#include "FluidSolver.h"
+#include "PairForces.h"
+#include "Species.h"
+#include "NeighborList.h"
+#include "Snapshot.h"
+#include "ForceField.h"
+#include "Obstacle.h"
+#include "StepKernels.h"
+#include "TaskGraph.h"
 #include <vector>
 #include <memory>
 #include <SFML/Graphics.hpp>
 #include <map>
+#include <random>
+#include <cstdint>
 
 class ParticleSystem {
 public:
@@ -20,7 +36,39 @@ public:
         sf::Vector2f mousePosition;
         float mouseForceStrength;
         bool mouseForceAttractMode;
-        int forceMode;
+        int forceMode; // 0 padrão, 1 redemoinho, 2 onda de pulso, 3 linha de força
+        int solverIterations; // 0 impulso em passada única; N >= 1 solver por posição com N iterações
+        StepKernels::IntegratorType integrator;
+        // divide o passo quando a partícula mais rápida andaria mais que courantLimit raios
+        bool adaptiveSubsteps;
+        // fluido SPH no lugar das colisões de disco; o passo também é dividido pelo limite acústico
+        bool fluidEnabled;
+    };
+
+    // Uma partícula de um lote de addParticles
+    struct ParticleSpawn {
+        float mass;
+        sf::Vector2f position;
+        sf::Vector2f velocity;
+        sf::Color color;
+        ParticleType type;
+    };
+
+    // Tempo acumulado (em segundos) de cada fase de update(). syncFromSoA, trails e
+    // heads rodam sobrepostas no grafo do quadro: contam o tempo somado dos blocos
+    struct StepTimings {
+        double syncToSoA = 0.0;
+        double neighbors = 0.0;
+        double forces = 0.0;
+        double integrate = 0.0;
+        double syncFromSoA = 0.0;
+        double collisions = 0.0;
+        double constraints = 0.0;
+        double trails = 0.0;
+        double heads = 0.0;
+        double splat = 0.0;
+        std::uint64_t steps = 0;
+        std::uint64_t substeps = 0;  // passos de física; > steps com subpassos adaptativos
     };
 
     ParticleSystem(float width, float height);
@@ -29,68 +77,283 @@ public:
     Particle* addParticle(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity, const sf::Color& color);
     void removeParticle(Particle* particle);
     void removeParticle(size_t index);
+    // Lote de partículas: o pool cresce uma vez só para o lote inteiro. Devolve
+    // quantas entraram (no limite do pool, as mais antigas dão lugar)
+    size_t addParticles(const ParticleSpawn* spawns, size_t count);
+    // Remove quem tiver o centro a menos de radius de center; devolve quantas saíram
+    size_t removeParticlesNear(const sf::Vector2f& center, float radius);
+    // Avança deltaTime; com adaptiveSubsteps a física roda em subpassos iguais
     void update(float deltaTime, const PhysicsInputState& inputs);
+    int getLastSubsteps() const { return m_lastSubsteps; }
     
     void draw(sf::RenderWindow& window);
     
-    void generateRandomParticles(int count, float minMass = 1.0f, float maxMass = 5.0f);
+    // Em lote, como addParticles; os sorteios seguem a ordem de generateRandomParticle
+    // chamada count vezes, então gravação e replay continuam iguais
+    size_t generateRandomParticles(int count, float minMass = 1.0f, float maxMass = 5.0f,
+                                   ParticleType type = ParticleType::Original);
     Particle* generateRandomParticle(float minMass, float maxMass);
     
-    void setWindowSize(float width, float height);
-    void handleCollisions(float restitution, float dt);
+    // Tamanho do mundo (as paredes); não acompanha a janela, que só muda a câmera
+    void setWorldSize(float width, float height);
+    // Mundo aberto: sem paredes, as partículas vão até onde a física levar; o
+    // tamanho do mundo continua valendo para a câmera e para gerar partículas
+    void setUnbounded(bool unbounded) { m_unbounded = unbounded; }
+    bool isUnbounded() const { return m_unbounded; }
+    void handleCollisions(float restitution, float dt, int solverIterations = 0);
     
     size_t getParticleCount() const { return m_particlePool.getActiveCount(); }
+    // Capacidade do pool além do limite de expansão automática (cenas grandes de fluido)
+    void reserveParticles(size_t count) { m_particlePool.reserve(count); }
+
+    void setRandomSeed(std::uint32_t seed) { m_rng.seed(seed); }
+
+    // Snapshot do mundo: a captura é feita aqui, a gravação em segundo plano.
+    // Carregar restaura também o tamanho do mundo em que ele foi salvo
+    void captureSnapshot(Snapshot::Data& out) const;
+    bool saveSnapshot(const std::string& path);
+    bool isSavingSnapshot() const { return m_snapshotWriter.isBusy(); }
+    bool loadSnapshot(const std::string& path);
+    bool loadSnapshot(const Snapshot::View& view);
+
+    const StepTimings& getStepTimings() const { return m_timings; }
+    void resetStepTimings() { m_timings = StepTimings(); m_neighbors.resetStats(); }
+
+    // Desligado, o passo usa o kernel genérico (para comparação nos benchmarks)
+    void setSpecializedKernels(bool enabled) { m_specializedKernels = enabled; }
+    bool usesSpecializedKernels() const { return m_specializedKernels; }
+
+    // Grafo do fim do update (volta ao AoS, trilhas, cabeças); parallel = false roda
+    // tudo na thread do update, na mesma ordem de nós
+    void setFrameGraphParams(const TaskGraph::Params& params) { m_frameGraph.setParams(params); }
+    const TaskGraph::Stats& getFrameGraphStats() const { return m_frameGraph.getStats(); }
+
+    // Desligado, nenhuma fase do passo usa o pool (grafo do quadro, fluido,
+    // restrições, tiles, mapa de densidade): é como vários mundos rodam ao mesmo
+    // tempo, um por thread (WorldBatch)
+    void setParallel(bool parallel);
+    // Desligado, o update só devolve posições e velocidades às partículas: sem
+    // trilhas, cabeças, cores por velocidade nem mapa de densidade. Para mundos
+    // que ninguém desenha; a física é a mesma
+    void setFrameGeometry(bool enabled);
+    bool hasFrameGeometry() const { return m_frameGeometry; }
+
+    // Campos de força fixos da cena; a força do mouse entra por cima deles a cada passo
+    ForceFieldSet& getForceFields() { return m_forceFields; }
+    const ForceFieldSet& getForceFields() const { return m_forceFields; }
+    static ForceField makeMouseField(const PhysicsInputState& inputs);
+
+    // Obstáculos estáticos da cena; o campo de distância é refeito no passo seguinte a uma mudança
+    ObstacleSet& getObstacles() { return m_obstacles; }
+    const ObstacleSet& getObstacles() const { return m_obstacles; }
+    float getWorldWidth() const { return m_width; }
+    float getWorldHeight() const { return m_height; }
+
+    // Região do mundo na tela e pixels por unidade, para o próximo update: trilhas
+    // e cabeças fora dela não são montadas, o número de lados do disco segue o
+    // raio na tela e o mapa de densidade cobre só a região, na resolução da tela.
+    // Sem chamar (o replay), tudo é montado com um pixel por unidade.
+    void setViewArea(const sf::FloatRect& area, float pixelsPerUnit);
+    // Partículas com cabeça montada no último update
+    size_t getVisibleCount() const { return m_visibleCount; }
+
+    // Com skin > 0, os pares de repulsão/colisão vêm de uma lista de Verlet reaproveitada
+    // entre passos; com 0 (padrão) a grade refaz os pares a cada passo.
+    void setNeighborSkin(float skin) { m_neighbors.setSkin(skin); }
+    float getNeighborSkin() const { return m_neighbors.getSkin(); }
+    const NeighborList::Stats& getNeighborStats() const { return m_neighbors.getStats(); }
+    const ContactSolver::Stats& getContactStats() const { return m_contactSolver.getStats(); }
+    // Partida dos lambdas do passo anterior no solver por posição (ligada por padrão)
+    void setWarmStarting(bool enabled) { m_contactSolver.setWarmStarting(enabled); }
+
+    // Espécies: força entre pares por par de espécies, restituição e atrito por espécie.
+    // Quem nasce recebe a próxima espécie em rodízio; trocar o preset redistribui as
+    // partículas existentes do mesmo jeito (e, com mais de uma, pinta pela espécie).
+    void loadSpeciesPreset(SpeciesPreset preset);
+    SpeciesTable& getSpecies() { return m_species; }
+    const SpeciesTable& getSpecies() const { return m_species; }
+    const PairForces::Stats& getPairForceStats() const { return m_pairForces.getStats(); }
+
+    // Molas, hastes e cordas entre partículas. A loja segue o pool: partícula
+    // removida leva junto as restrições em que estava.
+    ConstraintStore& getConstraints() { return m_constraints; }
+    const ConstraintStore& getConstraints() const { return m_constraints; }
+    void setConstraintParams(const ConstraintSolver::Params& params) { m_constraintSolver.setParams(params); }
+    const ConstraintSolver::Stats& getConstraintStats() const { return m_constraintSolver.getStats(); }
+    // Monta um corpo pronto centrado em position (partículas e restrições)
+    void addBody(BodyShape shape, const sf::Vector2f& position);
+
+    // Acima de splatThreshold partículas (no modo Auto) a tela mostra o mapa de
+    // densidade em vez de cabeças e trilhas
+    void setRenderMode(RenderMode mode) { m_renderMode = mode; }
+    RenderMode getRenderMode() const { return m_renderMode; }
+    void setSplatThreshold(size_t count) { m_splatThreshold = count; }
+    size_t getSplatThreshold() const { return m_splatThreshold; }
+    // Se o último update montou o mapa de densidade
+    bool isSplatting() const { return m_splatting; }
+    void setSplatParams(const DensitySplat::Params& params) { m_splat.setParams(params); }
+    const DensitySplat::Stats& getSplatStats() const { return m_splat.getStats(); }
+
+    // Geometria que o último update montou, a mesma que draw desenha; é o que o
+    // SoftwareRenderer rasteriza sem janela
+    const sf::VertexArray& getTrailVertices() const { return m_trailVertices; }
+    const sf::VertexArray& getHeadVertices() const { return m_untexturedHeadVertices; }
+    const std::map<const sf::Texture*, sf::VertexArray>& getTexturedHeadBatches() const {
+        return m_texturedHeadBatches;
+    }
+    const sf::VertexArray& getConstraintVertices() const { return m_constraintVertices; }
+    const DensitySplat& getSplat() const { return m_splat; }
+
+    void setFluidParams(const FluidSolver::Params& params) { m_fluidSolver.setParams(params); }
+    const FluidSolver::Params& getFluidParams() const { return m_fluidSolver.getParams(); }
+    const FluidSolver::Stats& getFluidStats() const { return m_fluidSolver.getStats(); }
+
+    // Busca de pares: grade (padrão), sweep-and-prune ou tiles esparsos
+    void setBroadphase(BroadphaseType type) { m_broadphaseType = type; m_neighbors.invalidate(); }
+    BroadphaseType getBroadphaseType() const { return m_broadphaseType; }
+    const Broadphase& getBroadphase() const;
+
+    // Célula da grade de pares; 0 (padrão) ajusta pela distribuição dos raios
+    void setGridCellSize(float cellSize) { m_grid.setCellSize(cellSize); m_neighbors.invalidate(); }
+    const SpatialGrid::GridStats& getGridStats() const { return m_grid.getGridStats(); }
+    const TileGrid::TileStats& getTileStats() const { return m_tileGrid.getTileStats(); }
 
 private:
+    // Um passo de física sobre o SoA: vizinhos, forças, integração, restrições e colisões
+    void simulateStep(float deltaTime, const PhysicsInputState& inputs);
+    // Subpassos para que ninguém ande mais que courantLimit raios em cada um
+    int chooseSubsteps(float deltaTime, StepKernels::IntegratorType integrator) const;
+    // Atualiza m_neighbors para o alcance ra + rb + margin
+    void updateNeighbors(float margin);
+    Broadphase& activeBroadphase();
+    // Paredes do passo: o retângulo do mundo, ou infinitas no mundo aberto
+    void worldBounds(float& minX, float& minY, float& maxX, float& maxY) const;
     void applyInteractiveForces(float repulsionStrength);
-    void applyGravityEffect(float gravitationalAcceleration);
-    void applyMouseForce(const sf::Vector2f& mousePosition, float strength, bool attractMode, int forceMode);
-    void updateHeadVertices();
+    void assignSpecies(Particle& particle, size_t species);
+    // Forças externas + Verlet + bordas, numa só passada pelo kernel escolhido para as flags
+    void integrate(float deltaTime, const PhysicsInputState& inputs);
+    void drawObstacles(sf::RenderWindow& window);
 
-    void syncToSoA();
-    void syncFromSoA(float dt);
+    // Vértices de um bloco de partículas do quadro, montados por uma tarefa do grafo
+    struct FrameChunk {
+        std::vector<sf::Vertex> trails;
+        std::vector<sf::Vertex> heads;              // sem textura
+        std::vector<const Particle*> textured;      // quads montados depois, na thread do update
+        size_t visible = 0;
+    };
+
+    // Fim do update como grafo de tarefas: volta ao AoS, trilhas, cabeças e linhas
+    // das restrições, com trilhas e cabeças de um bloco começando assim que a volta
+    // daquele bloco termina
+    void buildFrame(float dt);
+    void buildTrails(size_t begin, size_t end, std::vector<sf::Vertex>& out) const;
+    void buildHeads(size_t begin, size_t end, FrameChunk& out) const;
+    void buildConstraintVertices(size_t begin, size_t end);
+    // Emenda os vértices dos blocos em ordem: o resultado é o de uma passada só
+    void gatherVertices(size_t chunks, std::vector<sf::Vertex> FrameChunk::*part, sf::VertexArray& out);
+    void gatherTexturedHeads(size_t chunks);
 
-    void updateTrailVertices();
+    ParticleSpawn randomSpawn(float minMass, float maxMass, ParticleType type);
+    void syncToSoA();
+    // Leva as posições anteriores e as acelerações guardadas de cada partícula
+    // para o índice que ela ocupa agora; chamada antes de syncToSoA reatribuir os índices
+    void remapStepHistory();
+    // Com splatColors, guarda também a cor de cada partícula para o mapa de densidade
+    void syncFromSoA(size_t begin, size_t end, float dt, bool splatColors);
+    void renderSplat();
 
     ParticlePool m_particlePool;
-    std::unique_ptr<SpatialGrid> m_grid;
+    SpatialGrid m_grid;
+    SweepAndPrune m_sweep;
+    TileGrid m_tileGrid;
+    BroadphaseType m_broadphaseType = BroadphaseType::Grid;
+    NeighborList m_neighbors;
+    ContactSolver m_contactSolver;
+    FluidSolver m_fluidSolver;
+    ConstraintStore m_constraints;
+    ConstraintSolver m_constraintSolver;
+    sf::VertexArray m_constraintVertices;
+    DensitySplat m_splat;
+    RenderMode m_renderMode = RenderMode::Auto;
+    size_t m_splatThreshold = DEFAULT_SPLAT_THRESHOLD;
+    bool m_splatting = false;
+    sf::Texture m_splatTexture;
+    sf::Sprite m_splatSprite;
+    std::uint64_t m_splatTextureVersion = 0;
+    PairForces m_pairForces;
+    SpeciesTable m_species;
+    size_t m_nextSpecies = 0;
+    std::uint64_t m_spawnCount = 0;  // escolhe a variante de textura de cada nova partícula
+    std::mt19937 m_rng;
+    std::vector<ParticleSpawn> m_randomSpawns;
+    StepTimings m_timings;
+    ForceFieldSet m_forceFields;
+    ForceFieldSet m_stepFields;
+    ObstacleSet m_obstacles;
+    sf::Texture m_obstacleTexture;
+    sf::Sprite m_obstacleSprite;
+    std::uint64_t m_obstacleTextureVersion = 0;
+    double m_simulationTime = 0.0;
+    float m_previousDt = 0.0f;  // 0: posições anteriores recém-montadas, sem passo conhecido
+    int m_lastSubsteps = 1;
+    bool m_specializedKernels = true;
+    bool m_frameGeometry = true;
     float m_width;
     float m_height;
+    bool m_unbounded = false;
+    sf::FloatRect m_viewArea;
+    float m_pixelsPerUnit = 1.0f;
+    bool m_hasViewArea = false;
+    size_t m_visibleCount = 0;
     
     static constexpr size_t INITIAL_POOL_CAPACITY = 1000;
-    static constexpr float GRID_CELL_SIZE = 60.0f;
+    // daqui para cima cada partícula ocupa menos que um pixel numa tela comum
+    static constexpr size_t DEFAULT_SPLAT_THRESHOLD = 200000;
     static constexpr float MOUSE_FORCE_STEP = 10000.0f;
+    static constexpr int MAX_SUBSTEPS = 16;
+    // piso do raio no critério dos subpassos, para partículas degeneradas não travarem o quadro
+    static constexpr float MIN_SUBSTEP_RADIUS = 1.0f;
+    // corpos prontos
+    static constexpr int SOFT_BOX_SIDE = 6;
+    static constexpr int CHAIN_LINKS = 24;
+    static constexpr float BODY_SPACING = 16.0f;
+    static constexpr float BODY_MASS = 2.0f;
+    // trilhas mais finas que isto na tela (em pixels) não são montadas
+    static constexpr float MIN_TRAIL_PIXELS = 0.5f;
+    // lado máximo, em pixels da tela, do mapa de densidade que segue a câmera
+    static constexpr float MAX_SPLAT_PIXELS = 4096.0f;
+    // partículas por bloco do grafo do quadro e restrições por bloco das linhas
+    static constexpr size_t FRAME_GRAIN = 1024;
+    static constexpr size_t CONSTRAINT_VERTEX_GRAIN = 16384;
+
+    TaskGraph m_frameGraph;
+    std::vector<FrameChunk> m_frameChunks;
 
     sf::VertexArray m_trailVertices;
     sf::VertexArray m_untexturedHeadVertices;
-    std::map<std::shared_ptr<sf::Texture>, sf::VertexArray> m_texturedHeadBatches;
+    // chave é a textura resolvida na hora de montar os vértices (pode ser a provisória)
+    std::map<const sf::Texture*, sf::VertexArray> m_texturedHeadBatches;
+    // handles vistos no quadro: o TextureManager (e o mapa) é consultado uma vez por handle
+    struct HeadTexture {
+        TextureHandle handle;
+        sf::VertexArray* batch;  // nullptr quando o handle não resolve para textura
+        sf::Vector2f size;
+    };
+    std::vector<HeadTexture> m_headTextures;
 
     std::vector<float> m_soa_positions;
     std::vector<float> m_soa_velocities;
+    // só as forças entre pares (repulsão e fluido); as demais nunca passam por memória
     std::vector<float> m_soa_accelerations;
     std::vector<float> m_soa_masses;
     std::vector<float> m_soa_radii;
+    std::vector<std::uint8_t> m_soa_species;
+    std::vector<std::uint32_t> m_soa_colors;  // só no modo densidade
     std::vector<float> m_soa_previous_positions;
-};
+    // só com a velocity Verlet: aceleração usada no passo anterior
+    std::vector<float> m_soa_stored_accelerations;
+    std::vector<float> m_soa_history_scratch;
+    std::uint64_t m_soaGeneration = 0;  // ParticlePool::getGeneration do último syncToSoA
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-void update_particles_c(
-    float* positions,
-    float* previous_positions,
-    float* velocities,
-    float* accelerations,
-    float* masses,
-    float* radii,
-    int particle_count,
-    float dt,
-    float world_width,
-    float world_height,
-    float restitution
-);
-
-#ifdef __cplusplus
-}
-#endif
+    SnapshotWriter m_snapshotWriter;
+};
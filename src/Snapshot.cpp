@@ -0,0 +1,176 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    constexpr std::uint64_t SECTION_BYTES_PER_PARTICLE[Snapshot::SectionCount] = {
+        2 * sizeof(float),  // Positions
+        2 * sizeof(float),  // PreviousPositions
+        2 * sizeof(float),  // Velocities
+        sizeof(float),      // Masses
+        sizeof(float),      // Radii
+        4,                  // Colors
+        1,                  // Types
+        1,                  // Species
+    };
+
+    std::uint64_t alignUp(std::uint64_t value) {
+        return (value + Snapshot::SECTION_ALIGNMENT - 1) & ~(Snapshot::SECTION_ALIGNMENT - 1);
+    }
+
+    void computeOffsets(std::uint64_t count, std::uint64_t offsets[Snapshot::SectionCount]) {
+        std::uint64_t cursor = alignUp(sizeof(Snapshot::Header));
+        for (std::uint32_t s = 0; s < Snapshot::SectionCount; ++s) {
+            offsets[s] = cursor;
+            cursor = alignUp(cursor + count * SECTION_BYTES_PER_PARTICLE[s]);
+        }
+    }
+}
+
+bool Snapshot::write(const std::string& path, const Data& data) {
+    const std::uint64_t count = data.count();
+    if (data.positions.size() != count * 2 || data.previousPositions.size() != count * 2 ||
+        data.velocities.size() != count * 2 || data.radii.size() != count ||
+        data.colors.size() != count * 4 || data.types.size() != count || data.species.size() != count) {
+        std::cerr << "[ERRO] Snapshot inconsistente, nada foi gravado." << std::endl;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.particleCount = count;
+    header.worldWidth = data.worldWidth;
+    header.worldHeight = data.worldHeight;
+    computeOffsets(count, header.sectionOffsets);
+
+    const void* sections[SectionCount] = {
+        data.positions.data(), data.previousPositions.data(), data.velocities.data(),
+        data.masses.data(), data.radii.data(), data.colors.data(), data.types.data(), data.species.data(),
+    };
+
+    // Grava num arquivo temporário e renomeia, para nunca deixar um snapshot pela metade
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "[ERRO] Não foi possível criar o snapshot: " << tempPath << std::endl;
+            return false;
+        }
+
+        static const char padding[SECTION_ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::uint64_t written = sizeof(header);
+
+        for (std::uint32_t s = 0; s < SectionCount; ++s) {
+            out.write(padding, static_cast<std::streamsize>(header.sectionOffsets[s] - written));
+            const std::uint64_t bytes = count * SECTION_BYTES_PER_PARTICLE[s];
+            out.write(static_cast<const char*>(sections[s]), static_cast<std::streamsize>(bytes));
+            written = header.sectionOffsets[s] + bytes;
+        }
+
+        if (!out) {
+            std::cerr << "[ERRO] Falha ao gravar o snapshot: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "[ERRO] Não foi possível renomear o snapshot para " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Snapshot::View::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) {
+        std::cerr << "[ERRO] Não foi possível abrir o snapshot: " << path << std::endl;
+        return false;
+    }
+    m_data = m_file.data();
+    m_size = m_file.size();
+    return parse(path);
+}
+
+bool Snapshot::View::open(std::vector<unsigned char>&& bytes) {
+    close();
+    m_bytes = std::move(bytes);
+    m_data = m_bytes.data();
+    m_size = m_bytes.size();
+    return parse("(em memória)");
+}
+
+void Snapshot::View::close() {
+    m_file.close();
+    m_bytes.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+    m_hasSpecies = false;
+}
+
+bool Snapshot::View::parse(const std::string& name) {
+    // o cabeçalho da versão 1 é o atual sem o último offset
+    constexpr size_t headerBytesV1 = sizeof(Header) - sizeof(std::uint64_t);
+    Header header{};
+    if (m_size < headerBytesV1) {
+        std::cerr << "[ERRO] Snapshot truncado: " << name << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header, m_data, std::min(m_size, sizeof(header)));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version < 1 || header.version > VERSION ||
+        (header.version >= VERSION_SPECIES && m_size < sizeof(header))) {
+        std::cerr << "[ERRO] Snapshot inválido ou de versão incompatível: " << name << std::endl;
+        close();
+        return false;
+    }
+    m_hasSpecies = header.version >= VERSION_SPECIES;
+    const std::uint32_t sectionCount = m_hasSpecies ? SectionCount : Species;
+
+    for (std::uint32_t s = 0; s < sectionCount; ++s) {
+        const std::uint64_t offset = header.sectionOffsets[s];
+        // a contagem é comparada com o que cabe antes de multiplicar: um cabeçalho
+        // forjado não pode dar a volta no u64 e passar no teste de limite
+        if (offset % SECTION_ALIGNMENT != 0 || offset > m_size ||
+            header.particleCount > (m_size - offset) / SECTION_BYTES_PER_PARTICLE[s]) {
+            std::cerr << "[ERRO] Seção " << s << " do snapshot fora dos limites: " << name << std::endl;
+            close();
+            return false;
+        }
+        m_offsets[s] = offset;
+    }
+
+    m_count = static_cast<size_t>(header.particleCount);
+    m_worldWidth = header.worldWidth;
+    m_worldHeight = header.worldHeight;
+    return true;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool SnapshotWriter::saveAsync(const std::string& path, Snapshot::Data&& data) {
+    if (m_busy.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_busy.store(true, std::memory_order_release);
+    m_thread = std::thread([this, path, data = std::move(data)]() {
+        Snapshot::write(path, data);
+        m_busy.store(false, std::memory_order_release);
+    });
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Snapshot binário do estado SoA de um mundo. Cada seção começa alinhada a
+// SECTION_ALIGNMENT, então o carregamento só mapeia o arquivo e aponta para os
+// arrays; não há parsing por partícula.
+//
+// Layout: Header | posições (2N f32) | posições anteriores (2N f32) |
+//         velocidades (2N f32) | massas (N f32) | raios (N f32) |
+//         cores (4N u8, RGBA) | tipos (N u8) | espécies (N u8)
+//
+// Cada byte de tipos traz o ParticleType nos 4 bits baixos e a variante de
+// textura nos altos (arquivos antigos têm variante 0).
+//
+// A versão 1 não tinha espécies: o cabeçalho tem uma seção a menos (os offsets
+// param em Types) e todas as partículas são da espécie 0.
+namespace Snapshot {
+    constexpr char MAGIC[4] = {'C', 'H', 'S', 'N'};
+    constexpr std::uint32_t VERSION = 2;
+    constexpr std::uint32_t VERSION_SPECIES = 2;
+    constexpr std::uint64_t SECTION_ALIGNMENT = 64;
+    constexpr std::uint8_t TYPE_BITS = 4;
+    constexpr std::uint8_t TYPE_MASK = (1u << TYPE_BITS) - 1;
+
+    enum Section : std::uint32_t {
+        Positions,
+        PreviousPositions,
+        Velocities,
+        Masses,
+        Radii,
+        Colors,
+        Types,
+        Species,
+        SectionCount
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t particleCount;
+        float worldWidth;
+        float worldHeight;
+        std::uint64_t sectionOffsets[SectionCount];
+    };
+
+    // Cópia do estado capturada no thread de física, entregue ao writer
+    struct Data {
+        float worldWidth = 0.0f;
+        float worldHeight = 0.0f;
+        std::vector<float> positions;
+        std::vector<float> previousPositions;
+        std::vector<float> velocities;
+        std::vector<float> masses;
+        std::vector<float> radii;
+        std::vector<std::uint8_t> colors;
+        std::vector<std::uint8_t> types;
+        std::vector<std::uint8_t> species;
+
+        size_t count() const { return masses.size(); }
+    };
+
+    bool write(const std::string& path, const Data& data);
+
+    // Snapshot mapeado em memória; os ponteiros apontam direto para o arquivo
+    class View {
+    public:
+        bool open(const std::string& path);
+        // O arquivo inteiro já lido (o que o log de entrada guarda num carregamento)
+        bool open(std::vector<unsigned char>&& bytes);
+
+        // Bytes do arquivo, como estão no disco
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+        size_t count() const { return m_count; }
+        float worldWidth() const { return m_worldWidth; }
+        float worldHeight() const { return m_worldHeight; }
+
+        const float* positions() const { return section<float>(Positions); }
+        const float* previousPositions() const { return section<float>(PreviousPositions); }
+        const float* velocities() const { return section<float>(Velocities); }
+        const float* masses() const { return section<float>(Masses); }
+        const float* radii() const { return section<float>(Radii); }
+        const std::uint8_t* colors() const { return section<std::uint8_t>(Colors); }
+        const std::uint8_t* types() const { return section<std::uint8_t>(Types); }
+        // nullptr num snapshot de versão 1: todos da espécie 0
+        const std::uint8_t* species() const { return m_hasSpecies ? section<std::uint8_t>(Species) : nullptr; }
+
+    private:
+        template <typename T>
+        const T* section(Section s) const {
+            return reinterpret_cast<const T*>(m_data + m_offsets[s]);
+        }
+
+        // Valida o cabeçalho e as seções de m_data; name só aparece nas mensagens
+        bool parse(const std::string& name);
+        void close();
+
+        MappedFile m_file;
+        std::vector<unsigned char> m_bytes;
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_count = 0;
+        float m_worldWidth = 0.0f;
+        float m_worldHeight = 0.0f;
+        std::uint64_t m_offsets[SectionCount] = {};
+        bool m_hasSpecies = false;
+    };
+}
+
+// Grava snapshots num thread próprio; o passo de física só paga a captura.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Retorna false se ainda houver uma gravação em andamento.
+    bool saveAsync(const std::string& path, Snapshot::Data&& data);
+    bool isBusy() const { return m_busy.load(std::memory_order_acquire); }
+
+private:
+    std::thread m_thread;
+    std::atomic<bool> m_busy{false};
+};
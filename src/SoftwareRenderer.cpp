@@ -0,0 +1,724 @@
+#include "SoftwareRenderer.h"
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // ponto fixo dos vértices: 1/256 px, como o subpixel das GPUs
+    constexpr int SUBPIXEL_BITS = 8;
+    constexpr std::int64_t SUBPIXEL_ONE = std::int64_t(1) << SUBPIXEL_BITS;
+    constexpr std::int64_t SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+    // vértices mais longe que isto da tela são presos, para os produtos caberem em 64 bits
+    constexpr float COORDINATE_LIMIT = 65536.0f;
+    // primitivas por lote da distribuição
+    constexpr size_t BLOCK_SIZE = 16384;
+    // a mesma cor de ParticleSystem::drawObstacles
+    constexpr float OBSTACLE_COLOR[3] = {70.0f, 80.0f, 110.0f};
+    // cor de fundo de main quando background.png não existe
+    const sf::Color FALLBACK_BACKGROUND(20, 20, 50);
+
+    std::int64_t toFixed(float screen) {
+        const float clamped = std::min(std::max(screen, -COORDINATE_LIMIT), COORDINATE_LIMIT);
+        return static_cast<std::int64_t>(std::floor(clamped * static_cast<float>(SUBPIXEL_ONE) + 0.5f));
+    }
+
+    // pixel que contém a coordenada em ponto fixo, arredondando para baixo também nos negativos
+    std::int64_t fixedFloor(std::int64_t value) {
+        return value >= 0 ? value >> SUBPIXEL_BITS : -((-value + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS);
+    }
+
+    // float em [0, 255] -> unorm8 como o blending do OpenGL (arredondado)
+    std::uint8_t toUnorm(float value) {
+        return static_cast<std::uint8_t>(std::min(value, 255.0f) + 0.5f);
+    }
+
+    // sf::BlendAlpha: src * a + dst * (1 - a)
+    void blendAlpha(std::uint8_t* dst, float r, float g, float b, float alpha) {
+        const float keep = 1.0f - alpha;
+        dst[0] = toUnorm(r * alpha + dst[0] * keep);
+        dst[1] = toUnorm(g * alpha + dst[1] * keep);
+        dst[2] = toUnorm(b * alpha + dst[2] * keep);
+    }
+
+    // sf::BlendAdd: src * a + dst, saturado
+    void blendAdd(std::uint8_t* dst, float r, float g, float b, float alpha) {
+        dst[0] = toUnorm(r * alpha + dst[0]);
+        dst[1] = toUnorm(g * alpha + dst[1]);
+        dst[2] = toUnorm(b * alpha + dst[2]);
+    }
+
+    // Primeiro i com e + i * step >= 0, para e < 0 e step > 0. A divisão vai em
+    // double (uma divisão inteira de 64 bits por aresta e linha dominava o custo)
+    // e o arredondamento é corrigido no teste exato em inteiros.
+    std::int64_t firstInside(std::int64_t e, std::int64_t step, double invStep) {
+        std::int64_t i = static_cast<std::int64_t>(std::ceil(static_cast<double>(-e) * invStep));
+        if (e + i * step < 0) ++i;
+        else if (e + (i - 1) * step >= 0) --i;
+        return i;
+    }
+
+    // Último i com e + i * step >= 0, para e >= 0 e step < 0
+    std::int64_t lastInside(std::int64_t e, std::int64_t step, double invStep) {
+        std::int64_t i = static_cast<std::int64_t>(std::floor(static_cast<double>(-e) * invStep));
+        if (e + i * step < 0) --i;
+        else if (e + (i + 1) * step >= 0) ++i;
+        return i;
+    }
+
+    // r, g, b, a, u, v
+    constexpr int ATTRIBUTE_COUNT = 6;
+
+    // Trecho de uma linha do triângulo: atributos no primeiro pixel e passo por pixel
+    struct Span {
+        float value[ATTRIBUTE_COUNT];
+        float step[ATTRIBUTE_COUNT];
+    };
+
+    struct TexelLevel {
+        const std::uint8_t* texels;
+        int width;
+        int height;
+        float scaleX;  // coordenada de textura (nível 0) -> texel deste nível
+        float scaleY;
+    };
+
+    void fillFlatSpan(std::uint8_t* __restrict dst, std::int64_t count, const sf::Color& color) {
+        if (color.a == 255) {
+            for (std::int64_t i = 0; i < count; ++i, dst += 4) {
+                dst[0] = color.r;
+                dst[1] = color.g;
+                dst[2] = color.b;
+            }
+            return;
+        }
+        const float alpha = color.a / 255.0f;
+        for (std::int64_t i = 0; i < count; ++i, dst += 4) {
+            blendAlpha(dst, color.r, color.g, color.b, alpha);
+        }
+    }
+
+    template <bool Additive>
+    void shadeSpan(std::uint8_t* __restrict dst, std::int64_t count, Span span) {
+        for (std::int64_t i = 0; i < count; ++i, dst += 4) {
+            const float alpha = span.value[3] * (1.0f / 255.0f);
+            if (Additive) {
+                blendAdd(dst, span.value[0], span.value[1], span.value[2], alpha);
+            } else {
+                blendAlpha(dst, span.value[0], span.value[1], span.value[2], alpha);
+            }
+            for (int c = 0; c < 4; ++c) span.value[c] += span.step[c];
+        }
+    }
+
+    // Bilinear no nível escolhido, presa na borda, modulada pela cor do vértice; alfa por cima
+    void shadeTexturedSpan(std::uint8_t* __restrict dst, std::int64_t count, Span span, const TexelLevel& level) {
+        const int maxX = level.width - 1;
+        const int maxY = level.height - 1;
+        for (std::int64_t i = 0; i < count; ++i, dst += 4) {
+            const float u = span.value[4] * level.scaleX - 0.5f;
+            const float t = span.value[5] * level.scaleY - 0.5f;
+            const float fu = std::floor(u);
+            const float ft = std::floor(t);
+            const float su = u - fu;
+            const float st = t - ft;
+            const int ix0 = std::min(std::max(static_cast<int>(fu), 0), maxX);
+            const int ix1 = std::min(std::max(static_cast<int>(fu) + 1, 0), maxX);
+            const int iy0 = std::min(std::max(static_cast<int>(ft), 0), maxY);
+            const int iy1 = std::min(std::max(static_cast<int>(ft) + 1, 0), maxY);
+            const std::uint8_t* t00 = level.texels + (static_cast<size_t>(iy0) * level.width + ix0) * 4;
+            const std::uint8_t* t10 = level.texels + (static_cast<size_t>(iy0) * level.width + ix1) * 4;
+            const std::uint8_t* t01 = level.texels + (static_cast<size_t>(iy1) * level.width + ix0) * 4;
+            const std::uint8_t* t11 = level.texels + (static_cast<size_t>(iy1) * level.width + ix1) * 4;
+            float texel[4];
+            for (int c = 0; c < 4; ++c) {
+                texel[c] = ((t00[c] * (1.0f - su) + t10[c] * su) * (1.0f - st) +
+                            (t01[c] * (1.0f - su) + t11[c] * su) * st) * (1.0f / 255.0f);
+            }
+            blendAlpha(dst, span.value[0] * texel[0], span.value[1] * texel[1], span.value[2] * texel[2],
+                       span.value[3] * texel[3] * (1.0f / 255.0f));
+            for (int c = 0; c < ATTRIBUTE_COUNT; ++c) span.value[c] += span.step[c];
+        }
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer() : m_backgroundColor(FALLBACK_BACKGROUND) {}
+
+void SoftwareRenderer::resize(size_t width, size_t height, float worldWidth, float worldHeight) {
+    m_worldWidth = worldWidth;
+    m_worldHeight = worldHeight;
+    m_scaleX = worldWidth > 0.0f ? static_cast<float>(width) / worldWidth : 1.0f;
+    m_scaleY = worldHeight > 0.0f ? static_cast<float>(height) / worldHeight : 1.0f;
+    if (width == m_width && height == m_height) return;
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_pixels.assign(width * height * 4, 255);
+    stretchBackground();
+}
+
+void SoftwareRenderer::setBackground(const sf::Image& image) {
+    m_backgroundImage = image;
+    m_hasBackgroundImage = image.getSize().x > 0 && image.getSize().y > 0;
+    stretchBackground();
+}
+
+void SoftwareRenderer::setBackground(const sf::Color& color) {
+    m_backgroundColor = color;
+    m_hasBackgroundImage = false;
+    stretchBackground();
+}
+
+void SoftwareRenderer::stretchBackground() {
+    m_background.resize(m_width * m_height * 4);
+    const sf::Vector2u size = m_backgroundImage.getSize();
+    const std::uint8_t* source = m_hasBackgroundImage ? m_backgroundImage.getPixelsPtr() : nullptr;
+    for (size_t y = 0; y < m_height; ++y) {
+        const size_t sy = source ? std::min<size_t>(static_cast<size_t>((y + 0.5) * size.y / m_height), size.y - 1) : 0;
+        for (size_t x = 0; x < m_width; ++x) {
+            std::uint8_t* out = &m_background[(y * m_width + x) * 4];
+            if (source) {
+                // a janela limpa em preto e desenha o sprite com alfa por cima
+                const size_t sx = std::min<size_t>(static_cast<size_t>((x + 0.5) * size.x / m_width), size.x - 1);
+                const std::uint8_t* texel = source + (sy * size.x + sx) * 4;
+                const float alpha = texel[3] / 255.0f;
+                out[0] = toUnorm(texel[0] * alpha);
+                out[1] = toUnorm(texel[1] * alpha);
+                out[2] = toUnorm(texel[2] * alpha);
+            } else {
+                out[0] = m_backgroundColor.r;
+                out[1] = m_backgroundColor.g;
+                out[2] = m_backgroundColor.b;
+            }
+            out[3] = 255;
+        }
+    }
+}
+
+void SoftwareRenderer::render(const ParticleSystem& system, ThreadPool& pool) {
+    m_stats = Stats();
+    m_stats.width = m_width;
+    m_stats.height = m_height;
+    m_stats.tiles = m_tilesX * m_tilesY;
+    m_stats.threads = m_params.parallel ? pool.getThreadCount() : 1;
+    if (m_width == 0 || m_height == 0) return;
+
+    // a mesma ordem de ParticleSystem::draw
+    m_segments.clear();
+    m_primitiveCount = 0;
+    bakeObstacles(system);
+    addSegment(system.getConstraintVertices(), Layer::Lines);
+    m_splatPixels = nullptr;
+    if (system.isSplatting()) {
+        const DensitySplat::Stats& splat = system.getSplatStats();
+        if (splat.width > 0 && splat.height > 0) {
+            m_splatPixels = system.getSplat().pixels();
+            m_splatWidth = splat.width;
+            m_splatHeight = splat.height;
+            m_splatArea = sf::FloatRect(splat.areaLeft, splat.areaTop, splat.areaWidth, splat.areaHeight);
+        }
+    } else {
+        addSegment(system.getTrailVertices(), Layer::Trails);
+        addSegment(system.getHeadVertices(), Layer::Heads);
+        const auto& batches = system.getTexturedHeadBatches();
+        m_textures.resize(batches.size());
+        size_t texture = 0;
+        for (const auto& pair : batches) {
+            loadTexture(*pair.first, m_textures[texture]);
+            addSegment(pair.second, Layer::Textured, texture);
+            ++texture;
+        }
+    }
+
+    binPrimitives(pool);
+
+    const size_t tiles = m_tilesX * m_tilesY;
+    if (m_params.parallel) {
+        pool.parallelFor(tiles, 1, [this](size_t begin, size_t end) {
+            for (size_t tile = begin; tile < end; ++tile) rasterizeTile(tile);
+        });
+    } else {
+        for (size_t tile = 0; tile < tiles; ++tile) rasterizeTile(tile);
+    }
+}
+
+size_t SoftwareRenderer::primitiveCount(const sf::VertexArray& vertices, Layer layer) const {
+    const size_t count = vertices.getVertexCount();
+    switch (layer) {
+        case Layer::Lines:    return count / 2;
+        case Layer::Trails:   return count >= 3 ? count - 2 : 0;
+        case Layer::Heads:    return count / 3;
+        case Layer::Textured: return (count / 4) * 2;
+    }
+    return 0;
+}
+
+void SoftwareRenderer::addSegment(const sf::VertexArray& vertices, Layer layer, size_t texture) {
+    const size_t count = primitiveCount(vertices, layer);
+    if (count == 0) return;
+    m_segments.push_back({&vertices, layer, m_primitiveCount, count, texture});
+    m_primitiveCount += count;
+}
+
+int SoftwareRenderer::primitiveVertices(const Segment& segment, size_t local, size_t out[3]) const {
+    switch (segment.layer) {
+        case Layer::Lines:
+            out[0] = local * 2;
+            out[1] = local * 2 + 1;
+            return 2;
+        case Layer::Trails:
+            out[0] = local;
+            out[1] = local + 1;
+            out[2] = local + 2;
+            return 3;
+        case Layer::Heads:
+            out[0] = local * 3;
+            out[1] = local * 3 + 1;
+            out[2] = local * 3 + 2;
+            return 3;
+        case Layer::Textured: {
+            // um quad vira (0, 1, 2) e (0, 2, 3), como o driver divide GL_QUADS
+            const size_t first = (local / 2) * 4;
+            const size_t second = (local % 2 == 0) ? 1 : 2;
+            out[0] = first;
+            out[1] = first + second;
+            out[2] = first + second + 1;
+            return 3;
+        }
+    }
+    return 0;
+}
+
+bool SoftwareRenderer::primitiveTiles(const Segment& segment, size_t local, int& tx0, int& ty0, int& tx1,
+                                      int& ty1) const {
+    size_t index[3] = {};
+    const int corners = primitiveVertices(segment, local, index);
+    const sf::VertexArray& vertices = *segment.vertices;
+    std::int64_t x[3], y[3];
+    for (int k = 0; k < corners; ++k) {
+        x[k] = toFixed(vertices[index[k]].position.x * m_scaleX);
+        y[k] = toFixed(vertices[index[k]].position.y * m_scaleY);
+    }
+
+    std::int64_t px0, py0, px1, py1;
+    if (corners == 3) {
+        const std::int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0) return false;
+        // pixels cujo centro cabe na caixa
+        px0 = fixedFloor(std::min({x[0], x[1], x[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1);
+        py0 = fixedFloor(std::min({y[0], y[1], y[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1);
+        px1 = fixedFloor(std::max({x[0], x[1], x[2]}) - SUBPIXEL_HALF);
+        py1 = fixedFloor(std::max({y[0], y[1], y[2]}) - SUBPIXEL_HALF);
+    } else {
+        if (x[0] == x[1] && y[0] == y[1]) return false;
+        px0 = fixedFloor(std::min(x[0], x[1]));
+        py0 = fixedFloor(std::min(y[0], y[1]));
+        px1 = fixedFloor(std::max(x[0], x[1]));
+        py1 = fixedFloor(std::max(y[0], y[1]));
+    }
+    px0 = std::max<std::int64_t>(px0, 0);
+    py0 = std::max<std::int64_t>(py0, 0);
+    px1 = std::min<std::int64_t>(px1, static_cast<std::int64_t>(m_width) - 1);
+    py1 = std::min<std::int64_t>(py1, static_cast<std::int64_t>(m_height) - 1);
+    if (px0 > px1 || py0 > py1) return false;
+    tx0 = static_cast<int>(px0 / static_cast<std::int64_t>(TILE_SIZE));
+    ty0 = static_cast<int>(py0 / static_cast<std::int64_t>(TILE_SIZE));
+    tx1 = static_cast<int>(px1 / static_cast<std::int64_t>(TILE_SIZE));
+    ty1 = static_cast<int>(py1 / static_cast<std::int64_t>(TILE_SIZE));
+    return true;
+}
+
+void SoftwareRenderer::loadTexture(const sf::Texture& texture, TextureImage& image) {
+    // copiada a cada quadro: o ponteiro pode passar da provisória para a carregada
+    const sf::Image copy = texture.copyToImage();
+    const sf::Vector2u size = copy.getSize();
+    image.levels.clear();
+    image.width = static_cast<float>(std::max(texture.getSize().x, 1u));
+    image.height = static_cast<float>(std::max(texture.getSize().y, 1u));
+    if (size.x == 0 || size.y == 0) {
+        // sem os texels (sem contexto OpenGL), a cabeça sai só com a cor do vértice
+        image.levels.push_back({1, 1, {255, 255, 255, 255}});
+        return;
+    }
+    image.levels.push_back({size.x, size.y, std::vector<std::uint8_t>(copy.getPixelsPtr(),
+                                                                      copy.getPixelsPtr() + size.x * size.y * 4)});
+    // mipmaps como generateMipmap: média de 2x2
+    while (image.levels.back().width > 1 || image.levels.back().height > 1) {
+        const TextureImage::Level& source = image.levels.back();
+        TextureImage::Level level;
+        level.width = std::max<size_t>(source.width / 2, 1);
+        level.height = std::max<size_t>(source.height / 2, 1);
+        level.texels.resize(level.width * level.height * 4);
+        for (size_t y = 0; y < level.height; ++y) {
+            const size_t y0 = std::min(y * 2, source.height - 1);
+            const size_t y1 = std::min(y * 2 + 1, source.height - 1);
+            for (size_t x = 0; x < level.width; ++x) {
+                const size_t x0 = std::min(x * 2, source.width - 1);
+                const size_t x1 = std::min(x * 2 + 1, source.width - 1);
+                for (size_t c = 0; c < 4; ++c) {
+                    const unsigned sum = source.texels[(y0 * source.width + x0) * 4 + c] +
+                                         source.texels[(y0 * source.width + x1) * 4 + c] +
+                                         source.texels[(y1 * source.width + x0) * 4 + c] +
+                                         source.texels[(y1 * source.width + x1) * 4 + c];
+                    level.texels[(y * level.width + x) * 4 + c] = static_cast<std::uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        image.levels.push_back(std::move(level));
+    }
+}
+
+void SoftwareRenderer::bakeObstacles(const ParticleSystem& system) {
+    // o campo é refeito no passo; antes do primeiro passo depois de uma mudança ele ainda não existe
+    const ObstacleSet& obstacles = system.getObstacles();
+    m_drawObstacles = !obstacles.empty() && obstacles.getNodesX() > 0 && obstacles.getNodesY() > 0 &&
+                      obstacles.grid().values != nullptr;
+    if (!m_drawObstacles || m_obstacleVersion == obstacles.getVersion()) return;
+    m_obstacleVersion = obstacles.getVersion();
+    m_obstacleNodesX = obstacles.getNodesX();
+    m_obstacleNodesY = obstacles.getNodesY();
+    m_obstacleCell = obstacles.getCellSize();
+    const float* distances = obstacles.grid().values;
+    m_obstacleAlpha.resize(m_obstacleNodesX * m_obstacleNodesY);
+    for (size_t i = 0; i < m_obstacleAlpha.size(); ++i) {
+        const float coverage = std::min(std::max(0.5f - distances[i] / m_obstacleCell, 0.0f), 1.0f);
+        m_obstacleAlpha[i] = static_cast<std::uint8_t>(coverage * 255.0f);
+    }
+}
+
+void SoftwareRenderer::binPrimitives(ThreadPool& pool) {
+    auto forRange = [&](size_t total, size_t grain, const ThreadPool::Body& body) {
+        if (m_params.parallel) {
+            pool.parallelFor(total, grain, body);
+        } else {
+            body(0, total);
+        }
+    };
+
+    const size_t tiles = m_tilesX * m_tilesY;
+    const size_t blockCount = (m_primitiveCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_blockOffsets.assign(blockCount * tiles, 0);
+    std::vector<size_t> visibleTriangles(blockCount, 0);
+    std::vector<size_t> visibleLines(blockCount, 0);
+
+    // o primeiro segmento do lote; dali em diante os segmentos só avançam
+    auto firstSegment = [this](size_t primitive) {
+        size_t segment = 0;
+        while (primitive >= m_segments[segment].first + m_segments[segment].count) ++segment;
+        return segment;
+    };
+
+    forRange(blockCount, 1, [&](size_t blockBegin, size_t blockEnd) {
+        for (size_t block = blockBegin; block < blockEnd; ++block) {
+            size_t* histogram = &m_blockOffsets[block * tiles];
+            const size_t end = std::min(m_primitiveCount, (block + 1) * BLOCK_SIZE);
+            size_t segment = firstSegment(block * BLOCK_SIZE);
+            for (size_t p = block * BLOCK_SIZE; p < end; ++p) {
+                while (p >= m_segments[segment].first + m_segments[segment].count) ++segment;
+                const Segment& s = m_segments[segment];
+                int tx0, ty0, tx1, ty1;
+                if (!primitiveTiles(s, p - s.first, tx0, ty0, tx1, ty1)) continue;
+                ++(s.layer == Layer::Lines ? visibleLines[block] : visibleTriangles[block]);
+                for (int ty = ty0; ty <= ty1; ++ty) {
+                    for (int tx = tx0; tx <= tx1; ++tx) {
+                        ++histogram[static_cast<size_t>(ty) * m_tilesX + static_cast<size_t>(tx)];
+                    }
+                }
+            }
+        }
+    });
+
+    // soma de prefixos bloco a bloco dentro de cada tile: a ordem de desenho se mantém
+    m_tileStart.assign(tiles + 1, 0);
+    size_t running = 0;
+    for (size_t tile = 0; tile < tiles; ++tile) {
+        m_tileStart[tile] = running;
+        for (size_t block = 0; block < blockCount; ++block) {
+            const size_t inBlock = m_blockOffsets[block * tiles + tile];
+            m_blockOffsets[block * tiles + tile] = running;
+            running += inBlock;
+        }
+    }
+    m_tileStart[tiles] = running;
+    m_entries.resize(running);
+
+    forRange(blockCount, 1, [&](size_t blockBegin, size_t blockEnd) {
+        for (size_t block = blockBegin; block < blockEnd; ++block) {
+            size_t* cursor = &m_blockOffsets[block * tiles];
+            const size_t end = std::min(m_primitiveCount, (block + 1) * BLOCK_SIZE);
+            size_t segment = firstSegment(block * BLOCK_SIZE);
+            for (size_t p = block * BLOCK_SIZE; p < end; ++p) {
+                while (p >= m_segments[segment].first + m_segments[segment].count) ++segment;
+                const Segment& s = m_segments[segment];
+                int tx0, ty0, tx1, ty1;
+                if (!primitiveTiles(s, p - s.first, tx0, ty0, tx1, ty1)) continue;
+                for (int ty = ty0; ty <= ty1; ++ty) {
+                    for (int tx = tx0; tx <= tx1; ++tx) {
+                        m_entries[cursor[static_cast<size_t>(ty) * m_tilesX + static_cast<size_t>(tx)]++] =
+                            static_cast<std::uint32_t>(p);
+                    }
+                }
+            }
+        }
+    });
+
+    for (size_t block = 0; block < blockCount; ++block) {
+        m_stats.triangles += visibleTriangles[block];
+        m_stats.lines += visibleLines[block];
+    }
+    m_stats.tileEntries = running;
+}
+
+void SoftwareRenderer::rasterizeTile(size_t tile) {
+    const size_t tx = tile % m_tilesX;
+    const size_t ty = tile / m_tilesX;
+    const TileRect rect{static_cast<int>(tx * TILE_SIZE), static_cast<int>(ty * TILE_SIZE),
+                        static_cast<int>(std::min(m_width, (tx + 1) * TILE_SIZE)),
+                        static_cast<int>(std::min(m_height, (ty + 1) * TILE_SIZE))};
+
+    fillBackground(rect);
+    if (m_drawObstacles) {
+        compositeObstacles(rect);
+    }
+
+    // as entradas do tile estão em ordem crescente de primitiva, então o segmento só avança
+    size_t segment = 0;
+    for (size_t e = m_tileStart[tile]; e < m_tileStart[tile + 1]; ++e) {
+        const size_t p = m_entries[e];
+        while (p >= m_segments[segment].first + m_segments[segment].count) ++segment;
+        const Segment& s = m_segments[segment];
+        if (s.layer == Layer::Lines) {
+            drawLine(s, p - s.first, rect);
+        } else {
+            fillTriangle(s, p - s.first, rect);
+        }
+    }
+
+    if (m_splatPixels) {
+        compositeSplat(rect);
+    }
+}
+
+void SoftwareRenderer::fillBackground(const TileRect& rect) {
+    const size_t rowBytes = static_cast<size_t>(rect.x1 - rect.x0) * 4;
+    for (int y = rect.y0; y < rect.y1; ++y) {
+        const size_t offset = (static_cast<size_t>(y) * m_width + static_cast<size_t>(rect.x0)) * 4;
+        std::copy(m_background.data() + offset, m_background.data() + offset + rowBytes, m_pixels.data() + offset);
+    }
+}
+
+void SoftwareRenderer::compositeObstacles(const TileRect& rect) {
+    // o sprite da janela: nó (i, j) no centro do texel, amostra bilinear presa na borda
+    const float nodesX = static_cast<float>(m_obstacleNodesX);
+    const float nodesY = static_cast<float>(m_obstacleNodesY);
+    for (int y = rect.y0; y < rect.y1; ++y) {
+        const float gy = (static_cast<float>(y) + 0.5f) / m_scaleY / m_obstacleCell;
+        if (gy < -0.5f || gy >= nodesY - 0.5f) continue;
+        const float fy = std::max(gy, 0.0f);
+        const size_t iy0 = std::min(static_cast<size_t>(fy), m_obstacleNodesY - 1);
+        const size_t iy1 = std::min(iy0 + 1, m_obstacleNodesY - 1);
+        const float wy = std::min(fy - static_cast<float>(iy0), 1.0f);
+        for (int x = rect.x0; x < rect.x1; ++x) {
+            const float gx = (static_cast<float>(x) + 0.5f) / m_scaleX / m_obstacleCell;
+            if (gx < -0.5f || gx >= nodesX - 0.5f) continue;
+            const float fx = std::max(gx, 0.0f);
+            const size_t ix0 = std::min(static_cast<size_t>(fx), m_obstacleNodesX - 1);
+            const size_t ix1 = std::min(ix0 + 1, m_obstacleNodesX - 1);
+            const float wx = std::min(fx - static_cast<float>(ix0), 1.0f);
+            const float top = m_obstacleAlpha[iy0 * m_obstacleNodesX + ix0] * (1.0f - wx) +
+                              m_obstacleAlpha[iy0 * m_obstacleNodesX + ix1] * wx;
+            const float bottom = m_obstacleAlpha[iy1 * m_obstacleNodesX + ix0] * (1.0f - wx) +
+                                 m_obstacleAlpha[iy1 * m_obstacleNodesX + ix1] * wx;
+            const float alpha = (top * (1.0f - wy) + bottom * wy) / 255.0f;
+            if (alpha <= 0.0f) continue;
+            std::uint8_t* dst = &m_pixels[(static_cast<size_t>(y) * m_width + static_cast<size_t>(x)) * 4];
+            blendAlpha(dst, OBSTACLE_COLOR[0], OBSTACLE_COLOR[1], OBSTACLE_COLOR[2], alpha);
+        }
+    }
+}
+
+void SoftwareRenderer::compositeSplat(const TileRect& rect) {
+    // o sprite do mapa cobre a região do mundo em que foi montado, sem suavização
+    const float texelsX = static_cast<float>(m_splatWidth) / m_splatArea.width;
+    const float texelsY = static_cast<float>(m_splatHeight) / m_splatArea.height;
+    for (int y = rect.y0; y < rect.y1; ++y) {
+        const float ty = ((static_cast<float>(y) + 0.5f) / m_scaleY - m_splatArea.top) * texelsY;
+        if (ty < 0.0f || ty >= static_cast<float>(m_splatHeight)) continue;
+        const size_t sy = static_cast<size_t>(ty);
+        for (int x = rect.x0; x < rect.x1; ++x) {
+            const float tx = ((static_cast<float>(x) + 0.5f) / m_scaleX - m_splatArea.left) * texelsX;
+            if (tx < 0.0f || tx >= static_cast<float>(m_splatWidth)) continue;
+            const std::uint8_t* texel = m_splatPixels + (sy * m_splatWidth + static_cast<size_t>(tx)) * 4;
+            if (texel[3] == 0) continue;
+            std::uint8_t* dst = &m_pixels[(static_cast<size_t>(y) * m_width + static_cast<size_t>(x)) * 4];
+            blendAdd(dst, texel[0], texel[1], texel[2], texel[3] / 255.0f);
+        }
+    }
+}
+
+void SoftwareRenderer::fillTriangle(const Segment& segment, size_t local, const TileRect& rect) {
+    size_t index[3] = {};
+    primitiveVertices(segment, local, index);
+    const sf::VertexArray& vertices = *segment.vertices;
+    const sf::Vertex* v[3] = {&vertices[index[0]], &vertices[index[1]], &vertices[index[2]]};
+    std::int64_t x[3], y[3];
+    for (int k = 0; k < 3; ++k) {
+        x[k] = toFixed(v[k]->position.x * m_scaleX);
+        y[k] = toFixed(v[k]->position.y * m_scaleY);
+    }
+    std::int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0) return;
+    if (area < 0) {
+        std::swap(v[1], v[2]);
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        area = -area;
+    }
+
+    const int px0 = std::max(rect.x0, static_cast<int>(
+        fixedFloor(std::min({x[0], x[1], x[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1)));
+    const int py0 = std::max(rect.y0, static_cast<int>(
+        fixedFloor(std::min({y[0], y[1], y[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1)));
+    const int px1 = std::min(rect.x1 - 1, static_cast<int>(
+        fixedFloor(std::max({x[0], x[1], x[2]}) - SUBPIXEL_HALF)));
+    const int py1 = std::min(rect.y1 - 1, static_cast<int>(
+        fixedFloor(std::max({y[0], y[1], y[2]}) - SUBPIXEL_HALF)));
+    if (px0 > px1 || py0 > py1) return;
+
+    // função de aresta da aresta oposta a cada vértice, no centro do primeiro pixel;
+    // aresta que não é de cima nem da esquerda perde o empate (-1)
+    std::int64_t rowEdge[3], stepX[3], stepY[3];
+    double invStepX[3];
+    const std::int64_t centerX = px0 * SUBPIXEL_ONE + SUBPIXEL_HALF;
+    const std::int64_t centerY = py0 * SUBPIXEL_ONE + SUBPIXEL_HALF;
+    for (int k = 0; k < 3; ++k) {
+        const int a = (k + 1) % 3;
+        const int b = (k + 2) % 3;
+        const std::int64_t dx = x[b] - x[a];
+        const std::int64_t dy = y[b] - y[a];
+        const bool topLeft = (dy == 0 && dx > 0) || dy < 0;
+        rowEdge[k] = dx * (centerY - y[a]) - dy * (centerX - x[a]) - (topLeft ? 0 : 1);
+        stepX[k] = -dy * SUBPIXEL_ONE;
+        stepY[k] = dx * SUBPIXEL_ONE;
+        invStepX[k] = stepX[k] != 0 ? 1.0 / static_cast<double>(stepX[k]) : 0.0;
+    }
+
+    const bool textured = segment.layer == Layer::Textured;
+    const bool flat = !textured && v[0]->color == v[1]->color && v[0]->color == v[2]->color;
+    const float invArea = 1.0f / static_cast<float>(area);
+
+    // cor e coordenada de textura como planos na tela: A = A2 + (A0 - A2) w0 + (A1 - A2) w1,
+    // com wk = ek / área; o passo por pixel sai do passo das funções de aresta
+    float corner[3][ATTRIBUTE_COUNT];
+    for (int k = 0; k < 3; ++k) {
+        corner[k][0] = v[k]->color.r;
+        corner[k][1] = v[k]->color.g;
+        corner[k][2] = v[k]->color.b;
+        corner[k][3] = v[k]->color.a;
+        corner[k][4] = v[k]->texCoords.x;
+        corner[k][5] = v[k]->texCoords.y;
+    }
+    float delta0[ATTRIBUTE_COUNT], delta1[ATTRIBUTE_COUNT];
+    Span span;
+    for (int c = 0; c < ATTRIBUTE_COUNT; ++c) {
+        delta0[c] = corner[0][c] - corner[2][c];
+        delta1[c] = corner[1][c] - corner[2][c];
+        span.step[c] = (delta0[c] * static_cast<float>(stepX[0]) + delta1[c] * static_cast<float>(stepX[1])) * invArea;
+    }
+
+    TexelLevel level{nullptr, 0, 0, 1.0f, 1.0f};
+    if (textured) {
+        // nível da mipmap pela razão entre a área em texels e a área em pixels
+        const TextureImage& image = m_textures[segment.texture];
+        const sf::Vector2f du = v[1]->texCoords - v[0]->texCoords;
+        const sf::Vector2f dv = v[2]->texCoords - v[0]->texCoords;
+        const float texelArea = std::abs(du.x * dv.y - du.y * dv.x) *
+                                (image.levels[0].width / image.width) * (image.levels[0].height / image.height);
+        const float pixelArea = static_cast<float>(area) / static_cast<float>(SUBPIXEL_ONE * SUBPIXEL_ONE);
+        const float ratio = texelArea / std::max(pixelArea, 1e-6f);
+        const int maxLevel = static_cast<int>(image.levels.size()) - 1;
+        const int chosen = ratio > 1.0f ? static_cast<int>(0.5f * std::log2(ratio)) : 0;
+        const TextureImage::Level& chosenLevel = image.levels[static_cast<size_t>(std::min(chosen, maxLevel))];
+        level = {chosenLevel.texels.data(), static_cast<int>(chosenLevel.width), static_cast<int>(chosenLevel.height),
+                 static_cast<float>(chosenLevel.width) / image.width,
+                 static_cast<float>(chosenLevel.height) / image.height};
+    }
+
+    for (int py = py0; py <= py1; ++py) {
+        // trecho da linha em que as três funções são >= 0, calculado exato em inteiros:
+        // triângulo fino numa caixa grande (trilha rápida) não testa pixel vazio
+        std::int64_t spanBegin = 0;
+        std::int64_t spanEnd = px1 - px0;
+        for (int k = 0; k < 3; ++k) {
+            const std::int64_t e = rowEdge[k];
+            if (stepX[k] > 0) {
+                if (e < 0) spanBegin = std::max(spanBegin, firstInside(e, stepX[k], invStepX[k]));
+            } else if (stepX[k] < 0) {
+                spanEnd = e < 0 ? -1 : std::min(spanEnd, lastInside(e, stepX[k], invStepX[k]));
+            } else if (e < 0) {
+                spanEnd = -1;
+            }
+        }
+        if (spanBegin <= spanEnd) {
+            std::uint8_t* dst = &m_pixels[(static_cast<size_t>(py) * m_width + static_cast<size_t>(px0 + spanBegin)) * 4];
+            const std::int64_t count = spanEnd - spanBegin + 1;
+            if (flat) {
+                fillFlatSpan(dst, count, v[0]->color);
+            } else {
+                // valores no primeiro pixel a partir das funções exatas, sem acumular erro entre linhas
+                const float w0 = static_cast<float>(rowEdge[0] + spanBegin * stepX[0]) * invArea;
+                const float w1 = static_cast<float>(rowEdge[1] + spanBegin * stepX[1]) * invArea;
+                for (int c = 0; c < ATTRIBUTE_COUNT; ++c) {
+                    span.value[c] = corner[2][c] + delta0[c] * w0 + delta1[c] * w1;
+                }
+                if (textured) {
+                    shadeTexturedSpan(dst, count, span, level);
+                } else if (segment.layer == Layer::Trails) {
+                    shadeSpan<true>(dst, count, span);
+                } else {
+                    shadeSpan<false>(dst, count, span);
+                }
+            }
+        }
+        for (int k = 0; k < 3; ++k) rowEdge[k] += stepY[k];
+    }
+}
+
+void SoftwareRenderer::drawLine(const Segment& segment, size_t local, const TileRect& rect) {
+    // um pixel por coluna (ou linha) do eixo maior, no centro, sem o último: o
+    // mesmo traço de 1 px das linhas do OpenGL, a menos de um pixel nas pontas
+    size_t index[3] = {};
+    primitiveVertices(segment, local, index);
+    const sf::Vertex& first = (*segment.vertices)[index[0]];
+    const sf::Vertex& second = (*segment.vertices)[index[1]];
+    float x0 = first.position.x * m_scaleX;
+    float y0 = first.position.y * m_scaleY;
+    float x1 = second.position.x * m_scaleX;
+    float y1 = second.position.y * m_scaleY;
+    const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    if (x1 - x0 <= 0.0f) return;
+    const float slope = (y1 - y0) / (x1 - x0);
+    const int majorMin = steep ? rect.y0 : rect.x0;
+    const int majorMax = steep ? rect.y1 : rect.x1;
+    const int minorMin = steep ? rect.x0 : rect.y0;
+    const int minorMax = steep ? rect.x1 : rect.y1;
+    const int begin = std::max(majorMin, static_cast<int>(std::ceil(x0 - 0.5f)));
+    const int end = std::min(majorMax, static_cast<int>(std::ceil(x1 - 0.5f)));
+    const sf::Color& color = first.color;
+    for (int major = begin; major < end; ++major) {
+        const float minorPosition = y0 + (static_cast<float>(major) + 0.5f - x0) * slope;
+        const int minor = static_cast<int>(std::floor(minorPosition));
+        if (minor < minorMin || minor >= minorMax) continue;
+        const size_t px = static_cast<size_t>(steep ? minor : major);
+        const size_t py = static_cast<size_t>(steep ? major : minor);
+        blendAlpha(&m_pixels[(py * m_width + px) * 4], color.r, color.g, color.b, color.a / 255.0f);
+    }
+}
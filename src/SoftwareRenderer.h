@@ -0,0 +1,151 @@
+#pragma once
+#include "ThreadPool.h"
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ParticleSystem;
+
+// Desenho sem GPU: o mesmo quadro de ParticleSystem::draw (obstáculos,
+// restrições, trilhas somadas como sf::BlendAdd e cabeças por cima com alfa, ou
+// o mapa de densidade) sobre o fundo, num framebuffer RGBA na memória. Serve
+// para gerar vídeo em máquinas sem placa de vídeo.
+//
+// A tela é dividida em blocos de TILE_SIZE x TILE_SIZE pixels. Triângulos e
+// linhas vão para os blocos que a caixa envolvente toca com o mesmo counting
+// sort em blocos do mapa de densidade, e cada bloco é rasterizado por uma
+// thread só, na ordem de desenho: sem disputa, e o resultado não depende do
+// número de threads. Os vértices viram ponto fixo de 1/256 px e a cobertura é
+// testada no centro do pixel com a regra do canto superior esquerdo, como no
+// OpenGL, então arestas compartilhadas (as das trilhas) não somam duas vezes.
+class SoftwareRenderer {
+public:
+    static constexpr size_t TILE_SIZE = 64;
+
+    struct Params {
+        bool parallel = true;
+    };
+
+    struct Stats {
+        size_t width = 0;
+        size_t height = 0;
+        size_t triangles = 0;    // com área e dentro do quadro
+        size_t lines = 0;
+        size_t tileEntries = 0;  // pares (primitiva, bloco) depois da distribuição
+        size_t tiles = 0;
+        size_t threads = 1;
+    };
+
+    SoftwareRenderer();
+
+    // Tamanho do quadro; o mundo [0, worldWidth) x [0, worldHeight) é esticado sobre ele
+    void resize(size_t width, size_t height, float worldWidth, float worldHeight);
+
+    // Fundo esticado sobre o quadro com o vizinho mais próximo, como o sprite da janela
+    void setBackground(const sf::Image& image);
+    void setBackground(const sf::Color& color);
+
+    // Desenha o que o último update do sistema montou
+    void render(const ParticleSystem& system, ThreadPool& pool);
+
+    // RGBA, width * height * 4 bytes, linha a linha de cima para baixo
+    const std::uint8_t* pixels() const { return m_pixels.data(); }
+    size_t getWidth() const { return m_width; }
+    size_t getHeight() const { return m_height; }
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    enum class Layer : std::uint8_t {
+        Lines,     // sf::Lines, alfa
+        Trails,    // sf::TriangleStrip, soma
+        Heads,     // sf::Triangles, alfa
+        Textured,  // sf::Quads com textura, alfa
+    };
+
+    // Um array de vértices de uma camada, com as primitivas numeradas em sequência
+    struct Segment {
+        const sf::VertexArray* vertices;
+        Layer layer;
+        size_t first;
+        size_t count;
+        size_t texture;
+    };
+
+    // Textura de uma camada de cabeças copiada para a memória, com as mipmaps
+    struct TextureImage {
+        struct Level {
+            size_t width;
+            size_t height;
+            std::vector<std::uint8_t> texels;
+        };
+        float width;
+        float height;
+        std::vector<Level> levels;
+    };
+
+    struct TileRect {
+        int x0, y0, x1, y1;  // [x0, x1) x [y0, y1) em pixels
+    };
+
+    void stretchBackground();
+    void addSegment(const sf::VertexArray& vertices, Layer layer, size_t texture = 0);
+    size_t primitiveCount(const sf::VertexArray& vertices, Layer layer) const;
+    // Vértices da primitiva local do segmento; devolve quantos (2 ou 3)
+    int primitiveVertices(const Segment& segment, size_t local, size_t out[3]) const;
+    // Blocos tocados pela primitiva; false se ela não cobre nenhum pixel
+    bool primitiveTiles(const Segment& segment, size_t local, int& tx0, int& ty0, int& tx1, int& ty1) const;
+    void loadTexture(const sf::Texture& texture, TextureImage& image);
+    void bakeObstacles(const ParticleSystem& system);
+    void binPrimitives(ThreadPool& pool);
+
+    void rasterizeTile(size_t tile);
+    void fillBackground(const TileRect& rect);
+    void compositeObstacles(const TileRect& rect);
+    void compositeSplat(const TileRect& rect);
+    void fillTriangle(const Segment& segment, size_t local, const TileRect& rect);
+    void drawLine(const Segment& segment, size_t local, const TileRect& rect);
+
+    Params m_params;
+    Stats m_stats;
+    size_t m_width = 0;
+    size_t m_height = 0;
+    float m_worldWidth = 0.0f;
+    float m_worldHeight = 0.0f;
+    float m_scaleX = 1.0f;
+    float m_scaleY = 1.0f;
+    size_t m_tilesX = 0;
+    size_t m_tilesY = 0;
+
+    sf::Image m_backgroundImage;
+    sf::Color m_backgroundColor;
+    bool m_hasBackgroundImage = false;
+    std::vector<std::uint8_t> m_background;  // já esticado para o quadro
+    std::vector<std::uint8_t> m_pixels;
+
+    std::vector<Segment> m_segments;
+    std::vector<TextureImage> m_textures;
+    size_t m_primitiveCount = 0;
+
+    // obstáculos: a mesma textura de cobertura que a janela desenha
+    std::vector<std::uint8_t> m_obstacleAlpha;
+    size_t m_obstacleNodesX = 0;
+    size_t m_obstacleNodesY = 0;
+    float m_obstacleCell = 1.0f;
+    std::uint64_t m_obstacleVersion = ~std::uint64_t(0);
+    bool m_drawObstacles = false;
+
+    // mapa de densidade do sistema, quando é ele que aparece
+    const std::uint8_t* m_splatPixels = nullptr;
+    size_t m_splatWidth = 0;
+    size_t m_splatHeight = 0;
+    sf::FloatRect m_splatArea;
+
+    // distribuição por bloco: histograma por lote de primitivas, virando deslocamentos
+    std::vector<size_t> m_blockOffsets;
+    std::vector<size_t> m_tileStart;
+    std::vector<std::uint32_t> m_entries;
+};
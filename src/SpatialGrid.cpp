@@ -1,46 +1,273 @@
 #include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-SpatialGrid::SpatialGrid(float width, float height, float cellSize)
-    : m_width(width), m_height(height), m_cellSize(cellSize) {
+namespace {
+    // Limite de células por partícula; acima disso a célula é aumentada
+    constexpr size_t MAX_CELLS_PER_PARTICLE = 4;
+    constexpr size_t MIN_CELL_BUDGET = 4096;
+
+    // A grade fina cobre até este quantil dos raios
+    constexpr float SPLIT_QUANTILE = 0.95f;
+    // Só quem passa disto vezes o quantil vai para o segundo nível
+    constexpr float OUTLIER_RATIO = 1.5f;
+    // Deslocamento relativo da média ou do máximo que dispara um novo ajuste
+    constexpr float RETUNE_DRIFT = 0.1f;
+    // Abaixo disto o quantil não diz muito; fica tudo num nível só
+    constexpr size_t MIN_TUNING_COUNT = 64;
+
+    bool drifted(float current, float tuned) {
+        return std::fabs(current - tuned) > RETUNE_DRIFT * tuned;
+    }
+
+    // Caixa das posições finitas. NaN e infinitos ficam de fora: esticariam a
+    // caixa até a grade virar uma célula só (ou um cast indefinido)
+    void finiteBounds(const float* positions, size_t count, float& minX, float& minY, float& maxX, float& maxY) {
+        minX = minY = std::numeric_limits<float>::max();
+        maxX = maxY = std::numeric_limits<float>::lowest();
+        for (size_t i = 0; i < count; ++i) {
+            const float x = positions[i * 2];
+            const float y = positions[i * 2 + 1];
+            if (!std::isfinite(x) || !std::isfinite(y)) continue;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        if (minX > maxX) {
+            minX = minY = maxX = maxY = 0.0f;
+        }
+    }
+
+    // Coordenada de célula presa a [0, cells - 1] antes do cast; max(0, NaN) é 0
+    size_t cellCoord(float coordinate, size_t cells) {
+        const float clamped = std::min(static_cast<float>(cells - 1), std::max(0.0f, coordinate));
+        return std::min(cells - 1, static_cast<size_t>(clamped));
+    }
 }
 
-void SpatialGrid::clear() {
-    m_grid.clear();
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_cellSize(cellSize) {
+}
+
+void SpatialGrid::tune(const float* radii, size_t count, float meanRadius, float maxRadius) {
+    m_tunedMeanRadius = meanRadius;
+    m_tunedMaxRadius = maxRadius;
+    m_splitRadius = std::numeric_limits<float>::infinity();
+    ++m_gridStats.retunes;
+    if (count < MIN_TUNING_COUNT) return;
+
+    m_scratch.assign(radii, radii + count);
+    const size_t k = static_cast<size_t>(SPLIT_QUANTILE * static_cast<float>(count - 1));
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + k, m_scratch.end());
+    const float quantile = m_scratch[k];
+    // o corte fica com folga sobre o quantil para não separar a cauda da distribuição comum
+    if (maxRadius > OUTLIER_RATIO * quantile) {
+        m_splitRadius = OUTLIER_RATIO * quantile;
+    }
 }
 
-void SpatialGrid::insert(Particle* particle) {
-    if (!particle) return;
+void SpatialGrid::build(Level& level, const float* positions, float cellSize, float minX, float minY,
+                        float maxX, float maxY) {
+    const size_t count = level.members.size();
+    const size_t cellBudget = std::max(MIN_CELL_BUDGET, count * MAX_CELLS_PER_PARTICLE);
+    const float budget = static_cast<float>(cellBudget);
+    while (true) {
+        // caixa finita mas enorme: o teto evita o cast fora de size_t enquanto a célula dobra
+        level.cellsX = static_cast<size_t>(std::min((maxX - minX) / cellSize, budget)) + 1;
+        level.cellsY = static_cast<size_t>(std::min((maxY - minY) / cellSize, budget)) + 1;
+        if (level.cellsX * level.cellsY <= cellBudget) break;
+        cellSize *= 2.0f;
+    }
+    level.minX = minX;
+    level.minY = minY;
+    level.cellSize = cellSize;
+    level.invCell = 1.0f / cellSize;
+
+    const size_t cellCount = level.cellsX * level.cellsY;
+    level.cellStart.assign(cellCount + 1, 0);
+    level.cellOf.resize(count);
+    level.sorted.resize(count);
 
-    int cellX = static_cast<int>(particle->getPosition().x / m_cellSize);
-    int cellY = static_cast<int>(particle->getPosition().y / m_cellSize);
-    
-    long long hash = getCellHash(cellX, cellY);
-    m_grid[hash].push_back(particle);
+    for (size_t m = 0; m < count; ++m) {
+        const std::uint32_t i = level.members[m];
+        // quem ficou fora da caixa (não finito) cai numa célula da borda
+        const size_t cx = cellCoord((positions[i * 2] - minX) * level.invCell, level.cellsX);
+        const size_t cy = cellCoord((positions[i * 2 + 1] - minY) * level.invCell, level.cellsY);
+        const std::uint32_t cell = static_cast<std::uint32_t>(cy * level.cellsX + cx);
+        level.cellOf[m] = cell;
+        ++level.cellStart[cell + 1];
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        level.cellStart[c + 1] += level.cellStart[c];
+    }
+    // cellStart[c] vira o cursor de escrita da célula c; no fim aponta para o início de c + 1
+    for (size_t m = 0; m < count; ++m) {
+        level.sorted[level.cellStart[level.cellOf[m]]++] = level.members[m];
+    }
+    for (size_t c = cellCount; c > 0; --c) {
+        level.cellStart[c] = level.cellStart[c - 1];
+    }
+    level.cellStart[0] = 0;
 }
 
-std::vector<Particle*> SpatialGrid::getNearbyParticles(Particle* particle) {
-    std::vector<Particle*> nearbyParticles;
-    if (!particle) return nearbyParticles;
+template <typename Test>
+void SpatialGrid::forEachPairInLevel(const Level& level, Test&& test) const {
+    // metade da vizinhança: a própria célula, a da direita e as três de baixo
+    const int forward[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    for (size_t cy = 0; cy < level.cellsY; ++cy) {
+        for (size_t cx = 0; cx < level.cellsX; ++cx) {
+            const size_t cell = cy * level.cellsX + cx;
+            const std::uint32_t begin = level.cellStart[cell];
+            const std::uint32_t end = level.cellStart[cell + 1];
+            if (begin == end) continue;
+
+            for (std::uint32_t s = begin; s < end; ++s) {
+                for (std::uint32_t t = s + 1; t < end; ++t) {
+                    test(level.sorted[s], level.sorted[t]);
+                }
+            }
 
-    int centralCellX = static_cast<int>(particle->getPosition().x / m_cellSize);
-    int centralCellY = static_cast<int>(particle->getPosition().y / m_cellSize);
-    
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            int cellX = centralCellX + x;
-            int cellY = centralCellY + y;
-            
-            long long hash = getCellHash(cellX, cellY);
-            
-            if (m_grid.count(hash)) {
-                nearbyParticles.insert(nearbyParticles.end(), m_grid[hash].begin(), m_grid[hash].end());
+            for (const auto& offset : forward) {
+                const long nx = static_cast<long>(cx) + offset[0];
+                const long ny = static_cast<long>(cy) + offset[1];
+                if (nx < 0 || nx >= static_cast<long>(level.cellsX) || ny >= static_cast<long>(level.cellsY)) continue;
+                const size_t other = static_cast<size_t>(ny) * level.cellsX + static_cast<size_t>(nx);
+                const std::uint32_t otherBegin = level.cellStart[other];
+                const std::uint32_t otherEnd = level.cellStart[other + 1];
+                for (std::uint32_t s = begin; s < end; ++s) {
+                    for (std::uint32_t t = otherBegin; t < otherEnd; ++t) {
+                        test(level.sorted[s], level.sorted[t]);
+                    }
+                }
             }
         }
     }
-    
-    return nearbyParticles;
 }
 
-long long SpatialGrid::getCellHash(int cellX, int cellY) const {
-    return static_cast<long long>(cellX) << 32 | static_cast<long long>(cellY);
+template <typename Test>
+void SpatialGrid::forEachCrossPair(const Level& fine, const Level& coarse, const float* positions,
+                                   const float* radii, float reachExtra, Test&& test) const {
+    // cada grande procura na grade fina todas as células que o seu alcance toca;
+    // o par grande-pequena só aparece aqui, então não precisa de meia vizinhança
+    for (const std::uint32_t i : coarse.members) {
+        const float reach = radii[i] + reachExtra;
+        const float x = positions[i * 2];
+        const float y = positions[i * 2 + 1];
+        const float left = (x - reach - fine.minX) * fine.invCell;
+        const float right = (x + reach - fine.minX) * fine.invCell;
+        const float top = (y - reach - fine.minY) * fine.invCell;
+        const float bottom = (y + reach - fine.minY) * fine.invCell;
+        // alcance todo fora da grade fina (ou NaN): nenhuma célula a visitar
+        if (!(right >= 0.0f && bottom >= 0.0f && left < static_cast<float>(fine.cellsX) &&
+              top < static_cast<float>(fine.cellsY))) {
+            continue;
+        }
+        const size_t x0 = cellCoord(left, fine.cellsX);
+        const size_t y0 = cellCoord(top, fine.cellsY);
+        const size_t x1 = cellCoord(right, fine.cellsX);
+        const size_t y1 = cellCoord(bottom, fine.cellsY);
+        for (size_t cy = y0; cy <= y1; ++cy) {
+            for (size_t cx = x0; cx <= x1; ++cx) {
+                const size_t cell = cy * fine.cellsX + cx;
+                for (std::uint32_t s = fine.cellStart[cell]; s < fine.cellStart[cell + 1]; ++s) {
+                    test(i, fine.sorted[s]);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::findPairs(const float* positions, const float* radii, size_t count, float margin,
+                            std::vector<ParticlePair>& pairs) {
+    pairs.clear();
+    m_stats.candidates = 0;
+    m_stats.pairs = 0;
+    if (count < 2) return;
+
+    float minX, minY, maxX, maxY;
+    finiteBounds(positions, count, minX, minY, maxX, maxY);
+    float maxRadius = 0.0f;
+    float radiusSum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxRadius = std::max(maxRadius, radii[i]);
+        radiusSum += radii[i];
+    }
+
+    float splitRadius = std::numeric_limits<float>::infinity();
+    if (isAutomatic()) {
+        const float meanRadius = radiusSum / static_cast<float>(count);
+        if (m_tunedMaxRadius <= 0.0f || drifted(meanRadius, m_tunedMeanRadius) ||
+            drifted(maxRadius, m_tunedMaxRadius)) {
+            tune(radii, count, meanRadius, maxRadius);
+        }
+        splitRadius = m_splitRadius;
+    }
+
+    m_fine.members.clear();
+    m_coarse.members.clear();
+    float fineMaxRadius = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        if (radii[i] > splitRadius) {
+            m_coarse.members.push_back(static_cast<std::uint32_t>(i));
+        } else {
+            m_fine.members.push_back(static_cast<std::uint32_t>(i));
+            fineMaxRadius = std::max(fineMaxRadius, radii[i]);
+        }
+    }
+
+    // a vizinhança 3x3 só basta se nenhum par do nível alcançar além de uma célula
+    const float fineCell = std::max(m_cellSize, 2.0f * fineMaxRadius + margin);
+    build(m_fine, positions, fineCell, minX, minY, maxX, maxY);
+    m_gridStats.cellSize = m_fine.cellSize;
+    m_gridStats.outliers = m_coarse.members.size();
+    m_gridStats.coarseCellSize = 0.0f;
+
+    size_t candidates = 0;
+    auto testPair = [&](std::uint32_t i, std::uint32_t j) {
+        ++candidates;
+        const float dx = positions[i * 2] - positions[j * 2];
+        const float dy = positions[i * 2 + 1] - positions[j * 2 + 1];
+        const float reach = radii[i] + radii[j] + margin;
+        if (dx * dx + dy * dy < reach * reach) {
+            pairs.push_back({std::min(i, j), std::max(i, j)});
+        }
+    };
+
+    forEachPairInLevel(m_fine, testPair);
+    if (!m_coarse.members.empty()) {
+        build(m_coarse, positions, 2.0f * maxRadius + margin, minX, minY, maxX, maxY);
+        m_gridStats.coarseCellSize = m_coarse.cellSize;
+        forEachPairInLevel(m_coarse, testPair);
+        forEachCrossPair(m_fine, m_coarse, positions, radii, fineMaxRadius + margin, testPair);
+    }
+
+    m_stats.candidates = candidates;
+    m_stats.pairs = pairs.size();
+}
+
+SpatialGrid::CellIndex SpatialGrid::indexCells(const float* positions, size_t count, float cellSize) {
+    CellIndex index;
+    if (count == 0) return index;
+
+    float minX, minY, maxX, maxY;
+    finiteBounds(positions, count, minX, minY, maxX, maxY);
+    if (m_index.members.size() != count) {
+        m_index.members.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_index.members[i] = static_cast<std::uint32_t>(i);
+        }
+    }
+    build(m_index, positions, cellSize, minX, minY, maxX, maxY);
+
+    index.minX = m_index.minX;
+    index.minY = m_index.minY;
+    index.cellSize = m_index.cellSize;
+    index.invCell = m_index.invCell;
+    index.cellsX = m_index.cellsX;
+    index.cellsY = m_index.cellsY;
+    index.cellStart = m_index.cellStart.data();
+    index.sorted = m_index.sorted.data();
+    return index;
 }
@@ -1,24 +1,89 @@
 #pragma once
-#include "Particle.h"
+#include "Broadphase.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 
-class SpatialGrid {
+// Grade uniforme sobre as posições do SoA. Cada construção ordena os índices por
+// célula (counting sort, sem alocação depois da primeira vez) e percorre só
+// metade da vizinhança 3x3, então cada par sai uma única vez.
+//
+// No modo automático (padrão) a célula sai da distribuição de raios: ela cobre o
+// alcance das partículas comuns (quantil 95%) e as poucas bem maiores que isso
+// vão para um segundo nível, uma grade grossa só delas, em vez de inflar a célula
+// de todo mundo. A distribuição é reavaliada quando a média ou o máximo dos
+// raios se desloca mais que 10%.
+class SpatialGrid : public Broadphase {
 public:
-    SpatialGrid(float width, float height, float cellSize);
-    
-    void clear();
-    
-    void insert(Particle* particle);
-    
-    std::vector<Particle*> getNearbyParticles(Particle* particle);
+    struct GridStats {
+        float cellSize = 0.0f;        // célula da grade fina na última construção
+        float coarseCellSize = 0.0f;  // 0 se não houve segundo nível
+        size_t outliers = 0;          // partículas no segundo nível
+        std::uint64_t retunes = 0;
+    };
+
+    SpatialGrid() = default;
+    // Célula fixa; 0 volta ao modo automático
+    explicit SpatialGrid(float cellSize);
+
+    // Todos os pares com distância < ra + rb + margin. A célula nunca fica menor
+    // que o maior alcance do seu nível (2 * raio máximo + margin).
+    void findPairs(const float* positions, const float* radii, size_t count, float margin,
+                   std::vector<ParticlePair>& pairs) override;
+    const char* getName() const override { return "grade"; }
+
+    void setCellSize(float cellSize) { m_cellSize = cellSize; m_tunedMaxRadius = 0.0f; }
+    float getCellSize() const { return m_cellSize; }
+    bool isAutomatic() const { return m_cellSize <= 0.0f; }
+
+    const GridStats& getGridStats() const { return m_gridStats; }
+
+    // Índices ordenados por célula, para quem percorre a vizinhança 3x3 de cada
+    // partícula em vez de uma lista de pares (o fluido). As células de uma linha
+    // são consecutivas em sorted, então as três de cima, as três do meio e as
+    // três de baixo são três faixas contínuas.
+    struct CellIndex {
+        float minX = 0.0f, minY = 0.0f;
+        float cellSize = 0.0f, invCell = 0.0f;
+        size_t cellsX = 0, cellsY = 0;
+        const std::uint32_t* cellStart = nullptr;  // cellsX * cellsY + 1 entradas
+        const std::uint32_t* sorted = nullptr;
+    };
+    // Célula de pelo menos cellSize; cresce se passar do orçamento de células.
+    // Usa um nível próprio: não mexe nos pares nem no ajuste automático.
+    CellIndex indexCells(const float* positions, size_t count, float cellSize);
 
 private:
-    long long getCellHash(int cellX, int cellY) const;
+    // Um nível da grade: só os índices de members entram
+    struct Level {
+        float minX = 0.0f, minY = 0.0f;
+        float cellSize = 0.0f, invCell = 0.0f;
+        size_t cellsX = 0, cellsY = 0;
+        std::vector<std::uint32_t> members;
+        std::vector<std::uint32_t> cellStart;
+        std::vector<std::uint32_t> cellOf;
+        std::vector<std::uint32_t> sorted;
+    };
+
+    void tune(const float* radii, size_t count, float meanRadius, float maxRadius);
+    void build(Level& level, const float* positions, float cellSize, float minX, float minY, float maxX,
+               float maxY);
+    template <typename Test>
+    void forEachPairInLevel(const Level& level, Test&& test) const;
+    template <typename Test>
+    void forEachCrossPair(const Level& fine, const Level& coarse, const float* positions, const float* radii,
+                          float reachExtra, Test&& test) const;
+
+    float m_cellSize = 0.0f;
+
+    // raio que separa os dois níveis; infinito quando todos cabem na grade fina
+    float m_splitRadius = 0.0f;
+    float m_tunedMeanRadius = 0.0f;
+    float m_tunedMaxRadius = 0.0f;
 
-    float m_width;
-    float m_height;
-    float m_cellSize;
-    
-    std::unordered_map<long long, std::vector<Particle*>> m_grid;
+    Level m_fine;
+    Level m_coarse;
+    Level m_index;
+    std::vector<float> m_scratch;
+    GridStats m_gridStats;
 };
@@ -0,0 +1,89 @@
+#include "Species.h"
+#include <algorithm>
+
+void SpeciesTable::setCount(size_t count) {
+    m_count = std::min(std::max<size_t>(count, 1), MAX_SPECIES);
+    for (size_t a = 0; a < MAX_SPECIES; ++a) {
+        for (size_t b = 0; b < MAX_SPECIES; ++b) {
+            m_matrix[a][b] = Interaction();
+        }
+        m_restitution[a] = 1.0f;
+        m_friction[a] = DEFAULT_FRICTION;
+    }
+}
+
+void SpeciesTable::setInteraction(size_t a, size_t b, const Interaction& interaction) {
+    m_matrix[a][b] = interaction;
+    m_matrix[b][a] = interaction;
+}
+
+size_t SpeciesTable::pairIndex(size_t a, size_t b) const {
+    const size_t low = std::min(a, b);
+    const size_t high = std::max(a, b);
+    // linhas do triângulo superior: a linha low começa depois de low linhas encurtando
+    return low * m_count - low * (low - 1) / 2 + (high - low);
+}
+
+float SpeciesTable::maxRange() const {
+    float range = 0.0f;
+    for (size_t a = 0; a < m_count; ++a) {
+        for (size_t b = a; b < m_count; ++b) {
+            range = std::max(range, m_matrix[a][b].range);
+        }
+    }
+    return range;
+}
+
+void SpeciesTable::loadPreset(SpeciesPreset preset) {
+    m_preset = preset;
+    switch (preset) {
+        case SpeciesPreset::Clusters:
+            setCount(3);
+            for (size_t a = 0; a < 3; ++a) {
+                for (size_t b = a; b < 3; ++b) {
+                    setInteraction(a, b, a == b ? Interaction{-150.0f, 50.0f} : Interaction{200.0f, 70.0f});
+                }
+            }
+            // uma espécie quica e escorrega, outra quase não quica e gruda
+            setRestitution(0, 1.4f);
+            setFriction(0, 0.2f);
+            setRestitution(1, 0.3f);
+            setFriction(1, 1.0f);
+            break;
+        case SpeciesPreset::Chain:
+            setCount(3);
+            setInteraction(0, 0, {10.0f, 40.0f});
+            setInteraction(1, 1, {10.0f, 40.0f});
+            setInteraction(2, 2, {10.0f, 40.0f});
+            setInteraction(0, 1, {-150.0f, 60.0f});
+            setInteraction(1, 2, {-150.0f, 60.0f});
+            setInteraction(0, 2, {200.0f, 80.0f});
+            break;
+        case SpeciesPreset::Uniform:
+        case SpeciesPreset::Count:
+            m_preset = SpeciesPreset::Uniform;
+            setCount(1);
+            break;
+    }
+}
+
+const char* SpeciesTable::presetName(SpeciesPreset preset) {
+    switch (preset) {
+        case SpeciesPreset::Clusters: return "aglomerados";
+        case SpeciesPreset::Chain:    return "cadeia";
+        case SpeciesPreset::Uniform:
+        case SpeciesPreset::Count:    break;
+    }
+    return "uniforme";
+}
+
+void SpeciesTable::color(size_t species, std::uint8_t& r, std::uint8_t& g, std::uint8_t& b) {
+    static const std::uint8_t PALETTE[MAX_SPECIES][3] = {
+        {255, 90, 80}, {80, 200, 255}, {255, 220, 70}, {140, 255, 120},
+        {220, 120, 255}, {255, 160, 60}, {90, 255, 220}, {240, 240, 240},
+    };
+    const std::uint8_t* rgb = PALETTE[species % MAX_SPECIES];
+    r = rgb[0];
+    g = rgb[1];
+    b = rgb[2];
+}
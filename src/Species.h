@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Conjuntos prontos de espécies
+enum class SpeciesPreset : std::uint8_t {
+    Uniform = 0,  // uma espécie só: a repulsão e as colisões de sempre
+    Clusters,     // três espécies; iguais se atraem, diferentes se repelem
+    Chain,        // A atrai B, B atrai C, A e C se repelem
+    Count
+};
+
+// Espécies de partícula e como elas interagem. Cada par de espécies tem a sua
+// força entre pares (escala da repulsão global: positiva repele, negativa atrai)
+// e o seu alcance além da soma dos raios; a matriz é simétrica, para a força
+// continuar sendo ação e reação. Cada espécie tem a sua restituição (escala da
+// global) e o seu atrito; num contato vale a maior restituição e a média
+// geométrica dos atritos.
+class SpeciesTable {
+public:
+    static constexpr size_t MAX_SPECIES = 8;
+    static constexpr float DEFAULT_RANGE = 60.0f;
+    static constexpr float DEFAULT_FRICTION = 0.9f;
+
+    struct Interaction {
+        float strength = 1.0f;
+        float range = DEFAULT_RANGE;
+    };
+
+    SpeciesTable() { loadPreset(SpeciesPreset::Uniform); }
+
+    void loadPreset(SpeciesPreset preset);
+    static const char* presetName(SpeciesPreset preset);
+    SpeciesPreset getPreset() const { return m_preset; }
+
+    // Espécies em uso (1..MAX_SPECIES); as interações voltam ao padrão
+    void setCount(size_t count);
+    size_t getCount() const { return m_count; }
+
+    void setInteraction(size_t a, size_t b, const Interaction& interaction);
+    const Interaction& getInteraction(size_t a, size_t b) const { return m_matrix[a][b]; }
+    // Índice do par sem ordem, de 0 a pairCount() - 1
+    size_t pairIndex(size_t a, size_t b) const;
+    size_t pairCount() const { return m_count * (m_count + 1) / 2; }
+    // Maior alcance entre os pares: a margem da busca de vizinhos
+    float maxRange() const;
+
+    void setRestitution(size_t species, float scale) { m_restitution[species] = scale; }
+    void setFriction(size_t species, float friction) { m_friction[species] = friction; }
+    // Por espécie, para o solver de contato coletar por índice
+    const float* restitutionScales() const { return m_restitution; }
+    const float* frictions() const { return m_friction; }
+
+    // Cor de quem nasce na espécie (RGB)
+    static void color(size_t species, std::uint8_t& r, std::uint8_t& g, std::uint8_t& b);
+
+private:
+    SpeciesPreset m_preset = SpeciesPreset::Uniform;
+    size_t m_count = 1;
+    Interaction m_matrix[MAX_SPECIES][MAX_SPECIES];
+    float m_restitution[MAX_SPECIES];
+    float m_friction[MAX_SPECIES];
+};
@@ -0,0 +1,270 @@
+#include "StateExportFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef CHAOS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    constexpr int ZSTD_LEVEL = 3;
+
+    void putVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    bool getVarint(const std::uint8_t* data, size_t size, size_t& cursor, std::uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (cursor >= size) return false;
+            const std::uint8_t byte = data[cursor++];
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    std::uint32_t zigzag(std::int32_t v) {
+        return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+    }
+
+    std::int32_t unzigzag(std::uint32_t v) {
+        return static_cast<std::int32_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    template <typename T>
+    void putRaw(std::vector<std::uint8_t>& out, const T& value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    bool getRaw(const std::uint8_t* data, size_t size, size_t& cursor, T& value) {
+        if (cursor + sizeof(T) > size) return false;
+        std::memcpy(&value, data + cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    bool decodeFrame(const StateExport::FileHeader& header, const std::uint8_t* data, size_t size, size_t& cursor,
+                     std::vector<std::int32_t> (&previousQ)[StateExport::FieldCount], StateExport::Frame& frame) {
+        std::uint8_t keyframe = 0;
+        if (!getRaw(data, size, cursor, frame.step) ||
+            !getRaw(data, size, cursor, frame.particleCount) ||
+            !getRaw(data, size, cursor, keyframe)) {
+            return false;
+        }
+
+        for (std::uint32_t f = 0; f < StateExport::FieldCount; ++f) {
+            std::vector<float>& values = frame.fields[f];
+            if (!(header.fields & (1u << f))) {
+                values.clear();
+                continue;
+            }
+
+            const size_t n = static_cast<size_t>(frame.particleCount) * StateExport::FIELD_COMPONENTS[f];
+            values.resize(n);
+
+            if (!header.quantized) {
+                if (cursor + n * sizeof(float) > size) return false;
+                std::memcpy(values.data(), data + cursor, n * sizeof(float));
+                cursor += n * sizeof(float);
+                continue;
+            }
+
+            std::vector<std::int32_t>& q = previousQ[f];
+            if (!keyframe && q.size() != n) return false;
+            q.resize(n);
+
+            const float invScale = 1.0f / header.fieldScales[f];
+            for (size_t i = 0; i < n; ++i) {
+                std::uint32_t encoded;
+                if (!getVarint(data, size, cursor, encoded)) return false;
+                q[i] = keyframe ? unzigzag(encoded) : q[i] + unzigzag(encoded);
+                values[i] = static_cast<float>(q[i]) * invScale;
+            }
+        }
+        return true;
+    }
+}
+
+bool StateExport::codecAvailable(Codec codec) {
+#ifdef CHAOS_HAVE_ZSTD
+    if (codec == CodecZstd) return true;
+#endif
+    return codec == CodecNone;
+}
+
+void StateExport::encodeFrame(const FileHeader& header, const Frame& frame, bool keyframe,
+                              std::vector<std::int32_t> (&previousQ)[FieldCount], std::vector<std::uint8_t>& out) {
+    // delta só faz sentido se o número de partículas não mudou
+    for (std::uint32_t f = 0; f < FieldCount && !keyframe; ++f) {
+        if ((header.fields & (1u << f)) &&
+            previousQ[f].size() != static_cast<size_t>(frame.particleCount) * FIELD_COMPONENTS[f]) {
+            keyframe = true;
+        }
+    }
+
+    putRaw(out, frame.step);
+    putRaw(out, frame.particleCount);
+    putRaw(out, static_cast<std::uint8_t>(keyframe ? 1 : 0));
+
+    for (std::uint32_t f = 0; f < FieldCount; ++f) {
+        if (!(header.fields & (1u << f))) continue;
+
+        const std::vector<float>& values = frame.fields[f];
+        const size_t n = static_cast<size_t>(frame.particleCount) * FIELD_COMPONENTS[f];
+
+        if (!header.quantized) {
+            const size_t at = out.size();
+            out.resize(at + n * sizeof(float));
+            std::memcpy(out.data() + at, values.data(), n * sizeof(float));
+            continue;
+        }
+
+        std::vector<std::int32_t>& q = previousQ[f];
+        q.resize(n);
+        const float scale = header.fieldScales[f];
+        for (size_t i = 0; i < n; ++i) {
+            const std::int32_t current = static_cast<std::int32_t>(std::lround(values[i] * scale));
+            putVarint(out, zigzag(keyframe ? current : current - q[i]));
+            q[i] = current;
+        }
+    }
+}
+
+bool StateExport::compress(Codec codec, const std::vector<std::uint8_t>& raw, std::vector<std::uint8_t>& stored) {
+    if (codec == CodecNone) {
+        stored = raw;
+        return true;
+    }
+#ifdef CHAOS_HAVE_ZSTD
+    if (codec == CodecZstd) {
+        stored.resize(ZSTD_compressBound(raw.size()));
+        const size_t bytes = ZSTD_compress(stored.data(), stored.size(), raw.data(), raw.size(), ZSTD_LEVEL);
+        if (ZSTD_isError(bytes)) return false;
+        stored.resize(bytes);
+        return true;
+    }
+#else
+    (void)ZSTD_LEVEL;
+#endif
+    return false;
+}
+
+bool StateExport::decompress(Codec codec, const std::uint8_t* stored, size_t storedBytes,
+                             size_t rawBytes, std::vector<std::uint8_t>& raw) {
+    if (codec == CodecNone) {
+        if (storedBytes != rawBytes) return false;
+        raw.assign(stored, stored + storedBytes);
+        return true;
+    }
+#ifdef CHAOS_HAVE_ZSTD
+    if (codec == CodecZstd) {
+        raw.resize(rawBytes);
+        const size_t bytes = ZSTD_decompress(raw.data(), raw.size(), stored, storedBytes);
+        return !ZSTD_isError(bytes) && bytes == rawBytes;
+    }
+#endif
+    return false;
+}
+
+bool StateExport::Reader::open(const std::string& path) {
+    m_file.open(path, std::ios::binary);
+    if (!m_file) {
+        std::cerr << "[ERRO] Não foi possível abrir o export: " << path << std::endl;
+        return false;
+    }
+
+    if (!m_file.read(reinterpret_cast<char*>(&m_header), sizeof(m_header)) ||
+        std::memcmp(m_header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || m_header.version != VERSION) {
+        std::cerr << "[ERRO] Export inválido ou de versão incompatível: " << path << std::endl;
+        return false;
+    }
+
+    if (!readIndexFromTrailer()) {
+        std::cerr << "[AVISO] Export sem índice (gravação interrompida?), varrendo chunks..." << std::endl;
+        if (!rebuildIndexByScanning()) return false;
+    }
+
+    m_frameCount = 0;
+    for (const IndexEntry& entry : m_index) {
+        m_frameCount = std::max<std::uint64_t>(m_frameCount, entry.firstFrame + entry.frameCount);
+    }
+    return true;
+}
+
+bool StateExport::Reader::readIndexFromTrailer() {
+    m_file.clear();
+    m_file.seekg(0, std::ios::end);
+    const std::streamoff fileSize = m_file.tellg();
+    if (fileSize < static_cast<std::streamoff>(sizeof(FileHeader) + sizeof(Trailer))) return false;
+
+    Trailer trailer;
+    m_file.seekg(fileSize - static_cast<std::streamoff>(sizeof(Trailer)));
+    if (!m_file.read(reinterpret_cast<char*>(&trailer), sizeof(trailer)) ||
+        std::memcmp(trailer.magic, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0) {
+        return false;
+    }
+
+    m_index.resize(trailer.chunkCount);
+    m_file.seekg(static_cast<std::streamoff>(trailer.indexOffset));
+    return static_cast<bool>(m_file.read(reinterpret_cast<char*>(m_index.data()),
+                                         static_cast<std::streamsize>(m_index.size() * sizeof(IndexEntry))));
+}
+
+bool StateExport::Reader::rebuildIndexByScanning() {
+    m_index.clear();
+    m_file.clear();
+    std::uint64_t offset = sizeof(FileHeader);
+
+    while (true) {
+        ChunkHeader chunk;
+        m_file.seekg(static_cast<std::streamoff>(offset));
+        if (!m_file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk)) ||
+            std::memcmp(chunk.magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+            break;
+        }
+        m_index.push_back({offset, chunk.firstFrame, chunk.frameCount});
+        offset += sizeof(chunk) + chunk.storedBytes;
+    }
+    m_file.clear();
+    return !m_index.empty();
+}
+
+bool StateExport::Reader::readFrame(std::uint64_t frameIndex, Frame& out) {
+    const IndexEntry* entry = nullptr;
+    for (const IndexEntry& candidate : m_index) {
+        if (frameIndex >= candidate.firstFrame && frameIndex < candidate.firstFrame + candidate.frameCount) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (!entry) return false;
+
+    ChunkHeader chunk;
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(entry->fileOffset));
+    if (!m_file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))) return false;
+
+    m_stored.resize(chunk.storedBytes);
+    if (!m_file.read(reinterpret_cast<char*>(m_stored.data()), chunk.storedBytes)) return false;
+    if (!decompress(static_cast<Codec>(chunk.codec), m_stored.data(), m_stored.size(), chunk.rawBytes, m_raw)) {
+        std::cerr << "[ERRO] Não foi possível descomprimir o chunk do frame " << frameIndex << std::endl;
+        return false;
+    }
+
+    std::vector<std::int32_t> previousQ[FieldCount];
+    size_t cursor = 0;
+    for (std::uint64_t frame = chunk.firstFrame; frame <= frameIndex; ++frame) {
+        if (!decodeFrame(m_header, m_raw.data(), m_raw.size(), cursor, previousQ, out)) return false;
+    }
+    return true;
+}
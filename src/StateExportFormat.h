@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Formato do export de estado por frame (lido por tools/export_reader.cpp).
+//
+//   FileHeader
+//   Chunk*        ChunkHeader + payload (opcionalmente comprimido com zstd)
+//   Index         IndexEntry por chunk
+//   Trailer       aponta para o índice; ausente se o processo morreu no meio
+//
+// Payload de um chunk, por frame: u64 passo | u32 partículas | u8 keyframe |
+// cada campo selecionado, na ordem dos bits de Field. Com quantização, cada
+// componente vira ponto fixo (escala no cabeçalho) e é gravado como varint
+// zigzag: absoluto nos keyframes, delta em relação ao frame anterior nos demais.
+// O primeiro frame de cada chunk é sempre keyframe, então qualquer chunk é
+// decodificável isoladamente.
+namespace StateExport {
+    constexpr char FILE_MAGIC[4] = {'C', 'H', 'E', 'X'};
+    constexpr char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+    constexpr char TRAILER_MAGIC[4] = {'C', 'H', 'I', 'X'};
+    constexpr std::uint32_t VERSION = 1;
+
+    enum Field : std::uint32_t {
+        FieldPositions         = 1 << 0,
+        FieldPreviousPositions = 1 << 1,
+        FieldVelocities        = 1 << 2,
+        FieldMasses            = 1 << 3,
+        FieldRadii             = 1 << 4,
+        FieldCount             = 5
+    };
+
+    enum Codec : std::uint32_t {
+        CodecNone = 0,
+        CodecZstd = 1,
+    };
+
+    // componentes por partícula de cada campo (x/y ou escalar)
+    constexpr std::uint32_t FIELD_COMPONENTS[FieldCount] = {2, 2, 2, 1, 1};
+
+    struct FileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t fields;
+        std::uint32_t quantized;
+        std::uint32_t stepInterval;
+        float fieldScales[FieldCount];
+    };
+
+    struct ChunkHeader {
+        char magic[4];
+        std::uint32_t codec;
+        std::uint32_t frameCount;
+        std::uint32_t rawBytes;
+        std::uint32_t storedBytes;
+        std::uint32_t reserved;
+        std::uint64_t firstFrame;
+    };
+
+    struct IndexEntry {
+        std::uint64_t fileOffset;
+        std::uint64_t firstFrame;
+        std::uint64_t frameCount;
+    };
+
+    struct Trailer {
+        char magic[4];
+        std::uint32_t chunkCount;
+        std::uint64_t indexOffset;
+    };
+
+    // Um frame decodificado; os vetores dos campos não selecionados ficam vazios
+    struct Frame {
+        std::uint64_t step = 0;
+        std::uint32_t particleCount = 0;
+        std::vector<float> fields[FieldCount];
+    };
+
+    bool codecAvailable(Codec codec);
+
+    // Codifica um frame no fim de out. previous é o último frame codificado
+    // (ou nullptr para forçar keyframe); previousQ guarda o estado quantizado entre chamadas.
+    void encodeFrame(const FileHeader& header, const Frame& frame, bool keyframe,
+                     std::vector<std::int32_t> (&previousQ)[FieldCount], std::vector<std::uint8_t>& out);
+
+    // Comprime (se o codec pedir) e devolve o payload a gravar
+    bool compress(Codec codec, const std::vector<std::uint8_t>& raw, std::vector<std::uint8_t>& stored);
+    bool decompress(Codec codec, const std::uint8_t* stored, size_t storedBytes,
+                    size_t rawBytes, std::vector<std::uint8_t>& raw);
+
+    class Reader {
+    public:
+        bool open(const std::string& path);
+
+        const FileHeader& header() const { return m_header; }
+        std::uint64_t frameCount() const { return m_frameCount; }
+        size_t chunkCount() const { return m_index.size(); }
+
+        // Busca o chunk pelo índice e decodifica só até o frame pedido
+        bool readFrame(std::uint64_t frameIndex, Frame& out);
+
+    private:
+        bool readIndexFromTrailer();
+        bool rebuildIndexByScanning();
+
+        std::ifstream m_file;
+        FileHeader m_header{};
+        std::vector<IndexEntry> m_index;
+        std::uint64_t m_frameCount = 0;
+        std::vector<std::uint8_t> m_stored;
+        std::vector<std::uint8_t> m_raw;
+    };
+}
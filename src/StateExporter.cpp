@@ -0,0 +1,182 @@
+#include "StateExporter.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // ponto fixo de cada campo quando quantizado: 1/16 px, 1/16 px/s, 1/256 de massa/raio
+    constexpr float FIELD_SCALES[StateExport::FieldCount] = {16.0f, 16.0f, 16.0f, 256.0f, 256.0f};
+}
+
+StateExporter::~StateExporter() {
+    close();
+}
+
+bool StateExporter::open(const std::string& path, const Options& options) {
+    close();
+
+    if (options.fields == 0 || options.stepInterval == 0 || options.framesPerChunk == 0) {
+        std::cerr << "[ERRO] Opções de export inválidas." << std::endl;
+        return false;
+    }
+    if (!StateExport::codecAvailable(options.codec)) {
+        std::cerr << "[ERRO] Compressão não disponível nesta build." << std::endl;
+        return false;
+    }
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        std::cerr << "[ERRO] Não foi possível criar o export: " << path << std::endl;
+        return false;
+    }
+
+    m_options = options;
+    m_header = StateExport::FileHeader{};
+    std::memcpy(m_header.magic, StateExport::FILE_MAGIC, sizeof(StateExport::FILE_MAGIC));
+    m_header.version = StateExport::VERSION;
+    m_header.fields = options.fields;
+    m_header.quantized = options.quantize ? 1 : 0;
+    m_header.stepInterval = options.stepInterval;
+    std::memcpy(m_header.fieldScales, FIELD_SCALES, sizeof(FIELD_SCALES));
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_fileOffset = sizeof(m_header);
+
+    for (auto& q : m_previousQ) q.clear();
+    m_front.clear();
+    m_frontFrames = 0;
+    m_frontFirstFrame = 0;
+    m_stepCounter = 0;
+    m_frameCounter = 0;
+    m_backReady = false;
+    m_stopping = false;
+    m_index.clear();
+
+    m_thread = std::thread(&StateExporter::ioLoop, this);
+    return true;
+}
+
+void StateExporter::close() {
+    if (!m_thread.joinable()) return;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return !m_backReady; });
+    }
+    if (m_frontFrames > 0) {
+        handOffFront();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    StateExport::Trailer trailer;
+    std::memcpy(trailer.magic, StateExport::TRAILER_MAGIC, sizeof(StateExport::TRAILER_MAGIC));
+    trailer.chunkCount = static_cast<std::uint32_t>(m_index.size());
+    trailer.indexOffset = m_fileOffset;
+    m_file.write(reinterpret_cast<const char*>(m_index.data()),
+                 static_cast<std::streamsize>(m_index.size() * sizeof(StateExport::IndexEntry)));
+    m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    m_file.close();
+}
+
+void StateExporter::onStep(const ParticleSystem& system) {
+    if (!m_thread.joinable()) return;
+    if (m_stepCounter++ % m_options.stepInterval != 0) return;
+
+    system.captureSnapshot(m_capture);
+
+    // troca em vez de copiar: os dois lados mantêm a capacidade entre frames
+    m_frame.step = m_stepCounter - 1;
+    m_frame.particleCount = static_cast<std::uint32_t>(m_capture.count());
+    std::swap(m_frame.fields[0], m_capture.positions);
+    std::swap(m_frame.fields[1], m_capture.previousPositions);
+    std::swap(m_frame.fields[2], m_capture.velocities);
+    std::swap(m_frame.fields[3], m_capture.masses);
+    std::swap(m_frame.fields[4], m_capture.radii);
+
+    if (m_frontFrames == 0) {
+        m_frontFirstFrame = m_frameCounter;
+    }
+    StateExport::encodeFrame(m_header, m_frame, m_frontFrames == 0, m_previousQ, m_front);
+    ++m_frontFrames;
+    ++m_frameCounter;
+
+    if (m_frontFrames >= m_options.framesPerChunk) {
+        handOffFront();
+    }
+}
+
+void StateExporter::handOffFront() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_backReady) {
+            return; // I/O ainda ocupado: o chunk da frente continua crescendo
+        }
+        std::swap(m_front, m_back);
+        m_backFrames = m_frontFrames;
+        m_backFirstFrame = m_frontFirstFrame;
+        m_backReady = true;
+    }
+    m_cv.notify_all();
+
+    m_front.clear();
+    m_frontFrames = 0;
+}
+
+void StateExporter::ioLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_backReady || m_stopping; });
+            if (!m_backReady) return;
+        }
+
+        // m_back é exclusivo deste thread até m_backReady voltar a false
+        if (!StateExport::compress(m_options.codec, m_back, m_stored)) {
+            std::cerr << "[ERRO] Falha ao comprimir chunk do export." << std::endl;
+            m_stored = m_back;
+            m_options.codec = StateExport::CodecNone;
+        }
+
+        StateExport::ChunkHeader chunk{};
+        std::memcpy(chunk.magic, StateExport::CHUNK_MAGIC, sizeof(StateExport::CHUNK_MAGIC));
+        chunk.codec = m_options.codec;
+        chunk.frameCount = m_backFrames;
+        chunk.rawBytes = static_cast<std::uint32_t>(m_back.size());
+        chunk.storedBytes = static_cast<std::uint32_t>(m_stored.size());
+        chunk.firstFrame = m_backFirstFrame;
+
+        m_file.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+        m_file.write(reinterpret_cast<const char*>(m_stored.data()), static_cast<std::streamsize>(m_stored.size()));
+        m_index.push_back({m_fileOffset, m_backFirstFrame, m_backFrames});
+        m_fileOffset += sizeof(chunk) + m_stored.size();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_backReady = false;
+        }
+        m_cv.notify_all();
+    }
+}
+
+std::uint32_t StateExporter::parseFieldList(const std::string& list) {
+    static const char* const NAMES[StateExport::FieldCount] = {"pos", "prev", "vel", "mass", "radius"};
+
+    std::uint32_t fields = 0;
+    std::stringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        bool found = false;
+        for (std::uint32_t f = 0; f < StateExport::FieldCount; ++f) {
+            if (name == NAMES[f]) {
+                fields |= 1u << f;
+                found = true;
+            }
+        }
+        if (!found) return 0;
+    }
+    return fields;
+}
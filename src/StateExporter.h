@@ -0,0 +1,76 @@
+#pragma once
+#include "ParticleSystem.h"
+#include "StateExportFormat.h"
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Exporta campos do SoA a cada N passos para um arquivo em chunks (ver
+// StateExportFormat.h). O thread de física só codifica o frame no chunk da
+// frente; um thread de I/O grava o chunk de trás. Se o I/O atrasar, o chunk
+// da frente simplesmente cresce: a física nunca espera pelo disco.
+class StateExporter {
+public:
+    struct Options {
+        std::uint32_t fields = StateExport::FieldPositions | StateExport::FieldVelocities;
+        std::uint32_t stepInterval = 1;
+        std::uint32_t framesPerChunk = 64;
+        bool quantize = true;
+        StateExport::Codec codec = StateExport::codecAvailable(StateExport::CodecZstd)
+                                       ? StateExport::CodecZstd : StateExport::CodecNone;
+    };
+
+    StateExporter() = default;
+    ~StateExporter();
+
+    StateExporter(const StateExporter&) = delete;
+    StateExporter& operator=(const StateExporter&) = delete;
+
+    bool open(const std::string& path, const Options& options);
+    // Grava o que falta, o índice e o trailer. Bloqueia até o I/O terminar.
+    void close();
+    bool isOpen() const { return m_thread.joinable(); }
+
+    void onStep(const ParticleSystem& system);
+
+    // "pos,prev,vel,mass,radius" -> máscara de StateExport::Field (0 se inválida)
+    static std::uint32_t parseFieldList(const std::string& list);
+
+private:
+    void ioLoop();
+    void handOffFront();
+
+    std::ofstream m_file;
+    StateExport::FileHeader m_header{};
+    Options m_options;
+
+    // estado do thread de física
+    Snapshot::Data m_capture;
+    StateExport::Frame m_frame;
+    std::vector<std::int32_t> m_previousQ[StateExport::FieldCount];
+    std::vector<std::uint8_t> m_front;
+    std::uint32_t m_frontFrames = 0;
+    std::uint64_t m_frontFirstFrame = 0;
+    std::uint64_t m_stepCounter = 0;
+    std::uint64_t m_frameCounter = 0;
+
+    // chunk de trás: pertence ao thread de I/O enquanto m_backReady for true
+    std::vector<std::uint8_t> m_back;
+    std::uint32_t m_backFrames = 0;
+    std::uint64_t m_backFirstFrame = 0;
+    bool m_backReady = false;
+    bool m_stopping = false;
+
+    // estado do thread de I/O
+    std::vector<std::uint8_t> m_stored;
+    std::vector<StateExport::IndexEntry> m_index;
+    std::uint64_t m_fileOffset = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
@@ -0,0 +1,53 @@
+#include "StepKernels.h"
+#include <array>
+#include <utility>
+
+namespace StepKernels {
+    namespace {
+        template <bool Gravity, bool Fields, bool Pairwise, bool Obstacles, IntegratorType Integrator>
+        void stepKernel(const ExternalForceParams& forces, const IntegrationParams& integration,
+                        const StepArrays& arrays) {
+            integrateParticles(StaticStepFlags<Gravity, Fields, Pairwise, Obstacles, Integrator>(), forces,
+                               integration, arrays);
+        }
+
+        // índice = integrador << 4 | obstacles << 3 | pairwise << 2 | fields << 1 | gravity
+        constexpr size_t kernelIndex(bool gravity, bool fields, bool pairwise, bool obstacles,
+                                     IntegratorType integrator) {
+            return (size_t(integrator) << 4) | (size_t(obstacles) << 3) | (size_t(pairwise) << 2) |
+                   (size_t(fields) << 1) | size_t(gravity);
+        }
+
+        template <size_t... I>
+        constexpr std::array<StepKernel, sizeof...(I)> makeKernelTable(std::index_sequence<I...>) {
+            return {{ &stepKernel<(I & 1) != 0, ((I >> 1) & 1) != 0, ((I >> 2) & 1) != 0, ((I >> 3) & 1) != 0,
+                                  static_cast<IntegratorType>(I >> 4)>... }};
+        }
+
+        constexpr auto KERNEL_TABLE = makeKernelTable(std::make_index_sequence<16 * INTEGRATOR_COUNT>());
+    }
+
+    const char* integratorName(IntegratorType integrator) {
+        switch (integrator) {
+            case IntegratorType::SymplecticEuler: return "euler simplético";
+            case IntegratorType::VelocityVerlet:  return "velocity verlet";
+            case IntegratorType::PositionVerlet:  break;
+        }
+        return "verlet de posição";
+    }
+
+    float courantLimit(IntegratorType integrator) {
+        // o Euler erra mais por passo (primeira ordem), então anda menos
+        return integrator == IntegratorType::SymplecticEuler ? 0.25f : 0.5f;
+    }
+
+    StepKernel selectStepKernel(const DynamicStepFlags& flags) {
+        return KERNEL_TABLE[kernelIndex(flags.gravity, flags.fields, flags.pairwise, flags.obstacles,
+                                        flags.integrator)];
+    }
+
+    void integrateParticlesGeneric(const DynamicStepFlags& flags, const ExternalForceParams& forces,
+                                   const IntegrationParams& integration, const StepArrays& arrays) {
+        integrateParticles(flags, forces, integration, arrays);
+    }
+}
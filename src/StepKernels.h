@@ -0,0 +1,241 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "ForceField.h"
+#include "Obstacle.h"
+
+// Passo fundido: as partículas são processadas em blocos de
+// ForceFieldSet::BLOCK_SIZE. Para cada bloco os campos de força somam numa
+// aceleração local (que fica no L1) e em seguida gravidade, arrasto do ar,
+// integração e bordas saem na mesma passada, então cada array do SoA é lido e
+// escrito uma única vez por passo. O único array de aceleração em
+// memória é o das forças entre pares (repulsão), e só quando elas estão ligadas.
+//
+// O mesmo kernel serve para os dois casos: com StaticStepFlags as flags são
+// constantes de compilação e o compilador remove os ramos mortos de cada
+// variante; com DynamicStepFlags as flags são lidas em tempo de execução
+// (caminho genérico, mantido para comparação nos benchmarks).
+//
+// O integrador também é uma flag. Os três são explícitos e de passo único, e
+// para uma força tipo mola de frequência w só são estáveis com w * dt < 2; na
+// prática quem limita o passo são as colisões, que perdem contatos quando uma
+// partícula anda mais que uma fração do raio por passo (ver courantLimit).
+// O amortecimento é uma taxa por segundo (DAMPING por passo de 1/60 s), então
+// o resultado não muda de caráter quando o passo muda.
+//
+// Com a flag obstacles, depois de integrar cada partícula faz uma amostra do
+// campo de distância dos obstáculos: se a distância é menor que o raio ela é
+// empurrada para fora pela normal e a componente normal da velocidade é
+// refletida, como nas bordas (que continuam valendo por cima).
+namespace StepKernels {
+    enum class IntegratorType : std::uint8_t {
+        // x' = x + (x - x_ant) * (dt / dt_ant) + a * dt²; velocidade sai das posições.
+        // Segunda ordem nas posições; o padrão e o comportamento original.
+        PositionVerlet,
+        // v' = v + a * dt; x' = x + v' * dt. Primeira ordem, o mais barato, energia limitada.
+        SymplecticEuler,
+        // x' = x + v * dt + a * dt² / 2; a velocidade é completada no passo seguinte com
+        // a média das acelerações. Segunda ordem também na velocidade; guarda a aceleração.
+        VelocityVerlet,
+    };
+
+    constexpr size_t INTEGRATOR_COUNT = 3;
+
+    const char* integratorName(IntegratorType integrator);
+
+    // Fração do raio que uma partícula pode andar por passo com este integrador
+    // sem que as colisões comecem a falhar; base dos subpassos adaptativos
+    float courantLimit(IntegratorType integrator);
+
+    struct ExternalForceParams {
+        float gravity;
+        const ForceFieldSet* fields;
+        double time;
+    };
+
+    struct IntegrationParams {
+        float dt;
+        float previousDt;  // passo anterior; reescala o deslocamento do Verlet de posição
+        // paredes do mundo; infinitas no mundo aberto, e aí o clamp nunca pega
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        float restitution;
+        DistanceGrid obstacles;  // só lido com a flag obstacles
+    };
+
+    struct StepArrays {
+        float* positions;
+        float* previousPositions;
+        float* velocities;
+        const float* masses;
+        const float* radii;
+        // acelerações das forças entre pares; só é lido com a flag pairwise
+        const float* pairwiseAccelerations;
+        // aceleração do passo anterior; só a velocity Verlet lê e escreve
+        float* storedAccelerations;
+        size_t count;
+    };
+
+    template <bool Gravity, bool Fields, bool Pairwise, bool Obstacles, IntegratorType Integrator>
+    struct StaticStepFlags {
+        static constexpr bool gravity = Gravity;
+        static constexpr bool fields = Fields;
+        static constexpr bool pairwise = Pairwise;
+        static constexpr bool obstacles = Obstacles;
+        static constexpr IntegratorType integrator = Integrator;
+    };
+
+    struct DynamicStepFlags {
+        bool gravity;
+        bool fields;
+        bool pairwise;
+        bool obstacles;
+        IntegratorType integrator;
+    };
+
+    constexpr float MIN_VALID_MASS = 0.0001f;
+    // passo em que o amortecimento por passo vale DAMPING
+    constexpr float DAMPING_REFERENCE_DT = 1.0f / 60.0f;
+
+    template <typename Flags>
+    inline void integrateRange(const Flags& flags, const ExternalForceParams forces, const IntegrationParams integration,
+                               float* __restrict positions, float* __restrict previous, float* __restrict velocities,
+                               const float* __restrict masses, const float* __restrict radii,
+                               const float* __restrict pairwise, float* __restrict stored, size_t count) {
+        const float BASE_AIR_RESISTANCE = 0.002f;
+        const float DAMPING = 0.998f;
+        const float dt = integration.dt;
+        const float invDt = 1.0f / dt;
+        const float previousDt = integration.previousDt;
+        const float stepRatio = dt / previousDt;
+        const float damping = std::pow(DAMPING, dt / DAMPING_REFERENCE_DT);
+        const float restitution = integration.restitution;
+        const float gravity = forces.gravity;
+
+        constexpr size_t BLOCK = ForceFieldSet::BLOCK_SIZE;
+        alignas(64) float tileX[BLOCK];
+        alignas(64) float tileY[BLOCK];
+
+        for (size_t begin = 0; begin < count; begin += BLOCK) {
+            const size_t blockCount = std::min(BLOCK, count - begin);
+
+            for (size_t j = 0; j < blockCount; ++j) {
+                tileX[j] = flags.pairwise ? pairwise[(begin + j) * 2] : 0.0f;
+                tileY[j] = flags.pairwise ? pairwise[(begin + j) * 2 + 1] : 0.0f;
+            }
+            if (flags.fields) {
+                forces.fields->accumulate(positions + begin * 2, masses + begin, blockCount, forces.time, tileX, tileY);
+            }
+
+            for (size_t j = 0; j < blockCount; ++j) {
+                const size_t i = begin + j;
+                const float x = positions[i * 2];
+                const float y = positions[i * 2 + 1];
+                const float px = previous[i * 2];
+                const float py = previous[i * 2 + 1];
+                const float ux = velocities[i * 2];
+                const float uy = velocities[i * 2 + 1];
+                const float mass = masses[i];
+
+                float ax = tileX[j];
+                float ay = tileY[j];
+                if (flags.gravity) {
+                    ay += (mass > MIN_VALID_MASS) ? gravity : 0.0f;
+                }
+
+                // resistência do ar baseada na velocidade atual
+                // aritmética fora dos ternários: só seleções, para o laço vetorizar
+                const float drag = BASE_AIR_RESISTANCE / std::max(mass, MIN_VALID_MASS);
+                const float dragCoefficient = (mass > MIN_VALID_MASS) ? drag : 0.0f;
+                ax -= ux * dragCoefficient;
+                ay -= uy * dragCoefficient;
+
+                float newX, newY, vx, vy;
+                if (flags.integrator == IntegratorType::SymplecticEuler) {
+                    vx = (ux + ax * dt) * damping;
+                    vy = (uy + ay * dt) * damping;
+                    newX = x + vx * dt;
+                    newY = y + vy * dt;
+                } else if (flags.integrator == IntegratorType::VelocityVerlet) {
+                    // a velocidade guardada foi prevista com a aceleração velha; a correção
+                    // fecha a média (a_ant + a) / 2 sobre o passo anterior
+                    const float wx = ux + 0.5f * (ax - stored[i * 2]) * previousDt;
+                    const float wy = uy + 0.5f * (ay - stored[i * 2 + 1]) * previousDt;
+                    newX = x + (wx + 0.5f * ax * dt) * dt;
+                    newY = y + (wy + 0.5f * ay * dt) * dt;
+                    vx = (wx + ax * dt) * damping;
+                    vy = (wy + ay * dt) * damping;
+                    stored[i * 2] = ax;
+                    stored[i * 2 + 1] = ay;
+                } else {
+                    // Verlet de posição; o deslocamento anterior é reescalado se o passo mudou
+                    newX = x + (x - px) * stepRatio + ax * dt * dt;
+                    newY = y + (y - py) * stepRatio + ay * dt * dt;
+                    vx = (newX - x) * invDt * damping;
+                    vy = (newY - y) * invDt * damping;
+                }
+
+                const float radius = radii[i];
+                if (flags.obstacles) {
+                    float distance, gradX, gradY;
+                    integration.obstacles.sample(newX, newY, distance, gradX, gradY);
+                    const float invLength = 1.0f / std::max(std::sqrt(gradX * gradX + gradY * gradY), 1e-6f);
+                    const float normalX = gradX * invLength;
+                    const float normalY = gradY * invLength;
+                    const float penetration = std::max(radius - distance, 0.0f);
+                    newX += normalX * penetration;
+                    newY += normalY * penetration;
+                    // só a velocidade que entra no obstáculo é refletida
+                    const float normalSpeed = vx * normalX + vy * normalY;
+                    const float approach = (penetration > 0.0f) ? std::min(normalSpeed, 0.0f) : 0.0f;
+                    vx -= (1.0f + restitution) * approach * normalX;
+                    vy -= (1.0f + restitution) * approach * normalY;
+                }
+
+                // bordas
+                const float maxX = integration.maxX - radius;
+                const float maxY = integration.maxY - radius;
+                const float clampedX = std::max(std::min(newX, maxX), integration.minX + radius);
+                const float clampedY = std::max(std::min(newY, maxY), integration.minY + radius);
+                const float bouncedX = -vx * restitution;
+                const float bouncedY = -vy * restitution;
+                vx = (clampedX != newX) ? bouncedX : vx;
+                vy = (clampedY != newY) ? bouncedY : vy;
+                newX = clampedX;
+                newY = clampedY;
+
+                positions[i * 2] = newX;
+                positions[i * 2 + 1] = newY;
+                velocities[i * 2] = vx;
+                velocities[i * 2 + 1] = vy;
+                // posição anterior coerente com a velocidade já amortecida/refletida
+                previous[i * 2] = newX - vx * dt;
+                previous[i * 2 + 1] = newY - vy * dt;
+            }
+        }
+    }
+
+    // Parâmetros por valor e ponteiros __restrict: nada escrito no laço pode ser lido de volta,
+    // o que o vetorizador precisa saber para não cair no caminho escalar
+    template <typename Flags>
+    inline void integrateParticles(const Flags& flags, const ExternalForceParams& forces,
+                                   const IntegrationParams& integration, const StepArrays& arrays) {
+        integrateRange(flags, forces, integration, arrays.positions, arrays.previousPositions, arrays.velocities,
+                       arrays.masses, arrays.radii, arrays.pairwiseAccelerations, arrays.storedAccelerations,
+                       arrays.count);
+    }
+
+    using StepKernel = void (*)(const ExternalForceParams& forces, const IntegrationParams& integration,
+                                const StepArrays& arrays);
+
+    // Variante especializada para a combinação de flags e integrador; escolhida uma vez por passo
+    StepKernel selectStepKernel(const DynamicStepFlags& flags);
+
+    // Caminho genérico, com as flags testadas dentro do laço
+    void integrateParticlesGeneric(const DynamicStepFlags& flags, const ExternalForceParams& forces,
+                                   const IntegrationParams& integration, const StepArrays& arrays);
+}
@@ -0,0 +1,107 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    // Acima disto o insertion sort desiste e a ordem é refeita com std::sort
+    constexpr size_t MAX_SHIFTS_PER_PARTICLE = 8;
+
+    // Marca em hits quais candidatos [0, n) estão a menos de r + radius[j] + margin
+    // de (x, y). Sem desvio no laço, então o compilador vetoriza.
+    void overlapTest(float x, float y, float reachBase, const float* __restrict xs, const float* __restrict ys,
+                     const float* __restrict radii, std::uint8_t* __restrict hits, size_t n) {
+        for (size_t j = 0; j < n; ++j) {
+            const float dx = xs[j] - x;
+            const float dy = ys[j] - y;
+            const float reach = reachBase + radii[j];
+            hits[j] = static_cast<std::uint8_t>(dx * dx + dy * dy < reach * reach);
+        }
+    }
+}
+
+void SweepAndPrune::sortOrder(size_t count) {
+    ++m_sweepStats.sorts;
+    m_sweepStats.shifts = 0;
+    const float* keys = m_keys.data();
+    auto byKey = [keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; };
+
+    // a ordem guardada só vale se ainda for uma permutação de [0, count)
+    if (m_order.size() != count) {
+        m_order.resize(count);
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        std::sort(m_order.begin(), m_order.end(), byKey);
+        ++m_sweepStats.fullSorts;
+        return;
+    }
+
+    const size_t budget = MAX_SHIFTS_PER_PARTICLE * count;
+    std::uint32_t* order = m_order.data();
+    for (size_t k = 1; k < count; ++k) {
+        const std::uint32_t value = order[k];
+        const float key = keys[value];
+        size_t j = k;
+        while (j > 0 && keys[order[j - 1]] > key) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = value;
+        m_sweepStats.shifts += k - j;
+        if (m_sweepStats.shifts > budget) {
+            // muita coisa mudou de lugar (índices remapeados, teleporte); sai mais barato ordenar do zero
+            std::sort(m_order.begin(), m_order.end(), byKey);
+            ++m_sweepStats.fullSorts;
+            return;
+        }
+    }
+}
+
+void SweepAndPrune::findPairs(const float* positions, const float* radii, size_t count, float margin,
+                              std::vector<ParticlePair>& pairs) {
+    pairs.clear();
+    m_stats.candidates = 0;
+    m_stats.pairs = 0;
+    if (count < 2) return;
+
+    m_keys.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_keys[i] = positions[i * 2] - radii[i];
+    }
+    sortOrder(count);
+
+    m_minX.resize(count);
+    m_x.resize(count);
+    m_y.resize(count);
+    m_radius.resize(count);
+    m_hits.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        const std::uint32_t i = m_order[k];
+        m_minX[k] = m_keys[i];
+        m_x[k] = positions[i * 2];
+        m_y[k] = positions[i * 2 + 1];
+        m_radius[k] = radii[i];
+    }
+
+    size_t candidates = 0;
+    for (size_t k = 0; k + 1 < count; ++k) {
+        // quem começa depois de x + r + margin já está longe demais no eixo x
+        const float limit = m_x[k] + m_radius[k] + margin;
+        size_t end = k + 1;
+        while (end < count && m_minX[end] < limit) ++end;
+
+        const size_t n = end - (k + 1);
+        if (n == 0) continue;
+        candidates += n;
+        overlapTest(m_x[k], m_y[k], m_radius[k] + margin, &m_x[k + 1], &m_y[k + 1], &m_radius[k + 1],
+                    m_hits.data(), n);
+        const std::uint32_t a = m_order[k];
+        for (size_t j = 0; j < n; ++j) {
+            if (m_hits[j]) {
+                const std::uint32_t b = m_order[k + 1 + j];
+                pairs.push_back({std::min(a, b), std::max(a, b)});
+            }
+        }
+    }
+
+    m_stats.candidates = candidates;
+    m_stats.pairs = pairs.size();
+}
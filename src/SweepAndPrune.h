@@ -0,0 +1,40 @@
+#pragma once
+#include "Broadphase.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sort-and-sweep no eixo x. A ordem das partículas pelo início do intervalo
+// (x - raio) é guardada entre chamadas; como quase nada troca de lugar de um
+// passo para o outro, um insertion sort sobre a ordem anterior custa perto de
+// O(n). Não depende de tamanho de célula, então raios muito diferentes ou uma
+// faixa espremida no chão não a degradam como à grade.
+class SweepAndPrune : public Broadphase {
+public:
+    struct SweepStats {
+        std::uint64_t sorts = 0;
+        std::uint64_t fullSorts = 0;  // a ordem anterior não servia (contagem mudou ou trocas demais)
+        size_t shifts = 0;            // trocas do insertion sort na última chamada
+    };
+
+    void findPairs(const float* positions, const float* radii, size_t count, float margin,
+                   std::vector<ParticlePair>& pairs) override;
+    const char* getName() const override { return "sap"; }
+
+    const SweepStats& getSweepStats() const { return m_sweepStats; }
+
+private:
+    void sortOrder(size_t count);
+
+    std::vector<std::uint32_t> m_order;  // índices do SoA por x - raio crescente
+    std::vector<float> m_keys;           // x - raio, por índice do SoA
+
+    // cópias na ordem do eixo, contíguas para o teste de sobreposição vetorizar
+    std::vector<float> m_minX;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_radius;
+    std::vector<std::uint8_t> m_hits;
+
+    SweepStats m_sweepStats;
+};
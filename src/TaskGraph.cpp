@@ -0,0 +1,232 @@
+#include "TaskGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+void TaskGraph::Deque::reset(size_t capacity) {
+    if (capacity > m_capacity) {
+        m_items.reset(new std::atomic<std::uint32_t>[capacity]);
+        m_capacity = capacity;
+    }
+    m_top.store(0, std::memory_order_relaxed);
+    m_bottom.store(0, std::memory_order_relaxed);
+}
+
+void TaskGraph::Deque::push(std::uint32_t node) {
+    // cada nó entra uma vez só no grafo inteiro: o índice nunca passa da capacidade
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    m_items[bottom].store(node, std::memory_order_relaxed);
+    // publica o item para quem rouba (steal lê m_bottom com acquire)
+    m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+std::uint32_t TaskGraph::Deque::take() {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = m_top.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return NO_NODE;
+    }
+    std::uint32_t node = m_items[bottom].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // último elemento: quem ganhar o topo fica com ele
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            node = NO_NODE;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+std::uint32_t TaskGraph::Deque::steal() {
+    std::int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) return NO_NODE;
+    const std::uint32_t node = m_items[top].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return NO_NODE;
+    }
+    return node;
+}
+
+TaskGraph::TaskGraph() = default;
+TaskGraph::~TaskGraph() = default;
+
+void TaskGraph::clear() {
+    m_tasks.clear();
+}
+
+TaskGraph::TaskId TaskGraph::add(size_t count, size_t grain, Body body) {
+    Task task;
+    task.count = count;
+    task.grain = std::max<size_t>(grain, 1);
+    task.body = std::move(body);
+    m_tasks.push_back(std::move(task));
+    return static_cast<TaskId>(m_tasks.size() - 1);
+}
+
+void TaskGraph::precede(TaskId from, TaskId to) {
+    m_tasks[from].after.push_back(to);
+}
+
+void TaskGraph::precedeChunks(TaskId from, TaskId to) {
+    m_tasks[from].afterChunks.push_back(to);
+}
+
+template <typename Visit>
+void TaskGraph::forEachEdge(const Visit& visit) const {
+    // tarefa sem blocos entra e sai pela junção
+    auto entries = [this, &visit](std::uint32_t from, const Task& to) {
+        if (to.nodeCount == 0) {
+            visit(from, to.join);
+            return;
+        }
+        for (std::uint32_t i = 0; i < to.nodeCount; ++i) visit(from, to.firstNode + i);
+    };
+    for (const Task& task : m_tasks) {
+        if (task.join != NO_NODE) {
+            for (std::uint32_t i = 0; i < task.nodeCount; ++i) visit(task.firstNode + i, task.join);
+            for (const TaskId next : task.after) entries(task.join, m_tasks[next]);
+        }
+        for (const TaskId next : task.afterChunks) {
+            const Task& to = m_tasks[next];
+            const std::uint32_t shared = std::min(task.nodeCount, to.nodeCount);
+            for (std::uint32_t i = 0; i < shared; ++i) visit(task.firstNode + i, to.firstNode + i);
+        }
+    }
+}
+
+void TaskGraph::build() {
+    m_nodes.clear();
+    for (size_t t = 0; t < m_tasks.size(); ++t) {
+        Task& task = m_tasks[t];
+        task.firstNode = static_cast<std::uint32_t>(m_nodes.size());
+        task.nodeCount = static_cast<std::uint32_t>((task.count + task.grain - 1) / task.grain);
+        for (size_t begin = 0; begin < task.count; begin += task.grain) {
+            Node node;
+            node.task = static_cast<TaskId>(t);
+            node.begin = begin;
+            node.end = std::min(begin + task.grain, task.count);
+            m_nodes.push_back(node);
+        }
+    }
+    for (size_t t = 0; t < m_tasks.size(); ++t) {
+        Task& task = m_tasks[t];
+        task.join = NO_NODE;
+        if (!task.after.empty() || task.nodeCount == 0) {
+            task.join = static_cast<std::uint32_t>(m_nodes.size());
+            Node node;
+            node.task = static_cast<TaskId>(t);
+            m_nodes.push_back(node);
+        }
+    }
+
+    // duas passadas pelas arestas: contar, depois preencher as listas no lugar
+    forEachEdge([this](std::uint32_t from, std::uint32_t to) {
+        ++m_nodes[from].successorCount;
+        ++m_nodes[to].dependencies;
+    });
+    std::uint32_t offset = 0;
+    for (Node& node : m_nodes) {
+        node.firstSuccessor = offset;
+        offset += node.successorCount;
+        node.successorCount = 0;
+    }
+    m_successors.resize(offset);
+    forEachEdge([this](std::uint32_t from, std::uint32_t to) {
+        Node& node = m_nodes[from];
+        m_successors[node.firstSuccessor + node.successorCount++] = to;
+    });
+}
+
+void TaskGraph::run(ThreadPool& pool) {
+    build();
+    const size_t nodeCount = m_nodes.size();
+    const size_t threads = m_params.parallel ? pool.getThreadCount() : 1;
+    m_stats.nodes = nodeCount;
+    m_stats.threads = threads;
+    m_stats.steals = 0;
+
+    if (m_tasks.size() > m_taskNanosCapacity) {
+        m_taskNanos.reset(new std::atomic<std::uint64_t>[m_tasks.size()]);
+        m_taskNanosCapacity = m_tasks.size();
+    }
+    for (size_t t = 0; t < m_tasks.size(); ++t) m_taskNanos[t].store(0, std::memory_order_relaxed);
+    if (nodeCount == 0) return;
+
+    if (nodeCount > m_pendingCapacity) {
+        m_pending.reset(new std::atomic<std::uint32_t>[nodeCount]);
+        m_pendingCapacity = nodeCount;
+    }
+    while (m_deques.size() < threads) m_deques.push_back(std::make_unique<Deque>());
+    for (size_t i = 0; i < threads; ++i) m_deques[i]->reset(nodeCount);
+
+    // os nós sem dependência são repartidos entre as deques antes de as threads
+    // acordarem; o resto entra na deque de quem liberou o nó
+    size_t seeded = 0;
+    for (size_t n = 0; n < nodeCount; ++n) {
+        m_pending[n].store(m_nodes[n].dependencies, std::memory_order_relaxed);
+        if (m_nodes[n].dependencies == 0) {
+            m_deques[seeded++ % threads]->push(static_cast<std::uint32_t>(n));
+        }
+    }
+    m_remaining.store(nodeCount, std::memory_order_relaxed);
+    m_steals.store(0, std::memory_order_relaxed);
+
+    if (threads == 1) {
+        worker(0);
+    } else {
+        // um índice por thread; com o pool ocupado, tudo roda aqui e worker(0) rouba o resto
+        pool.parallelFor(threads, 1, [this](size_t begin, size_t end) {
+            for (size_t self = begin; self < end; ++self) worker(self);
+        });
+    }
+    m_stats.steals = m_steals.load(std::memory_order_relaxed);
+}
+
+void TaskGraph::worker(size_t self) {
+    Deque& own = *m_deques[self];
+    const size_t threads = m_stats.threads;
+    while (m_remaining.load(std::memory_order_acquire) > 0) {
+        std::uint32_t node = own.take();
+        for (size_t k = 1; node == NO_NODE && k < threads; ++k) {
+            node = m_deques[(self + k) % threads]->steal();
+            if (node != NO_NODE) m_steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (node == NO_NODE) {
+            // o que falta está rodando em outra thread ou esperando por ela
+            std::this_thread::yield();
+            continue;
+        }
+        execute(node, self);
+    }
+}
+
+void TaskGraph::execute(std::uint32_t index, size_t self) {
+    const Node& node = m_nodes[index];
+    const Task& task = m_tasks[node.task];
+    // a junção de uma tarefa com blocos não tem trabalho; a de uma tarefa vazia roda o corpo
+    if ((node.end > node.begin || task.count == 0) && task.body) {
+        const auto start = std::chrono::steady_clock::now();
+        task.body(node.begin, node.end);
+        const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        m_taskNanos[node.task].fetch_add(static_cast<std::uint64_t>(nanos), std::memory_order_relaxed);
+    }
+
+    Deque& own = *m_deques[self];
+    for (std::uint32_t s = 0; s < node.successorCount; ++s) {
+        const std::uint32_t next = m_successors[node.firstSuccessor + s];
+        if (m_pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            own.push(next);
+        }
+    }
+    m_remaining.fetch_sub(1, std::memory_order_release);
+}
+
+double TaskGraph::getSeconds(TaskId task) const {
+    return task < m_taskNanosCapacity ? m_taskNanos[task].load(std::memory_order_relaxed) * 1e-9 : 0.0;
+}
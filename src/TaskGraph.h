@@ -0,0 +1,122 @@
+#pragma once
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Grafo de tarefas com roubo de trabalho, para fases do passo que dependem umas
+// das outras só em parte. Cada tarefa cobre [0, count) em blocos de grain
+// índices, e cada bloco é um nó do grafo: com precede() a tarefa seguinte só
+// começa quando a anterior termina inteira; com precedeChunks() o bloco i da
+// seguinte espera só o bloco i da anterior. Assim uma fase começa a andar
+// enquanto a de antes ainda não acabou, e duas fases independentes se misturam
+// nas mesmas threads, sem a barreira de um parallelFor no fim de cada uma.
+//
+// Cada thread tem uma deque de Chase-Lev: empilha e tira do fundo os nós que
+// ela mesma liberou (o bloco i da fase seguinte roda logo depois do bloco i da
+// anterior, com os dados ainda no cache) e, sem nada, rouba do topo da deque de
+// outra. Cada nó entra numa deque uma vez só, então o vetor de cada uma tem o
+// tamanho do grafo e nunca cresce. As threads são as do ThreadPool: o grafo
+// ocupa o pool inteiro durante run(), e um parallelFor dentro de uma tarefa
+// roda inteiro na thread dela.
+class TaskGraph {
+public:
+    using TaskId = std::uint32_t;
+    using Body = std::function<void(size_t begin, size_t end)>;
+
+    struct Params {
+        bool parallel = true;
+    };
+
+    struct Stats {
+        size_t nodes = 0;    // blocos + junções da última execução
+        size_t steals = 0;   // nós tirados da deque de outra thread
+        size_t threads = 1;
+    };
+
+    TaskGraph();
+    ~TaskGraph();
+
+    // Esvazia o grafo; a memória fica para a próxima montagem
+    void clear();
+    // count 0 vira um nó só, em que o corpo roda uma vez com (0, 0): serve para
+    // juntar os blocos de outra tarefa ou para um trabalho que não se divide.
+    // Um corpo que indexa estado por bloco (begin / grain) não pode receber
+    // count 0; quem monta o grafo deixa de adicionar a tarefa nesse caso.
+    TaskId add(size_t count, size_t grain, Body body);
+    // to começa quando from terminou inteira
+    void precede(TaskId from, TaskId to);
+    // Bloco a bloco; as duas precisam de count e grain iguais
+    void precedeChunks(TaskId from, TaskId to);
+
+    // Executa tudo e volta quando o último nó termina
+    void run(ThreadPool& pool);
+    // Tempo somado dos blocos da tarefa na última execução (de todas as threads)
+    double getSeconds(TaskId task) const;
+
+    void setParams(const Params& params) { m_params = params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    static constexpr std::uint32_t NO_NODE = ~std::uint32_t(0);
+
+    struct Task {
+        size_t count = 0;
+        size_t grain = 1;
+        Body body;
+        std::uint32_t firstNode = 0;
+        std::uint32_t nodeCount = 0;
+        std::uint32_t join = NO_NODE;  // nó vazio que espera todos os blocos
+        std::vector<TaskId> after;       // precede(this, x)
+        std::vector<TaskId> afterChunks; // precedeChunks(this, x)
+    };
+
+    struct Node {
+        TaskId task = 0;
+        size_t begin = 0;
+        size_t end = 0;
+        std::uint32_t firstSuccessor = 0;
+        std::uint32_t successorCount = 0;
+        std::uint32_t dependencies = 0;
+    };
+
+    // Deque de Chase-Lev de tamanho fixo. O dono usa push/take no fundo, os
+    // outros steal no topo; só o último elemento é disputado, com um CAS no topo.
+    class Deque {
+    public:
+        void reset(size_t capacity);
+        void push(std::uint32_t node);
+        std::uint32_t take();
+        // NO_NODE se vazia ou se outra thread levou o elemento antes
+        std::uint32_t steal();
+
+    private:
+        alignas(64) std::atomic<std::int64_t> m_top{0};
+        alignas(64) std::atomic<std::int64_t> m_bottom{0};
+        std::unique_ptr<std::atomic<std::uint32_t>[]> m_items;
+        size_t m_capacity = 0;
+    };
+
+    // Cria os nós e as listas de sucessores (CSR) a partir das tarefas
+    void build();
+    template <typename Visit> void forEachEdge(const Visit& visit) const;
+    void worker(size_t self);
+    void execute(std::uint32_t node, size_t self);
+
+    Params m_params;
+    std::vector<Task> m_tasks;
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_successors;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> m_pending;
+    size_t m_pendingCapacity = 0;
+    std::vector<std::unique_ptr<Deque>> m_deques;
+    // segundos por tarefa em nanossegundos inteiros, somados de várias threads
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_taskNanos;
+    size_t m_taskNanosCapacity = 0;
+    std::atomic<size_t> m_remaining{0};
+    std::atomic<size_t> m_steals{0};
+    Stats m_stats;
+};
@@ -1,102 +1,246 @@
 #include "TextureManager.h"
+#include "AssetPack.h"
+#include <condition_variable>
+#include <deque>
 #include <iostream>
-#include <filesystem>
+#include <thread>
 
-std::map<std::string, std::shared_ptr<sf::Texture>> TextureManager::m_textures;
+std::map<std::string, TextureHandle, std::less<>> TextureManager::m_handles;
+std::vector<TextureManager::Slot> TextureManager::m_slots;
+std::mutex TextureManager::m_mutex;
 
-std::shared_ptr<sf::Texture> TextureManager::getTexture(std::string_view filename) {
-    const std::string filenameStr(filename);
-    
-    // cache pra evitar alocações desnecessárias
-    auto it = m_textures.find(filenameStr);
-    if (it != m_textures.end()) {
-        return it->second;
+namespace {
+    bool loadImage(const std::string& filename, sf::Image& image) {
+        if (AssetPack::contains(filename)) {
+            return AssetPack::loadImage(filename, image);
+        }
+        return image.loadFromFile(filename) ||
+               image.loadFromFile("assets/" + filename) ||
+               image.loadFromFile("sprites/" + filename);
     }
-    
-    static bool fallbackCreated = false;
-    if (filenameStr == "fallback" && fallbackCreated) {
-        return m_textures["fallback"];
+
+    void configureTexture(sf::Texture& texture) {
+        texture.setSmooth(true);
+        texture.generateMipmap();
     }
-    
-    auto texPtr = std::make_shared<sf::Texture>();
-    bool loaded = false;
-    
-    if (texPtr->loadFromFile(filenameStr)) {
-        loaded = true;
-    } 
-
-    else if (texPtr->loadFromFile("assets/" + filenameStr)) {
-        loaded = true;
+
+    // Lê e decodifica imagens fora do thread principal; o upload para a GPU
+    // fica para processPendingUploads, que roda no thread do OpenGL.
+    class TextureLoader {
+    public:
+        struct Result {
+            TextureHandle handle;
+            std::string name;
+            sf::Image image;
+            bool loaded;
+        };
+
+        ~TextureLoader() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_cv.notify_all();
+            if (m_thread.joinable()) {
+                m_thread.join();
+            }
+        }
+
+        void enqueue(TextureHandle handle, std::string name) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_requests.push_back({handle, std::move(name)});
+                if (!m_thread.joinable()) {
+                    m_thread = std::thread(&TextureLoader::run, this);
+                }
+            }
+            m_cv.notify_one();
+        }
+
+        bool popResult(Result& out) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_results.empty()) return false;
+            out = std::move(m_results.front());
+            m_results.pop_front();
+            return true;
+        }
+
+    private:
+        struct Request {
+            TextureHandle handle;
+            std::string name;
+        };
+
+        void run() {
+            while (true) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+                    if (m_stopping) return;
+                    request = std::move(m_requests.front());
+                    m_requests.pop_front();
+                }
+
+                Result result{request.handle, std::move(request.name), sf::Image(), false};
+                result.loaded = loadImage(result.name, result.image);
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_results.push_back(std::move(result));
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<Request> m_requests;
+        std::deque<Result> m_results;
+        std::thread m_thread;
+        bool m_stopping = false;
+    };
+
+    TextureLoader& loader() {
+        static TextureLoader instance;
+        return instance;
     }
-    else if (texPtr->loadFromFile("sprites/" + filenameStr)) {
-        loaded = true;
+}
+
+TextureHandle TextureManager::createSlot(std::string_view filename) {
+    m_slots.push_back({std::string(filename), std::make_unique<sf::Texture>(), SlotState::Loading});
+    const TextureHandle handle = static_cast<TextureHandle>(m_slots.size());
+    m_handles.emplace(m_slots.back().name, handle);
+    return handle;
+}
+
+TextureHandle TextureManager::requestTexture(std::string_view filename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // cache: nenhuma alocação quando o nome já é conhecido
+    auto it = m_handles.find(filename);
+    if (it != m_handles.end()) {
+        return it->second;
     }
-    
-    if (loaded) {
-        texPtr->setSmooth(true);
-        texPtr->generateMipmap(); 
-        
-        m_textures[filenameStr] = texPtr;
-        return texPtr;
+
+    const TextureHandle handle = createSlot(filename);
+    loader().enqueue(handle, m_slots[handle - 1].name);
+    return handle;
+}
+
+const sf::Texture* TextureManager::getTexture(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (handle == INVALID_HANDLE || handle > m_slots.size()) {
+        return nullptr;
     }
-    
-    // textura reserva
-    if (!fallbackCreated) {
-        std::cerr << "[ERRO] Não foi possível carregar textura: " << filenameStr << " - usando fallback" << std::endl;
-        
-        auto fallbackTex = std::make_shared<sf::Texture>();
-        fallbackTex->create(32, 32);
-        
-        sf::Image img;
-        img.create(32, 32, sf::Color::Magenta);
-        fallbackTex->update(img);
-        
-        m_textures["fallback"] = fallbackTex;
-        fallbackCreated = true;
-    } else {
-        std::cerr << "[ERRO] Não foi possível carregar textura: " << filenameStr << " - usando fallback" << std::endl;
+    const Slot& slot = m_slots[handle - 1];
+    switch (slot.state) {
+        case SlotState::Ready:  return slot.texture.get();
+        case SlotState::Failed: return &fallbackTexture();
+        default:                return &placeholderTexture();
+    }
+}
+
+bool TextureManager::isReady(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return isReadyLocked(handle);
+}
+
+bool TextureManager::isReadyLocked(TextureHandle handle) {
+    return handle != INVALID_HANDLE && handle <= m_slots.size() &&
+           m_slots[handle - 1].state == SlotState::Ready;
+}
+
+void TextureManager::processPendingUploads() {
+    TextureLoader::Result result;
+    while (loader().popResult(result)) {
+        // o upload e os mipmaps ficam fora da trava: quem resolve handles não espera a GPU
+        auto texture = std::make_unique<sf::Texture>();
+        const bool uploaded = result.loaded && texture->loadFromImage(result.image);
+        if (uploaded) configureTexture(*texture);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // clearAll pode ter reaproveitado o handle para outro nome
+        if (result.handle > m_slots.size()) continue;
+        Slot& slot = m_slots[result.handle - 1];
+        if (slot.name != result.name || slot.state != SlotState::Loading) continue;
+
+        if (uploaded) {
+            slot.texture = std::move(texture);
+            slot.state = SlotState::Ready;
+        } else {
+            std::cerr << "[ERRO] Não foi possível carregar textura: " << slot.name << " - usando fallback" << std::endl;
+            slot.state = SlotState::Failed;
+        }
     }
-    
-    return m_textures["fallback"];
 }
 
 bool TextureManager::preloadTexture(std::string_view filename) {
-    const std::string filenameStr(filename);
-    if (isTextureLoaded(filename)) {
-        return true;
+    TextureHandle handle;
+    std::string name;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_handles.find(filename);
+        if (it != m_handles.end() && isReadyLocked(it->second)) {
+            return true;
+        }
+        handle = (it != m_handles.end()) ? it->second : createSlot(filename);
+        name = m_slots[handle - 1].name;
     }
-    
-    sf::Texture tex;
-    bool loaded = false;
-    
-    if (tex.loadFromFile(filenameStr)) {
-        loaded = true;
-    } 
-    else if (tex.loadFromFile("assets/" + filenameStr)) {
-        loaded = true;
+
+    // disco e upload sem a trava, como em processPendingUploads
+    sf::Image image;
+    auto texture = std::make_unique<sf::Texture>();
+    const bool uploaded = loadImage(name, image) && texture->loadFromImage(image);
+    if (uploaded) configureTexture(*texture);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (handle > m_slots.size() || m_slots[handle - 1].name != name) {
+        return false;
     }
-    else if (tex.loadFromFile("sprites/" + filenameStr)) {
-        loaded = true;
+    Slot& slot = m_slots[handle - 1];
+    if (slot.state == SlotState::Ready) {
+        // o carregamento assíncrono chegou antes
+        return true;
     }
-    
-    if (loaded) {
-        tex.setSmooth(true);
-        tex.generateMipmap();
-        
-        auto texPtr = std::make_shared<sf::Texture>(std::move(tex));
-        
-        m_textures[filenameStr] = texPtr;
+    if (uploaded) {
+        slot.texture = std::move(texture);
+        slot.state = SlotState::Ready;
         return true;
     }
-    
+    slot.state = SlotState::Failed;
     return false;
 }
 
 bool TextureManager::isTextureLoaded(std::string_view filename) {
-    const std::string filenameStr(filename);
-    return m_textures.find(filenameStr) != m_textures.end();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_handles.find(filename);
+    return it != m_handles.end() && isReadyLocked(it->second);
 }
 
 void TextureManager::clearAll() {
-    m_textures.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handles.clear();
+    m_slots.clear();
+}
+
+const sf::Texture& TextureManager::placeholderTexture() {
+    static sf::Texture placeholder;
+    static bool created = false;
+    if (!created) {
+        sf::Image img;
+        img.create(32, 32, sf::Color::White);
+        placeholder.loadFromImage(img);
+        created = true;
+    }
+    return placeholder;
+}
+
+const sf::Texture& TextureManager::fallbackTexture() {
+    // textura reserva
+    static sf::Texture fallback;
+    static bool created = false;
+    if (!created) {
+        sf::Image img;
+        img.create(32, 32, sf::Color::Magenta);
+        fallback.loadFromImage(img);
+        created = true;
+    }
+    return fallback;
 }
@@ -1,26 +1,69 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <functional>
 #include <map>
-#include <string>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
-#include <iostream>
+#include <vector>
 
+using TextureHandle = std::uint32_t;
+
+// Texturas são pedidas por nome e devolvidas como handles. O disco é lido e a
+// imagem decodificada num thread de carregamento; até o upload terminar, o
+// handle resolve para uma textura provisória. Nenhuma chamada daqui bloqueia
+// no disco, exceto preloadTexture. Handles podem ser pedidos de qualquer
+// thread (partículas nascem no thread de física); o upload fica no do OpenGL.
 class TextureManager {
 private:
-    static std::map<std::string, std::shared_ptr<sf::Texture>> m_textures;
-    
+    enum class SlotState : std::uint8_t {
+        Loading,
+        Ready,
+        Failed,
+    };
+
+    struct Slot {
+        std::string name;
+        std::unique_ptr<sf::Texture> texture;
+        SlotState state;
+    };
+
+    // busca heterogênea: find(string_view) não aloca
+    static std::map<std::string, TextureHandle, std::less<>> m_handles;
+    static std::vector<Slot> m_slots;
+    static std::mutex m_mutex;  // protege m_handles e m_slots
+
     TextureManager() = delete;
     ~TextureManager() = delete;
     TextureManager(const TextureManager&) = delete;
     TextureManager& operator=(const TextureManager&) = delete;
-    
+
+    // Supõem m_mutex já travado
+    static TextureHandle createSlot(std::string_view filename);
+    static bool isReadyLocked(TextureHandle handle);
+    static const sf::Texture& placeholderTexture();
+    static const sf::Texture& fallbackTexture();
+
 public:
-    static std::shared_ptr<sf::Texture> getTexture(std::string_view filename);
-    
+    static constexpr TextureHandle INVALID_HANDLE = 0;
+
+    // Não bloqueia: enfileira o carregamento na primeira vez que o nome aparece
+    static TextureHandle requestTexture(std::string_view filename);
+
+    // Textura provisória enquanto carrega, textura reserva se falhou
+    static const sf::Texture* getTexture(TextureHandle handle);
+    static bool isReady(TextureHandle handle);
+
+    // Faz o upload das imagens já decodificadas. Chamar uma vez por frame no thread do OpenGL.
+    static void processPendingUploads();
+
+    // Carrega de forma síncrona (para o início do programa)
     static bool preloadTexture(std::string_view filename);
-    
+
     static bool isTextureLoaded(std::string_view filename);
-    
+
+    // Invalida todos os handles; só chamar quando nenhuma partícula os usa
     static void clearAll();
 };
@@ -0,0 +1,79 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t workers) {
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const Body& body) {
+    grain = std::max<size_t>(grain, 1);
+    std::unique_lock<std::mutex> owner(m_submit, std::try_to_lock);
+    // pouco trabalho, nenhum worker ou pool ocupado: tudo aqui mesmo
+    if (count <= grain || m_workers.empty() || !owner.owns_lock()) {
+        if (count > 0) body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_grain = grain;
+        m_next.store(0, std::memory_order_relaxed);
+        m_pending = m_workers.size();
+        ++m_job;
+    }
+    m_wake.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_body = nullptr;
+}
+
+void ThreadPool::runChunks() {
+    while (true) {
+        const size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+        if (begin >= m_count) return;
+        (*m_body)(begin, std::min(begin + m_grain, m_count));
+    }
+}
+
+void ThreadPool::workerLoop() {
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_job != seen; });
+            if (m_stop) return;
+            seen = m_job;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) {
+            m_done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads fixas para os laços paralelos do passo. parallelFor divide [0, count)
+// em blocos de grain índices, que as threads (a que chamou inclusive) vão pegando
+// de um contador atômico, e só volta quando todos os blocos terminaram. Quem usa
+// escreve cada saída a partir de um índice só, então o resultado não depende de
+// quantas threads existem nem da ordem em que os blocos saem.
+//
+// Um laço por vez: se outra thread já está com o pool, o laço roda inteiro em
+// quem chamou, em vez de esperar.
+class ThreadPool {
+public:
+    using Body = std::function<void(size_t begin, size_t end)>;
+
+    // workers threads além da que chama parallelFor
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Pool do processo, com uma thread por núcleo
+    static ThreadPool& shared();
+
+    size_t getThreadCount() const { return m_workers.size() + 1; }
+
+    void parallelFor(size_t count, size_t grain, const Body& body);
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_submit;  // dono do laço em andamento
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::uint64_t m_job = 0;
+    size_t m_pending = 0;  // workers que ainda não largaram o laço atual
+    bool m_stop = false;
+
+    const Body* m_body = nullptr;
+    size_t m_count = 0;
+    size_t m_grain = 1;
+    std::atomic<size_t> m_next{0};
+};
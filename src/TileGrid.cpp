@@ -0,0 +1,274 @@
+#include "TileGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr size_t CELLS_PER_TILE = size_t(TileGrid::TILE_CELLS) * TileGrid::TILE_CELLS;
+    constexpr size_t MIN_TABLE_SIZE = 64;
+    // coordenadas de célula ficam bem dentro de int32 mesmo longe da origem
+    constexpr float CELL_LIMIT = 1e9f;
+
+    size_t hashTile(std::int32_t x, std::int32_t y) {
+        const std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+                                  static_cast<std::uint32_t>(y);
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+}
+
+std::uint32_t TileGrid::findTile(std::int32_t x, std::int32_t y) const {
+    const size_t mask = m_table.size() - 1;
+    for (size_t probe = hashTile(x, y) & mask;; probe = (probe + 1) & mask) {
+        const std::uint32_t slot = m_table[probe];
+        if (slot == NO_TILE) return NO_TILE;
+        if (m_tiles[slot].x == x && m_tiles[slot].y == y) return slot;
+    }
+}
+
+void TileGrid::insertTile(std::uint32_t slot) {
+    const size_t mask = m_table.size() - 1;
+    size_t probe = hashTile(m_tiles[slot].x, m_tiles[slot].y) & mask;
+    while (m_table[probe] != NO_TILE) probe = (probe + 1) & mask;
+    m_table[probe] = slot;
+}
+
+void TileGrid::rebuildTable(size_t capacity) {
+    m_table.assign(std::max(capacity, MIN_TABLE_SIZE), NO_TILE);
+    for (std::uint32_t slot = 0; slot < m_tiles.size(); ++slot) {
+        if (m_tiles[slot].live) insertTile(slot);
+    }
+}
+
+std::uint32_t TileGrid::acquireTile(std::int32_t x, std::int32_t y) {
+    const std::uint32_t found = findTile(x, y);
+    if (found != NO_TILE) return found;
+
+    std::uint32_t slot;
+    if (!m_freeTiles.empty()) {
+        slot = m_freeTiles.back();
+        m_freeTiles.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(m_tiles.size());
+        m_tiles.emplace_back();
+        m_tiles.back().cellStart.resize(CELLS_PER_TILE + 1);
+        ++m_tileStats.createdTiles;
+    }
+    Tile& tile = m_tiles[slot];
+    tile.x = x;
+    tile.y = y;
+    tile.live = true;
+    tile.end = 0;
+    // carga máxima de metade: a sondagem linear continua curta
+    if ((m_tiles.size() - m_freeTiles.size()) * 2 > m_table.size()) {
+        rebuildTable(m_table.size() * 2);
+    } else {
+        insertTile(slot);
+    }
+    return slot;
+}
+
+void TileGrid::releaseUnused() {
+    // na tabela ficam os tiles da construção anterior; o que não recebeu ninguém agora sai
+    bool released = false;
+    for (size_t probe = 0; probe < m_table.size(); ++probe) {
+        const std::uint32_t slot = m_table[probe];
+        if (slot != NO_TILE && m_tiles[slot].end == 0) {
+            m_tiles[slot].live = false;
+            m_freeTiles.push_back(slot);
+            released = true;
+        }
+    }
+    if (released) rebuildTable(m_table.size());
+}
+
+void TileGrid::sortTile(Tile& tile) {
+    std::uint32_t* cellStart = tile.cellStart.data();
+    std::fill(cellStart, cellStart + CELLS_PER_TILE + 1, 0u);
+    for (std::uint32_t s = tile.begin; s < tile.end; ++s) {
+        ++cellStart[m_cellOf[m_byTile[s]] + 1];
+    }
+    for (size_t c = 0; c < CELLS_PER_TILE; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    // cellStart[c] vira o cursor de escrita; no fim aponta para o início de c + 1
+    for (std::uint32_t s = tile.begin; s < tile.end; ++s) {
+        const std::uint32_t i = m_byTile[s];
+        m_sorted[tile.begin + cellStart[m_cellOf[i]]++] = i;
+    }
+    for (size_t c = CELLS_PER_TILE; c > 0; --c) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
+
+void TileGrid::findTilePairs(const float* positions, const float* radii, float margin, const Tile& tile,
+                             std::vector<ParticlePair>& out, size_t& candidates) const {
+    auto testPair = [&](std::uint32_t i, std::uint32_t j) {
+        ++candidates;
+        const float dx = positions[i * 2] - positions[j * 2];
+        const float dy = positions[i * 2 + 1] - positions[j * 2 + 1];
+        const float reach = radii[i] + radii[j] + margin;
+        if (dx * dx + dy * dy < reach * reach) {
+            out.push_back({std::min(i, j), std::max(i, j)});
+        }
+    };
+
+    // meia vizinhança, como na grade densa; nas bordas do tile a célula vizinha
+    // pode estar à esquerda, à direita ou na linha de tiles de baixo
+    const int forward[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    std::uint32_t s = tile.begin;
+    while (s < tile.end) {
+        const std::uint16_t cell = m_cellOf[m_sorted[s]];
+        const std::uint32_t cellEnd = tile.begin + tile.cellStart[cell + 1];
+        for (std::uint32_t a = s; a < cellEnd; ++a) {
+            for (std::uint32_t b = a + 1; b < cellEnd; ++b) {
+                testPair(m_sorted[a], m_sorted[b]);
+            }
+        }
+
+        const int cx = cell & (TILE_CELLS - 1);
+        const int cy = cell >> TILE_SHIFT;
+        for (const auto& offset : forward) {
+            int nx = cx + offset[0];
+            int ny = cy + offset[1];
+            const int tx = nx < 0 ? -1 : (nx >= TILE_CELLS ? 1 : 0);
+            const int ty = ny >= TILE_CELLS ? 1 : 0;
+            const std::uint32_t slot = tile.neighbors[(ty + 1) * 3 + tx + 1];
+            if (slot == NO_TILE) continue;
+            nx -= tx * TILE_CELLS;
+            ny -= ty * TILE_CELLS;
+            const Tile& other = m_tiles[slot];
+            const size_t otherCell = static_cast<size_t>(ny) * TILE_CELLS + static_cast<size_t>(nx);
+            const std::uint32_t otherBegin = other.begin + other.cellStart[otherCell];
+            const std::uint32_t otherEnd = other.begin + other.cellStart[otherCell + 1];
+            for (std::uint32_t a = s; a < cellEnd; ++a) {
+                for (std::uint32_t b = otherBegin; b < otherEnd; ++b) {
+                    testPair(m_sorted[a], m_sorted[b]);
+                }
+            }
+        }
+        s = cellEnd;
+    }
+}
+
+void TileGrid::findPairs(const float* positions, const float* radii, size_t count, float margin,
+                         std::vector<ParticlePair>& pairs) {
+    pairs.clear();
+    m_stats.candidates = 0;
+    m_stats.pairs = 0;
+    m_tileStats.createdTiles = 0;
+    if (count < 2) return;
+
+    float maxRadius = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxRadius = std::max(maxRadius, radii[i]);
+    }
+    // a vizinhança 3x3 só basta se nenhum par alcançar além de uma célula
+    const float cellSize = std::max(2.0f * maxRadius + margin, 1.0f);
+    if (cellSize != m_cellSize) {
+        // outra célula: nenhum tile guardado vale mais
+        for (std::uint32_t slot = 0; slot < m_tiles.size(); ++slot) {
+            if (m_tiles[slot].live) m_freeTiles.push_back(slot);
+            m_tiles[slot].live = false;
+        }
+        m_cellSize = cellSize;
+        m_invCell = 1.0f / cellSize;
+        rebuildTable(m_table.size());
+    }
+    if (m_table.empty()) rebuildTable(MIN_TABLE_SIZE);
+
+    // contagem por tile; só aparece em m_activeTiles quem recebe alguém
+    for (const std::uint32_t slot : m_activeTiles) m_tiles[slot].end = 0;
+    m_activeTiles.clear();
+    m_tileOf.resize(count);
+    m_cellOf.resize(count);
+    std::int32_t lastX = 0, lastY = 0;
+    std::uint32_t lastSlot = NO_TILE;
+    for (size_t i = 0; i < count; ++i) {
+        // limite antes do cast; nesta ordem, max(-CELL_LIMIT, NaN) é -CELL_LIMIT
+        const float fx = std::min(CELL_LIMIT, std::max(-CELL_LIMIT, std::floor(positions[i * 2] * m_invCell)));
+        const float fy = std::min(CELL_LIMIT, std::max(-CELL_LIMIT, std::floor(positions[i * 2 + 1] * m_invCell)));
+        const std::int32_t cx = static_cast<std::int32_t>(fx);
+        const std::int32_t cy = static_cast<std::int32_t>(fy);
+        // deslocamento aritmético: arredonda para baixo também nos negativos
+        const std::int32_t tx = cx >> TILE_SHIFT;
+        const std::int32_t ty = cy >> TILE_SHIFT;
+        // partículas vizinhas no SoA costumam cair no mesmo tile
+        if (lastSlot == NO_TILE || tx != lastX || ty != lastY) {
+            lastSlot = acquireTile(tx, ty);
+            lastX = tx;
+            lastY = ty;
+        }
+        Tile& tile = m_tiles[lastSlot];
+        if (tile.end++ == 0) m_activeTiles.push_back(lastSlot);
+        m_tileOf[i] = lastSlot;
+        m_cellOf[i] = static_cast<std::uint16_t>(((cy & (TILE_CELLS - 1)) << TILE_SHIFT) | (cx & (TILE_CELLS - 1)));
+    }
+    releaseUnused();
+
+    // counting sort por tile, na ordem em que os tiles apareceram
+    m_tileCursor.resize(m_tiles.size());
+    std::uint32_t offset = 0;
+    for (const std::uint32_t slot : m_activeTiles) {
+        Tile& tile = m_tiles[slot];
+        const std::uint32_t size = tile.end;
+        tile.begin = offset;
+        tile.end = offset + size;
+        m_tileCursor[slot] = offset;
+        offset += size;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                tile.neighbors[(dy + 1) * 3 + dx + 1] = findTile(tile.x + dx, tile.y + dy);
+            }
+        }
+    }
+    m_byTile.resize(count);
+    m_sorted.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_byTile[m_tileCursor[m_tileOf[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    ThreadPool& pool = ThreadPool::shared();
+    auto forRange = [&](size_t total, size_t grain, const ThreadPool::Body& body) {
+        if (m_params.parallel) {
+            pool.parallelFor(total, grain, body);
+        } else {
+            body(0, total);
+        }
+    };
+
+    const size_t activeCount = m_activeTiles.size();
+    forRange(activeCount, 1, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            sortTile(m_tiles[m_activeTiles[t]]);
+        }
+    });
+
+    if (m_tilePairs.size() < activeCount) m_tilePairs.resize(activeCount);
+    m_tileCandidates.assign(activeCount, 0);
+    forRange(activeCount, 1, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            m_tilePairs[t].clear();
+            findTilePairs(positions, radii, margin, m_tiles[m_activeTiles[t]], m_tilePairs[t], m_tileCandidates[t]);
+        }
+    });
+
+    size_t total = 0;
+    size_t candidates = 0;
+    for (size_t t = 0; t < activeCount; ++t) {
+        total += m_tilePairs[t].size();
+        candidates += m_tileCandidates[t];
+    }
+    pairs.reserve(total);
+    for (size_t t = 0; t < activeCount; ++t) {
+        pairs.insert(pairs.end(), m_tilePairs[t].begin(), m_tilePairs[t].end());
+    }
+
+    m_stats.candidates = candidates;
+    m_stats.pairs = pairs.size();
+    m_tileStats.cellSize = m_cellSize;
+    m_tileStats.activeTiles = activeCount;
+    m_tileStats.pooledTiles = m_freeTiles.size();
+    m_tileStats.memoryBytes = m_tiles.size() * (sizeof(Tile) + (CELLS_PER_TILE + 1) * sizeof(std::uint32_t)) +
+                              m_table.size() * sizeof(std::uint32_t) +
+                              count * (3 * sizeof(std::uint32_t) + sizeof(std::uint16_t));
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "Broadphase.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Grade esparsa para o mundo aberto. O plano é dividido em tiles de
+// TILE_CELLS x TILE_CELLS células, e só existem os tiles em que caiu alguma
+// partícula: memória e tempo seguem a área ocupada, não a caixa envolvente,
+// então duas nuvens a um milhão de pixels uma da outra custam o mesmo que lado
+// a lado. A grade densa, ao contrário, cobre a caixa inteira e precisa engrossar
+// a célula quando ela passa do orçamento.
+//
+// Os tiles ficam guardados entre chamadas e são achados por uma tabela hash
+// (endereçamento aberto) pela coordenada do tile; o que esvaziou volta para uma
+// lista livre e é reaproveitado pelo próximo tile que aparecer. Cada construção
+// distribui as partículas pelos tiles ocupados e depois pelas células de cada
+// tile (dois counting sorts), e a busca de pares roda um tile por tarefa no
+// pool, cada uma na sua própria lista, emendadas na ordem dos tiles: o
+// resultado não depende do número de threads.
+class TileGrid : public Broadphase {
+public:
+    static constexpr int TILE_SHIFT = 6;
+    static constexpr int TILE_CELLS = 1 << TILE_SHIFT;
+
+    struct TileStats {
+        float cellSize = 0.0f;
+        size_t activeTiles = 0;   // tiles com partículas na última construção
+        size_t pooledTiles = 0;   // alocados e livres para reaproveitar
+        size_t createdTiles = 0;  // alocações novas na última construção
+        size_t memoryBytes = 0;   // tiles + tabela + índices
+    };
+
+    struct Params {
+        bool parallel = true;
+    };
+
+    // Todos os pares com distância < ra + rb + margin; a célula é 2 * raio máximo + margin
+    void findPairs(const float* positions, const float* radii, size_t count, float margin,
+                   std::vector<ParticlePair>& pairs) override;
+    const char* getName() const override { return "tiles"; }
+
+    void setParams(const Params& params) { m_params = params; }
+    const TileStats& getTileStats() const { return m_tileStats; }
+
+private:
+    static constexpr std::uint32_t NO_TILE = ~std::uint32_t(0);
+
+    struct Tile {
+        std::int32_t x = 0;
+        std::int32_t y = 0;
+        // partículas do tile em m_sorted: [begin, end), ordenadas por célula
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+        // tiles vizinhos ocupados, 3 x 3 em torno deste (NO_TILE onde não há)
+        std::uint32_t neighbors[9];
+        bool live = false;  // na tabela; fora dela, está na lista livre
+        // TILE_CELLS^2 + 1 inícios de célula, relativos a begin
+        std::vector<std::uint32_t> cellStart;
+    };
+
+    // Tile na coordenada dada, criado (ou tirado da lista livre) se não existir
+    std::uint32_t acquireTile(std::int32_t x, std::int32_t y);
+    std::uint32_t findTile(std::int32_t x, std::int32_t y) const;
+    void insertTile(std::uint32_t slot);
+    void rebuildTable(size_t capacity);
+    // Devolve à lista livre os tiles que não receberam ninguém nesta construção
+    void releaseUnused();
+    void sortTile(Tile& tile);
+    void findTilePairs(const float* positions, const float* radii, float margin, const Tile& tile,
+                       std::vector<ParticlePair>& out, size_t& candidates) const;
+
+    Params m_params;
+    float m_cellSize = 0.0f;
+    float m_invCell = 0.0f;
+
+    std::vector<Tile> m_tiles;
+    std::vector<std::uint32_t> m_freeTiles;
+    std::vector<std::uint32_t> m_activeTiles;  // na ordem em que apareceram nesta construção
+    // tabela hash: slot do tile ou NO_TILE; potência de dois
+    std::vector<std::uint32_t> m_table;
+
+    // por partícula: tile e célula local; depois, índices ordenados por tile e célula
+    std::vector<std::uint32_t> m_tileOf;
+    std::vector<std::uint16_t> m_cellOf;
+    std::vector<std::uint32_t> m_byTile;
+    std::vector<std::uint32_t> m_sorted;
+    std::vector<std::uint32_t> m_tileCursor;
+
+    // pares por tile, emendados em ordem no fim
+    std::vector<std::vector<ParticlePair>> m_tilePairs;
+    std::vector<size_t> m_tileCandidates;
+
+    TileStats m_tileStats;
+};
@@ -0,0 +1,190 @@
+#include "WorldBatch.h"
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <tuple>
+
+namespace {
+    using BatchClock = std::chrono::steady_clock;
+
+    double secondsBetween(BatchClock::time_point begin, BatchClock::time_point end) {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    // Média e desvio padrão (amostral) de um campo do resultado sobre um grupo de mundos
+    template <typename Field>
+    void meanDeviation(const std::vector<WorldBatch::WorldResult>& results, const std::vector<size_t>& group,
+                       Field field, double& mean, double& deviation) {
+        mean = 0.0;
+        for (size_t index : group) mean += static_cast<double>(results[index].*field);
+        mean /= static_cast<double>(group.size());
+        deviation = 0.0;
+        if (group.size() < 2) return;
+        for (size_t index : group) {
+            const double delta = static_cast<double>(results[index].*field) - mean;
+            deviation += delta * delta;
+        }
+        deviation = std::sqrt(deviation / static_cast<double>(group.size() - 1));
+    }
+}
+
+float WorldBatch::Range::at(int i) const {
+    if (count <= 1) return first;
+    return first + (last - first) * static_cast<float>(i) / static_cast<float>(count - 1);
+}
+
+bool WorldBatch::Range::parse(const std::string& text, Range& out) {
+    Range range;
+    char tail = 0;
+    const int fields = std::sscanf(text.c_str(), "%f:%f:%d%c", &range.first, &range.last, &range.count, &tail);
+    if (fields == 1) {
+        range.last = range.first;
+        range.count = 1;
+    } else if (fields != 3 || range.count < 1) {
+        return false;
+    }
+    out = range;
+    return true;
+}
+
+void WorldBatch::addGrid(const Range& restitution, const Range& gravity, const Range& mouseForce,
+                         int seeds, std::uint32_t baseSeed) {
+    m_configs.reserve(m_configs.size() + static_cast<size_t>(restitution.count) * gravity.count *
+                                        mouseForce.count * std::max(seeds, 1));
+    for (int r = 0; r < restitution.count; ++r) {
+        for (int g = 0; g < gravity.count; ++g) {
+            for (int m = 0; m < mouseForce.count; ++m) {
+                for (int s = 0; s < std::max(seeds, 1); ++s) {
+                    WorldConfig config;
+                    config.restitution = restitution.at(r);
+                    config.gravity = gravity.at(g);
+                    config.mouseForce = mouseForce.at(m);
+                    config.seed = baseSeed + static_cast<std::uint32_t>(s);
+                    m_configs.push_back(config);
+                }
+            }
+        }
+    }
+}
+
+void WorldBatch::run(ThreadPool& pool) {
+    m_results.assign(m_configs.size(), WorldResult());
+    m_stats = Stats();
+    m_stats.worlds = m_configs.size();
+    m_stats.threads = m_params.parallel ? pool.getThreadCount() : 1;
+
+    const BatchClock::time_point begin = BatchClock::now();
+    if (m_params.parallel) {
+        // um mundo por bloco: o custo de cada um varia com a semente e os parâmetros
+        pool.parallelFor(m_configs.size(), 1, [this](size_t first, size_t last) {
+            for (size_t index = first; index < last; ++index) runWorld(index);
+        });
+    } else {
+        for (size_t index = 0; index < m_configs.size(); ++index) runWorld(index);
+    }
+    m_stats.seconds = secondsBetween(begin, BatchClock::now());
+    if (m_stats.seconds > 0.0) {
+        m_stats.worldStepsPerSecond = static_cast<double>(m_configs.size()) * m_params.steps / m_stats.seconds;
+    }
+}
+
+void WorldBatch::runWorld(size_t index) {
+    const WorldConfig& config = m_configs[index];
+    const BatchClock::time_point begin = BatchClock::now();
+
+    ParticleSystem system(m_params.worldWidth, m_params.worldHeight);
+    // o paralelismo é entre mundos: nada aqui dentro disputa o pool
+    system.setParallel(false);
+    system.setFrameGeometry(false);
+    system.setRandomSeed(config.seed);
+    system.generateRandomParticles(m_params.particles);
+
+    ParticleSystem::PhysicsInputState inputs{};
+    inputs.gravityEnabled = true;
+    inputs.gravitationalAcceleration = config.gravity;
+    inputs.collisionsEnabled = true;
+    inputs.collisionRestitution = config.restitution;
+    inputs.mouseForceEnabled = config.mouseForce != 0.0f;
+    inputs.mousePosition = {m_params.worldWidth / 2.0f, m_params.worldHeight / 2.0f};
+    inputs.mouseForceStrength = std::abs(config.mouseForce);
+    inputs.mouseForceAttractMode = config.mouseForce > 0.0f;
+
+    for (int step = 0; step < m_params.steps; ++step) {
+        system.update(m_params.dt, inputs);
+    }
+
+    Snapshot::Data state;
+    system.captureSnapshot(state);
+    WorldResult& result = m_results[index];
+    result.config = config;
+    result.particles = state.count();
+    double totalMass = 0.0, centerX = 0.0, centerY = 0.0;
+    for (size_t i = 0; i < state.count(); ++i) {
+        const double mass = state.masses[i];
+        const double vx = state.velocities[i * 2];
+        const double vy = state.velocities[i * 2 + 1];
+        const double speedSq = vx * vx + vy * vy;
+        result.kineticEnergy += 0.5 * mass * speedSq;
+        result.meanSpeed += std::sqrt(speedSq);
+        totalMass += mass;
+        centerX += mass * state.positions[i * 2];
+        centerY += mass * state.positions[i * 2 + 1];
+    }
+    if (state.count() > 0) {
+        result.meanSpeed /= static_cast<double>(state.count());
+        result.centerX = static_cast<float>(centerX / totalMass);
+        result.centerY = static_cast<float>(centerY / totalMass);
+    }
+    result.meanPenetration = system.getContactStats().meanPenetration;
+    result.substeps = system.getStepTimings().substeps;
+    result.seconds = secondsBetween(begin, BatchClock::now());
+}
+
+bool WorldBatch::writeSummary(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "[ERRO] Não foi possível criar o resumo da varredura: " << path << std::endl;
+        return false;
+    }
+
+    // pontos na ordem em que apareceram pela primeira vez
+    std::map<std::tuple<float, float, float>, size_t> pointOf;
+    std::vector<std::vector<size_t>> points;
+    for (size_t index = 0; index < m_results.size(); ++index) {
+        const WorldConfig& config = m_results[index].config;
+        const auto key = std::make_tuple(config.restitution, config.gravity, config.mouseForce);
+        const auto found = pointOf.emplace(key, points.size());
+        if (found.second) points.emplace_back();
+        points[found.first->second].push_back(index);
+    }
+
+    file << "restitution,gravity,mouse_force,seeds,particles,steps,"
+            "kinetic_energy,kinetic_energy_sd,mean_speed,mean_speed_sd,"
+            "center_x,center_x_sd,center_y,center_y_sd,penetration,penetration_sd,seconds\n";
+    char line[512];
+    for (const std::vector<size_t>& group : points) {
+        const WorldConfig& config = m_results[group.front()].config;
+        double particles, particlesSd, energy, energySd, speed, speedSd;
+        double centerX, centerXSd, centerY, centerYSd, penetration, penetrationSd, seconds, secondsSd;
+        // as sementes de um ponto têm o mesmo número de partículas: a média é inteira
+        meanDeviation(m_results, group, &WorldResult::particles, particles, particlesSd);
+        meanDeviation(m_results, group, &WorldResult::kineticEnergy, energy, energySd);
+        meanDeviation(m_results, group, &WorldResult::meanSpeed, speed, speedSd);
+        meanDeviation(m_results, group, &WorldResult::centerX, centerX, centerXSd);
+        meanDeviation(m_results, group, &WorldResult::centerY, centerY, centerYSd);
+        meanDeviation(m_results, group, &WorldResult::meanPenetration, penetration, penetrationSd);
+        meanDeviation(m_results, group, &WorldResult::seconds, seconds, secondsSd);
+        std::snprintf(line, sizeof(line),
+                      "%g,%g,%g,%zu,%lld,%d,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n",
+                      config.restitution, config.gravity, config.mouseForce, group.size(), std::llround(particles),
+                      m_params.steps, energy, energySd, speed, speedSd, centerX, centerXSd, centerY, centerYSd,
+                      penetration, penetrationSd, seconds);
+        file << line;
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Muitos mundos pequenos e independentes de uma vez, para varrer parâmetros
+// (restituição, gravidade, força do mouse) com várias sementes. Cada mundo é um
+// ParticleSystem sem janela, sem geometria de quadro e sem usar o pool por
+// dentro; o paralelismo é entre mundos, um por tarefa do pool, pegos de um
+// contador atômico: com mundos de poucas centenas de partículas não há passo
+// grande o bastante para dividir, mas há mundos de sobra para todas as threads.
+//
+// O mundo nasce, roda e some dentro da tarefa, então a memória segue o número
+// de threads e não o de mundos. O resultado de cada um depende só da sua
+// configuração: a ordem em que as threads pegam os mundos não muda nada.
+class WorldBatch {
+public:
+    // O que muda de um mundo para outro
+    struct WorldConfig {
+        float restitution = 0.7f;
+        float gravity = 250.0f;
+        float mouseForce = 0.0f;  // no centro do mundo; > 0 atrai, < 0 repele, 0 desliga
+        std::uint32_t seed = 1;
+    };
+
+    // O que todos os mundos têm em comum
+    struct Params {
+        int particles = 500;
+        int steps = 600;
+        float dt = 1.0f / 120.0f;
+        float worldWidth = 800.0f;
+        float worldHeight = 600.0f;
+        bool parallel = true;  // false roda os mundos um atrás do outro na thread de run()
+    };
+
+    // Estado no fim do último passo
+    struct WorldResult {
+        WorldConfig config;
+        size_t particles = 0;
+        double kineticEnergy = 0.0;
+        double meanSpeed = 0.0;
+        float centerX = 0.0f;          // centro de massa
+        float centerY = 0.0f;
+        float meanPenetration = 0.0f;  // sobreposição média dos contatos
+        std::uint64_t substeps = 0;
+        double seconds = 0.0;          // só a simulação deste mundo
+    };
+
+    struct Stats {
+        size_t worlds = 0;
+        size_t threads = 1;
+        double seconds = 0.0;              // parede, o lote inteiro
+        double worldStepsPerSecond = 0.0;
+    };
+
+    // first..last em count valores igualmente espaçados ("a:b:n"; "a" sozinho é um valor só)
+    struct Range {
+        float first = 0.0f;
+        float last = 0.0f;
+        int count = 1;
+
+        float at(int i) const;
+        static bool parse(const std::string& text, Range& out);
+    };
+
+    void clear() { m_configs.clear(); m_results.clear(); }
+    void add(const WorldConfig& config) { m_configs.push_back(config); }
+    // Produto das três faixas, cada ponto com as sementes baseSeed .. baseSeed + seeds - 1
+    // (as mesmas em todos os pontos, para que a diferença entre eles seja o parâmetro)
+    void addGrid(const Range& restitution, const Range& gravity, const Range& mouseForce,
+                 int seeds, std::uint32_t baseSeed);
+    size_t size() const { return m_configs.size(); }
+
+    // Roda todos os mundos e volta quando o último termina
+    void run(ThreadPool& pool);
+    // Na ordem em que os mundos foram adicionados
+    const std::vector<WorldResult>& getResults() const { return m_results; }
+
+    // CSV com uma linha por ponto da varredura (mesmos parâmetros, sementes
+    // diferentes): média e desvio padrão de cada resultado entre as sementes
+    bool writeSummary(const std::string& path) const;
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void runWorld(size_t index);
+
+    Params m_params;
+    std::vector<WorldConfig> m_configs;
+    std::vector<WorldResult> m_results;
+    Stats m_stats;
+};
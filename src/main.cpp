@@ -7,13 +7,29 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include "ParticleSystem.h"
+#include "Camera.h"
+#include "CommandQueue.h"
 #include "Mousart.h"
+#include "InputLog.h"
+#include "StateExporter.h"
+#include "SoftwareRenderer.h"
+#include "FrameWriter.h"
+#include "AssetPack.h"
+#include "Benchmark.h"
+#include "WorldBatch.h"
 #include <iostream>
+#include <atomic>
+#include <thread>
 #include <exception>
 #include <random>
 #include <string>
 #include <algorithm>
 #include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
 
 struct AppState {
     static constexpr int NUM_PARTICLES_INICIAL = 0;
@@ -24,12 +40,29 @@ struct AppState {
     static constexpr float MIN_MOUSE_FORCE = 50.0f;
     static constexpr float MAX_MOUSE_FORCE = 25000.0f;
     static constexpr float MOUSE_FORCE_STEP = 250.0f;
+    static constexpr const char* SNAPSHOT_PADRAO = "chaos.snap";
+    static constexpr float SKIN_PADRAO = 8.0f;
+    // J dobra as iterações do solver de contato até este limite e volta ao impulso (0)
+    static constexpr int MAX_ITERACOES_SOLVER = 8;
+    // Com subpassos adaptativos o quadro vira um passo só, até este limite
+    static constexpr float MAX_PASSO_ADAPTATIVO = 1.0f / 20.0f;
+    // zoom por clique da roda e deslocamento das setas (fração da tela)
+    static constexpr float ZOOM_RODA = 1.1f;
+    static constexpr float PASSO_SETAS = 0.1f;
+    // Ctrl + clique remove quem estiver neste raio (unidades do mundo)
+    static constexpr float RAIO_REMOCAO = 40.0f;
     
     float desiredGravitationalAcceleration = GRAVIDADE_PADRAO;
     bool gravityEnabled = true;
     bool repulsionEnabled = false;
     bool collisionsEnabled = true;
     float collisionRestitution = RESTITUICAO_PADRAO;
+    int solverIterations = 0;
+    StepKernels::IntegratorType integrator = StepKernels::IntegratorType::PositionVerlet;
+    bool adaptiveSubsteps = false;
+    ObstacleScene obstacleScene = ObstacleScene::None;
+    bool fluidEnabled = false;
+    SpeciesPreset speciesPreset = SpeciesPreset::Uniform;
     
     ParticleType currentParticleType = ParticleType::Original;
     std::string particleTypeName = "Original";
@@ -45,7 +78,20 @@ struct AppState {
     float mouseForceStrength = DEFAULT_MOUSE_FORCE;
     sf::Vector2f mousePositionWindow;
     
+    std::uint32_t rngSeed;
+    std::mt19937 rng;
+    InputRecorder recorder;
+    StateExporter exporter;
+
+    // tudo o que muda o mundo fora do passo entra por aqui e é aplicado no começo do passo seguinte
+    CommandQueue commands;
+    std::vector<SimCommand> drained;
+    std::vector<ParticleSystem::ParticleSpawn> spawnBatch;
+
     ParticleSystem particleSystem;
+    Camera camera;
+    bool panning = false;
+    sf::Vector2i panOrigin;
     Mousart mousart;
 
     sf::Font font;
@@ -53,18 +99,228 @@ struct AppState {
     sf::Texture backgroundTexture;
     sf::Sprite backgroundSprite;
 
-    AppState(float width, float height) : particleSystem(width, height) {}
+    AppState(float worldWidth, float worldHeight, float windowWidth, float windowHeight)
+        : rngSeed(std::random_device{}()), rng(rngSeed), particleSystem(worldWidth, worldHeight),
+          camera(worldWidth, worldHeight, windowWidth, windowHeight) {
+        particleSystem.setRandomSeed(rngSeed);
+    }
+};
+
+// Opções de física da linha de comando; valem igual para a janela e para o replay
+struct PhysicsOptions {
+    float neighborSkin = 0.0f;
+    bool neighborSkinChosen = false;
+    BroadphaseType broadphase = BroadphaseType::Grid;
+    bool broadphaseChosen = false;
+    bool unbounded = false;  // no replay vale o que está no log
+
+    void applyTo(ParticleSystem& system) const {
+        if (unbounded) system.setUnbounded(true);
+        system.setNeighborSkin(neighborSkin);
+        // no mundo aberto a grade densa cobriria a caixa envolvente inteira
+        system.setBroadphase(broadphaseChosen || !system.isUnbounded() ? broadphase : BroadphaseType::Tiles);
+    }
+};
+
+// Segundo produtor da fila de comandos (--spawn-rate): uma thread que pede
+// partículas aleatórias num ritmo fixo, junto com a entrada do usuário
+class LoadGenerator {
+public:
+    static constexpr int INTERVALO_MS = 10;
+
+    ~LoadGenerator() { stop(); }
+
+    void start(CommandQueue& commands, float particlesPerSecond, ParticleType type) {
+        stop();
+        m_running = true;
+        m_thread = std::thread([this, &commands, particlesPerSecond, type]() {
+            float owed = 0.0f;
+            while (m_running.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(INTERVALO_MS));
+                owed += particlesPerSecond * INTERVALO_MS / 1000.0f;
+                const std::uint32_t count = static_cast<std::uint32_t>(owed);
+                if (count == 0) continue;
+                // fila cheia: o pedido se perde e o gerador segue no ritmo, sem acumular atraso
+                commands.push(SimCommand::spawnRandom(count, 2.0f, 2.0f, type));
+                owed -= static_cast<float>(count);
+            }
+        });
+    }
+
+    void stop() {
+        m_running = false;
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+private:
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+};
+
+// Quadros desenhados sem janela durante o replay (--render)
+struct RenderOptions {
+    std::string target;
+    unsigned width = 0;   // 0: o tamanho do mundo gravado no log
+    unsigned height = 0;
+    std::uint32_t stepInterval = 1;
+};
+
+// Varredura de parâmetros em muitos mundos sem janela (--sweep)
+struct SweepOptions {
+    std::string summaryPath;
+    WorldBatch::Range restitution{0.7f, 0.7f, 1};
+    WorldBatch::Range gravity{250.0f, 250.0f, 1};
+    WorldBatch::Range mouseForce{0.0f, 0.0f, 1};
+    int seeds = 1;
+    std::uint32_t baseSeed = 1;
+    WorldBatch::Params params;
 };
 
 void setup(sf::RenderWindow& window, AppState& state);
 void processInput(sf::RenderWindow& window, AppState& state);
 void updatePhysics(AppState& state, float dt);
+void enqueue(AppState& state, const SimCommand& command);
+bool loadSnapshot(AppState& state, const std::string& path);
+void applyCommands(AppState& state);
+ParticleSystem::PhysicsInputState makeInputs(const AppState& state);
 
 void updateUI(sf::RenderWindow& window, AppState& state, float real_dt);
 void render(sf::RenderWindow& window, AppState& state);
+int runReplay(const std::string& path, const std::string& exportPath, const StateExporter::Options& exportOptions,
+              const PhysicsOptions& physicsOptions, const RenderOptions& renderOptions);
+int runSweep(const SweepOptions& options);
 
-int main()
+int main(int argc, char* argv[])
 {
+    std::string recordPath;
+    std::string replayPath;
+    std::string snapshotPath;
+    std::string exportPath;
+    StateExporter::Options exportOptions;
+    bool usePack = true;
+    bool runBench = false;
+    PhysicsOptions physicsOptions;
+    RenderOptions renderOptions;
+    unsigned worldWidth = 0;   // 0: o tamanho inicial da janela
+    unsigned worldHeight = 0;
+    float spawnRate = 0.0f;    // partículas por segundo do gerador de carga
+    std::string benchFilter;
+    SweepOptions sweepOptions;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (arg == "--bench") {
+            runBench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                benchFilter = argv[++i];
+            }
+        } else if (arg == "--verlet") {
+            physicsOptions.neighborSkin = AppState::SKIN_PADRAO;
+            physicsOptions.neighborSkinChosen = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                physicsOptions.neighborSkin = static_cast<float>(std::atof(argv[++i]));
+            }
+        } else if (arg == "--broadphase" && i + 1 < argc) {
+            const std::string name = argv[++i];
+            if (name == "grid") {
+                physicsOptions.broadphase = BroadphaseType::Grid;
+            } else if (name == "sap") {
+                physicsOptions.broadphase = BroadphaseType::SweepAndPrune;
+            } else if (name == "tiles") {
+                physicsOptions.broadphase = BroadphaseType::Tiles;
+            } else {
+                std::cerr << "Valores válidos para --broadphase: grid, sap, tiles" << std::endl;
+                return 1;
+            }
+            physicsOptions.broadphaseChosen = true;
+        } else if (arg == "--unbounded") {
+            physicsOptions.unbounded = true;
+        } else if (arg == "--no-pak") {
+            usePack = false;
+        } else if (arg == "--export" && i + 1 < argc) {
+            exportPath = argv[++i];
+        } else if (arg == "--export-every" && i + 1 < argc) {
+            exportOptions.stepInterval = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--export-fields" && i + 1 < argc) {
+            exportOptions.fields = StateExporter::parseFieldList(argv[++i]);
+            if (exportOptions.fields == 0) {
+                std::cerr << "Campos válidos para --export-fields: pos,prev,vel,mass,radius" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--render" && i + 1 < argc) {
+            renderOptions.target = argv[++i];
+        } else if (arg == "--render-size" && i + 1 < argc) {
+            unsigned width = 0;
+            unsigned height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::cerr << "Tamanho inválido para --render-size (use LxA, p.ex. 1920x1080)" << std::endl;
+                return 1;
+            }
+            renderOptions.width = width;
+            renderOptions.height = height;
+        } else if (arg == "--world" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &worldWidth, &worldHeight) != 2 || worldWidth == 0 ||
+                worldHeight == 0) {
+                std::cerr << "Tamanho inválido para --world (use LxA, p.ex. 8000x6000)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--spawn-rate" && i + 1 < argc) {
+            spawnRate = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--render-every" && i + 1 < argc) {
+            renderOptions.stepInterval = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweepOptions.summaryPath = argv[++i];
+        } else if ((arg == "--sweep-restitution" || arg == "--sweep-gravity" || arg == "--sweep-mouse") && i + 1 < argc) {
+            WorldBatch::Range& range = arg == "--sweep-restitution" ? sweepOptions.restitution
+                                     : arg == "--sweep-gravity"     ? sweepOptions.gravity
+                                                                    : sweepOptions.mouseForce;
+            if (!WorldBatch::Range::parse(argv[++i], range)) {
+                std::cerr << "Faixa inválida para " << arg << " (use início:fim:n, p.ex. 0.1:0.9:9, ou um valor só)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sweep-seeds" && i + 1 < argc) {
+            sweepOptions.seeds = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sweep-particles" && i + 1 < argc) {
+            sweepOptions.params.particles = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sweep-steps" && i + 1 < argc) {
+            sweepOptions.params.steps = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Uso: Chaos [--record <log>] [--replay <log>] [--snapshot <arquivo>] [--no-pak] [--world LxA] [--unbounded]\n"
+                         "             [--verlet [skin]] [--broadphase grid|sap|tiles] [--spawn-rate N]\n"
+                         "             [--bench [filtro]] [--export <arquivo> [--export-every N] [--export-fields pos,prev,vel,mass,radius]]\n"
+                         "             [--render <quadros%05d.png|quadros.ppm|-> [--render-size LxA] [--render-every N]]\n"
+                         "             [--sweep <resumo.csv> [--sweep-restitution a:b:n] [--sweep-gravity a:b:n] [--sweep-mouse a:b:n]\n"
+                         "              [--sweep-seeds N] [--sweep-particles N] [--sweep-steps N]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (runBench) {
+        return Benchmark::run(benchFilter);
+    }
+
+    if (!sweepOptions.summaryPath.empty()) {
+        if (worldWidth > 0) {
+            sweepOptions.params.worldWidth = static_cast<float>(worldWidth);
+            sweepOptions.params.worldHeight = static_cast<float>(worldHeight);
+        }
+        return runSweep(sweepOptions);
+    }
+
+    const auto startupBegin = std::chrono::steady_clock::now();
+    if (usePack) {
+        AssetPack::mount(AssetPack::DEFAULT_PATH);
+    }
+
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, exportPath, exportOptions, physicsOptions, renderOptions);
+    }
+
     try {
         const int WIDTH = 800;
         const int HEIGHT = 600;
@@ -73,8 +329,39 @@ int main()
     sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), sf::String::fromUtf8(windowTitle.begin(), windowTitle.end()));
         window.setFramerateLimit(120);
 
-        AppState state(WIDTH, HEIGHT);
+        const float worldW = worldWidth > 0 ? static_cast<float>(worldWidth) : static_cast<float>(WIDTH);
+        const float worldH = worldHeight > 0 ? static_cast<float>(worldHeight) : static_cast<float>(HEIGHT);
+        AppState state(worldW, worldH, static_cast<float>(WIDTH), static_cast<float>(HEIGHT));
         setup(window, state);
+        physicsOptions.applyTo(state.particleSystem);
+        state.camera.setUnbounded(state.particleSystem.isUnbounded());
+
+        const double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+        std::cout << "[INFO] Inicialização: " << startupMs << " ms ("
+                  << (AssetPack::isMounted() ? AssetPack::DEFAULT_PATH : "arquivos soltos") << ")" << std::endl;
+
+        if (!recordPath.empty() && state.recorder.open(recordPath, state.rngSeed, worldW, worldH,
+                                                           state.particleSystem.isUnbounded(),
+                                                           state.particleSystem.getBroadphaseType(),
+                                                           state.particleSystem.getNeighborSkin())) {
+            std::cout << "[INFO] Gravando entradas em '" << recordPath << "'" << std::endl;
+        }
+
+        // depois de abrir a gravação: o snapshot inicial entra no log como o primeiro registro
+        if (!snapshotPath.empty() && loadSnapshot(state, snapshotPath)) {
+            std::cout << "[INFO] Snapshot '" << snapshotPath << "' carregado com "
+                      << state.particleSystem.getParticleCount() << " partículas" << std::endl;
+        }
+
+        if (!exportPath.empty() && state.exporter.open(exportPath, exportOptions)) {
+            std::cout << "[INFO] Exportando estado em '" << exportPath << "'" << std::endl;
+        }
+
+        LoadGenerator generator;
+        if (spawnRate > 0.0f) {
+            generator.start(state.commands, spawnRate, ParticleType::Original);
+            std::cout << "[INFO] Gerador de carga: " << spawnRate << " partículas/s" << std::endl;
+        }
         
         sf::Clock clock;
         sf::Time timeSinceLastUpdate = sf::Time::Zero;
@@ -84,8 +371,17 @@ int main()
             sf::Time elapsedTime = clock.restart();
             timeSinceLastUpdate += elapsedTime;
             
+            TextureManager::processPendingUploads();
             processInput(window, state);
+            // o que a câmera mostra decide o que é montado para a tela neste quadro
+            state.particleSystem.setViewArea(state.camera.getVisibleArea(), state.camera.getZoom());
             
+            if (state.adaptiveSubsteps) {
+                // o sistema subdivide quando precisa; cena calma anda o quadro inteiro de uma vez
+                const float frameStep = std::min(timeSinceLastUpdate.asSeconds(), AppState::MAX_PASSO_ADAPTATIVO);
+                timeSinceLastUpdate = sf::Time::Zero;
+                updatePhysics(state, frameStep);
+            }
             while (timeSinceLastUpdate > TimePerFrame) {
                 timeSinceLastUpdate -= TimePerFrame;
                 updatePhysics(state, TimePerFrame.asSeconds());
@@ -106,13 +402,13 @@ void setup(sf::RenderWindow& window, AppState& state) {
     window.setFramerateLimit(60);
 
     sf::Image windowIcon;
-    if (windowIcon.loadFromFile("assets/icon.png")) {
+    if (AssetPack::loadImage("icon.png", windowIcon)) {
         window.setIcon(windowIcon.getSize().x, windowIcon.getSize().y, windowIcon.getPixelsPtr());
     } else {
         std::cerr << "[AVISO] Não foi possível carregar 'assets/icon.png'" << std::endl;
     }
 
-    if (!state.backgroundTexture.loadFromFile("assets/background.png")) {
+    if (!AssetPack::loadTexture("background.png", state.backgroundTexture)) {
         std::cerr << "[AVISO] Não foi possível carregar 'assets/background.png', usando cor de fallback." << std::endl;
         state.backgroundTexture.create(1, 1);
         sf::Image fallbackImage;
@@ -121,13 +417,13 @@ void setup(sf::RenderWindow& window, AppState& state) {
     }
     state.backgroundSprite.setTexture(state.backgroundTexture);
     
-    sf::Vector2u windowSize = window.getSize();
+    // o fundo cobre o mundo, não a janela: é ele que mostra onde ficam as paredes
     sf::Vector2u textureSize = state.backgroundTexture.getSize();
-    float scaleX = static_cast<float>(windowSize.x) / textureSize.x;
-    float scaleY = static_cast<float>(windowSize.y) / textureSize.y;
+    float scaleX = state.particleSystem.getWorldWidth() / textureSize.x;
+    float scaleY = state.particleSystem.getWorldHeight() / textureSize.y;
     state.backgroundSprite.setScale(scaleX, scaleY);
 
-    if (!state.font.loadFromFile("assets/fonts/PressStart2P-Regular.ttf")) {
+    if (!AssetPack::loadFont("fonts/PressStart2P-Regular.ttf", state.font)) {
         if (!state.font.loadFromFile("C:/Windows/Fonts/arial.ttf")) {
             std::cerr << "ERRO FATAL: Nenhuma fonte encontrada. O texto não será exibido." << std::endl;
             throw std::runtime_error("Font not found");
@@ -139,6 +435,11 @@ void setup(sf::RenderWindow& window, AppState& state) {
     state.instructions.setFillColor(sf::Color::White);
     state.instructions.setPosition(10.f, 10.f); 
     
+    // Já começa a carregar as texturas do Crystal em segundo plano
+    for (const char* textureFile : {"1.png", "2.png", "3.png"}) {
+        TextureManager::requestTexture(textureFile);
+    }
+
     state.particleSystem.generateRandomParticles(AppState::NUM_PARTICLES_INICIAL, 1.0f, 10.0f);
     
     if (!state.mousart.initialize()) {
@@ -151,39 +452,54 @@ void processInput(sf::RenderWindow& window, AppState& state) {
         sf::Event event;
     while (window.pollEvent(event)) {
         if (event.type == sf::Event::Resized) {
-            sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
-            window.setView(sf::View(visibleArea));
-
-            sf::Vector2u textureSize = state.backgroundTexture.getSize();
-            float scaleX = static_cast<float>(event.size.width) / textureSize.x;
-            float scaleY = static_cast<float>(event.size.height) / textureSize.y;
-            state.backgroundSprite.setScale(scaleX, scaleY);
-            
-            state.particleSystem.setWindowSize(static_cast<float>(event.size.width), static_cast<float>(event.size.height));
+            // só a câmera muda: o mundo e a física não sabem da janela
+            state.camera.setViewport(static_cast<float>(event.size.width), static_cast<float>(event.size.height));
+        }
+        if (event.type == sf::Event::MouseWheelScrolled) {
+            const sf::Vector2f pixel(static_cast<float>(event.mouseWheelScroll.x), static_cast<float>(event.mouseWheelScroll.y));
+            state.camera.zoomAt(pixel, std::pow(AppState::ZOOM_RODA, event.mouseWheelScroll.delta));
+        }
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle) {
+            state.panning = true;
+            state.panOrigin = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+        }
+        if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle) {
+            state.panning = false;
+        }
+        if (event.type == sf::Event::MouseMoved && state.panning) {
+            const sf::Vector2i position(event.mouseMove.x, event.mouseMove.y);
+            state.camera.pan(sf::Vector2f(position - state.panOrigin));
+            state.panOrigin = position;
         }
         if (event.type == sf::Event::Closed) {
             window.close();
         }
         
         if (event.type == sf::Event::MouseButtonPressed) {
-            sf::Vector2f position = window.mapPixelToCoords({event.mouseButton.x, event.mouseButton.y});
-            position += state.mousart.getCursorTipOffset();
+            // a ponta do cursor está em pixels da tela; só depois vira coordenada do mundo
+            const sf::Vector2f pixel(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+            sf::Vector2f position = state.camera.pixelToWorld(pixel + state.mousart.getCursorTipOffset());
+            const bool control = sf::Keyboard::isKeyPressed(sf::Keyboard::LControl) ||
+                                 sf::Keyboard::isKeyPressed(sf::Keyboard::RControl);
                 
-                std::random_device rd;
-                std::mt19937 gen(rd());
+                std::mt19937& gen = state.rng;
                 std::uniform_real_distribution<float> velDist(-50.0f, 50.0f);
             
             const sf::Color harmoniousPalette[] = { sf::Color(3, 169, 244), sf::Color(156, 39, 176), sf::Color(255, 87, 34), sf::Color(76, 175, 80), sf::Color(255, 193, 7) };
             std::uniform_int_distribution<int> colorIndex(0, std::size(harmoniousPalette) - 1);
             
-            Particle* p = nullptr;
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                p = state.particleSystem.addParticle(2.0f, position, {velDist(gen), velDist(gen)}, harmoniousPalette[colorIndex(gen)]);
+            float mass = 0.0f;
+                if (control && event.mouseButton.button == sf::Mouse::Left) {
+                enqueue(state, SimCommand::despawn(position, AppState::RAIO_REMOCAO));
+                } else if (event.mouseButton.button == sf::Mouse::Left) {
+                mass = 2.0f;
                 } else if (event.mouseButton.button == sf::Mouse::Right) {
-                p = state.particleSystem.addParticle(10.0f, position, {velDist(gen), velDist(gen)}, harmoniousPalette[colorIndex(gen)]);
+                mass = 10.0f;
             }
-            if (p) {
-                p->setParticleType(state.currentParticleType);
+            if (mass > 0.0f) {
+                const sf::Vector2f velocity(velDist(gen), velDist(gen));
+                const sf::Color color = harmoniousPalette[colorIndex(gen)];
+                enqueue(state, SimCommand::spawn(mass, position, velocity, color, state.currentParticleType));
             }
         }
         
@@ -192,17 +508,88 @@ void processInput(sf::RenderWindow& window, AppState& state) {
                 case sf::Keyboard::G: state.gravityEnabled = !state.gravityEnabled; break;
                 case sf::Keyboard::R: state.repulsionEnabled = !state.repulsionEnabled; if(state.repulsionEnabled) state.collisionsEnabled = false; break;
                 case sf::Keyboard::L: state.collisionsEnabled = !state.collisionsEnabled; if(state.collisionsEnabled) state.repulsionEnabled = false; break;
-                case sf::Keyboard::C: while (state.particleSystem.getParticleCount() > 0) state.particleSystem.removeParticle(size_t(0)); break;
+                case sf::Keyboard::C: enqueue(state, SimCommand::simple(SimCommand::Type::Clear)); break;
                     case sf::Keyboard::Space:
-                        for (int i = 0; i < 20; ++i) {
-                        state.particleSystem.generateRandomParticle(2.0f, 2.0f)->setParticleType(state.currentParticleType); 
-                        }
+                        enqueue(state, SimCommand::spawnRandom(20, 2.0f, 2.0f, state.currentParticleType));
                         break;
                 case sf::Keyboard::M: state.mouseForceEnabled = !state.mouseForceEnabled; state.mousart.setForceMode(state.mouseForceEnabled); break;
                 case sf::Keyboard::N: if (state.mouseForceEnabled) state.mouseForceAttractMode = !state.mouseForceAttractMode; break;
                 case sf::Keyboard::Add: case sf::Keyboard::Equal: if (state.mouseForceEnabled) state.mouseForceStrength = std::min(AppState::MAX_MOUSE_FORCE, state.mouseForceStrength + AppState::MOUSE_FORCE_STEP); break;
                 case sf::Keyboard::Subtract: case sf::Keyboard::Hyphen: if (state.mouseForceEnabled) state.mouseForceStrength = std::max(AppState::MIN_MOUSE_FORCE, state.mouseForceStrength - AppState::MOUSE_FORCE_STEP); break;
                 case sf::Keyboard::K: state.mousart.cycleCursorType(); break;
+                case sf::Keyboard::V: {
+                    SimCommand command = SimCommand::simple(SimCommand::Type::SetNeighborSkin);
+                    command.value = state.particleSystem.getNeighborSkin() > 0.0f ? 0.0f : AppState::SKIN_PADRAO;
+                    enqueue(state, command);
+                    break;
+                }
+                case sf::Keyboard::J:
+                    // impulso -> 1 -> 2 -> 4 -> 8 -> impulso
+                    state.solverIterations = (state.solverIterations >= AppState::MAX_ITERACOES_SOLVER) ? 0
+                                           : std::max(1, state.solverIterations * 2);
+                    break;
+                case sf::Keyboard::E:
+                    state.integrator = static_cast<StepKernels::IntegratorType>(
+                        (static_cast<size_t>(state.integrator) + 1) % StepKernels::INTEGRATOR_COUNT);
+                    break;
+                case sf::Keyboard::A: state.adaptiveSubsteps = !state.adaptiveSubsteps; break;
+                case sf::Keyboard::H: state.fluidEnabled = !state.fluidEnabled; break;
+                case sf::Keyboard::W: {
+                    SimCommand command = SimCommand::withOption(SimCommand::Type::AddBody,
+                                                                static_cast<std::uint8_t>(BodyShape::SoftBox));
+                    command.position = state.mousePositionWindow;
+                    enqueue(state, command);
+                    break;
+                }
+                case sf::Keyboard::Q: {
+                    SimCommand command = SimCommand::withOption(SimCommand::Type::AddBody,
+                                                                static_cast<std::uint8_t>(BodyShape::Chain));
+                    command.position = state.mousePositionWindow;
+                    enqueue(state, command);
+                    break;
+                }
+                case sf::Keyboard::X:
+                    enqueue(state, SimCommand::withOption(SimCommand::Type::SetRenderMode, static_cast<std::uint8_t>(
+                        (static_cast<size_t>(state.particleSystem.getRenderMode()) + 1) %
+                        static_cast<size_t>(RenderMode::Count))));
+                    break;
+                case sf::Keyboard::Y:
+                    state.speciesPreset = static_cast<SpeciesPreset>(
+                        (static_cast<size_t>(state.speciesPreset) + 1) % static_cast<size_t>(SpeciesPreset::Count));
+                    enqueue(state, SimCommand::withOption(SimCommand::Type::SetSpeciesPreset,
+                                                          static_cast<std::uint8_t>(state.speciesPreset)));
+                    break;
+                case sf::Keyboard::Z:
+                    state.obstacleScene = static_cast<ObstacleScene>(
+                        (static_cast<size_t>(state.obstacleScene) + 1) % static_cast<size_t>(ObstacleScene::Count));
+                    enqueue(state, SimCommand::withOption(SimCommand::Type::LoadObstacleScene,
+                                                          static_cast<std::uint8_t>(state.obstacleScene)));
+                    break;
+                case sf::Keyboard::B: {
+                    BroadphaseType next = BroadphaseType::Grid;
+                    switch (state.particleSystem.getBroadphaseType()) {
+                        case BroadphaseType::Grid: next = BroadphaseType::SweepAndPrune; break;
+                        case BroadphaseType::SweepAndPrune: next = BroadphaseType::Tiles; break;
+                        default: break;
+                    }
+                    enqueue(state, SimCommand::withOption(SimCommand::Type::SetBroadphase, static_cast<std::uint8_t>(next)));
+                    break;
+                }
+                case sf::Keyboard::P: {
+                    // fixa o padrão atual do mouse como campo permanente da cena
+                    SimCommand command = SimCommand::simple(SimCommand::Type::AddForceField);
+                    command.field = ParticleSystem::makeMouseField(makeInputs(state));
+                    enqueue(state, command);
+                    break;
+                }
+                case sf::Keyboard::O: enqueue(state, SimCommand::simple(SimCommand::Type::ClearForceFields)); break;
+                case sf::Keyboard::D: state.camera.fitWorld(); break;
+                case sf::Keyboard::Left:  state.camera.pan({state.camera.getViewport().x * AppState::PASSO_SETAS, 0.0f}); break;
+                case sf::Keyboard::Right: state.camera.pan({-state.camera.getViewport().x * AppState::PASSO_SETAS, 0.0f}); break;
+                case sf::Keyboard::Up:    state.camera.pan({0.0f, state.camera.getViewport().y * AppState::PASSO_SETAS}); break;
+                case sf::Keyboard::Down:  state.camera.pan({0.0f, -state.camera.getViewport().y * AppState::PASSO_SETAS}); break;
+                case sf::Keyboard::F5: enqueue(state, SimCommand::simple(SimCommand::Type::SaveSnapshot)); break;
+                case sf::Keyboard::F9: enqueue(state, SimCommand::simple(SimCommand::Type::LoadSnapshot)); break;
                 case sf::Keyboard::S: state.instructions.setFillColor(state.instructions.getFillColor().a > 0 ? sf::Color::Transparent : sf::Color::White); break;
                 case sf::Keyboard::I: state.collisionRestitution = std::min(1.0f, state.collisionRestitution + 0.05f); break;
                 case sf::Keyboard::U: state.collisionRestitution = std::max(0.0f, state.collisionRestitution - 0.05f); break;
@@ -231,24 +618,279 @@ void processInput(sf::RenderWindow& window, AppState& state) {
     }
 }
 
-void updatePhysics(AppState& state, float dt) {
+ParticleSystem::PhysicsInputState makeInputs(const AppState& state) {
     ParticleSystem::PhysicsInputState inputs;
     inputs.gravityEnabled = state.gravityEnabled;
     inputs.gravitationalAcceleration = state.desiredGravitationalAcceleration;
     inputs.repulsionEnabled = state.repulsionEnabled;
     inputs.repulsionStrength = AppState::REPULSAO_PADRAO;
+    inputs.collisionsEnabled = state.collisionsEnabled;
     inputs.collisionRestitution = state.collisionRestitution;
     inputs.mouseForceEnabled = state.mouseForceEnabled;
     inputs.mousePosition = state.mousePositionWindow;
     inputs.mouseForceStrength = state.mouseForceStrength;
     inputs.mouseForceAttractMode = state.mouseForceAttractMode;
     inputs.forceMode = state.currentForceMode;
+    inputs.solverIterations = state.solverIterations;
+    inputs.integrator = state.integrator;
+    inputs.adaptiveSubsteps = state.adaptiveSubsteps;
+    inputs.fluidEnabled = state.fluidEnabled;
+    return inputs;
+}
+
+void enqueue(AppState& state, const SimCommand& command) {
+    if (!state.commands.push(command)) {
+        std::cerr << "[AVISO] Fila de comandos cheia, comando descartado" << std::endl;
+    }
+}
+
+void applyCommands(AppState& state) {
+    state.drained.clear();
+    if (state.commands.drain(state.drained) == 0) return;
+
+    ParticleSystem& system = state.particleSystem;
+    // spawns seguidos viram um lote só; qualquer outro comando fecha o lote antes,
+    // para que a ordem entre eles seja a mesma em que chegaram (e a da gravação)
+    auto flushSpawns = [&state, &system]() {
+        if (state.spawnBatch.empty()) return;
+        system.addParticles(state.spawnBatch.data(), state.spawnBatch.size());
+        state.spawnBatch.clear();
+    };
+
+    for (const SimCommand& command : state.drained) {
+        if (command.type == SimCommand::Type::Spawn) {
+            state.spawnBatch.push_back({command.mass, command.position, command.velocity, command.color,
+                                        command.particleType});
+            state.recorder.recordSpawn(command.mass, command.position, command.velocity, command.color,
+                                       command.particleType);
+            continue;
+        }
+        flushSpawns();
+
+        switch (command.type) {
+            case SimCommand::Type::SpawnRandom:
+                system.generateRandomParticles(static_cast<int>(command.count), command.mass, command.maxMass,
+                                               command.particleType);
+                state.recorder.recordSpawnRandom(command.count, command.mass, command.maxMass, command.particleType);
+                break;
+            case SimCommand::Type::Despawn:
+                system.removeParticlesNear(command.position, command.value);
+                state.recorder.recordDespawn(command.position, command.value);
+                break;
+            case SimCommand::Type::Clear:
+                while (system.getParticleCount() > 0) system.removeParticle(size_t(0));
+                state.recorder.recordClear();
+                break;
+            case SimCommand::Type::SetNeighborSkin:
+                system.setNeighborSkin(command.value);
+                state.recorder.recordNeighborSkin(command.value);
+                break;
+            case SimCommand::Type::SetBroadphase:
+                system.setBroadphase(static_cast<BroadphaseType>(command.option));
+                state.recorder.recordBroadphase(static_cast<BroadphaseType>(command.option));
+                break;
+            case SimCommand::Type::SetRenderMode:
+                system.setRenderMode(static_cast<RenderMode>(command.option));
+                break;
+            case SimCommand::Type::SetSpeciesPreset:
+                system.loadSpeciesPreset(static_cast<SpeciesPreset>(command.option));
+                state.recorder.recordSpeciesPreset(static_cast<SpeciesPreset>(command.option));
+                break;
+            case SimCommand::Type::LoadObstacleScene: {
+                ObstacleSet& obstacles = system.getObstacles();
+                obstacles.loadScene(static_cast<ObstacleScene>(command.option), system.getWorldWidth(),
+                                    system.getWorldHeight());
+                // a gravação guarda os obstáculos em si, não o nome da cena
+                state.recorder.recordClearObstacles();
+                for (const Obstacle& obstacle : obstacles.list()) state.recorder.recordAddObstacle(obstacle);
+                break;
+            }
+            case SimCommand::Type::AddBody:
+                system.addBody(static_cast<BodyShape>(command.option), command.position);
+                state.recorder.recordAddBody(static_cast<BodyShape>(command.option), command.position);
+                break;
+            case SimCommand::Type::AddForceField:
+                system.getForceFields().add(command.field);
+                state.recorder.recordAddForceField(command.field);
+                break;
+            case SimCommand::Type::ClearForceFields:
+                system.getForceFields().clear();
+                state.recorder.recordClearForceFields();
+                break;
+            case SimCommand::Type::SaveSnapshot:
+                system.saveSnapshot(AppState::SNAPSHOT_PADRAO);
+                break;
+            case SimCommand::Type::LoadSnapshot:
+                loadSnapshot(state, AppState::SNAPSHOT_PADRAO);
+                break;
+            default:
+                break;
+        }
+    }
+    flushSpawns();
+}
+
+bool loadSnapshot(AppState& state, const std::string& path) {
+    Snapshot::View view;
+    if (!view.open(path) || !state.particleSystem.loadSnapshot(view)) {
+        return false;
+    }
+    // o log guarda o arquivo inteiro: o do disco pode ser regravado pelo F5 depois
+    state.recorder.recordLoadSnapshot(view);
+    // o snapshot traz o tamanho do mundo em que foi salvo
+    state.camera.setWorldSize(state.particleSystem.getWorldWidth(), state.particleSystem.getWorldHeight());
+    return true;
+}
+
+void updatePhysics(AppState& state, float dt) {
+    // o que a entrada pediu desde o último passo entra de uma vez, antes dele
+    applyCommands(state);
+    const ParticleSystem::PhysicsInputState inputs = makeInputs(state);
 
+    state.recorder.recordStep(dt, inputs);
     state.particleSystem.update(dt, inputs);
+    state.exporter.onStep(state.particleSystem);
+}
+
+int runReplay(const std::string& path, const std::string& exportPath, const StateExporter::Options& exportOptions,
+              const PhysicsOptions& physicsOptions, const RenderOptions& renderOptions) {
+    InputReplayer replayer;
+    if (!replayer.open(path)) {
+        return 1;
+    }
+
+    StateExporter exporter;
+    if (!exportPath.empty() && !exporter.open(exportPath, exportOptions)) {
+        return 1;
+    }
+
+    FrameWriter frames;
+    if (!renderOptions.target.empty() && !frames.open(renderOptions.target)) {
+        return 1;
+    }
+    // com os quadros na saída padrão, o relatório vai para a de erro
+    std::FILE* report = frames.writesToStdout() ? stderr : stdout;
+
+    SoftwareRenderer renderer;
+    double renderSeconds = 0.0;
+    if (frames.isOpen()) {
+        const unsigned width = renderOptions.width > 0 ? renderOptions.width
+                                                       : static_cast<unsigned>(replayer.getWidth());
+        const unsigned height = renderOptions.height > 0 ? renderOptions.height
+                                                         : static_cast<unsigned>(replayer.getHeight());
+        renderer.resize(width, height, replayer.getWidth(), replayer.getHeight());
+        sf::Image background;
+        if (AssetPack::loadImage("background.png", background)) {
+            renderer.setBackground(background);
+        } else {
+            std::cerr << "[AVISO] Não foi possível carregar 'assets/background.png', usando cor de fallback." << std::endl;
+        }
+        // sem janela ninguém faz os uploads pendentes: as texturas entram antes do primeiro quadro
+        Particle::preloadTextures();
+        std::fprintf(report, "[INFO] Quadros %ux%u (%s) em '%s'\n", width, height,
+                     FrameWriter::formatName(frames.getFormat()), renderOptions.target.c_str());
+    }
+
+    ParticleSystem particleSystem(replayer.getWidth(), replayer.getHeight());
+    particleSystem.setUnbounded(replayer.isUnbounded());
+    physicsOptions.applyTo(particleSystem);
+    // a busca de pares e o skin vêm do log, a não ser que a linha de comando escolha
+    replayer.setOverrides({physicsOptions.broadphaseChosen, physicsOptions.neighborSkinChosen});
+    InputReplayer::Stats stats;
+    std::uint64_t step = 0;
+    const bool complete = replayer.run(particleSystem, stats, [&](const ParticleSystem& system) {
+        exporter.onStep(system);
+        if (frames.isOpen() && step++ % renderOptions.stepInterval == 0) {
+            TextureManager::processPendingUploads();
+            const auto begin = std::chrono::steady_clock::now();
+            renderer.render(system, ThreadPool::shared());
+            renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            frames.write(renderer.pixels(), static_cast<unsigned>(renderer.getWidth()),
+                         static_cast<unsigned>(renderer.getHeight()));
+        }
+    });
+    exporter.close();
+    frames.close();
+
+    const ParticleSystem::StepTimings& t = particleSystem.getStepTimings();
+    const double total = t.syncToSoA + t.neighbors + t.forces + t.integrate + t.syncFromSoA + t.collisions +
+                         t.constraints + t.trails + t.heads + t.splat;
+    const struct { const char* name; double seconds; } phases[] = {
+        {"syncToSoA", t.syncToSoA}, {"neighbors", t.neighbors}, {"forces", t.forces}, {"integrate", t.integrate},
+        {"syncFromSoA", t.syncFromSoA}, {"collisions", t.collisions}, {"constraints", t.constraints},
+        {"trails", t.trails}, {"heads", t.heads}, {"splat", t.splat},
+    };
+
+    std::fprintf(report, "replay: %s (versão %u)\n", path.c_str(), replayer.getVersion());
+    std::fprintf(report, "passos: %llu | spawns: %llu | pico de partículas: %zu | tempo total: %.3f s\n",
+                static_cast<unsigned long long>(stats.steps), static_cast<unsigned long long>(stats.spawns),
+                stats.peakParticles, stats.wallSeconds);
+    std::fprintf(report, "%-12s %12s %12s %8s\n", "fase", "total (ms)", "us/passo", "%");
+    for (const auto& phase : phases) {
+        const double perStep = t.steps > 0 ? phase.seconds * 1e6 / t.steps : 0.0;
+        const double share = total > 0.0 ? phase.seconds * 100.0 / total : 0.0;
+        std::fprintf(report, "%-12s %12.3f %12.2f %7.1f%%\n", phase.name, phase.seconds * 1e3, perStep, share);
+    }
+    if (t.steps > 0) {
+        std::fprintf(report, "passos/s: %.1f | subpassos por passo: %.2f\n", t.steps / stats.wallSeconds,
+                    static_cast<double>(t.substeps) / t.steps);
+    }
+    if (frames.getFramesWritten() > 0) {
+        const SoftwareRenderer::Stats& r = renderer.getStats();
+        std::fprintf(report, "quadros: %llu | desenho: %.2f ms/quadro (%zu threads) | triângulos: %zu | entradas por tile: %.1f\n",
+                     static_cast<unsigned long long>(frames.getFramesWritten()),
+                     renderSeconds * 1e3 / static_cast<double>(frames.getFramesWritten()), r.threads, r.triangles,
+                     r.tiles > 0 ? static_cast<double>(r.tileEntries) / r.tiles : 0.0);
+    }
+    const NeighborList::Stats& n = particleSystem.getNeighborStats();
+    if (n.updates > 0) {
+        std::fprintf(report, "pares: skin %.1f | reconstruções: %llu de %llu (%.1f%%) | pares: %zu | memória: %.1f KB\n",
+                    particleSystem.getNeighborSkin(), static_cast<unsigned long long>(n.rebuilds),
+                    static_cast<unsigned long long>(n.updates), n.rebuilds * 100.0 / n.updates,
+                    n.pairs, n.memoryBytes / 1024.0);
+        const Broadphase::Stats& b = particleSystem.getBroadphase().getStats();
+        std::fprintf(report, "busca de pares: %s | candidatos por par: %.2f\n", particleSystem.getBroadphase().getName(),
+                    b.pairs > 0 ? static_cast<double>(b.candidates) / b.pairs : 0.0);
+        const ContactSolver::Stats& c = particleSystem.getContactStats();
+        std::fprintf(report, "contatos (último passo): %zu | cores: %zu | lotes: %zu | transbordo: %zu\n",
+                    c.contacts, c.colors, c.batches, c.overflow);
+        std::fprintf(report, "solver: %d iteração(ões) | visitas a pares: %zu | warm start: %zu | sobreposição média %.3f px, máx %.2f px\n",
+                    c.iterations, c.pairVisits, c.warmStarted, c.meanPenetration, c.maxPenetration);
+        if (particleSystem.getBroadphaseType() == BroadphaseType::Grid) {
+            const SpatialGrid::GridStats& g = particleSystem.getGridStats();
+            std::fprintf(report, "grade: célula %.1f px | %zu grandes (célula %.1f px) | reajustes: %llu\n",
+                        g.cellSize, g.outliers, g.coarseCellSize, static_cast<unsigned long long>(g.retunes));
+        } else if (particleSystem.getBroadphaseType() == BroadphaseType::Tiles) {
+            const TileGrid::TileStats& g = particleSystem.getTileStats();
+            std::fprintf(report, "tiles: célula %.1f px | ativos: %zu | livres: %zu | memória: %.1f KB\n",
+                        g.cellSize, g.activeTiles, g.pooledTiles, g.memoryBytes / 1024.0);
+        }
+    }
+    return (complete && !frames.hasFailed()) ? 0 : 1;
+}
+
+int runSweep(const SweepOptions& options) {
+    WorldBatch batch;
+    batch.setParams(options.params);
+    batch.addGrid(options.restitution, options.gravity, options.mouseForce, options.seeds, options.baseSeed);
+    std::printf("[INFO] Varredura: %zu mundos de %d partículas, %d passos cada\n", batch.size(),
+                options.params.particles, options.params.steps);
+    std::fflush(stdout);
+
+    batch.run(ThreadPool::shared());
+    const WorldBatch::Stats& stats = batch.getStats();
+    std::printf("mundos: %zu | threads: %zu | tempo total: %.3f s | passos de mundo/s: %.0f | partículas x passos/s: %.3g\n",
+                stats.worlds, stats.threads, stats.seconds, stats.worldStepsPerSecond,
+                stats.worldStepsPerSecond * options.params.particles);
+    if (!batch.writeSummary(options.summaryPath)) {
+        return 1;
+    }
+    std::printf("[INFO] Resumo em '%s'\n", options.summaryPath.c_str());
+    return 0;
 }
 
 void updateUI(sf::RenderWindow& window, AppState& state, float real_dt) {
-    state.mousePositionWindow = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+    state.mousePositionWindow = state.camera.pixelToWorld(sf::Vector2f(sf::Mouse::getPosition(window)));
     state.mousart.update(sf::Mouse::getPosition(window), window);
 
     float fps = (real_dt > 0.0001f) ? 1.0f / real_dt : 0.0f;
@@ -265,20 +907,44 @@ void updateUI(sf::RenderWindow& window, AppState& state, float real_dt) {
         "+/-: Intensidade da Força (" + std::to_string(static_cast<int>(state.mouseForceStrength)) + ")\n"
         "I/U: Restituição (" + std::to_string(state.collisionRestitution).substr(0, 4) + ")\n"
         "T: Tipo de Partícula (" + state.particleTypeName + ")\n"
-        "K: Alternar Mouse\n"
+        "P/O: Fixar/Limpar Campos (" + std::to_string(state.particleSystem.getForceFields().size()) + ")\n"
+        "V: Listas de Verlet (" + std::string(state.particleSystem.getNeighborSkin() > 0.0f ? "ON" : "OFF") + ")\n"
+        "B: Busca de Pares (" + std::string(state.particleSystem.getBroadphase().getName()) + ")\n"
+        "Z: Obstáculos (" + std::string(ObstacleSet::sceneName(state.obstacleScene)) + ")\n"
+        "E: Integrador (" + std::string(StepKernels::integratorName(state.integrator)) + ")\n"
+        "A: Subpassos Adaptativos (" + std::string(state.adaptiveSubsteps ? "ON" : "OFF") + ", " +
+            std::to_string(state.particleSystem.getLastSubsteps()) + ")\n"
+        "H: Fluido SPH (" + std::string(state.fluidEnabled ? "ON" : "OFF") + ")\n"
+        "W/Q: Corpo Mole/Corrente (" + std::to_string(state.particleSystem.getConstraints().size()) + " restrições)\n"
+        "X: Imagem (" + std::string(DensitySplat::modeName(state.particleSystem.getRenderMode())) +
+            (state.particleSystem.isSplatting() ? ", densidade" : ", partículas") + ")\n"
+        "Y: Espécies (" + std::string(SpeciesTable::presetName(state.speciesPreset)) + ")\n"
+        "J: Iterações do Solver (" + (state.solverIterations > 0 ? std::to_string(state.solverIterations) : std::string("impulso")) + ")\n"
+        "K: Alternar Mouse | Ctrl+Clique: Remover\n"
+        "Roda/Botão do meio/Setas/D: Câmera (zoom " + std::to_string(state.camera.getZoom()).substr(0, 4) + ", mundo " +
+            std::to_string(static_cast<int>(state.particleSystem.getWorldWidth())) + "x" +
+            std::to_string(static_cast<int>(state.particleSystem.getWorldHeight())) +
+            (state.particleSystem.isUnbounded() ? ", aberto" : "") + ")\n"
+        "F5/F9: Salvar/Carregar Snapshot\n"
         "S: Mostrar/Ocultar Controles\n"
         "C: Limpar Tudo | Espaço: Adicionar Aleatórias\n\n"
         "Partículas: " + std::to_string(state.particleSystem.getParticleCount()) +
+        (state.particleSystem.isSplatting() ? std::string() :
+            " (" + std::to_string(state.particleSystem.getVisibleCount()) + " na tela)") +
         "\nFPS: " + std::to_string(static_cast<int>(fps));
     state.instructions.setString(sf::String::fromUtf8(statusText.begin(), statusText.end()));
 }
 
 void render(sf::RenderWindow& window, AppState& state) {
     window.clear();
+    window.setView(state.camera.getView());
     window.draw(state.backgroundSprite);
 
     state.particleSystem.draw(window);
-    
+
+    // texto e cursor ficam em pixels da tela, fora da câmera
+    const sf::Vector2u windowSize = window.getSize();
+    window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, static_cast<float>(windowSize.x), static_cast<float>(windowSize.y))));
     if (state.showInstructions) {
         window.draw(state.instructions);
     }
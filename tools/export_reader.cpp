@@ -0,0 +1,97 @@
+// Leitor dos exports de estado gravados com `Chaos --export`.
+//
+//   chaos-export-reader <arquivo>                       resumo do arquivo
+//   chaos-export-reader <arquivo> --frame N             CSV do frame N
+//   chaos-export-reader <arquivo> --frame N --particle I  só a partícula I
+#include "StateExportFormat.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+    const char* const FIELD_COLUMNS[StateExport::FieldCount] = {
+        "x,y", "prev_x,prev_y", "vx,vy", "mass", "radius"
+    };
+
+    void printRow(const StateExport::Frame& frame, std::uint32_t particle) {
+        std::printf("%u", particle);
+        for (std::uint32_t f = 0; f < StateExport::FieldCount; ++f) {
+            const std::vector<float>& values = frame.fields[f];
+            if (values.empty()) continue;
+            const std::uint32_t components = StateExport::FIELD_COMPONENTS[f];
+            for (std::uint32_t c = 0; c < components; ++c) {
+                std::printf(",%g", values[static_cast<size_t>(particle) * components + c]);
+            }
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: chaos-export-reader <arquivo> [--frame N] [--particle I]" << std::endl;
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    long long frameIndex = -1;
+    long long particle = -1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--frame" && i + 1 < argc) {
+            frameIndex = std::atoll(argv[++i]);
+        } else if (arg == "--particle" && i + 1 < argc) {
+            particle = std::atoll(argv[++i]);
+        } else {
+            std::cerr << "Argumento desconhecido: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    StateExport::Reader reader;
+    if (!reader.open(path)) {
+        return 1;
+    }
+
+    const StateExport::FileHeader& header = reader.header();
+    if (frameIndex < 0) {
+        std::printf("frames: %llu\n", static_cast<unsigned long long>(reader.frameCount()));
+        std::printf("chunks: %zu\n", reader.chunkCount());
+        std::printf("intervalo: %u passos\n", header.stepInterval);
+        std::printf("quantizado: %s\n", header.quantized ? "sim" : "não");
+        std::printf("campos:");
+        for (std::uint32_t f = 0; f < StateExport::FieldCount; ++f) {
+            if (header.fields & (1u << f)) std::printf(" %s", FIELD_COLUMNS[f]);
+        }
+        std::printf("\n");
+        return 0;
+    }
+
+    StateExport::Frame frame;
+    if (!reader.readFrame(static_cast<std::uint64_t>(frameIndex), frame)) {
+        std::cerr << "Frame " << frameIndex << " não encontrado ou corrompido." << std::endl;
+        return 1;
+    }
+
+    std::printf("# frame %lld, passo %llu, %u partículas\n", frameIndex,
+                static_cast<unsigned long long>(frame.step), frame.particleCount);
+    std::printf("particle");
+    for (std::uint32_t f = 0; f < StateExport::FieldCount; ++f) {
+        if (header.fields & (1u << f)) std::printf(",%s", FIELD_COLUMNS[f]);
+    }
+    std::printf("\n");
+
+    if (particle >= 0) {
+        if (particle >= frame.particleCount) {
+            std::cerr << "Partícula " << particle << " não existe neste frame." << std::endl;
+            return 1;
+        }
+        printRow(frame, static_cast<std::uint32_t>(particle));
+    } else {
+        for (std::uint32_t i = 0; i < frame.particleCount; ++i) {
+            printRow(frame, i);
+        }
+    }
+    return 0;
+}
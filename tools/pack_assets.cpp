@@ -0,0 +1,134 @@
+// Empacota a pasta de assets num único arquivo indexado (ver src/AssetPack.h).
+//
+//   chaos-pack-assets <saida.pak> <pasta de assets> [--decode]
+//
+// Com --decode, as imagens são gravadas já decodificadas em RGBA8.
+#include "AssetPack.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct PendingEntry {
+        std::string name;
+        std::vector<unsigned char> data;
+        AssetPackFormat::Encoding encoding = AssetPackFormat::Raw;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+    };
+
+    bool isImage(const fs::path& path) {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga";
+    }
+
+    std::uint64_t alignUp(std::uint64_t value) {
+        return (value + AssetPackFormat::DATA_ALIGNMENT - 1) & ~(AssetPackFormat::DATA_ALIGNMENT - 1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: chaos-pack-assets <saida.pak> <pasta de assets> [--decode]" << std::endl;
+        return 1;
+    }
+
+    const fs::path outputPath = argv[1];
+    const fs::path root = argv[2];
+    const bool decode = argc > 3 && std::strcmp(argv[3], "--decode") == 0;
+
+    std::vector<PendingEntry> entries;
+    std::error_code error;
+    for (const auto& item : fs::recursive_directory_iterator(root, error)) {
+        if (!item.is_regular_file()) continue;
+
+        PendingEntry entry;
+        entry.name = fs::relative(item.path(), root).generic_string();
+
+        sf::Image image;
+        if (decode && isImage(item.path()) && image.loadFromFile(item.path().string())) {
+            const sf::Vector2u size = image.getSize();
+            const unsigned char* pixels = image.getPixelsPtr();
+            entry.data.assign(pixels, pixels + static_cast<size_t>(size.x) * size.y * 4);
+            entry.encoding = AssetPackFormat::Rgba8;
+            entry.width = size.x;
+            entry.height = size.y;
+        } else {
+            std::ifstream in(item.path(), std::ios::binary);
+            entry.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    if (error) {
+        std::cerr << "Erro ao ler " << root << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    // O runtime faz busca binária: a ordem tem que ser a de std::string_view::compare
+    std::sort(entries.begin(), entries.end(), [](const PendingEntry& a, const PendingEntry& b) { return a.name < b.name; });
+
+    AssetPackFormat::Header header{};
+    std::memcpy(header.magic, AssetPackFormat::MAGIC, sizeof(AssetPackFormat::MAGIC));
+    header.version = AssetPackFormat::VERSION;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.entriesOffset = alignUp(sizeof(header));
+    header.namesOffset = header.entriesOffset + entries.size() * sizeof(AssetPackFormat::Entry);
+
+    std::string names;
+    std::vector<AssetPackFormat::Entry> table(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        table[i] = AssetPackFormat::Entry{};
+        table[i].nameOffset = static_cast<std::uint32_t>(names.size());
+        table[i].nameLength = static_cast<std::uint32_t>(entries[i].name.size());
+        names += entries[i].name;
+    }
+
+    std::uint64_t cursor = alignUp(header.namesOffset + names.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        table[i].dataOffset = cursor;
+        table[i].dataSize = entries[i].data.size();
+        table[i].encoding = entries[i].encoding;
+        table[i].width = entries[i].width;
+        table[i].height = entries[i].height;
+        cursor = alignUp(cursor + entries[i].data.size());
+    }
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Não foi possível criar " << outputPath << std::endl;
+        return 1;
+    }
+
+    static const char padding[AssetPackFormat::DATA_ALIGNMENT] = {};
+    auto padTo = [&out](std::uint64_t offset) {
+        const std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+        out.write(padding, static_cast<std::streamsize>(offset - position));
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(header.entriesOffset);
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(table[0])));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+    for (size_t i = 0; i < entries.size(); ++i) {
+        padTo(table[i].dataOffset);
+        out.write(reinterpret_cast<const char*>(entries[i].data.data()), static_cast<std::streamsize>(entries[i].data.size()));
+    }
+
+    if (!out) {
+        std::cerr << "Falha ao gravar " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Empacotados " << entries.size() << " assets em " << outputPath << " (" << cursor << " bytes)" << std::endl;
+    return 0;
+}